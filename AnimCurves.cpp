@@ -0,0 +1,172 @@
+/*
+ *
+ * AnimCurves.cpp, release 1.0.
+ *
+ * Keyframed animation curves, evaluated in batch.  See AnimCurves.h.
+ *
+ * Software is "as-is" and carries no warranty.  It may be used without
+ *   restriction, but if you modify it, please change the filenames to
+ *   prevent confusion between different versions.
+ *
+ */
+
+#include <math.h>
+#include "AnimCurves.h"
+
+// Floats per value, by TrackType
+static const int trackDim[3] = { 1, 3, 4 };
+
+// **************************************
+// Segment lookup and interpolation     *
+// * * * * * * * * * * * * * * * * * * **
+
+// Returns the segment i, 0 <= i <= numKeys-2, with times[i] <= t < times[i+1].
+//   (Or i = numKeys-2 if t is the last time.)  t must be between the first and last times.
+//   The segment used last time, and the one after it, are tried first.
+static inline int FindSegment( const float* times, int numKeys, float t, int last )
+{
+	if ( times[last] <= t ) {
+		if ( t < times[last+1] ) {
+			return last;
+		}
+		if ( last+2 < numKeys && t < times[last+2] ) {
+			return last+1;
+		}
+	}
+	int lo = 0;
+	int hi = numKeys-1;
+	while ( hi-lo > 1 ) {			// times[lo] <= t <= times[hi]
+		int mid = (lo+hi)>>1;
+		if ( times[mid] <= t ) {
+			lo = mid;
+		}
+		else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+// Interpolates between the keys k0 and k1 (each pointing to the key's data),
+//   with u from 0 to 1 over the segment, and dt the length of the segment.
+template<int Dim, int Interp, bool IsQuat>
+inline void InterpolateSegment( const float* k0, const float* k1, float u, float dt, float* out )
+{
+	if ( Interp==AnimCurveSet::Linear ) {
+		if ( IsQuat ) {
+			Quatf q = Slerp( Quatf( k0[0], k0[1], k0[2], k0[3] ), Quatf( k1[0], k1[1], k1[2], k1[3] ), u );
+			out[0] = q.x;
+			out[1] = q.y;
+			out[2] = q.z;
+			out[3] = q.w;
+			return;
+		}
+		for ( int k=0; k<Dim; k++ ) {
+			out[k] = k0[k] + u*(k1[k] - k0[k]);
+		}
+	}
+	else if ( Interp==AnimCurveSet::Hermite ) {
+		// The keys are (value, tangent).  The tangents are scaled to the segment.
+		float v = 1.0f - u;
+		float h00 = (1.0f + 2.0f*u)*v*v;
+		float h10 = u*v*v*dt;
+		float h01 = u*u*(3.0f - 2.0f*u);
+		float h11 = -u*u*v*dt;
+		for ( int k=0; k<Dim; k++ ) {
+			out[k] = h00*k0[k] + h10*k0[Dim+k] + h01*k1[k] + h11*k1[Dim+k];
+		}
+	}
+	else {
+		// The keys are (in, value, out).  The Bezier curve is value0, out0, in1, value1.
+		float v = 1.0f - u;
+		float b0 = v*v*v;
+		float b1 = 3.0f*u*v*v;
+		float b2 = 3.0f*u*u*v;
+		float b3 = u*u*u;
+		for ( int k=0; k<Dim; k++ ) {
+			out[k] = b0*k0[Dim+k] + b1*k0[2*Dim+k] + b2*k1[k] + b3*k1[Dim+k];
+		}
+	}
+	if ( IsQuat ) {
+		float normInv = 1.0f/sqrtf( out[0]*out[0] + out[1]*out[1] + out[2]*out[2] + out[3]*out[3] );
+		for ( int k=0; k<4; k++ ) {
+			out[k] *= normInv;
+		}
+	}
+}
+
+// **************************************
+// AnimCurveSet class                   *
+// * * * * * * * * * * * * * * * * * * **
+
+template<int Dim, int Interp, bool IsQuat>
+void AnimCurveSet::EvaluateTracks( std::vector<Track>& tracks, const float* keyTimes,
+								   const float* keyData, float time, float* values )
+{
+	const int stride = Dim*(Interp+1);		// Floats per key
+	for ( Track& track : tracks ) {
+		const float* times = keyTimes + track.firstKey;
+		int last = track.numKeys-1;
+		float t = time < times[0] ? times[0] : ( time > times[last] ? times[last] : time );
+		int seg = FindSegment( times, track.numKeys, t, track.segment );
+		track.segment = seg;
+		float dt = times[seg+1] - times[seg];
+		float u = (t - times[seg])/dt;
+		const float* k0 = keyData + track.firstData + seg*stride;
+		InterpolateSegment<Dim, Interp, IsQuat>( k0, k0+stride, u, dt, values + track.value );
+	}
+}
+
+void AnimCurveSet::Clear()
+{
+	for ( int k=0; k<NumKinds; k++ ) {
+		kindTracks[k].clear();
+	}
+	trackKind.clear();
+	trackValue.clear();
+	keyTimes.clear();
+	keyData.clear();
+	values.clear();
+}
+
+int AnimCurveSet::AddTrack( TrackType type, Interpolation interp, int numKeys, const float* times, const float* data )
+{
+	assert( numKeys >= 2 );
+	int dim = trackDim[type];
+	int stride = dim*(interp+1);
+
+	Track track;
+	track.firstKey = (int)keyTimes.size();
+	track.numKeys = numKeys;
+	track.firstData = (int)keyData.size();
+	track.value = (int)values.size();
+	track.segment = 0;
+	for ( int i=0; i<numKeys; i++ ) {
+		assert( i==0 || times[i-1] < times[i] );
+		keyTimes.push_back( times[i] );
+	}
+	keyData.insert( keyData.end(), data, data + numKeys*stride );
+	values.resize( values.size() + dim, 0.0f );
+
+	int kind = 3*type + interp;
+	kindTracks[kind].push_back( track );
+	trackKind.push_back( kind );
+	trackValue.push_back( track.value );
+	return (int)trackKind.size() - 1;
+}
+
+void AnimCurveSet::Evaluate( float time )
+{
+	const float* t = keyTimes.data();
+	const float* d = keyData.data();
+	float* v = values.data();
+	EvaluateTracks<1, Linear, false>( kindTracks[3*ScalarTrack + Linear], t, d, time, v );
+	EvaluateTracks<1, Hermite, false>( kindTracks[3*ScalarTrack + Hermite], t, d, time, v );
+	EvaluateTracks<1, Bezier, false>( kindTracks[3*ScalarTrack + Bezier], t, d, time, v );
+	EvaluateTracks<3, Linear, false>( kindTracks[3*VectorTrack + Linear], t, d, time, v );
+	EvaluateTracks<3, Hermite, false>( kindTracks[3*VectorTrack + Hermite], t, d, time, v );
+	EvaluateTracks<3, Bezier, false>( kindTracks[3*VectorTrack + Bezier], t, d, time, v );
+	EvaluateTracks<4, Linear, true>( kindTracks[3*QuatTrack + Linear], t, d, time, v );
+	EvaluateTracks<4, Hermite, true>( kindTracks[3*QuatTrack + Hermite], t, d, time, v );
+	EvaluateTracks<4, Bezier, true>( kindTracks[3*QuatTrack + Bezier], t, d, time, v );
+}
@@ -0,0 +1,104 @@
+/*
+ *
+ * AnimCurves.h, release 1.0.
+ *
+ * Keyframed animation curves, evaluated in batch.
+ *   An AnimCurveSet holds many tracks.  A track is a sequence of keys
+ *   (times and values) for a scalar, a vector in R3 or a rotation
+ *   (a quaternion), with linear, Hermite or Bezier interpolation.
+ *   The keys of all tracks are stored contiguously, and Evaluate()
+ *   computes the values of all tracks at one time.
+ *
+ *   The tracks are grouped by their type and interpolation, and each group
+ *   is evaluated by its own loop, with no branching on the kind of track.
+ *   Each track remembers the segment (the pair of keys) it used last time,
+ *   so when time moves forward a little each frame, finding the segment
+ *   takes constant time.  Other times use a binary search.
+ *
+ * Software is "as-is" and carries no warranty.  It may be used without
+ *   restriction, but if you modify it, please change the filenames to
+ *   prevent confusion between different versions.
+ *
+ */
+
+#ifndef ANIM_CURVES_H
+#define ANIM_CURVES_H
+
+#include <assert.h>
+#include <vector>
+#include "TRSf.h"
+
+// **************************************
+// AnimCurveSet class                   *
+// * * * * * * * * * * * * * * * * * * **
+
+class AnimCurveSet {
+
+public:
+	enum TrackType { ScalarTrack, VectorTrack, QuatTrack };		// 1, 3 or 4 floats per value
+	enum Interpolation { Linear, Hermite, Bezier };
+
+public:
+	AnimCurveSet() {}
+
+	AnimCurveSet( const AnimCurveSet& ) = delete;
+	AnimCurveSet& operator= ( const AnimCurveSet& ) = delete;
+
+	void Clear();
+
+	// Adds a track, and returns its index.
+	//   times[] holds numKeys (at least two) increasing times.
+	//   keyData[] holds, for each key in order:
+	//       Linear:  the value.
+	//       Hermite: the value, then the tangent (the derivative with respect to time).
+	//       Bezier:  the incoming control point, the value, then the outgoing control point.
+	//   A quaternion value is stored as x, y, z, w.  Linear quaternion tracks use Slerp();
+	//   the others interpolate the four components, then normalize.  For these,
+	//   consecutive keys should have a positive inner product (negate keys as needed).
+	int AddTrack( TrackType type, Interpolation interp, int numKeys, const float* times, const float* keyData );
+
+	// Computes the values of all tracks at the given time.
+	//   Times before the first key or after the last key of a track give
+	//   the first or last value.
+	void Evaluate( float time );
+
+	// The values computed by the last Evaluate()
+	int GetNumTracks() const { return (int)trackKind.size(); }
+	float GetScalar( int track ) const { assert( TypeOf(track)==ScalarTrack ); return values[trackValue[track]]; }
+	const float* GetVector( int track ) const { assert( TypeOf(track)==VectorTrack ); return &values[trackValue[track]]; }
+	Quatf GetQuat( int track ) const;
+
+private:
+	struct Track {
+		int firstKey;		// Index of the first time in keyTimes
+		int numKeys;
+		int firstData;		// Index of the first key's data in keyData
+		int value;			// Index of the value in values
+		int segment;		// The segment used by the last Evaluate()
+	};
+
+	static const int NumKinds = 9;			// Three types times three interpolations
+	std::vector<Track> kindTracks[NumKinds];	// The tracks, grouped by kind = 3*type + interp
+	std::vector<int> trackKind;				// The kind of each track, by track index
+	std::vector<int> trackValue;			// The index of each track's value in values
+
+	std::vector<float> keyTimes;
+	std::vector<float> keyData;
+	std::vector<float> values;
+
+	TrackType TypeOf( int track ) const { return (TrackType)(trackKind[track]/3); }
+
+	// Evaluates all tracks of one kind
+	template<int Dim, int Interp, bool IsQuat>
+	static void EvaluateTracks( std::vector<Track>& tracks, const float* keyTimes,
+								const float* keyData, float time, float* values );
+};
+
+inline Quatf AnimCurveSet::GetQuat( int track ) const
+{
+	assert( TypeOf(track)==QuatTrack );
+	const float* v = &values[trackValue[track]];
+	return Quatf( v[0], v[1], v[2], v[3] );
+}
+
+#endif // ANIM_CURVES_H
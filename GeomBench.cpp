@@ -0,0 +1,202 @@
+//
+//  GeomBench.cpp
+//
+//   Times the mesh generation of the sphere, torus, cylinder and teapot as the
+//   number of threads used by ParallelFor grows.  The meshes are generated
+//   into ordinary memory, so only the generation itself is timed.
+//
+
+
+// Use the static library (so glew32.dll is not needed):
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <math.h>
+#include <vector>
+
+// Enable standard input and output via printf(), etc.
+// Put this include *after* the includes for glew and GLFW!
+#include <stdio.h>
+#include <string.h>
+
+#include "GeomBench.h"
+#include "GlGeomSphere.h"
+#include "GlGeomTorus.h"
+#include "GlGeomCylinder.h"
+#include "GlGeomProcedural.h"
+#include "GlGeomTeapot.h"
+#include "MathMisc.h"
+#include "ParallelFor.h"
+#include "SurfaceProj.h"
+
+const int GeomBenchRepeats = 10;
+
+// Time the generation of one shape (positions, normals and texture coordinates),
+//    with 1, 2, 4, ... threads.
+void TimeGeometry(const char* name, GlGeomBase& shape, int maxThreads)
+{
+    const int stride = 8;
+    int numVerts = shape.GetNumVerticesTexCoords();
+    std::vector<float> serialVbo((size_t)numVerts * stride);
+    std::vector<unsigned int> serialEbo(shape.GetNumElementsMax());
+    std::vector<float> vbo(serialVbo.size());
+    std::vector<unsigned int> ebo(serialEbo.size());
+    printf(" %s (%d vertices, %d elements):\n", name, numVerts, (int)serialEbo.size());
+
+    double serialTime = 0.0;
+    for (int numThreads = 1; ; numThreads = (2 * numThreads < maxThreads ? 2 * numThreads : maxThreads)) {
+        SetParallelForThreads(numThreads);
+        float* vboData = (numThreads == 1) ? serialVbo.data() : vbo.data();
+        unsigned int* eboData = (numThreads == 1) ? serialEbo.data() : ebo.data();
+        shape.CalcVboAndEbo(vboData, eboData, 0, 3, 6, stride);        // Warm up: page faults, etc.
+        double startTime = glfwGetTime();
+        for (int i = 0; i < GeomBenchRepeats; i++) {
+            shape.CalcVboAndEbo(vboData, eboData, 0, 3, 6, stride);
+        }
+        double seconds = (glfwGetTime() - startTime) / GeomBenchRepeats;
+        if (numThreads == 1) {
+            serialTime = seconds;
+            printf("  %2d thread:  %8.3f ms\n", numThreads, 1000.0 * seconds);
+        }
+        else {
+            bool same = memcmp(vbo.data(), serialVbo.data(), vbo.size() * sizeof(float)) == 0
+                && memcmp(ebo.data(), serialEbo.data(), ebo.size() * sizeof(unsigned int)) == 0;
+            printf("  %2d threads: %8.3f ms  (%.2fx)%s\n", numThreads, 1000.0 * seconds,
+                serialTime / seconds, same ? "" : "  *** DIFFERS FROM THE SERIAL RESULT ***");
+        }
+        if (numThreads == maxThreads) {
+            break;
+        }
+    }
+}
+
+// Check that GlGeomProcedural gives the same vertex for each element of the EBO.
+void CheckProcedural(GlGeomBase& shape, GlGeomProcedural::ShapeType type, int res0, int res1, int res2, float radius)
+{
+    const int stride = 6;
+    std::vector<float> vbo((size_t)shape.GetNumVerticesNoTexCoords() * stride);
+    std::vector<unsigned int> ebo(shape.GetNumElementsMax());
+    shape.CalcVboAndEbo(vbo.data(), ebo.data(), 0, 3, -1, stride);
+    int numDiffer = 0;
+    for (int e = 0; e < (int)ebo.size(); e++) {
+        float procVert[6];
+        GlGeomProcedural::CalcVertex(type, res0, res1, res2, radius, e, 0, procVert, procVert + 3);
+        if (memcmp(procVert, &vbo[(size_t)ebo[e] * stride], sizeof(procVert)) != 0) {
+            numDiffer++;
+        }
+    }
+    if (numDiffer == 0) {
+        printf("  Procedural vertices: identical.\n");
+    }
+    else {
+        printf("  Procedural vertices: *** %d OF %d DIFFER ***\n", numDiffer, (int)ebo.size());
+    }
+}
+
+// Time the teapot's mesh generation with the evaluators specialized for its bicubic patches,
+//    and with the generic evaluator (see GlGeomBezierEval.h).  The results must be identical.
+void TimeBezierEval(GlGeomTeapot& teapot)
+{
+    const int stride = 8;
+    int numVerts = teapot.GetNumVerticesTexCoords();
+    std::vector<float> vbo[2];
+    std::vector<unsigned int> ebo[2];
+    double seconds[2];
+    bool wasSpecialized = GlGeomBezier::IsOrderSpecialized();
+    for (int k = 0; k < 2; k++) {
+        GlGeomBezier::SetOrderSpecialized(k == 0);
+        vbo[k].resize((size_t)numVerts * stride);
+        ebo[k].resize(teapot.GetNumElementsMax());
+        teapot.CalcVboAndEbo(vbo[k].data(), ebo[k].data(), 0, 3, 6, stride);     // Warm up
+        double startTime = glfwGetTime();
+        for (int i = 0; i < GeomBenchRepeats; i++) {
+            teapot.CalcVboAndEbo(vbo[k].data(), ebo[k].data(), 0, 3, 6, stride);
+        }
+        seconds[k] = (glfwGetTime() - startTime) / GeomBenchRepeats;
+    }
+    GlGeomBezier::SetOrderSpecialized(wasSpecialized);
+    bool same = (vbo[0] == vbo[1] && ebo[0] == ebo[1]);
+    printf("  Bicubic evaluator: %8.3f ms,  generic evaluator: %8.3f ms  (%.2fx)%s\n",
+        1000.0 * seconds[0], 1000.0 * seconds[1], seconds[1] / seconds[0],
+        same ? "" : "  *** RESULTS DIFFER ***");
+}
+
+// Compare the teapot's mesh computed by the compute shader with the mesh computed on the CPU.
+//    The compute shader works in floats, so the vertices agree only approximately.
+void CheckBezierCompute(GlGeomTeapot& teapot)
+{
+    const int stride = 6;
+    int numVerts = teapot.GetNumVerticesNoTexCoords();
+    std::vector<float> vbo((size_t)numVerts * stride);
+    std::vector<unsigned int> ebo(teapot.GetNumElementsMax());
+    double startTime = glfwGetTime();
+    for (int i = 0; i < GeomBenchRepeats; i++) {
+        teapot.CalcVboAndEbo(vbo.data(), ebo.data(), 0, 3, -1, stride);
+    }
+    double cpuSeconds = (glfwGetTime() - startTime) / GeomBenchRepeats;
+    int cpuNumElements = teapot.GetNumElementsRender();
+
+    unsigned int oldProgram = GlGeomBezier::GetComputeProgram();
+    GlGeomBezier::SetComputeProgram(shaderProgramBezierCompute);
+    teapot.InitializeAttribLocations(0, 2);                // Warm up: uploads the control points
+    glFinish();
+    startTime = glfwGetTime();
+    for (int i = 0; i < GeomBenchRepeats; i++) {
+        teapot.InitializeAttribLocations(0, 2);
+    }
+    glFinish();
+    double gpuSeconds = (glfwGetTime() - startTime) / GeomBenchRepeats;
+    GlGeomBezier::SetComputeProgram(oldProgram);
+
+    std::vector<float> gpuVbo(vbo.size());
+    std::vector<unsigned int> gpuEbo(ebo.size());
+    glBindBuffer(GL_ARRAY_BUFFER, teapot.GetVBO());
+    glGetBufferSubData(GL_ARRAY_BUFFER, 0, gpuVbo.size() * sizeof(float), gpuVbo.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_COPY_READ_BUFFER, teapot.GetEBO());
+    glGetBufferSubData(GL_COPY_READ_BUFFER, 0, gpuEbo.size() * sizeof(unsigned int), gpuEbo.data());
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+    float maxPosError = 0.0f;
+    float maxNormalError = 0.0f;
+    for (size_t v = 0; v < vbo.size(); v += stride) {
+        for (int k = 0; k < 3; k++) {
+            maxPosError = Max(maxPosError, fabsf(gpuVbo[v + k] - vbo[v + k]));
+            maxNormalError = Max(maxNormalError, fabsf(gpuVbo[v + 3 + k] - vbo[v + 3 + k]));
+        }
+    }
+    int numElements = teapot.GetNumElementsRender();
+    bool sameElements = (numElements == cpuNumElements)
+        && memcmp(gpuEbo.data(), ebo.data(), numElements * sizeof(unsigned int)) == 0;
+    bool ok = sameElements && maxPosError < 1.0e-4f && maxNormalError < 1.0e-3f;
+    printf("  CPU: %8.3f ms,  compute shader: %8.3f ms\n", 1000.0 * cpuSeconds, 1000.0 * gpuSeconds);
+    printf("  Compute shader: elements %s, max position error %.2g, max normal error %.2g%s\n",
+        sameElements ? "identical" : "DIFFER", maxPosError, maxNormalError,
+        ok ? "" : "  *** DIFFERS FROM THE CPU RESULT ***");
+}
+
+void MyRunGeomBenchmark() {
+    int maxThreads = GetParallelForThreads();
+    printf("Mesh generation benchmark (up to %d threads; each time is the average of %d meshes):\n",
+        maxThreads, GeomBenchRepeats);
+
+    GlGeomSphere sphere(1024, 512);
+    TimeGeometry("GlGeomSphere(1024, 512)", sphere, maxThreads);
+    CheckProcedural(sphere, GlGeomProcedural::Sphere, 1024, 512, 0, 0.0f);
+    GlGeomTorus torus(1024, 512, 0.3f);
+    TimeGeometry("GlGeomTorus(1024, 512)", torus, maxThreads);
+    CheckProcedural(torus, GlGeomProcedural::Torus, 1024, 512, 0, 0.3f);
+    GlGeomCylinder cylinder(1024, 512, 256);
+    TimeGeometry("GlGeomCylinder(1024, 512, 256)", cylinder, maxThreads);
+    CheckProcedural(cylinder, GlGeomProcedural::Cylinder, 1024, 512, 256, 0.0f);
+    GlGeomTeapot teapot(256, 256);
+    teapot.InitializeAttribLocations(0, 2);         // Loads the control points
+    TimeGeometry("GlGeomTeapot(256, 256)", teapot, maxThreads);
+    TimeBezierEval(teapot);
+    if (shaderProgramBezierCompute != 0) {
+        CheckBezierCompute(teapot);
+    }
+
+    SetParallelForThreads(maxThreads);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+//
+// GeomBench.h   ---  Header file for GeomBench.cpp.
+//
+//   A benchmark of the mesh generation (CalcVboAndEbo) of GlGeomSphere,
+//   GlGeomTorus, GlGeomCylinder and GlGeomTeapot at high resolution, with
+//   1, 2, 4, ... threads, up to the number of hardware threads.  Each result
+//   is checked to be identical to the single-threaded result, and (except
+//   for the teapot) to the vertices computed by GlGeomProcedural.
+//   The teapot's mesh generation is timed with the evaluators specialized
+//   for bicubic patches and with the generic evaluator, which must give
+//   identical results.  Then the teapot's mesh is computed by the compute
+//   shader (if there is OpenGL 4.3), and compared to the mesh computed on the CPU.
+//
+
+//
+// Function Prototypes
+//
+void MyRunGeomBenchmark();          // Runs the benchmark (takes a few seconds), and prints the results.
@@ -25,54 +25,159 @@
 
 
 #include "GlGeomBase.h"
+#include "MathMisc.h"
+#include "ParallelFor.h"
+#include "TaskScheduler.h"
 #include "assert.h"
+#include <string.h>
+#include <atomic>
+#include <memory>
 
 // Use the static library (so glew32.dll is not needed):
 #define GLEW_STATIC
 #include <GL/glew.h> 
 #include <GLFW/glfw3.h>
 
+// Definition of the constant passed by reference (e.g., to ClampRange), so it has storage.
+const int GlGeomBase::MaxChunkedRes;
+
 void GlGeomBase::ReInitializeAttribLocations()
 {
     InitializeAttribLocations(posLoc, normalLoc, texcoordsLoc);
 }
 
+// Separate vertex formats and buffer bindings are in OpenGL 4.3 and ARB_vertex_attrib_binding.
+static bool VertexAttribBindingSupported()
+{
+    return GLEW_VERSION_4_3 || GLEW_ARB_vertex_attrib_binding;
+}
+
+// The capacity (in bytes) of a buffer which must hold neededBytes.
+//   A buffer is only reallocated when it is too small, and then is given
+//   50% extra room.  Thus remeshing at a lower resolution (or a slightly
+//   higher one) reuses the existing storage.
+static size_t GrowCapacity(size_t neededBytes, size_t capacity)
+{
+    if (neededBytes <= capacity) {
+        return capacity;
+    }
+    return neededBytes + neededBytes / 2;
+}
+
 void GlGeomBase::InitializeAttribLocations(
     unsigned int pos_loc, unsigned int normal_loc, unsigned int texcoords_loc)
 {
-    posLoc = pos_loc;
-    normalLoc = normal_loc;
-    texcoordsLoc = texcoords_loc;
-
     // Generate Vertex Array Object and Buffer Objects, not already done.
-    if (theVAO == 0) {
+    //   The EBO binding is part of the VAO's state, so it is set just once.
+    bool newVAO = (theVAO == 0);
+    if (newVAO) {
         glGenVertexArrays(1, &theVAO);
         glGenBuffers(1, &theVBO);
         glGenBuffers(1, &theEBO);
+        glBindVertexArray(theVAO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, theEBO);
     }
-
-    // Link the VBO and EBO to the VAO, and request OpenGL to
-    //   allocate memory for them.
     glBindVertexArray(theVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, theVBO);
+
+    // The vertex format only changes if the attribute locations change.
+    //   (A remesh keeps the same locations.)
+    if (newVAO || pos_loc != posLoc || normal_loc != normalLoc || texcoords_loc != texcoordsLoc) {
+        SetVertexFormat(pos_loc, normal_loc, texcoords_loc, !newVAO);
+    }
+
+    // Large meshes are loaded in chunks, into buffers of their own.
+    if (NeedsChunks()) {
+        LoadChunks();
+        return;
+    }
+    FreeChunks();
+
+    // Request OpenGL to allocate memory for the VBO and EBO, if they are not big enough.
     int numVertices = UseTexCoords() ? GetNumVerticesTexCoords() : GetNumVerticesNoTexCoords();
-    glBufferData(GL_ARRAY_BUFFER, StrideVal() * numVertices * sizeof(float), 0, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, theEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, GetNumElementsMax() * sizeof(unsigned int), 0, GL_STATIC_DRAW);
-    glVertexAttribPointer(posLoc, 3, GL_FLOAT, GL_FALSE, StrideVal() * sizeof(float), (void*)0);
+    size_t vboBytes = (size_t)StrideVal() * numVertices * sizeof(float);
+    size_t eboBytes = (size_t)GetNumElementsMax() * sizeof(unsigned int);
+    if (vboBytes > vboCapacity) {
+        vboCapacity = GrowCapacity(vboBytes, vboCapacity);
+        glBindBuffer(GL_ARRAY_BUFFER, theVBO);
+        glBufferData(GL_ARRAY_BUFFER, vboCapacity, 0, GL_STATIC_DRAW);
+    }
+    if (eboBytes > eboCapacity) {
+        eboCapacity = GrowCapacity(eboBytes, eboCapacity);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, theEBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, eboCapacity, 0, GL_STATIC_DRAW);
+    }
+
+    if (CalcVboAndEboOnGPU()) {
+        ReleaseStaging();
+        return;
+    }
+    CalcVBOandEBO_Base();
+}
+
+// Set the locations and the layout of the vertex attributes, in the VAO.
+//    The VAO must be bound.  If disableOld is true, the previous locations are disabled first.
+void GlGeomBase::SetVertexFormat(unsigned int pos_loc, unsigned int normal_loc, unsigned int texcoords_loc,
+    bool disableOld)
+{
+    if (disableOld) {
+        glDisableVertexAttribArray(posLoc);
+        if (UseNormals()) {
+            glDisableVertexAttribArray(normalLoc);
+        }
+        if (UseTexCoords()) {
+            glDisableVertexAttribArray(texcoordsLoc);
+        }
+    }
+    posLoc = pos_loc;
+    normalLoc = normal_loc;
+    texcoordsLoc = texcoords_loc;
+
+    GLsizei stride = StrideVal() * sizeof(float);
+    if (VertexAttribBindingSupported()) {
+        // The formats give the offsets within a vertex; the VBO is bound to binding point 0 with the stride.
+        const GLuint binding = 0;
+        glVertexAttribFormat(posLoc, 3, GL_FLOAT, GL_FALSE, 0);
+        glVertexAttribBinding(posLoc, binding);
+        if (UseNormals()) {
+            glVertexAttribFormat(normalLoc, 3, GL_FLOAT, GL_FALSE, NormalOffset() * sizeof(float));
+            glVertexAttribBinding(normalLoc, binding);
+        }
+        if (UseTexCoords()) {
+            glVertexAttribFormat(texcoordsLoc, 2, GL_FLOAT, GL_FALSE, TexOffset() * sizeof(float));
+            glVertexAttribBinding(texcoordsLoc, binding);
+        }
+        glBindVertexBuffer(binding, theVBO, 0, stride);
+    }
+    else {
+        // Older OpenGL: the attribute pointers record the VBO (which keeps its name when reallocated).
+        SetAttribPointers(theVBO);
+    }
+    EnableAttribArrays();
+}
+
+// Point the vertex attributes of the bound VAO into vbo.
+void GlGeomBase::SetAttribPointers(unsigned int vbo)
+{
+    GLsizei stride = StrideVal() * sizeof(float);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glVertexAttribPointer(posLoc, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+    if (UseNormals()) {
+        glVertexAttribPointer(normalLoc, 3, GL_FLOAT, GL_FALSE, stride, (void*)(NormalOffset() * sizeof(float)));
+    }
+    if (UseTexCoords()) {
+        glVertexAttribPointer(texcoordsLoc, 2, GL_FLOAT, GL_FALSE, stride, (void*)(TexOffset() * sizeof(float)));
+    }
+}
+
+void GlGeomBase::EnableAttribArrays()
+{
     glEnableVertexAttribArray(posLoc);
     if (UseNormals()) {
-        glVertexAttribPointer(normalLoc, 3, GL_FLOAT, GL_FALSE, StrideVal() * sizeof(float),
-            (void*)(NormalOffset() * sizeof(float)));
         glEnableVertexAttribArray(normalLoc);
     }
     if (UseTexCoords()) {
-         glVertexAttribPointer(texcoordsLoc, 2, GL_FLOAT, GL_FALSE, StrideVal() * sizeof(float),
-            (void*)(TexOffset() * sizeof(float)));
         glEnableVertexAttribArray(texcoordsLoc);
     }
-
-    CalcVBOandEBO_Base();
 }
 
 // Load the data into the VBO and EBO arrays.
@@ -80,14 +185,30 @@ void GlGeomBase::InitializeAttribLocations(
 void GlGeomBase::CalcVBOandEBO_Base() {
 
 	// Calculate the buffer data - map and the unmap the two buffers.
+    //   The old contents are invalidated, so the driver need not wait for
+    //   the GPU to finish drawing with them (as glMapBuffer may).
     glBindVertexArray(theVAO);
     glBindBuffer(GL_ARRAY_BUFFER, theVBO);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, theEBO);
-    float* VBOdata = (float*)glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-    unsigned int* EBOdata = (unsigned int*)glMapBuffer(GL_ELEMENT_ARRAY_BUFFER, GL_WRITE_ONLY);
-    int normalOffset = UseNormals() ? NormalOffset() : -1;
-    int tcOffset = UseTexCoords() ? TexOffset() : -1;
-    CalcVboAndEbo(VBOdata, EBOdata, 0, normalOffset, tcOffset, StrideVal());
+    int numVertices = UseTexCoords() ? GetNumVerticesTexCoords() : GetNumVerticesNoTexCoords();
+    GLbitfield mapFlags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+    float* VBOdata = (float*)glMapBufferRange(GL_ARRAY_BUFFER, 0,
+        StrideVal() * numVertices * sizeof(float), mapFlags);
+    unsigned int* EBOdata = (unsigned int*)glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0,
+        GetNumElementsMax() * sizeof(unsigned int), mapFlags);
+    // Use the data from GenerateStaging() if there is any (and the layout has not changed since).
+    bool useStaging = stagingReady && stagingVBO.size() == (size_t)(StrideVal() * numVertices)
+        && stagingEBO.size() == (size_t)GetNumElementsMax();
+    if (useStaging) {
+        memcpy(VBOdata, stagingVBO.data(), stagingVBO.size() * sizeof(float));
+        memcpy(EBOdata, stagingEBO.data(), stagingEBO.size() * sizeof(unsigned int));
+    }
+    ReleaseStaging();
+    if (!useStaging) {
+        int normalOffset = UseNormals() ? NormalOffset() : -1;
+        int tcOffset = UseTexCoords() ? TexOffset() : -1;
+        CalcVboAndEbo(VBOdata, EBOdata, 0, normalOffset, tcOffset, StrideVal());
+    }
     glUnmapBuffer(GL_ARRAY_BUFFER);
     glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
  
@@ -97,6 +218,180 @@ void GlGeomBase::CalcVBOandEBO_Base() {
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
+void GlGeomBase::GenerateStaging() {
+    assert(theVAO != 0);        // The layout of the VBO must be known
+    if (!NeedsReload()) {
+        return;                 // Not remeshed: the data in the VBO and EBO is still current
+    }
+    if (NeedsChunks()) {
+        return;                 // Large meshes are generated chunk by chunk, as they are loaded
+    }
+    int numVertices = UseTexCoords() ? GetNumVerticesTexCoords() : GetNumVerticesNoTexCoords();
+    stagingVBO.resize((size_t)StrideVal() * numVertices);
+    stagingEBO.resize(GetNumElementsMax());
+    int normalOffset = UseNormals() ? NormalOffset() : -1;
+    int tcOffset = UseTexCoords() ? TexOffset() : -1;
+    CalcVboAndEbo(stagingVBO.data(), stagingEBO.data(), 0, normalOffset, tcOffset, StrideVal());
+    stagingReady = true;
+}
+
+void GlGeomBase::LoadBuffers() {
+    PreRender();
+    ReleaseStaging();       // In case the shape was not remeshed, and the data was not used
+}
+
+void GlGeomBase::ReleaseStaging() {
+    if (stagingReady) {
+        std::vector<float>().swap(stagingVBO);      // Release the memory
+        std::vector<unsigned int>().swap(stagingEBO);
+        stagingReady = false;
+    }
+}
+
+bool GlGeomBase::NeedsChunks() const
+{
+    if (GetNumChunkUnits() == 0) {
+        return false;
+    }
+    int numVertices = UseTexCoords() ? GetNumVerticesTexCoords() : GetNumVerticesNoTexCoords();
+    size_t meshBytes = (size_t)StrideVal() * numVertices * sizeof(float)
+        + (size_t)GetNumElementsMax() * sizeof(unsigned int);
+    return meshBytes > LargeMeshBytes;
+}
+
+// Load a large mesh in chunks.
+//   The chunks are generated by tasks on the TaskScheduler, and loaded into the
+//   buffers by this thread as they finish, while the later chunks are generated.
+//   Only a few chunks are in memory at once, however large the mesh.
+void GlGeomBase::LoadChunks()
+{
+    FreeChunks();
+    bool calcTexCoords = UseTexCoords();
+    int normalOffset = UseNormals() ? NormalOffset() : -1;
+    int tcOffset = calcTexCoords ? TexOffset() : -1;
+    size_t vertBytes = StrideVal() * sizeof(float);
+
+    // Plan the chunks, each with about ChunkVerts vertices.
+    //   A new block is started when a chunk does not fit in the current block.
+    struct Chunk {
+        int unitStart, unitEnd;
+        int numVerts, numElts;
+        int block;
+        size_t vboOffset, eboOffset;        // In bytes
+    };
+    std::vector<Chunk> chunks;
+    int numUnits = GetNumChunkUnits();
+    int vertsPerUnit, eltsPerUnit;
+    GetChunkSize(0, 1, calcTexCoords, &vertsPerUnit, &eltsPerUnit);
+    int unitsPerChunk = Max(1, ChunkVerts / vertsPerUnit);
+    for (int unitStart = 0; unitStart < numUnits; unitStart += unitsPerChunk) {
+        Chunk chunk;
+        chunk.unitStart = unitStart;
+        chunk.unitEnd = Min(unitStart + unitsPerChunk, numUnits);
+        GetChunkSize(chunk.unitStart, chunk.unitEnd, calcTexCoords, &chunk.numVerts, &chunk.numElts);
+        size_t vboBytes = chunk.numVerts * vertBytes;
+        size_t eboBytes = chunk.numElts * sizeof(unsigned int);
+        if (meshBlocks.empty() || meshBlocks.back().vboBytes + vboBytes > BlockBytes
+                               || meshBlocks.back().eboBytes + eboBytes > BlockBytes) {
+            meshBlocks.push_back(MeshBlock());
+        }
+        MeshBlock& block = meshBlocks.back();
+        chunk.block = (int)meshBlocks.size() - 1;
+        chunk.vboOffset = block.vboBytes;
+        chunk.eboOffset = block.eboBytes;
+        block.counts.push_back(chunk.numElts);
+        block.eboOffsets.push_back((const void*)block.eboBytes);
+        block.baseVertices.push_back((int)(block.vboBytes / vertBytes));
+        block.vboBytes += vboBytes;
+        block.eboBytes += eboBytes;
+        chunks.push_back(chunk);
+    }
+
+    // Allocate the blocks' buffers, and set up their VAO's.
+    for (MeshBlock& block : meshBlocks) {
+        glGenVertexArrays(1, &block.vao);
+        glGenBuffers(1, &block.vbo);
+        glGenBuffers(1, &block.ebo);
+        glBindVertexArray(block.vao);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, block.ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, block.eboBytes, 0, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, block.vbo);
+        glBufferData(GL_ARRAY_BUFFER, block.vboBytes, 0, GL_STATIC_DRAW);
+        SetAttribPointers(block.vbo);
+        EnableAttribArrays();
+    }
+
+    // Chunk k is generated into slot k % numSlots, once chunk k-numSlots has been loaded from it.
+    struct Slot {
+        std::vector<float> verts;
+        std::vector<unsigned int> elts;
+        std::atomic<bool> ready;
+    };
+    int numChunks = (int)chunks.size();
+    int numSlots = Min(GetParallelForThreads() + 1, numChunks);
+    std::unique_ptr<Slot[]> slots(new Slot[numSlots]);
+    TaskScheduler& scheduler = TaskScheduler::Get();
+    auto generateChunk = [&](int k) {
+        slots[k % numSlots].ready = false;
+        scheduler.Submit([&, k] {
+            const Chunk& chunk = chunks[k];
+            Slot& slot = slots[k % numSlots];
+            slot.verts.resize((size_t)chunk.numVerts * StrideVal());
+            slot.elts.resize(chunk.numElts);
+            CalcChunk(chunk.unitStart, chunk.unitEnd, slot.verts.data(), slot.elts.data(),
+                0, normalOffset, tcOffset, StrideVal());
+            slot.ready = true;
+        });
+    };
+    for (int k = 0; k < numSlots; k++) {
+        generateChunk(k);
+    }
+    for (int k = 0; k < numChunks; k++) {
+        Slot& slot = slots[k % numSlots];
+        scheduler.HelpUntil([&slot] { return slot.ready.load(); });
+        const Chunk& chunk = chunks[k];
+        glBindVertexArray(meshBlocks[chunk.block].vao);     // Binds the block's EBO
+        glBindBuffer(GL_ARRAY_BUFFER, meshBlocks[chunk.block].vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, chunk.vboOffset, slot.verts.size() * sizeof(float), slot.verts.data());
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, chunk.eboOffset, slot.elts.size() * sizeof(unsigned int), slot.elts.data());
+        if (k + numSlots < numChunks) {
+            generateChunk(k + numSlots);
+        }
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GlGeomBase::FreeChunks()
+{
+    for (MeshBlock& block : meshBlocks) {
+        glDeleteVertexArrays(1, &block.vao);
+        glDeleteBuffers(1, &block.vbo);
+        glDeleteBuffers(1, &block.ebo);
+    }
+    meshBlocks.clear();
+}
+
+// Render a mesh loaded in chunks: one multi-draw per block, or with instancing, one draw per chunk.
+void GlGeomBase::RenderChunks(int numInstances)
+{
+    for (const MeshBlock& block : meshBlocks) {
+        glBindVertexArray(block.vao);
+        if (numInstances == 1) {
+            glMultiDrawElementsBaseVertex(GL_TRIANGLES, block.counts.data(), GL_UNSIGNED_INT,
+                block.eboOffsets.data(), (GLsizei)block.counts.size(), block.baseVertices.data());
+        }
+        else {
+            for (size_t i = 0; i < block.counts.size(); i++) {
+                glDrawElementsInstancedBaseVertex(GL_TRIANGLES, block.counts[i], GL_UNSIGNED_INT,
+                    block.eboOffsets[i], (GLsizei)numInstances, block.baseVertices[i]);
+            }
+        }
+    }
+    glBindVertexArray(0);
+}
+
 void GlGeomBase::PreRender() {
     if (theVAO == 0) {
         assert(false && "InitializeAttribLocations must be called before rendering!");
@@ -109,9 +404,28 @@ void GlGeomBase::PreRender() {
 // **********************************************
 void GlGeomBase::Render()
 {
+    if (IsChunked()) {
+        RenderChunks(1);
+        return;
+    }
     RenderEBO(GL_TRIANGLES, GetNumElementsRender(), 0);
 }
 
+// **********************************************
+// This routine renders the entire object numInstances times (as loaded in the EBO).
+// **********************************************
+void GlGeomBase::RenderInstanced(int numInstances)
+{
+    PreRender();
+    if (IsChunked()) {
+        RenderChunks(numInstances);
+        return;
+    }
+    glBindVertexArray(theVAO);
+    glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)GetNumElementsRender(), GL_UNSIGNED_INT, (void*)0, (GLsizei)numInstances);
+    glBindVertexArray(0);
+}
+
 // **********************************************
 // This routine does the rendering of the specified EBO data
 // The EBO has already been bound to the VAO.
@@ -121,6 +435,11 @@ void GlGeomBase::RenderEBO(unsigned int drawMode, int numRenderElements, int EBO
     if (theVAO == 0) {
         assert(false && "InitializeAttribLocations must be called before rendering!");
     }
+    // A chunked mesh is not in theVBO and theEBO: draw nothing, rather than stale data.
+    if (IsChunked()) {
+        assert(false && "Meshes loaded in chunks can only be rendered whole");
+        return;
+    }
     glBindVertexArray(theVAO);
     glDrawElements(drawMode, (GLsizei)numRenderElements, GL_UNSIGNED_INT, (void*)(EBOstart * sizeof(unsigned int)));
     glBindVertexArray(0);           // Good practice to unbind: helps with debugging if nothing else
@@ -133,6 +452,10 @@ void GlGeomBase::RenderEBO(unsigned int drawMode, int numRenderElements, int EBO
 // **********************************************
 void GlGeomBase::RenderElements(unsigned int drawMode, int numRenderElements, const unsigned int *elementsData)
 {
+    if (IsChunked()) {
+        assert(false && "Meshes loaded in chunks can only be rendered whole");
+        return;
+    }
     unsigned int tempEBO;
     glGenBuffers(1, &tempEBO);
     glBindVertexArray(theVAO);
@@ -149,6 +472,7 @@ void GlGeomBase::RenderElements(unsigned int drawMode, int numRenderElements, co
 
 GlGeomBase::~GlGeomBase()
 {
+    FreeChunks();
     glDeleteVertexArrays(1, &theVAO);  
     glDeleteBuffers(1, &theVBO);  
     glDeleteBuffers(1, &theEBO);  
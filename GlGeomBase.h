@@ -28,7 +28,9 @@
 #define GLGEOM_BASE_H
 
 #include <limits.h>
+#include <stddef.h>
 #include <assert.h>
+#include <vector>
 
 // GlGeomBase
 //     Handles all the OpenGL rendering for the GlGeomShape classes.
@@ -63,6 +65,28 @@ public:
     virtual int GetNumVerticesTexCoords() const = 0;
     virtual int GetNumVerticesNoTexCoords() const = 0;
 
+    // Render the shape.  Each GlGeomShape class overrides this to first (re)load
+    //    the VBO and EBO if needed, so it can be called via a GlGeomBase pointer,
+    //    for instance, by the SceneGraph.
+    virtual void Render();
+
+    // Render numInstances copies of the shape with a single draw call.
+    //    The shader program uses gl_InstanceID to place each copy.
+    void RenderInstanced(int numInstances);
+
+    // Remeshing in two steps, so that several shapes can be remeshed in parallel (see TaskGraph.h).
+    //   Call both after Remesh(), and after the attribute locations have been initialized.
+    // GenerateStaging() computes the VBO and EBO data, into memory held by the shape.
+    //    It makes no OpenGL calls, so it may run on any thread.
+    // LoadBuffers() loads the VBO and EBO if the shape was remeshed, copying the
+    //    staged data instead of calling CalcVboAndEbo again.  It makes OpenGL calls.
+    //    Without LoadBuffers(), the next Render() loads them (from the staged data).
+    // NeedsReload() is true if the VBO and EBO are not loaded yet, or the shape was remeshed
+    //    since.  Shapes which do not track this always return true.
+    void GenerateStaging();
+    void LoadBuffers();
+    virtual bool NeedsReload() const { return true; }
+
     unsigned int GetVAO() const { return theVAO; }
     unsigned int GetVBO() const { return theVBO; }
     unsigned int GetEBO() const { return theEBO; }
@@ -96,7 +120,42 @@ public:
             int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset,
             unsigned int stride) = 0;
 
+    // Large meshes are loaded in chunks, so the memory used on the CPU does not grow
+    //    with the size of the mesh, and no buffer or element index gets too large.
+    //    A shape supports this by splitting its mesh into units (e.g., slices),
+    //    and overriding the following three routines:
+    //   GetNumChunkUnits() returns the number of units, or 0 if chunks are not supported.
+    //   GetChunkSize() returns the numbers of vertices and elements in the chunk
+    //       holding the units unitStart,...,unitEnd-1.
+    //   CalcChunk() is like CalcVboAndEbo, for that chunk only.  The elements number
+    //       the chunk's own vertices, starting at 0.  It may run on any thread.
+    // A mesh with more than LargeMeshBytes of data is loaded in chunks of about ChunkVerts
+    //    vertices.  The chunks are packed into blocks, each with its own VAO, VBO and EBO of
+    //    at most BlockBytes, and each chunk is drawn with its own base vertex.
+    virtual int GetNumChunkUnits() const { return 0; }
+    virtual void GetChunkSize(int /*unitStart*/, int /*unitEnd*/, bool /*calcTexCoords*/,
+            int* /*numVerts*/, int* /*numElts*/) const {
+        assert(false);
+    }
+    virtual void CalcChunk(int /*unitStart*/, int /*unitEnd*/, float* /*VBOdataBuffer*/, unsigned int* /*EBOdataBuffer*/,
+            int /*vertPosOffset*/, int /*vertNormalOffset*/, int /*vertTexCoordsOffset*/, unsigned int /*stride*/) {
+        assert(false);
+    }
+
+    bool IsChunked() const { return !meshBlocks.empty(); }
+    int GetNumBlocks() const { return (int)meshBlocks.size(); }
+
 protected:
+    // The CalcVboAndEbo routines split meshes with more vertices than this
+    //    into ranges which are generated in parallel (see ParallelFor.h).
+    static const int MinVertsPerTask = 16384;
+
+    // Limits for large meshes (see GetNumChunkUnits above)
+    static const int MaxChunkedRes = 16384;             // Largest resolution: keeps the element count below 2^31
+    static const size_t LargeMeshBytes = 64 << 20;      // Larger meshes are loaded in chunks
+    static const int ChunkVerts = 1 << 16;              // Approximate number of vertices in a chunk
+    static const size_t BlockBytes = 128 << 20;         // Largest VBO or EBO of a chunked mesh
+
     // Allocate the VAO, VBO, and EBO.
     // Set up info about the Vertex Attribute Locations
     // This must be called before render is first called.
@@ -106,11 +165,15 @@ protected:
     // The second and third parameters are optional.
     virtual void InitializeAttribLocations(
         unsigned int pos_loc, unsigned int normal_loc = UINT_MAX, unsigned int texcoords_loc = UINT_MAX);
+    // Called by Remesh() methods: reloads the VBO and EBO.  The vertex format
+    //    is not changed, and the buffers are only reallocated if they must grow.
     void ReInitializeAttribLocations();
     void CalcVBOandEBO_Base();
+    // A shape may instead compute its VBO and EBO on the GPU, by overriding this to fill
+    //    GetVBO() and GetEBO() and return true.  It is called once they are allocated.
+    virtual bool CalcVboAndEboOnGPU() { return false; }
 
-    void PreRender();
-    void Render(); 
+    virtual void PreRender();       // Overridden to reload the VBO and EBO after a remesh
     void RenderElements(unsigned int drawMode, int numRenderElements, const unsigned int *elementsData);
     void RenderEBO(unsigned int drawMode, int numRenderElements, int EBOstart);
 
@@ -119,9 +182,38 @@ private:
     unsigned int theVBO = 0;        // Vertex Buffer Object
     unsigned int theEBO = 0;        // Element Buffer Object;
 
-    unsigned int posLoc;            // location of vertex position x,y,z data in the shader program
-    unsigned int normalLoc;         // location of vertex normal data in the shader program
-    unsigned int texcoordsLoc;      // location of s,t texture coordinates in the shader program.
+    unsigned int posLoc = UINT_MAX;         // location of vertex position x,y,z data in the shader program
+    unsigned int normalLoc = UINT_MAX;      // location of vertex normal data in the shader program
+    unsigned int texcoordsLoc = UINT_MAX;   // location of s,t texture coordinates in the shader program.
+
+    size_t vboCapacity = 0;         // Allocated sizes of the VBO and EBO, in bytes
+    size_t eboCapacity = 0;
+
+    std::vector<float> stagingVBO;          // Data computed by GenerateStaging(), until it is loaded
+    std::vector<unsigned int> stagingEBO;
+    bool stagingReady = false;
+    void ReleaseStaging();
+
+    // The blocks of a mesh loaded in chunks.  Each has its own VAO, VBO and EBO.
+    struct MeshBlock {
+        unsigned int vao = 0;
+        unsigned int vbo = 0;
+        unsigned int ebo = 0;
+        size_t vboBytes = 0;                    // Sizes of the VBO and EBO
+        size_t eboBytes = 0;
+        std::vector<int> counts;                // For each chunk: the number of elements,
+        std::vector<const void*> eboOffsets;    //    the offset of its elements in the EBO (in bytes),
+        std::vector<int> baseVertices;          //    and the number of its first vertex in the VBO.
+    };
+    std::vector<MeshBlock> meshBlocks;          // Empty unless the mesh is loaded in chunks
+    bool NeedsChunks() const;
+    void LoadChunks();
+    void FreeChunks();
+    void RenderChunks(int numInstances);
+
+    void SetVertexFormat(unsigned int pos_loc, unsigned int normal_loc, unsigned int texcoords_loc, bool disableOld);
+    void SetAttribPointers(unsigned int vbo);
+    void EnableAttribArrays();
 
 public:
     // Stride value, and offset values for the data in the VBO
@@ -25,8 +25,21 @@
 #include <GLFW/glfw3.h>
 
 #include "GlGeomBezier.h"
+#include "GlGeomBezierEval.h"
 #include "MathMisc.h"
+#include "ParallelFor.h"
 #include "assert.h"
+#include <string.h>
+#include <vector>
+
+// Scratch memory for CalcVboAndEbo.  Each thread has its own, which is reused
+//    for every range of patches the thread generates (and kept for the next remesh).
+struct BezierScratch {
+    std::vector<double> sliceCntlPtsJ;
+    std::vector<double> sliceCntlPtsI;
+    std::vector<float> patchVerts;
+};
+static thread_local BezierScratch bezierScratch;
 
 // ************************************
 // LoadControlPts
@@ -34,7 +47,7 @@
 //      See header file for information on the parameters
 void GlGeomBezier::LoadControlPts(int uOrder, int vOrder,
                                     int numCoordinates, int numPatches,
-                                    double* controlPoints)
+                                    const double* controlPoints)
 {
     assert(uOrder > 0 && vOrder > 0);
     assert(numCoordinates == 3 || numCoordinates <= 4);           // Points in R^3 or homogeneous representations
@@ -71,8 +84,21 @@ void GlGeomBezier::LoadControlPts(int uOrder, int vOrder,
     for (int i = 0; i < numVals; i++) {
         *(controlPts + i) = *(controlPoints + i);
     }
+    patchesLoaded = false;
 }
 
+GlGeomBezier::~GlGeomBezier()
+{
+    delete[] controlPts;
+    delete[] firstTriInPatch;
+    glDeleteVertexArrays(1, &patchVAO);
+    glDeleteBuffers(1, &patchVBO);
+    glDeleteBuffers(1, &cornerNormalsBuffer);
+    glDeleteBuffers(1, &rowTrisBuffer);
+}
+
+bool GlGeomBezier::orderSpecialized = true;
+
 void GlGeomBezier::Remesh(int uMeshResolution, int vMeshResolution)
 {
     if (uMeshResolution == uMeshRes && vMeshResolution == vMeshRes) {
@@ -92,188 +118,259 @@ void GlGeomBezier::CalcVboAndEbo(float* VBOdataBuffer, unsigned int* EBOdataBuff
     bool calcTexCoords = (vertTexCoordsOffset >= 0);  // Should texture coordinates be calculated?
 
     int numCntlPtsEntriesJ = uOrder * (vMeshRes+1) * numCoordinates;   // Size for J-slices control points
-    double* sliceCntlPtsJ = new double[numCntlPtsEntriesJ];
     int numCntlPtsEntriesI = (uMeshRes+1) * vOrder * numCoordinates;   // Size for I-slices control points
-    double* sliceCntlPtsI = (calcNormals ? new double[numCntlPtsEntriesI] : (double*)0);
     int numValuesInPatch = uOrder * vOrder * numCoordinates;
-    for (int patchNum = 0; patchNum < numPatches; patchNum++) {
-        // Calculate vertices for patch number patchNum
-        double* patchPtr = controlPts + patchNum * numValuesInPatch;            // Pointer to patch's control points
-        double nearZeroSq;              // Threshhold at which a "normal" is considered be null
-
-        // First, calculate the control points for the "horizontal" paths (with j constant)
-        for (int j = 0; j <= vMeshRes; j++) {
-            for (int i = 0; i < uOrder; i++) {
-                // Calculate i-th control point for j-th horizontal slice
-                BezierMultiEval(patchPtr + i * numCoordinates, uOrder * numCoordinates,
-                    vOrder, j, vMeshRes,
-                    sliceCntlPtsJ + (j * uOrder + i) * numCoordinates);
-            }
-        }
-        // Second, if needed for the computation of normal vectors,
-        //    calculate the control points for the "vertical" paths (with i constant)
-        if (calcNormals) {
-            for (int i = 0; i <= uMeshRes; i++) {
-                for (int j = 0; j < vOrder; j++) {
-                    // Calculate j-th control point for i-th horizontal slice
-                    BezierMultiEval(patchPtr + j * uOrder * numCoordinates, numCoordinates,
-                        uOrder, i, uMeshRes,
-                        sliceCntlPtsI + (i * vOrder + j) * numCoordinates);
-                }
-            }
-        }
-        // Third, if needed, calculate normals at corners, including certain degenerate cases.
-        float* vboSubbufferPtr = VBOdataBuffer + stride * (patchNum * (uMeshRes + 1) * (vMeshRes + 1));
-        if (calcNormals) {
-            // Precompute the normals for the four corner vertices
-            //    with special coding to handle degenerate cases
-            // Then copy them into the VBO buffer
-            double cornerNormals[4][3];     // Precomputed normals at the four corners
-            CalcCornerNormals(patchPtr, &cornerNormals[0][0], &nearZeroSq);
-            for (int i = 0; i <= 1; i++) {
-                for (int j = 0; j <= 1; j ++) {
-                    float* vboPtr = vboSubbufferPtr + stride * (j * vMeshRes * (uMeshRes + 1) + i * uMeshRes);
-                    float* normalPtr = vboPtr + vertNormalOffset;
-                    int cornerIdx = 2*j + i;
-                    *(normalPtr++) = (float)cornerNormals[cornerIdx][0];
-                    *(normalPtr++) = (float)cornerNormals[cornerIdx][1];
-                    *normalPtr = (float)cornerNormals[cornerIdx][2];
-                }
-            }
-        }
-
-        // Fourth, generate coordinates and normals for each mesh vertex
-        for (int i = 0; i <= uMeshRes; i++) {
-            // Handle the (i,*) vertices
-            for (int j = 0; j <= vMeshRes; j++) {
-                // Handle vertex (i,j)
-                float* vboPtr = vboSubbufferPtr + stride * (j * (uMeshRes+1) + i);
-                double tempPositionJ[4];            // Max numCoordinates is 4
-                double tempDerivativeJ[4];          // Partial wrt i (ie., j is fixed.
-                BezierMultiEval(sliceCntlPtsJ + (j * uOrder * numCoordinates), numCoordinates,
-                    uOrder, i, uMeshRes,
-                    tempPositionJ, tempDerivativeJ);
-                if (numCoordinates == 4) {
-                    // Divide by w component to convert to R^3 position
-                    VecMultScalar(tempPositionJ, 1.0 / tempPositionJ[3], tempPositionJ, 3);
+    // Each patch is generated into a small staging block, which stays in the cache,
+    //    and is then copied to the VBO in one sequential pass.  VBOdataBuffer is
+    //    usually mapped GPU memory (write-combined): scattered writes to it are slow,
+    //    and reading it back (for EqualVerts) is slower still.
+    // The staging block holds only the fields computed here, packed: the position, the normal
+    //    and the texture coordinates.  Only these are copied, so the other entries of an
+    //    interleaved VBO are left as they are.
+    int stagingNormalOffset = 3;
+    int stagingTexCoordsOffset = calcNormals ? 6 : 3;
+    int stagingStride = stagingTexCoordsOffset + (calcTexCoords ? 2 : 0);
+    int numVertsInPatch = (uMeshRes + 1) * (vMeshRes + 1);
+    int numQuadsInPatch = uMeshRes * vMeshRes;
+    // Two bits for each quad of the mesh, set if its first or second triangle is not degenerate.
+    //    They are set with the vertices, and the EBO is written from them afterwards.
+    std::vector<unsigned char> quadTris((size_t)numPatches * numQuadsInPatch);
+
+    // The patches are independent, so ranges of patches are generated in parallel.
+    //    Each thread has its own slices of control points and its own staging block.
+    //    firstTriInPatch[patchNum + 1] is first set to the number of triangles in the patch.
+    int minPatchesPerTask = 1 + MinVertsPerTask / numVertsInPatch;
+    // The curves are evaluated by evaluators specialized for the orders of the patches (see GlGeomBezierEval.h).
+    GlGeomDispatchBezierEval(uOrder, vOrder, numCoordinates, orderSpecialized, [&](auto uEval, auto vEval) {
+        ParallelFor(0, numPatches, minPatchesPerTask, [&](int patchStart, int patchEnd) {
+            std::vector<double>& sliceCntlPtsJ = bezierScratch.sliceCntlPtsJ;
+            std::vector<double>& sliceCntlPtsI = bezierScratch.sliceCntlPtsI;
+            std::vector<float>& patchVerts = bezierScratch.patchVerts;
+            sliceCntlPtsJ.resize(numCntlPtsEntriesJ);
+            sliceCntlPtsI.resize(calcNormals ? numCntlPtsEntriesI : 0);
+            patchVerts.resize((size_t)numVertsInPatch * stagingStride);
+            for (int patchNum = patchStart; patchNum < patchEnd; patchNum++) {
+                // Calculate vertices for patch number patchNum
+                double* patchPtr = controlPts + patchNum * numValuesInPatch;            // Pointer to patch's control points
+                double nearZeroSq;              // Threshhold at which a "normal" is considered be null
+
+                // First, calculate the control points for the "horizontal" paths (with j constant)
+                for (int j = 0; j <= vMeshRes; j++) {
+                    for (int i = 0; i < uOrder; i++) {
+                        // Calculate i-th control point for j-th horizontal slice
+                        vEval.Eval(patchPtr + i * numCoordinates, uOrder * numCoordinates,
+                            j, vMeshRes,
+                            sliceCntlPtsJ.data() + (j * uOrder + i) * numCoordinates);
+                    }
                 }
-                // Copy the three coordinates (do not use homogeneous representation in VBO)
-                for (int t = 0; t < 3; t++) {
-                    *(vboPtr + vertPosOffset + t) = (float)tempPositionJ[t];
+                // Second, if needed for the computation of normal vectors,
+                //    calculate the control points for the "vertical" paths (with i constant)
+                if (calcNormals) {
+                    for (int i = 0; i <= uMeshRes; i++) {
+                        for (int j = 0; j < vOrder; j++) {
+                            // Calculate j-th control point for i-th horizontal slice
+                            uEval.Eval(patchPtr + j * uOrder * numCoordinates, numCoordinates,
+                                i, uMeshRes,
+                                sliceCntlPtsI.data() + (i * vOrder + j) * numCoordinates);
+                        }
+                    }
                 }
+                // Third, if needed, calculate normals at corners, including certain degenerate cases.
+                float* vboSubbufferPtr = patchVerts.data();
                 if (calcNormals) {
-                    float* normalPtr = vboPtr + vertNormalOffset;
-                    double normalNormSq;
-                    if ((i == 0 || i == uMeshRes) && (j == 0 || j == vMeshRes)) {
-                        // At a corner, do nothing
+                    // Precompute the normals for the four corner vertices
+                    //    with special coding to handle degenerate cases
+                    // Then copy them into the VBO buffer
+                    double cornerNormals[4][3];     // Precomputed normals at the four corners
+                    CalcCornerNormals(patchPtr, &cornerNormals[0][0], &nearZeroSq);
+                    for (int i = 0; i <= 1; i++) {
+                        for (int j = 0; j <= 1; j ++) {
+                            float* vboPtr = vboSubbufferPtr + stagingStride * (j * vMeshRes * (uMeshRes + 1) + i * uMeshRes);
+                            float* normalPtr = vboPtr + stagingNormalOffset;
+                            int cornerIdx = 2*j + i;
+                            *(normalPtr++) = (float)cornerNormals[cornerIdx][0];
+                            *(normalPtr++) = (float)cornerNormals[cornerIdx][1];
+                            *normalPtr = (float)cornerNormals[cornerIdx][2];
+                        }
                     }
-                    else {
-                        // Not at a corner
-                        double tempPositionI[4];        // Max numCoordinates is 4
-                        double tempDerivativeI[4];      // Partial wrt j (ie., i is fixed).
-                        BezierMultiEval(sliceCntlPtsI + i * vOrder * numCoordinates, numCoordinates,
-                            vOrder, j, vMeshRes, tempPositionI, tempDerivativeI);
-                        // tempPositionI is equal to tempPositionJ (except not divided by w, since not used)
-                        // tempDerivativeI is the partial wrt j (ie., i is fixed).
-                        // tempDerivativeJ is the partial wrt i (ie., j is fixed.
+                }
+
+                // Fourth, generate coordinates and normals for each mesh vertex, in the order of the VBO
+                for (int j = 0; j <= vMeshRes; j++) {
+                    // Handle the (*,j) vertices
+                    for (int i = 0; i <= uMeshRes; i++) {
+                        // Handle vertex (i,j)
+                        float* vboPtr = vboSubbufferPtr + stagingStride * (j * (uMeshRes+1) + i);
+                        double tempPositionJ[4] = {};          // Max numCoordinates is 4
+                        double tempDerivativeJ[4] = {};        // Partial wrt i (ie., j is fixed.
+                        uEval.Eval(sliceCntlPtsJ.data() + (j * uOrder * numCoordinates), numCoordinates,
+                            i, uMeshRes,
+                            tempPositionJ, tempDerivativeJ);
                         if (numCoordinates == 4) {
-                            // (x/w)' = (x'*w -x*w')/w^2 = (x' -(x/w)*w')/w
-                            // (x/w) is equal to tempPositionI[0] and to tempPositionJ[0]. Similarly for (y/w) and (z/w)
-                            // x', y', z', w' are in tempDerivativeI[] and tempDerivativeJ[], respectively for wrt j, i
-                            // We skip dividing by w since the result is normalized anyway.
-                            VecAddScaled(tempPositionJ, -tempDerivativeI[3], tempDerivativeI, 3);
-                            VecAddScaled(tempPositionJ, -tempDerivativeJ[3], tempDerivativeJ, 3);
+                            // Divide by w component to convert to R^3 position
+                            VecMultScalar(tempPositionJ, 1.0 / tempPositionJ[3], tempPositionJ, 3);
                         }
-                        double normalVec[3];
-                        VecCrossProd(tempDerivativeJ, tempDerivativeI, normalVec);
-                        // Check if the calculated normal was (close to) zero
-                        normalNormSq = VecNormSq(normalVec, 3);
-                        if (normalNormSq < nearZeroSq) {
-                            if (i == 0 || i == uMeshRes) {
-                                if (VecNormSq(tempDerivativeI, 3) < nearZeroSq) {
-                                    // This calculation valid if the edge is degenerate. (not checked)
-                                    // It is also valid if the if second partial w.r.t. v is also zero.
-                                    // Go to neighboring row, ii=1 or ii = uOrder-2. Find partial along control polygon
-                                    int ii = (i == 0) ? 1 : uOrder - 2;
-                                    double tempPositionI2[4];        // Values from neighboring row of origial control point
-                                    double tempDerivativeI2[4];      // Partial wrt j (ie., ii is fixed).
-                                    BezierMultiEval(patchPtr + ii * numCoordinates, uOrder * numCoordinates,
-                                        vOrder, j, vMeshRes,
-                                        tempPositionI2, tempDerivativeI2);
-                                    if (numCoordinates == 4) {
-                                        VecMultScalar(tempPositionI2, 1.0 / tempPositionI2[3], tempPositionI2, 3);
-                                        VecAddScaled(tempPositionI2, -tempDerivativeI2[3], tempDerivativeI2, 3);
-                                    }
-                                    VecCrossProd(tempDerivativeJ, tempDerivativeI2, normalVec);
-                                }
+                        // Copy the three coordinates (do not use homogeneous representation in VBO)
+                        for (int t = 0; t < 3; t++) {
+                            *(vboPtr + t) = (float)tempPositionJ[t];
+                        }
+                        if (calcNormals) {
+                            float* normalPtr = vboPtr + stagingNormalOffset;
+                            double normalNormSq;
+                            if ((i == 0 || i == uMeshRes) && (j == 0 || j == vMeshRes)) {
+                                // At a corner, do nothing
                             }
-                            else if (j == 0 || j == vMeshRes) {
-                                if (VecNormSq(tempDerivativeJ, 3) < nearZeroSq) {
-                                    // This calculation valid if the edge is degenerate. (not checked)
-                                    // It is also valid if the if second partial w.r.t. v is also zero.
-                                    // Go to neighboring column, j=1 or j = vOrder-2. Find partial along control polygon
-                                    int jj = (j == 0) ? 1 : vOrder - 2;
-                                    double tempPositionJ2[4];        // Values from neighboring column
-                                    double tempDerivativeJ2[4];      // Partial wrt i (ie., jj is fixed).
-                                    BezierMultiEval(patchPtr + jj * uOrder * numCoordinates, numCoordinates,
-                                        uOrder, i, uMeshRes,
-                                        tempPositionJ2, tempDerivativeJ2);
-                                    if (numCoordinates == 4) {
-                                        VecMultScalar(tempPositionJ2, 1.0 / tempPositionJ2[3], tempPositionJ2, 3);
-                                        VecAddScaled(tempPositionJ2, -tempDerivativeJ2[3], tempDerivativeJ2, 3);
+                            else {
+                                // Not at a corner
+                                double tempPositionI[4] = {};      // Max numCoordinates is 4
+                                double tempDerivativeI[4] = {};    // Partial wrt j (ie., i is fixed).
+                                vEval.Eval(sliceCntlPtsI.data() + i * vOrder * numCoordinates, numCoordinates,
+                                    j, vMeshRes, tempPositionI, tempDerivativeI);
+                                // tempPositionI is equal to tempPositionJ (except not divided by w, since not used)
+                                // tempDerivativeI is the partial wrt j (ie., i is fixed).
+                                // tempDerivativeJ is the partial wrt i (ie., j is fixed.
+                                if (numCoordinates == 4) {
+                                    // (x/w)' = (x'*w -x*w')/w^2 = (x' -(x/w)*w')/w
+                                    // (x/w) is equal to tempPositionI[0] and to tempPositionJ[0]. Similarly for (y/w) and (z/w)
+                                    // x', y', z', w' are in tempDerivativeI[] and tempDerivativeJ[], respectively for wrt j, i
+                                    // We skip dividing by w since the result is normalized anyway.
+                                    VecAddScaled(tempPositionJ, -tempDerivativeI[3], tempDerivativeI, 3);
+                                    VecAddScaled(tempPositionJ, -tempDerivativeJ[3], tempDerivativeJ, 3);
+                                }
+                                double normalVec[3];
+                                VecCrossProd(tempDerivativeJ, tempDerivativeI, normalVec);
+                                // Check if the calculated normal was (close to) zero
+                                normalNormSq = VecNormSq(normalVec, 3);
+                                if (normalNormSq < nearZeroSq) {
+                                    if (i == 0 || i == uMeshRes) {
+                                        if (VecNormSq(tempDerivativeI, 3) < nearZeroSq) {
+                                            // This calculation valid if the edge is degenerate. (not checked)
+                                            // It is also valid if the if second partial w.r.t. v is also zero.
+                                            // Go to neighboring row, ii=1 or ii = uOrder-2. Find partial along control polygon
+                                            int ii = (i == 0) ? 1 : uOrder - 2;
+                                            double tempPositionI2[4] = {};      // Values from neighboring row of origial control point
+                                            double tempDerivativeI2[4] = {};    // Partial wrt j (ie., ii is fixed).
+                                            vEval.Eval(patchPtr + ii * numCoordinates, uOrder * numCoordinates,
+                                                j, vMeshRes,
+                                                tempPositionI2, tempDerivativeI2);
+                                            if (numCoordinates == 4) {
+                                                VecMultScalar(tempPositionI2, 1.0 / tempPositionI2[3], tempPositionI2, 3);
+                                                VecAddScaled(tempPositionI2, -tempDerivativeI2[3], tempDerivativeI2, 3);
+                                            }
+                                            VecCrossProd(tempDerivativeJ, tempDerivativeI2, normalVec);
+                                        }
                                     }
-                                    VecCrossProd(tempDerivativeJ2, tempDerivativeI, normalVec);
+                                    else if (j == 0 || j == vMeshRes) {
+                                        if (VecNormSq(tempDerivativeJ, 3) < nearZeroSq) {
+                                            // This calculation valid if the edge is degenerate. (not checked)
+                                            // It is also valid if the if second partial w.r.t. v is also zero.
+                                            // Go to neighboring column, j=1 or j = vOrder-2. Find partial along control polygon
+                                            int jj = (j == 0) ? 1 : vOrder - 2;
+                                            double tempPositionJ2[4] = {};      // Values from neighboring column
+                                            double tempDerivativeJ2[4] = {};    // Partial wrt i (ie., jj is fixed).
+                                            uEval.Eval(patchPtr + jj * uOrder * numCoordinates, numCoordinates,
+                                                i, uMeshRes,
+                                                tempPositionJ2, tempDerivativeJ2);
+                                            if (numCoordinates == 4) {
+                                                VecMultScalar(tempPositionJ2, 1.0 / tempPositionJ2[3], tempPositionJ2, 3);
+                                                VecAddScaled(tempPositionJ2, -tempDerivativeJ2[3], tempDerivativeJ2, 3);
+                                            }
+                                            VecCrossProd(tempDerivativeJ2, tempDerivativeI, normalVec);
+                                        }
+                                    }
+                                    normalNormSq = VecNormSq(normalVec, 3);
                                 }
+                                // End of special edge calculation for degenerate edge
+                                double normSqInv = 1.0 / sqrt(normalNormSq);
+                                *(normalPtr++) = (float)(normalVec[0] * normSqInv);
+                                *(normalPtr++) = (float)(normalVec[1] * normSqInv);
+                                *normalPtr = (float)(normalVec[2] * normSqInv);
                             }
-                            normalNormSq = VecNormSq(normalVec, 3);
                         }
-                        // End of special edge calculation for degenerate edge
-                        double normSqInv = 1.0 / sqrt(normalNormSq);
-                        *(normalPtr++) = (float)(normalVec[0] * normSqInv);
-                        *(normalPtr++) = (float)(normalVec[1] * normSqInv);
-                        *normalPtr = (float)(normalVec[2] * normSqInv);
+                        // Calculate texture coordinate
+                        if (calcTexCoords) {
+                            float* tcPtr = vboPtr + stagingTexCoordsOffset;
+                            *tcPtr = (float)i / (float)uMeshRes;
+                            *(tcPtr + 1) = (float)j / (float)vMeshRes;
+                        }
                     }
                 }
-                // Calculate texture coordinate
-                if (calcTexCoords) {
-                    float* tcPtr = vboPtr + vertTexCoordsOffset;
-                    *tcPtr = (float)i / (float)uMeshRes;
-                    *(tcPtr + 1) = (float)j / (float)vMeshRes;
+
+                // Fifth, find the degenerate triangles in the staging block, and count the others.
+                unsigned char* quadTrisPtr = quadTris.data() + (size_t)patchNum * numQuadsInPatch;
+                const float* posPtr = patchVerts.data();
+                int numTris = 0;
+                int idx = 0;
+                for (int j = 0; j < vMeshRes; j++) {
+                    for (int i = 0; i < uMeshRes; i++) {
+                        unsigned char tris = 0;
+                        if (!(EqualVerts(idx, idx + 1, posPtr, stagingStride)
+                                || EqualVerts(idx, idx + (uMeshRes + 1), posPtr, stagingStride))) {
+                            tris |= 1;
+                            numTris++;
+                        }
+                        if (!(EqualVerts(idx + (uMeshRes + 1), idx + (uMeshRes + 2), posPtr, stagingStride)
+                                || EqualVerts(idx + (uMeshRes + 2), idx + 1, posPtr, stagingStride))) {
+                            tris |= 2;
+                            numTris++;
+                        }
+                        *(quadTrisPtr++) = tris;
+                        idx++;
+                    }
+                    idx++;
+                }
+                firstTriInPatch[patchNum + 1] = numTris;
+
+                // Finally, stream the patch's vertices into the VBO, in order.
+                const float* fromPtr = patchVerts.data();
+                float* toPtr = VBOdataBuffer + (size_t)stride * patchNum * numVertsInPatch;
+                for (int v = 0; v < numVertsInPatch; v++, fromPtr += stagingStride, toPtr += stride) {
+                    memcpy(toPtr + vertPosOffset, fromPtr, 3 * sizeof(float));
+                    if (calcNormals) {
+                        memcpy(toPtr + vertNormalOffset, fromPtr + stagingNormalOffset, 3 * sizeof(float));
+                    }
+                    if (calcTexCoords) {
+                        memcpy(toPtr + vertTexCoordsOffset, fromPtr + stagingTexCoordsOffset, 2 * sizeof(float));
+                    }
                 }
             }
-        }
-    }
-    delete[] sliceCntlPtsI;
-    delete[] sliceCntlPtsJ;
- 
-    // Set up the element array. Somewhat wastefully, each triangle has its own
-    // entries in the EBO, so as to fit the framework used by GlGeomBase.
+        });
+    });
+
+    // The prefix sum of the numbers of triangles gives the first triangle of each patch.
     firstTriInPatch[0] = 0;
-    int idx = 0;
-    unsigned int* eboPtr = EBOdataBuffer;
     for (int patchNum = 0; patchNum < numPatches; patchNum++) {
-        for (int j = 0; j < vMeshRes; j++) {
-            for (int i = 0; i < uMeshRes; i++) {
-                if (!(EqualVerts(idx, idx + 1, VBOdataBuffer+vertPosOffset, stride) 
-                        || EqualVerts(idx, idx + (uMeshRes + 1), VBOdataBuffer + vertPosOffset, stride))) {
-                    *(eboPtr++) = idx;
-                    *(eboPtr++) = idx + 1;
-                    *(eboPtr++) = idx + (uMeshRes + 1);
-                }
-                if (!(EqualVerts(idx + (uMeshRes + 1), idx + (uMeshRes + 2), VBOdataBuffer + vertPosOffset, stride)
-                        || EqualVerts(idx + (uMeshRes + 2), idx + 1, VBOdataBuffer + vertPosOffset, stride))) {
-                    *(eboPtr++) = idx + (uMeshRes + 1);
-                    *(eboPtr++) = idx + 1;
-                    *(eboPtr++) = idx + (uMeshRes + 2);
+        firstTriInPatch[patchNum + 1] += firstTriInPatch[patchNum];
+    }
+
+    // Then each patch's part of the element array is written, in parallel.
+    //    Somewhat wastefully, each triangle has its own entries in the EBO,
+    //    so as to fit the framework used by GlGeomBase.
+    ParallelFor(0, numPatches, minPatchesPerTask, [&](int patchStart, int patchEnd) {
+        for (int patchNum = patchStart; patchNum < patchEnd; patchNum++) {
+            unsigned int* eboPtr = EBOdataBuffer + 3 * firstTriInPatch[patchNum];
+            const unsigned char* quadTrisPtr = quadTris.data() + (size_t)patchNum * numQuadsInPatch;
+            unsigned int idx = patchNum * numVertsInPatch;
+            for (int j = 0; j < vMeshRes; j++) {
+                for (int i = 0; i < uMeshRes; i++) {
+                    unsigned char tris = *(quadTrisPtr++);
+                    if (tris & 1) {
+                        *(eboPtr++) = idx;
+                        *(eboPtr++) = idx + 1;
+                        *(eboPtr++) = idx + (uMeshRes + 1);
+                    }
+                    if (tris & 2) {
+                        *(eboPtr++) = idx + (uMeshRes + 1);
+                        *(eboPtr++) = idx + 1;
+                        *(eboPtr++) = idx + (uMeshRes + 2);
+                    }
+                    idx++;
                 }
                 idx++;
             }
-            idx++;
+            assert(eboPtr == EBOdataBuffer + 3 * firstTriInPatch[patchNum + 1]);
         }
-        idx += uMeshRes+1;
-        firstTriInPatch[patchNum + 1] = (int)((eboPtr - EBOdataBuffer) / 3);
-    }
-
+    });
 }
 
 // retCornerNormals is a pointer to an array where the
@@ -517,10 +614,10 @@ double GlGeomBezier::MaxAbsEntry(double* cntlPt)
     return ret;
 }
 
-bool GlGeomBezier::EqualVerts(int i, int j, float* vboVertPtr, int stride) const
+bool GlGeomBezier::EqualVerts(int i, int j, const float* vboVertPtr, int stride) const
 {
-    float* vertI = vboVertPtr + stride * i;
-    float* vertJ = vboVertPtr + stride * j;
+    const float* vertI = vboVertPtr + stride * i;
+    const float* vertJ = vboVertPtr + stride * j;
     return (*vertI == *vertJ && *(vertI + 1) == *(vertJ + 1) && *(vertI + 2) == *(vertJ + 2));
 }
 
@@ -531,75 +628,14 @@ void GlGeomBezier::InitializeAttribLocations(
     // The call to GlGeomBase::InitializeAttribLocations will further call
     //   GlGeomBezier::CalcVboAndEbo()
 
+    if (pos_loc != patchPosLoc) {
+        patchPosLoc = pos_loc;
+        patchesLoaded = false;
+    }
     GlGeomBase::InitializeAttribLocations(pos_loc, normal_loc, texcoords_loc);
     VboEboLoaded = true;
 }
 
-// Main computation for values and derivatives of Bezier curves of arbitrary degree
-// Parameters:
-//     cntlPts - pointer to the control points.
-//               Each control point consists numCoordinates many floats
-//     stride - stride between control points. Measured in floats.
-//     order - The order (degree plus 1) of the Bezier curve.
-//     alphaNumerator & alphaDenominator: divide to get value where curve is evaluated
-//             They are specified separately to avoid round off error causing 
-//             different results if a curve is traversed in both directions 
-//             (i.e., with control points reversed)
-//     destVal- Pointer to where the results are returned (numCoordinates many values)
-//     destDeriv - Pointer to where the derivative is returned. 
-//                 If null, no derivative returned
-void GlGeomBezier::BezierMultiEval(
-    double* cntlPts, int stride,
-    int order, int alphaNumerator, int alphaDenominator,
-    double* destVal, double* destDeriv)
-{
-    assert(alphaDenominator > 0);
-    assert(order > 1);
-    bool reverseLerpDirection = (alphaNumerator > alphaDenominator / 2);
-    double alpha;
-    if (reverseLerpDirection) {
-        // Reverse the traversal order
-        cntlPts += stride * (order - 1);
-        stride = -stride;
-        alpha = (double)(alphaDenominator-alphaNumerator) / (double)alphaDenominator;
-    }
-    else {
-        alpha = (double)alphaNumerator / (double)alphaDenominator;
-    }
-    double beta = 1.0 - alpha;
-    double* workSpace = new double[(order * (order + 1)) >> 1];
-    for (int i = 0; i < numCoordinates; i++) {
-        // Handle i-th coordinate
-        // First, copy control points into the workSpace array
-        for (int j = 0; j < order; j++) {
-            *(workSpace + j) = *(cntlPts + j * stride + i);
-        }
-        // De Casteljau algorithm
-        double* fromPtr = workSpace;
-        double* toPtr = workSpace + order;
-        for (int j = 0; j < order - 1; j++) {
-            for (int k = 0; k < order - j - 1; k++) {
-                *toPtr = beta * (*fromPtr) + alpha * (*(fromPtr + 1));
-                toPtr++;
-                fromPtr++;
-            }
-            fromPtr++;
-        }
-        // Copy answers to correct locations
-        double* ansPtr = workSpace + (((order * (order + 1)) >> 1) - 1);
-        *(destVal + i) = *ansPtr;
-        if (destDeriv != 0) {
-            double deriv = (*(ansPtr - 1) - *(ansPtr - 2));
-            if (reverseLerpDirection) {
-                deriv = -deriv;
-            }
-            *(destDeriv + i) = deriv;
-        }
-    }
-   
-    delete[] workSpace;
-}
-
 // **********************************************
 // These routines do the rendering.
 // If the patches' VAO, VBO, EBO need to be loaded, it does this first.
@@ -649,6 +685,86 @@ void GlGeomBezier::RenderPatches(int i, int n)
     GlGeomBase::RenderEBO(GL_TRIANGLES, 3 * numTriangles, patchEboIndex);
 }
 
+// **********************************************
+// Rendering with the tessellation shaders.
+// The VBO holds only the control points, as (x,y,z,w), one GL_PATCHES patch per Bezier patch.
+// **********************************************
+
+bool GlGeomBezier::TessellationSupported()
+{
+    return GLEW_VERSION_4_0 || GLEW_ARB_tessellation_shader;
+}
+
+int GlGeomBezier::maxTessLevel = 64;       // The smallest GL_MAX_TESS_GEN_LEVEL allowed by OpenGL
+
+void GlGeomBezier::QueryTessellationLimits()
+{
+    assert(TessellationSupported());
+    glGetIntegerv(GL_MAX_TESS_GEN_LEVEL, &maxTessLevel);
+}
+
+void GlGeomBezier::LoadPatches()
+{
+    assert(controlPts != 0 && patchPosLoc != UINT_MAX);
+    if (patchVAO == 0) {
+        glGenVertexArrays(1, &patchVAO);
+        glGenBuffers(1, &patchVBO);
+        glGenBuffers(1, &cornerNormalsBuffer);
+    }
+    int numCntlPts = numPatches * uOrder * vOrder;
+    float* patchData = new float[4 * numCntlPts];
+    const double* fromPtr = controlPts;
+    float* toPtr = patchData;
+    for (int k = 0; k < numCntlPts; k++) {
+        *(toPtr++) = (float)fromPtr[0];
+        *(toPtr++) = (float)fromPtr[1];
+        *(toPtr++) = (float)fromPtr[2];
+        *(toPtr++) = (numCoordinates == 4) ? (float)fromPtr[3] : 1.0f;
+        fromPtr += numCoordinates;
+    }
+    glBindVertexArray(patchVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, patchVBO);
+    glBufferData(GL_ARRAY_BUFFER, 4 * numCntlPts * sizeof(float), patchData, GL_STATIC_DRAW);
+    glVertexAttribPointer(patchPosLoc, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(patchPosLoc);
+    glBindVertexArray(0);
+    delete[] patchData;
+
+    // The corner normals, and nearZeroSq, for the compute shader.  (They do not depend on the mesh resolution.)
+    float* cornerData = new float[16 * numPatches];
+    int numValuesInPatch = uOrder * vOrder * numCoordinates;
+    for (int patchNum = 0; patchNum < numPatches; patchNum++) {
+        double cornerNormals[4][3];
+        double nearZeroSq;
+        CalcCornerNormals(controlPts + patchNum * numValuesInPatch, &cornerNormals[0][0], &nearZeroSq);
+        for (int k = 0; k < 4; k++) {
+            float* toCorner = cornerData + 16 * patchNum + 4 * k;
+            toCorner[0] = (float)cornerNormals[k][0];
+            toCorner[1] = (float)cornerNormals[k][1];
+            toCorner[2] = (float)cornerNormals[k][2];
+            toCorner[3] = (float)nearZeroSq;
+        }
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, cornerNormalsBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, 16 * numPatches * sizeof(float), cornerData, GL_STATIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    delete[] cornerData;
+    patchesLoaded = true;
+}
+
+void GlGeomBezier::RenderTessellated(unsigned int bezierParamsLoc)
+{
+    assert(uOrder > 1 && vOrder > 1 && uOrder * vOrder <= MaxTessPatchVertices);
+    if (!patchesLoaded) {
+        LoadPatches();
+    }
+    glBindVertexArray(patchVAO);
+    glPatchParameteri(GL_PATCH_VERTICES, uOrder * vOrder);
+    // Higher levels would be clamped by the GPU, and would no longer match the mesh resolutions.
+    glUniform4i(bezierParamsLoc, Min(uMeshRes, maxTessLevel), Min(vMeshRes, maxTessLevel), uOrder, vOrder);
+    glDrawArrays(GL_PATCHES, 0, numPatches * uOrder * vOrder);
+}
+
 // **********************************************
 // Simple vector functions (without classes)
 // **********************************************
@@ -717,3 +833,84 @@ bool GlGeomBezier::VecIsZero(const double* vec, int numComponents)
     }
     return true;
 }
+
+// **********************************************
+// Computing the VBO and EBO with the compute shader (computeShader_Bezier).
+// The VBO and EBO are bound as shader storage buffers, with the control points,
+//    the corner normals, and a buffer for the triangle counts of each row.
+// **********************************************
+
+unsigned int GlGeomBezier::computeProgram = 0;
+int GlGeomBezier::computeBezierParamsLoc = -1;
+int GlGeomBezier::computeVboLayoutLoc = -1;
+int GlGeomBezier::computePassLoc = -1;
+
+bool GlGeomBezier::ComputeSupported()
+{
+    return GLEW_VERSION_4_3 || (GLEW_ARB_compute_shader && GLEW_ARB_shader_storage_buffer_object);
+}
+
+void GlGeomBezier::SetComputeProgram(unsigned int program)
+{
+    computeProgram = program;
+    if (program != 0) {
+        computeBezierParamsLoc = glGetUniformLocation(program, "bezierParams");
+        computeVboLayoutLoc = glGetUniformLocation(program, "vboLayout");
+        computePassLoc = glGetUniformLocation(program, "bezierPass");
+    }
+}
+
+bool GlGeomBezier::CalcVboAndEboOnGPU()
+{
+    if (computeProgram == 0) {
+        return false;
+    }
+    assert(uOrder > 1 && vOrder > 1 && uOrder <= MaxComputeOrder && vOrder <= MaxComputeOrder);
+    if (!patchesLoaded) {
+        LoadPatches();
+    }
+    int numRows = numPatches * vMeshRes;
+    if (rowTrisBuffer == 0) {
+        glGenBuffers(1, &rowTrisBuffer);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, rowTrisBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, (numRows + numPatches + 1) * sizeof(unsigned int), 0, GL_DYNAMIC_COPY);
+
+    GLint oldProgram;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &oldProgram);
+    glUseProgram(computeProgram);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, patchVBO);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, cornerNormalsBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, GetVBO());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, GetEBO());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, rowTrisBuffer);
+    glUniform4i(computeBezierParamsLoc, uMeshRes, vMeshRes, uOrder, vOrder);
+    glUniform4i(computeVboLayoutLoc, StrideVal(), UseNormals() ? NormalOffset() : -1,
+        UseTexCoords() ? TexOffset() : -1, numPatches);
+
+    // The four passes (see computeShader_Bezier), with 64 invocations per work group.
+    const int localSize = 64;
+    int numVertices = GetNumVerticesNoTexCoords();
+    glUniform1i(computePassLoc, 0);
+    glDispatchCompute((numVertices + localSize - 1) / localSize, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    glUniform1i(computePassLoc, 1);
+    glDispatchCompute((numRows + localSize - 1) / localSize, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    glUniform1i(computePassLoc, 2);
+    glDispatchCompute(1, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    glUniform1i(computePassLoc, 3);
+    glDispatchCompute((numRows + localSize - 1) / localSize, 1, 1);
+    glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_ELEMENT_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    // Read back firstTriInPatch[] (this waits for the compute shader to finish).
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, numRows * sizeof(unsigned int),
+        (numPatches + 1) * sizeof(unsigned int), firstTriInPatch);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glUseProgram(oldProgram);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return true;
+}
+
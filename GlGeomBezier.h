@@ -49,6 +49,10 @@
 //     * Call RenderPatches(i,n) to render n patches starting with the i-th patch.
 //     * The routines Render(...) issues the the glDrawElements commands 
 //       for the Bezier patch(es) using the VAO, VBO and EBO.
+//     * Or, with OpenGL 4.0, call RenderTessellated() to render all the patches
+//       with the tessellation shaders, from their control points alone.
+//     * With OpenGL 4.3, call SetComputeProgram() to compute the VBO's and EBO's
+//       with a compute shader instead of CalcVboAndEbo().
 
 class GlGeomBezier : public GlGeomBase
 {
@@ -70,7 +74,7 @@ public:
     //     specifying numPatches*uOrder*vOrder many vertices.
     // LoadControlPts makes a copy of the control points in case ReMeshing is needed.
     //     It is possible to pass in a null pointer, and then just the parameters are saved (For future compatibility.)
-    void LoadControlPts(int uOrder, int vOrder, int numCoordinates, int numPatches, double* controlPoints);
+    void LoadControlPts(int uOrder, int vOrder, int numCoordinates, int numPatches, const double* controlPoints);
 
     // Disable all copy and assignment operators for a GlGeomBezier object.
     //     If you need to pass it to/from a function, use references or pointers
@@ -87,6 +91,7 @@ public:
     //    more efficient if Remesh() is called first, or if the constructor sets the mesh resolution;
     //    and InitializeAttribLocations() is called afterwards.
     void Remesh(int uMeshResolution, int vMeshResolution);
+    bool NeedsReload() const { return !VboEboLoaded; }
 
     // Allocate the VAO, VBO, and EBO.
     // Set up info about the Vertex Attribute Locations
@@ -104,6 +109,36 @@ public:
     void RenderPatch(int i);            // Render the i-th patch only
     void RenderPatches(int i, int n);   // Render patches i through i+n-1 (n patches)
 
+    // Render the Bezier patches with the tessellation shaders, which compute the mesh on the GPU.
+    //    The control points are loaded (as GL_PATCHES, with w = 1 unless they are homogeneous)
+    //    into their own VAO and VBO the first time.  After that, nothing is computed or loaded:
+    //    the mesh resolutions are set in the uniform "bezierParams", whose location is the parameter.
+    //    The shader program must be formed from tessControlShader_Bezier and a tessellation
+    //    evaluation shader compiled with codeBlock_BezierPatch (see SurfaceProj.glsl).
+    //    The control points use the position location given to InitializeAttribLocations.
+    //    Needs OpenGL 4.0 (see TessellationSupported()), and at most MaxTessPatchVertices
+    //    control points per patch.
+    // The GPU clamps tessellation levels to GL_MAX_TESS_GEN_LEVEL (at least 64), so the mesh
+    //    resolutions are clamped to it first.  Call QueryTessellationLimits() once at startup
+    //    to read it; until then it is taken to be 64.
+    void RenderTessellated(unsigned int bezierParamsLoc);
+    static bool TessellationSupported();
+    static void QueryTessellationLimits();
+    static int GetMaxTessLevel() { return maxTessLevel; }
+    static const int MaxTessPatchVertices = 16;     // As in tessControlShader_Bezier
+
+    // The VBO and EBO can be computed by a compute shader, instead of by CalcVboAndEbo():
+    //    give SetComputeProgram() the shader program formed from computeShader_Bezier
+    //    (see SurfaceProj.glsl), or 0 to compute them on the CPU again.  It applies to all
+    //    GlGeomBezier's, from their next remesh (or InitializeAttribLocations()).
+    //    The control points are loaded once, as for RenderTessellated().  Only the number
+    //    of triangles in each patch is read back, for RenderPatch() and RenderPatches().
+    //    Needs OpenGL 4.3 (see ComputeSupported()), and orders at most MaxComputeOrder.
+    static void SetComputeProgram(unsigned int program);
+    static unsigned int GetComputeProgram() { return computeProgram; }
+    static bool ComputeSupported();
+    static const int MaxComputeOrder = 8;           // As in computeShader_Bezier
+
     // GetNumElementsMax() returns the maximum number of elements in the EBO
     // GetNumElementsRender() returns the actual number of elements in the EBO (for rendering)
     // GetNumVerticesTexCoords() returns the number of vertices when there are texture coordinates
@@ -123,11 +158,14 @@ public:
                         int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, 
                         unsigned int stride);
 
+    // CalcVboAndEbo() evaluates bicubic and biquadratic patches with evaluators
+    //    specialized for their orders (see GlGeomBezierEval.h).  The results are identical
+    //    either way: SetOrderSpecialized(false) is for benchmarking.
+    static void SetOrderSpecialized(bool specialized) { orderSpecialized = specialized; }
+    static bool IsOrderSpecialized() { return orderSpecialized; }
+
 protected:
-    void BezierMultiEval(
-        double* cntlPts, int stride, 
-        int order, int alphaNumerator, int alphaDenominator, 
-        double* destVal, double* destDeriv = 0);
+    bool CalcVboAndEboOnGPU() override;
 
 private:
     int uMeshRes;   // Mesh resolution in the "u" direction
@@ -143,12 +181,28 @@ private:
 
     int GetFirstTriInPatch(int i) const { assert(i <= numPatches); return firstTriInPatch[i]; }
     int GetNumTrisInPatch(int i) const;
-    bool EqualVerts(int i, int j, float* vboVertPtr, int stride) const;
+    bool EqualVerts(int i, int j, const float* vboVertPtr, int stride) const;
 
     bool VboEboLoaded = false;
 
     void PreRender();
 
+    // For RenderTessellated() and the compute shader
+    unsigned int patchVAO = 0;
+    unsigned int patchVBO = 0;              // The control points, as (x,y,z,w)
+    unsigned int cornerNormalsBuffer = 0;   // For the compute shader: the normals at the corners of the patches
+    unsigned int rowTrisBuffer = 0;         // For the compute shader: the triangles in each row and patch
+    unsigned int patchPosLoc = UINT_MAX;
+    bool patchesLoaded = false;
+    void LoadPatches();
+
+    static bool orderSpecialized;
+    static int maxTessLevel;
+    static unsigned int computeProgram;
+    static int computeBezierParamsLoc;
+    static int computeVboLayoutLoc;
+    static int computePassLoc;
+
     void CalcCornerNormals(const double* controlPointsPtr, double* retCornerNormals, double* retNearZeroSq);
     int CalcOneCornerNormal(const double* cornerPtr, int uStride, int vStride, double dest[3], double nearZeroSq);
     double MaxAbsEntry(double* cntlPt);
@@ -173,12 +227,6 @@ inline GlGeomBezier::GlGeomBezier(int uMeshResolution, int vMeshResolution)
     vMeshRes = vMeshResolution;
 }
 
-// Destructor
-inline GlGeomBezier::~GlGeomBezier()
-{
-    delete[] controlPts;
-}
-
 inline int GlGeomBezier::GetNumTrisInPatch(int i) const 
 {
     assert(i < numPatches);
@@ -0,0 +1,201 @@
+/*
+* GlGeomBezierEval.h - Version 1.0
+*
+* Evaluators of Bezier curves (values and derivatives) for GlGeomBezier::CalcVboAndEbo.
+*   All evaluators run the de Casteljau algorithm on all the coordinates of a
+*   control point at once: each point is held as four doubles, padded with zero
+*   for points in R^3, and each lerp is one AVX operation, or two SSE2 operations.
+*   The workspace is on the stack, so there is no heap traffic (except for
+*   orders above GlGeomBezierMaxEvalOrder, which are rare).
+*
+*   GlGeomBezierEvalFixed has the order and the number of coordinates as template
+*   parameters, so its loops are fully unrolled (e.g., for cubic curves).
+*   GlGeomBezierEvalRuntime takes them at run time, for any order.  Both do exactly the same arithmetic, in the same
+*   order, as the original GlGeomBezier::BezierMultiEval, so the results are identical.
+*
+*   GlGeomDispatchBezierEval() picks the evaluators for the orders of a patch,
+*   and calls the mesh generating code (a generic lambda) with them.
+*
+* Software is "as-is" and carries no warranty.  It may be used without
+*   restriction, but if you modify it, please change the filenames to
+*   prevent confusion between different versions.
+*/
+
+#pragma once
+#ifndef GLGEOM_BEZIER_EVAL_H
+#define GLGEOM_BEZIER_EVAL_H
+
+#include <assert.h>
+#include <vector>
+
+#if defined(__AVX__)
+#define GLGEOM_BEZIER_USE_AVX 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GLGEOM_BEZIER_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+const int GlGeomBezierMaxEvalOrder = 32;     // Largest order with the workspace on the stack
+
+// An evaluator has the following members:
+//     GetOrder() - the order (degree plus 1) of the curves
+//     Eval(cntlPts, stride, alphaNumerator, alphaDenominator, destVal, destDeriv)
+//         Evaluates the curve with control points cntlPts[0], cntlPts[stride], ...
+//         at alpha = alphaNumerator/alphaDenominator.  They are specified separately to
+//         avoid round off error causing different results if a curve is traversed in
+//         both directions (i.e., with control points reversed).
+//         The value and the derivative (not multiplied by the degree) are returned
+//         in destVal and destDeriv (numCoordinates values each).  destDeriv may be null.
+
+// to = beta*from0 + alpha*from1, for the four doubles of a point.
+inline void GlGeomBezierLerp4(double* to, const double* from0, const double* from1, double alpha, double beta)
+{
+#if GLGEOM_BEZIER_USE_AVX
+    __m256d val = _mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(beta), _mm256_loadu_pd(from0)),
+                                _mm256_mul_pd(_mm256_set1_pd(alpha), _mm256_loadu_pd(from1)));
+    _mm256_storeu_pd(to, val);
+#elif GLGEOM_BEZIER_USE_SSE2
+    __m128d betaV = _mm_set1_pd(beta);
+    __m128d alphaV = _mm_set1_pd(alpha);
+    __m128d lo = _mm_add_pd(_mm_mul_pd(betaV, _mm_loadu_pd(from0)), _mm_mul_pd(alphaV, _mm_loadu_pd(from1)));
+    __m128d hi = _mm_add_pd(_mm_mul_pd(betaV, _mm_loadu_pd(from0 + 2)), _mm_mul_pd(alphaV, _mm_loadu_pd(from1 + 2)));
+    _mm_storeu_pd(to, lo);
+    _mm_storeu_pd(to + 2, hi);
+#else
+    for (int c = 0; c < 4; c++) {
+        to[c] = beta * from0[c] + alpha * from1[c];
+    }
+#endif
+}
+
+// Sets alpha, and reverses the traversal order if alpha is more than one half.
+//    Returns true if it was reversed.
+inline bool GlGeomBezierSetAlpha(const double*& cntlPts, int& stride, int order,
+    int alphaNumerator, int alphaDenominator, double* alpha)
+{
+    assert(alphaDenominator > 0);
+    if (alphaNumerator > alphaDenominator / 2) {
+        cntlPts += stride * (order - 1);
+        stride = -stride;
+        *alpha = (double)(alphaDenominator - alphaNumerator) / (double)alphaDenominator;
+        return true;
+    }
+    *alpha = (double)alphaNumerator / (double)alphaDenominator;
+    return false;
+}
+
+// The de Casteljau algorithm, in place on the order points in workSpace (four doubles each).
+//    Returns the value and the derivative, from the last two points.
+inline void GlGeomBezierDeCasteljau(double* workSpace, int order, int numCoords, double alpha, bool reversed,
+    double* destVal, double* destDeriv)
+{
+    double beta = 1.0 - alpha;
+    for (int level = order - 1; level > 1; level--) {
+        for (int k = 0; k < level; k++) {
+            GlGeomBezierLerp4(workSpace + 4 * k, workSpace + 4 * k, workSpace + 4 * (k + 1), alpha, beta);
+        }
+    }
+    if (destDeriv != 0) {
+        for (int c = 0; c < numCoords; c++) {
+            double deriv = workSpace[4 + c] - workSpace[c];
+            destDeriv[c] = reversed ? -deriv : deriv;
+        }
+    }
+    GlGeomBezierLerp4(workSpace, workSpace, workSpace + 4, alpha, beta);
+    for (int c = 0; c < numCoords; c++) {
+        destVal[c] = workSpace[c];
+    }
+}
+
+// Copies the order control points into workSpace, padding each to four doubles.
+inline void GlGeomBezierLoadPoints(double* workSpace, const double* cntlPts, int stride, int order, int numCoords)
+{
+    for (int j = 0; j < order; j++) {
+        double* toPtr = workSpace + 4 * j;
+        const double* fromPtr = cntlPts + j * stride;
+        toPtr[0] = fromPtr[0];
+        toPtr[1] = fromPtr[1];
+        toPtr[2] = fromPtr[2];
+        toPtr[3] = (numCoords == 4) ? fromPtr[3] : 0.0;
+    }
+}
+
+// GlGeomBezierEvalFixed - order and number of coordinates (3 or 4) known at compile time.
+template<int Order, int NumCoords>
+struct GlGeomBezierEvalFixed
+{
+    static_assert(Order > 1, "A Bezier curve has order at least 2");
+    static_assert(NumCoords == 3 || NumCoords == 4, "Points in R^3, or homogeneous coordinates");
+
+    static constexpr int GetOrder() { return Order; }
+
+    static void Eval(const double* cntlPts, int stride, int alphaNumerator, int alphaDenominator,
+        double* destVal, double* destDeriv = 0)
+    {
+        double alpha;
+        bool reversed = GlGeomBezierSetAlpha(cntlPts, stride, Order, alphaNumerator, alphaDenominator, &alpha);
+        alignas(32) double workSpace[4 * Order];
+        GlGeomBezierLoadPoints(workSpace, cntlPts, stride, Order, NumCoords);
+        GlGeomBezierDeCasteljau(workSpace, Order, NumCoords, alpha, reversed, destVal, destDeriv);
+    }
+};
+
+// GlGeomBezierEvalRuntime - any order.  Orders above GlGeomBezierMaxEvalOrder use a heap workspace.
+struct GlGeomBezierEvalRuntime
+{
+    int order;
+    int numCoords;
+
+    int GetOrder() const { return order; }
+
+    void Eval(const double* cntlPts, int stride, int alphaNumerator, int alphaDenominator,
+        double* destVal, double* destDeriv = 0) const
+    {
+        assert(order > 1);
+        double alpha;
+        bool reversed = GlGeomBezierSetAlpha(cntlPts, stride, order, alphaNumerator, alphaDenominator, &alpha);
+        alignas(32) double stackSpace[4 * GlGeomBezierMaxEvalOrder];
+        std::vector<double> heapSpace;      // Only allocated if the order is too large for stackSpace
+        double* workSpace = stackSpace;
+        if (order > GlGeomBezierMaxEvalOrder) {
+            heapSpace.resize(4 * order);
+            workSpace = heapSpace.data();
+        }
+        GlGeomBezierLoadPoints(workSpace, cntlPts, stride, order, numCoords);
+        GlGeomBezierDeCasteljau(workSpace, order, numCoords, alpha, reversed, destVal, destDeriv);
+    }
+};
+
+// Call kernel(uEval, vEval) with the evaluators for the orders uOrder and vOrder.
+//    Bicubic and biquadratic patches get fixed evaluators; other orders, or all
+//    orders if specialize is false, use GlGeomBezierEvalRuntime.
+//    kernel is usually a generic lambda, so its code is compiled once for each pair.
+template<class Kernel>
+inline void GlGeomDispatchBezierEval(int uOrder, int vOrder, int numCoords, bool specialize, Kernel&& kernel)
+{
+    assert(numCoords == 3 || numCoords == 4);
+    if (specialize && uOrder == vOrder) {
+        if (uOrder == 4 && numCoords == 3) {
+            kernel(GlGeomBezierEvalFixed<4, 3>(), GlGeomBezierEvalFixed<4, 3>());
+            return;
+        }
+        if (uOrder == 4 && numCoords == 4) {
+            kernel(GlGeomBezierEvalFixed<4, 4>(), GlGeomBezierEvalFixed<4, 4>());
+            return;
+        }
+        if (uOrder == 3 && numCoords == 3) {
+            kernel(GlGeomBezierEvalFixed<3, 3>(), GlGeomBezierEvalFixed<3, 3>());
+            return;
+        }
+        if (uOrder == 3 && numCoords == 4) {
+            kernel(GlGeomBezierEvalFixed<3, 4>(), GlGeomBezierEvalFixed<3, 4>());
+            return;
+        }
+    }
+    GlGeomBezierEvalRuntime uEval = { uOrder, numCoords };
+    GlGeomBezierEvalRuntime vEval = { vOrder, numCoords };
+    kernel(uEval, vEval);
+}
+
+#endif  // GLGEOM_BEZIER_EVAL_H
@@ -25,9 +25,25 @@
 #include <GLFW/glfw3.h>
 
 #include "GlGeomCylinder.h"
+#include "GlGeomLayout.h"
+#include "GlGeomProcedural.h"
+#include "GlGeomTrigTable.h"
+#include "ParallelFor.h"
 #include "MathMisc.h"
 #include "assert.h"
 
+// Sets one vertex of the top or bottom face, at basePtr.
+template<class Layout>
+static void SetDiscVert(const Layout& layout, float* basePtr, float x, float z, bool top)
+{
+    float y = top ? 1.0f : -1.0f;
+    float sCoord = 0.5f*(x + 1.0f);
+    float tCoord = 0.5f*(-z + 1.0f);
+    layout.SetPos(basePtr, x, y, z);
+    layout.SetNormal(basePtr, 0.0f, y, 0.0f);
+    layout.SetTexCoords(basePtr, top ? sCoord : 1.0f - sCoord, tCoord);
+}
+
 
 void GlGeomCylinder::Remesh(int slices, int stacks, int rings)
 {
@@ -46,142 +62,123 @@ void GlGeomCylinder::CalcVboAndEbo(float* VBOdataBuffer, unsigned int* EBOdataBu
     int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride)
 {
     assert(vertPosOffset >= 0 && stride > 0);
-    bool calcNormals = (vertNormalOffset >= 0);       // Should normals be calculated?
     bool calcTexCoords = (vertTexCoordsOffset >= 0);  // Should texture coordinates be calculated?
 
-    // VBO Data is laid out: top face vertices, then bottom face vertices, then side vertices
-
-    // Set top and bottom center vertices
-    SetDiscVerts(0.0, 0.0, 0, 0, VBOdataBuffer, vertPosOffset, vertNormalOffset, vertTexCoordsOffset, stride);
-    int stopSlices = calcTexCoords ? numSlices : numSlices - 1;
-    for (int i = 0; i <= stopSlices; i++) {
-        // Handle a slice of vertices.
-        // theta measures from the negative z-axis, counterclockwise viewed from above.
-        float theta = ((float)(i%numSlices))*(float)PI2 / (float)(numSlices);
-        float c = -cosf(theta);      // Negated values (start at negative z-axis)
-        float s = -sinf(theta);
-        if (i < numSlices) {
-            // Top & bottom face vertices, positions and normals and texture coordinates
-            for (int j = 1; j <= numRings; j++) {
-                float radius = (float)j / (float)numRings;
-                SetDiscVerts(s * radius, c * radius, i, j, VBOdataBuffer, vertPosOffset, vertNormalOffset, vertTexCoordsOffset, stride);
-            }
+    // VBO Data is laid out: bottom face vertices, then top face vertices, then side vertices.
+    //   They are written strictly in this order, since VBOdataBuffer is usually
+    //   mapped GPU memory, where scattered writes are slow.
+    // The layout is fixed at compile time (see GlGeomLayout.h), so the inner loops have no branches.
+    // Large meshes are split into ranges of slices, which are generated in parallel.
+    int minDiscSlicesPerTask = 1 + MinVertsPerTask / numRings;
+    int minSideSlicesPerTask = 1 + MinVertsPerTask / (numStacks + 1);
+    const GlGeomTrigTable& sliceTrig = GlGeomTrigTable::GetCircle(numSlices);     // See GlGeomTrigTable.h
+    GlGeomDispatchLayout(vertPosOffset, vertNormalOffset, vertTexCoordsOffset, stride, [&](auto layout) {
+        for (int top = 0; top <= 1; top++) {
+            // Center vertex, then the rings of each slice
+            float* discPtr = VBOdataBuffer + top * GetNumVerticesDisk() * layout.Stride();
+            SetDiscVert(layout, discPtr, 0.0f, 0.0f, top != 0);
+            ParallelFor(0, numSlices, minDiscSlicesPerTask, [&](int sliceStart, int sliceEnd) {
+                float* basePtr = discPtr + (1 + sliceStart * numRings) * layout.Stride();
+                for (int i = sliceStart; i < sliceEnd; i++) {
+                    // theta measures from the negative z-axis, counterclockwise viewed from above.
+                    float c = -sliceTrig.Cos(i);      // Negated values (start at negative z-axis)
+                    float s = -sliceTrig.Sin(i);
+                    for (int j = 1; j <= numRings; j++, basePtr += layout.Stride()) {
+                        float radius = (float)j / (float)numRings;
+                        SetDiscVert(layout, basePtr, s * radius, c * radius, top != 0);
+                    }
+                }
+            });
         }
-        float* basePtr = VBOdataBuffer + (2*GetNumVerticesDisk()+ i*(numStacks + 1))*stride;
-        float sCoord = ((float)i) / (float)(numSlices);
-        // Side vertices, positions and normals and texture coordinates
-        for (int j = 0; j <= numStacks; j++, basePtr+=stride) {
-            float* vPtr = basePtr + vertPosOffset;
-            float tCoord = (float)j / (float)numStacks;
-            *(vPtr++) = s;
-            *(vPtr++) = -1.0f + 2.0f*tCoord;
-            *vPtr = c;
-            if (calcNormals) {
-                float* nPtr = basePtr + vertNormalOffset;
-                *(nPtr++) = s;
-                *(nPtr++) = 0.0f;
-                *nPtr = c;
-            }
-            if (calcTexCoords) {
-                float* tcPtr = basePtr + vertTexCoordsOffset;
-                *(tcPtr++) = sCoord;
-                *tcPtr = tCoord;
+
+        float* sidePtr = VBOdataBuffer + 2 * GetNumVerticesDisk() * layout.Stride();
+        int stopSlices = layout.HasTexCoords() ? numSlices : numSlices - 1;
+        ParallelFor(0, stopSlices + 1, minSideSlicesPerTask, [&](int sliceStart, int sliceEnd) {
+            float* basePtr = sidePtr + sliceStart * (numStacks + 1) * layout.Stride();
+            for (int i = sliceStart; i < sliceEnd; i++) {
+                // Handle a slice of vertices.
+                // theta measures from the negative z-axis, counterclockwise viewed from above.
+                float c = -sliceTrig.Cos(i);      // Negated values (start at negative z-axis)
+                float s = -sliceTrig.Sin(i);
+                float sCoord = ((float)i) / (float)(numSlices);
+                // Side vertices, positions and normals and texture coordinates
+                for (int j = 0; j <= numStacks; j++, basePtr += layout.Stride()) {
+                    float tCoord = (float)j / (float)numStacks;
+                    layout.SetPos(basePtr, s, -1.0f + 2.0f*tCoord, c);
+                    layout.SetNormal(basePtr, s, 0.0f, c);
+                    layout.SetTexCoords(basePtr, sCoord, tCoord);
+                }
             }
-        }
-    }
+        });
+    });
 
-    // EBO data is also laid out as base, the top, then sides
-    unsigned int* eboPtr = EBOdataBuffer;
+    // EBO data is also laid out as base, the top, then sides.
+    //    Each slice of the base and of the top has 3+6*(numRings-1) elements,
+    //    and each slice of the side has 6*numStacks elements.
+    int discSliceElts = 3 + 6 * (numRings - 1);
     // Bottom 
-    for (int i = 0; i < numSlices; i++) {
-        int r = i*numRings + 1;
-        int rightR = ((i+1)%numSlices)*numRings + 1;
-        *(eboPtr++) = 0;
-        *(eboPtr++) = rightR;
-        *(eboPtr++) = r;
-        for (int j = 0; j < numRings-1; j++) {
-            *(eboPtr++) = r + j;
-            *(eboPtr++) = rightR + j;
-            *(eboPtr++) = rightR + j + 1;
+    ParallelFor(0, numSlices, minDiscSlicesPerTask, [&](int sliceStart, int sliceEnd) {
+        unsigned int* eboPtr = EBOdataBuffer + discSliceElts * sliceStart;
+        for (int i = sliceStart; i < sliceEnd; i++) {
+            int r = i*numRings + 1;
+            int rightR = ((i+1)%numSlices)*numRings + 1;
+            *(eboPtr++) = 0;
+            *(eboPtr++) = rightR;
+            *(eboPtr++) = r;
+            for (int j = 0; j < numRings-1; j++) {
+                *(eboPtr++) = r + j;
+                *(eboPtr++) = rightR + j;
+                *(eboPtr++) = rightR + j + 1;
  
-            *(eboPtr++) = r + j;
-            *(eboPtr++) = rightR + j + 1;
-            *(eboPtr++) = r + j + 1;
+                *(eboPtr++) = r + j;
+                *(eboPtr++) = rightR + j + 1;
+                *(eboPtr++) = r + j + 1;
+            }
         }
-    }
+    });
     // Top 
     int delta = GetNumVerticesDisk();
-    for (int i = 0; i < numSlices; i++) {
-        int r = delta + i*numRings + 1;
-        int leftR = delta + ((i + 1) % numSlices)*numRings + 1;
-        *(eboPtr++) = delta;
-        *(eboPtr++) = r;
-        *(eboPtr++) = leftR;
-        for (int j = 0; j < numRings-1; j++) {
-            *(eboPtr++) = leftR + j;
-            *(eboPtr++) = r + j;
-            *(eboPtr++) = r + j + 1;
-
-            *(eboPtr++) = leftR + j;
-            *(eboPtr++) = r + j + 1;
-            *(eboPtr++) = leftR + j + 1;
+    unsigned int* topEbo = EBOdataBuffer + discSliceElts * numSlices;
+    ParallelFor(0, numSlices, minDiscSlicesPerTask, [&](int sliceStart, int sliceEnd) {
+        unsigned int* eboPtr = topEbo + discSliceElts * sliceStart;
+        for (int i = sliceStart; i < sliceEnd; i++) {
+            int r = delta + i*numRings + 1;
+            int leftR = delta + ((i + 1) % numSlices)*numRings + 1;
+            *(eboPtr++) = delta;
+            *(eboPtr++) = r;
+            *(eboPtr++) = leftR;
+            for (int j = 0; j < numRings-1; j++) {
+                *(eboPtr++) = leftR + j;
+                *(eboPtr++) = r + j;
+                *(eboPtr++) = r + j + 1;
+
+                *(eboPtr++) = leftR + j;
+                *(eboPtr++) = r + j + 1;
+                *(eboPtr++) = leftR + j + 1;
+            }
         }
-    }
+    });
     // Side
-    for (int i = 0; i < numSlices; i++) {
-        int r = i*(numStacks + 1) + 2*delta;
-        int ii = calcTexCoords ? (i + 1) : (i + 1) % numSlices;
-        int rightR = ii*(numStacks + 1) + 2*delta;
-        for (int j = 0; j < numStacks; j++) {
-            *(eboPtr++) = rightR + j;
-            *(eboPtr++) = r + j + 1;
-            *(eboPtr++) = r + j;
-
-            *(eboPtr++) = rightR + j;
-            *(eboPtr++) = rightR + j + 1;
-            *(eboPtr++) = r + j + 1;
+    unsigned int* sideEbo = topEbo + discSliceElts * numSlices;
+    ParallelFor(0, numSlices, minSideSlicesPerTask, [&](int sliceStart, int sliceEnd) {
+        unsigned int* eboPtr = sideEbo + 6 * numStacks * sliceStart;
+        for (int i = sliceStart; i < sliceEnd; i++) {
+            int r = i*(numStacks + 1) + 2*delta;
+            int ii = calcTexCoords ? (i + 1) : (i + 1) % numSlices;
+            int rightR = ii*(numStacks + 1) + 2*delta;
+            for (int j = 0; j < numStacks; j++) {
+                *(eboPtr++) = rightR + j;
+                *(eboPtr++) = r + j + 1;
+                *(eboPtr++) = r + j;
+
+                *(eboPtr++) = rightR + j;
+                *(eboPtr++) = rightR + j + 1;
+                *(eboPtr++) = r + j + 1;
+            }
         }
-    }
+    });
 }
 
-void GlGeomCylinder::SetDiscVerts(float x, float z, int i, int j, float* VBOdataBuffer,
-    int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, int stride)
-{
-    // i is the slice number, j is the ring number.
-    // j==0 means the center point.  In this case, i must equal 0. (Not checked)
-    float* basePtrBottom = VBOdataBuffer + stride*(i*numRings + j);
-    int delta = GetNumVerticesDisk()*stride;
-    float* vPtrBottom = basePtrBottom + vertPosOffset;
-    float* vPtrTop = vPtrBottom + delta;
-    *(vPtrBottom++) = x;
-    *(vPtrBottom++) = -1.0;
-    *vPtrBottom = z;
-    *(vPtrTop++) = x;
-    *(vPtrTop++) = 1.0;
-    *vPtrTop = z;
-    if (vertNormalOffset>=0) {
-        float* nPtrBottom = basePtrBottom + vertNormalOffset;
-        float* nPtrTop = nPtrBottom + delta;
-        *(nPtrBottom++) = 0.0;
-        *(nPtrBottom++) = -1.0;
-        *nPtrBottom = 0.0;
-        *(nPtrTop++) = 0.0;
-        *(nPtrTop++) = 1.0;
-        *nPtrTop = 0.0;
-    }
-    if (vertTexCoordsOffset>=0) {
-        float sCoord = 0.5f*(x + 1.0f);
-        float tCoord = 0.5f*(-z + 1.0f);
-        float* tcPtrBottom = basePtrBottom + vertTexCoordsOffset;
-        float* tcPtrTop = tcPtrBottom + delta;
-        *(tcPtrBottom++) = 1.0f - sCoord;
-        *tcPtrBottom = tCoord;
-        *(tcPtrTop++) = sCoord;
-        *tcPtrTop = tCoord;
-    }
-}
-
-
 void GlGeomCylinder::InitializeAttribLocations(
     unsigned int pos_loc, unsigned int normal_loc, unsigned int texcoords_loc)
 {
@@ -209,6 +206,10 @@ void GlGeomCylinder::PreRender()
 
 void GlGeomCylinder::Render()
 {
+    if (GlGeomProcedural::IsEnabled()) {       // No VBO or EBO needed (see GlGeomProcedural.h)
+        GlGeomProcedural::RenderTriangles(GlGeomProcedural::Cylinder, numSlices, numStacks, numRings, 0.0f, GetNumElements());
+        return;
+    }
     PreRender();
     GlGeomBase::Render();
 }
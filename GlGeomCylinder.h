@@ -54,6 +54,7 @@ public:
     // Can be called either before or after InitializeAttribLocations(), but it is
     //    more efficient if Remesh() is called first, or if the constructor sets the mesh resolution.
     void Remesh(int slices, int stacks, int rings);
+    bool NeedsReload() const { return !VboEboLoaded; }
 
 	// Allocate the VAO, VBO, and EBO.
 	// Set up info about the Vertex Attribute Locations
@@ -117,9 +118,6 @@ private:
     bool VboEboLoaded = false;
 
     void PreRender();
-
-    void SetDiscVerts(float x, float z, int i, int j, float* VBOdataBuffer,
-        int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, int stride);
  };
 
 // Constructor
@@ -0,0 +1,132 @@
+/*
+* GlGeomLayout.h - Version 1.0
+*
+* Vertex layouts for the CalcVboAndEbo routines of the GlGeomShape classes.
+*   CalcVboAndEbo takes the layout of a vertex as run-time offsets and a
+*   stride.  Checking these for every vertex puts branches and variable
+*   strides in the inner loops, which stops the compiler from unrolling
+*   and vectorizing them.
+*
+*   GlGeomDispatchLayout() checks the offsets once, and calls the vertex
+*   generating code (a generic lambda) with a layout type whose offsets and
+*   stride are compile-time constants, when they are one of the tightly
+*   packed layouts used by GlGeomBase.  Other layouts use GlGeomLayoutRuntime.
+*
+* Software is "as-is" and carries no warranty.  It may be used without
+*   restriction, but if you modify it, please change the filenames to
+*   prevent confusion between different versions.
+*/
+
+#pragma once
+#ifndef GLGEOM_LAYOUT_H
+#define GLGEOM_LAYOUT_H
+
+#include <assert.h>
+
+// A layout has the following members, all taking a pointer to the start of a vertex:
+//     HasNormals(), HasTexCoords(), Stride() (in floats)
+//     SetPos(vertex, x, y, z)
+//     SetNormal(vertex, x, y, z)      Does nothing if there are no normals
+//     SetTexCoords(vertex, s, t)      Does nothing if there are no texture coordinates
+// The position is always the first three floats of the vertex.
+
+// GlGeomLayoutFixed - offsets and stride known at compile time.
+//     An offset of -1 means the value is omitted.
+template<int NormalOffset, int TexOffset, int StrideVal>
+struct GlGeomLayoutFixed
+{
+    static constexpr bool HasNormals() { return NormalOffset >= 0; }
+    static constexpr bool HasTexCoords() { return TexOffset >= 0; }
+    static constexpr int Stride() { return StrideVal; }
+
+    static void SetPos(float* vertex, float x, float y, float z) {
+        vertex[0] = x;
+        vertex[1] = y;
+        vertex[2] = z;
+    }
+    static void SetNormal(float* vertex, float x, float y, float z) {
+        if (NormalOffset >= 0) {
+            vertex[NormalOffset] = x;
+            vertex[NormalOffset + 1] = y;
+            vertex[NormalOffset + 2] = z;
+        }
+    }
+    static void SetTexCoords(float* vertex, float s, float t) {
+        if (TexOffset >= 0) {
+            vertex[TexOffset] = s;
+            vertex[TexOffset + 1] = t;
+        }
+    }
+};
+
+// The layouts used by GlGeomBase (see StrideVal(), NormalOffset() and TexOffset()).
+typedef GlGeomLayoutFixed<-1, -1, 3> GlGeomLayoutPos;
+typedef GlGeomLayoutFixed<3, -1, 6> GlGeomLayoutPosNormal;
+typedef GlGeomLayoutFixed<-1, 3, 5> GlGeomLayoutPosTex;
+typedef GlGeomLayoutFixed<3, 6, 8> GlGeomLayoutPosNormalTex;
+
+// GlGeomLayoutRuntime - any other layout.
+struct GlGeomLayoutRuntime
+{
+    int posOffset;
+    int normalOffset;
+    int texOffset;
+    int stride;
+
+    bool HasNormals() const { return normalOffset >= 0; }
+    bool HasTexCoords() const { return texOffset >= 0; }
+    int Stride() const { return stride; }
+
+    void SetPos(float* vertex, float x, float y, float z) const {
+        float* vPtr = vertex + posOffset;
+        vPtr[0] = x;
+        vPtr[1] = y;
+        vPtr[2] = z;
+    }
+    void SetNormal(float* vertex, float x, float y, float z) const {
+        if (normalOffset >= 0) {
+            float* nPtr = vertex + normalOffset;
+            nPtr[0] = x;
+            nPtr[1] = y;
+            nPtr[2] = z;
+        }
+    }
+    void SetTexCoords(float* vertex, float s, float t) const {
+        if (texOffset >= 0) {
+            float* tcPtr = vertex + texOffset;
+            tcPtr[0] = s;
+            tcPtr[1] = t;
+        }
+    }
+};
+
+// Call kernel(layout) with the layout matching the CalcVboAndEbo parameters.
+//    kernel is usually a generic lambda, so its code is compiled once for each layout.
+template<class Kernel>
+inline void GlGeomDispatchLayout(int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset,
+    unsigned int stride, Kernel&& kernel)
+{
+    assert(vertPosOffset >= 0 && stride > 0);
+    if (vertPosOffset == 0) {
+        if (vertNormalOffset < 0 && vertTexCoordsOffset < 0 && stride == 3) {
+            kernel(GlGeomLayoutPos());
+            return;
+        }
+        if (vertNormalOffset == 3 && vertTexCoordsOffset < 0 && stride == 6) {
+            kernel(GlGeomLayoutPosNormal());
+            return;
+        }
+        if (vertNormalOffset < 0 && vertTexCoordsOffset == 3 && stride == 5) {
+            kernel(GlGeomLayoutPosTex());
+            return;
+        }
+        if (vertNormalOffset == 3 && vertTexCoordsOffset == 6 && stride == 8) {
+            kernel(GlGeomLayoutPosNormalTex());
+            return;
+        }
+    }
+    GlGeomLayoutRuntime layout = { vertPosOffset, vertNormalOffset, vertTexCoordsOffset, (int)stride };
+    kernel(layout);
+}
+
+#endif  // GLGEOM_LAYOUT_H
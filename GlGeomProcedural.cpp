@@ -0,0 +1,168 @@
+/*
+* GlGeomProcedural.cpp - Version 1.0
+*
+* Renders spheres, tori, cylinders and flat grids with no vertex buffers.
+*   See GlGeomProcedural.h for information on how to use it.
+*
+* Software is "as-is" and carries no warranty.  It may be used without
+*   restriction, but if you modify it, please change the filenames to
+*   prevent confusion between different versions.
+*/
+
+// Use the static library (so glew32.dll is not needed):
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <assert.h>
+
+#include "GlGeomProcedural.h"
+#include "GlGeomTrigTable.h"
+
+bool GlGeomProcedural::isEnabled = false;
+unsigned int GlGeomProcedural::shapeParamsLocation = (unsigned int)-1;
+unsigned int GlGeomProcedural::shapeRadiusLocation = (unsigned int)-1;
+unsigned int GlGeomProcedural::emptyVAO = 0;
+
+// The six elements of a pair of triangles, as offsets from the (slice or ring, stack or side)
+//    numbers of the pair.  The orders are those of the EBO's written by CalcVboAndEbo().
+//    The same tables are in codeBlock_ProceduralShapes.
+namespace {
+    const int sphereDi[6] = { 0, 1, 0, 0, 1, 1 };
+    const int sphereDj[6] = { 0, 1, 1, 1, 1, 2 };
+    const int torusDi[6] = { 1, 0, 0, 1, 1, 0 };    // Also the side of the cylinder
+    const int torusDj[6] = { 0, 1, 0, 0, 1, 1 };
+    const int bottomDi[6] = { 0, 1, 1, 0, 1, 0 };   // The rings of the cylinder's disks
+    const int topDi[6] = { 1, 0, 0, 1, 0, 1 };
+    const int discDj[6] = { 1, 1, 2, 1, 2, 2 };
+
+    void Set3(float* v, float x, float y, float z)
+    {
+        v[0] = x;
+        v[1] = y;
+        v[2] = z;
+    }
+}
+
+void GlGeomProcedural::SetUniformLocations(unsigned int shapeParamsLoc, unsigned int shapeRadiusLoc)
+{
+    shapeParamsLocation = shapeParamsLoc;
+    shapeRadiusLocation = shapeRadiusLoc;
+}
+
+void GlGeomProcedural::Draw(ShapeType type, int res0, int res1, int res2, float radius)
+{
+    if (emptyVAO == 0) {
+        glGenVertexArrays(1, &emptyVAO);
+    }
+    glBindVertexArray(emptyVAO);
+    glUniform4i(shapeParamsLocation, type, res0, res1, res2);
+    glUniform1f(shapeRadiusLocation, radius);
+}
+
+void GlGeomProcedural::RenderTriangles(ShapeType type, int res0, int res1, int res2, float radius, int numVertices)
+{
+    Draw(type, res0, res1, res2, radius);
+    glDrawArrays(GL_TRIANGLES, 0, numVertices);
+    glUniform4i(shapeParamsLocation, NotProcedural, 0, 0, 0);     // Back to using the vertex attributes
+}
+
+void GlGeomProcedural::RenderGrid(int meshRes, float halfWidth)
+{
+    Draw(Grid, meshRes, 0, 0, halfWidth);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 2 * (meshRes + 1), meshRes);
+    glUniform4i(shapeParamsLocation, NotProcedural, 0, 0, 0);
+}
+
+// The same arithmetic as the CalcVboAndEbo() routines, so the results are identical.
+void GlGeomProcedural::CalcVertex(ShapeType type, int res0, int res1, int res2, float radius,
+    int vertexID, int instanceID, float* pos, float* normal)
+{
+    int e = vertexID;
+    switch (type) {
+    case Sphere:
+    {
+        int perSlice = 6 * (res1 - 1);
+        int c = (e % perSlice) % 6;
+        int i = e / perSlice + sphereDi[c];
+        int j = (e % perSlice) / 6 + sphereDj[c];
+        if (j == 0 || j == res1) {
+            Set3(pos, -0.0f, (j == 0) ? -1.0f : 1.0f, -0.0f);   // South or north pole (x and z are -0.0, as in GlGeomSphere)
+        }
+        else {
+            const GlGeomTrigTable& sliceTrig = GlGeomTrigTable::GetCircle(res0);
+            const GlGeomTrigTable& stackTrig = GlGeomTrigTable::GetHalfCircle(res1);
+            float sinphi = stackTrig.Sin(j);
+            Set3(pos, -sliceTrig.Sin(i % res0)*sinphi, -stackTrig.Cos(j), -sliceTrig.Cos(i % res0)*sinphi);
+        }
+        Set3(normal, pos[0], pos[1], pos[2]);
+        break;
+    }
+    case Torus:
+    {
+        int c = e % 6;
+        int i = (e / (6 * res1) + torusDi[c]) % res0;
+        int j = ((e / 6) % res1 + torusDj[c]) % res1;
+        const GlGeomTrigTable& ringTrig = GlGeomTrigTable::GetCircle(res0);
+        const GlGeomTrigTable& sideTrig = GlGeomTrigTable::GetCircle(res1);
+        float ct = -ringTrig.Cos(i);
+        float st = -ringTrig.Sin(i);
+        float cphi = -sideTrig.Cos(j);
+        float sphi = -sideTrig.Sin(j);
+        Set3(pos, st * (1.0f + radius * cphi), radius * sphi, ct * (1.0f + radius * cphi));
+        Set3(normal, st * cphi, sphi, ct * cphi);
+        break;
+    }
+    case Cylinder:
+    {
+        const GlGeomTrigTable& sliceTrig = GlGeomTrigTable::GetCircle(res0);
+        int discSliceElts = 3 + 6 * (res2 - 1);
+        int discElts = res0 * discSliceElts;
+        if (e >= 2 * discElts) {
+            // The side
+            e -= 2 * discElts;
+            int c = e % 6;
+            int i = (e / (6 * res1) + torusDi[c]) % res0;
+            int j = (e / 6) % res1 + torusDj[c];
+            float tCoord = (float)j / (float)res1;
+            Set3(pos, -sliceTrig.Sin(i), -1.0f + 2.0f*tCoord, -sliceTrig.Cos(i));
+            Set3(normal, pos[0], 0.0f, pos[2]);
+            break;
+        }
+        // The bottom, then the top
+        bool top = (e >= discElts);
+        e -= top ? discElts : 0;
+        int i = e / discSliceElts;
+        int r = e % discSliceElts;
+        int ring;
+        if (r < 3) {
+            ring = (r == 0) ? 0 : 1;                // The triangle at the center
+            i += (r == (top ? 2 : 1)) ? 1 : 0;
+        }
+        else {
+            int c = (r - 3) % 6;
+            ring = (r - 3) / 6 + discDj[c];
+            i += top ? topDi[c] : bottomDi[c];
+        }
+        float y = top ? 1.0f : -1.0f;
+        if (ring == 0) {
+            Set3(pos, 0.0f, y, 0.0f);
+        }
+        else {
+            float rad = (float)ring / (float)res2;
+            Set3(pos, -sliceTrig.Sin(i % res0) * rad, y, -sliceTrig.Cos(i % res0) * rad);
+        }
+        Set3(normal, 0.0f, y, 0.0f);
+        break;
+    }
+    case Grid:
+    {
+        float step = 2.0f * radius / (float)res0;
+        Set3(pos, -radius + (float)(e / 2) * step, 0.0f, -radius + (float)(instanceID + e % 2) * step);
+        Set3(normal, 0.0f, 1.0f, 0.0f);
+        break;
+    }
+    default:
+        assert(false);
+    }
+}
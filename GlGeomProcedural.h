@@ -0,0 +1,70 @@
+/*
+* GlGeomProcedural.h - Version 1.0
+*
+* Renders spheres, tori, cylinders and flat grids with no vertex buffers at all.
+*   The vertex shader computes each vertex from gl_VertexID (and gl_InstanceID),
+*   given the type of the shape and its resolutions in a few uniforms.
+*   So remeshing costs nothing: a new resolution is just new uniform values.
+*
+*   Vertex number e of the draw call is the vertex of element e of the EBO
+*   written by the shape's CalcVboAndEbo().  So the triangles are the same,
+*   in the same order, and the two kinds of rendering can be compared.
+*   CalcVertex() computes the same vertices on the CPU, for checking.
+*
+*   The shader code is the codeblock "codeBlock_ProceduralShapes" in
+*   SurfaceProj.glsl.  Positions and normals are computed, but not texture coordinates.
+*
+* Software is "as-is" and carries no warranty.  It may be used without
+*   restriction, but if you modify it, please change the filenames to
+*   prevent confusion between different versions.
+*/
+
+#pragma once
+#ifndef GLGEOM_PROCEDURAL_H
+#define GLGEOM_PROCEDURAL_H
+
+// GlGeomProcedural
+// How to use:
+//     * Compile the vertex shaders with the codeblock "codeBlock_ProceduralShapes".
+//     * Call SetUniformLocations() after each change of shader program.
+//     * Call SetEnabled(true).  Then GlGeomSphere, GlGeomTorus and GlGeomCylinder
+//       render procedurally in Render(), and never load their VBO's and EBO's.
+//       (RenderInstanced() and the partial renders still use the buffers.)
+
+class GlGeomProcedural
+{
+public:
+    // The shape types, as in the uniform shapeParams.x.  NotProcedural uses the vertex attributes instead.
+    enum ShapeType { NotProcedural = -1, Sphere = 0, Torus = 1, Cylinder = 2, Grid = 3 };
+
+    static void SetEnabled(bool enabled) { isEnabled = enabled; }
+    static bool IsEnabled() { return isEnabled; }
+
+    // The locations of the uniforms "shapeParams" (an ivec4) and "shapeRadius" (a float)
+    //    in the current shader program.
+    static void SetUniformLocations(unsigned int shapeParamsLoc, unsigned int shapeRadiusLoc);
+
+    // Renders numVertices vertices (the number of elements of the shape's EBO) as GL_TRIANGLES.
+    //    The resolutions are (slices, stacks) for a sphere, (rings, sides) for a torus,
+    //    and (slices, stacks, rings) for a cylinder.  radius is the minor radius of a torus.
+    static void RenderTriangles(ShapeType type, int res0, int res1, int res2, float radius, int numVertices);
+
+    // Renders a square grid in the xz-plane, from -halfWidth to halfWidth, with meshRes
+    //    squares along each side: one triangle strip per row, as instances.
+    //    The vertices are as in the floor of MySurfaces.cpp.
+    static void RenderGrid(int meshRes, float halfWidth);
+
+    // Computes vertex vertexID of instance instanceID, as the vertex shader does.
+    static void CalcVertex(ShapeType type, int res0, int res1, int res2, float radius,
+        int vertexID, int instanceID, float* pos, float* normal);
+
+private:
+    static void Draw(ShapeType type, int res0, int res1, int res2, float radius);
+
+    static bool isEnabled;
+    static unsigned int shapeParamsLocation;
+    static unsigned int shapeRadiusLocation;
+    static unsigned int emptyVAO;       // A VAO with no attributes (core profile needs a VAO bound)
+};
+
+#endif  // GLGEOM_PROCEDURAL_H
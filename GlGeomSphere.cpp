@@ -29,6 +29,10 @@
 #include "assert.h"
 
 #include "GlGeomSphere.h"
+#include "GlGeomLayout.h"
+#include "GlGeomProcedural.h"
+#include "GlGeomTrigTable.h"
+#include "ParallelFor.h"
 
 void GlGeomSphere::Remesh(int slices, int stacks)
 {
@@ -36,8 +40,8 @@ void GlGeomSphere::Remesh(int slices, int stacks)
         return;
     }
 
-    numSlices = ClampRange(slices, 3, 255);
-    numStacks = ClampRange(stacks, 3, 255);
+    numSlices = ClampRange(slices, 3, MaxChunkedRes);     // Large spheres are loaded in chunks
+    numStacks = ClampRange(stacks, 3, MaxChunkedRes);
 
     VboEboLoaded = false;
 }
@@ -49,73 +53,109 @@ void GlGeomSphere::CalcVboAndEbo(float* VBOdataBuffer, unsigned int* EBOdataBuff
     int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride)
 {
     assert(vertPosOffset >= 0 && stride>0);
-    bool calcNormals = (vertNormalOffset >= 0);       // Should normals be calculated?
     bool calcTexCoords = (vertTexCoordsOffset >= 0);  // Should texture coordinates be calculated?
 
-     for (int i = 0; i <= numSlices; i++) {
-        // Handle a slice of vertices.
-        // theta measures from the (negative-z)-axis, going counterclockwise viewed from above.
-        float theta = ((float)(i%numSlices))*(float)PI2 / (float)(numSlices);
-        float sTexCd = ((float)i) / (float)numSlices;     // s texture coordinate
-        float costheta = cos(theta);
-        float sintheta = sinf(theta);
-        for (int j = 0; j <= numStacks; j++) {
-            unsigned int vertNumber;
-            if (!GetVertexNumber(i, j, calcTexCoords, &vertNumber)) {
-                continue;       // North or South pole -- duplicate not needed
-            }
-            // phi measures from the (postive-y)-axis
-            float tTexCd = ((float)j) / (float)(numStacks); // t texture coordinate
-            float phi = tTexCd * (float)PI;
-            float cosphi = cosf(phi);
-            float sinphi = (j < numStacks) ? sinf(phi) : 0.0f;
-            float x = -sintheta*sinphi;       // Position, x coordinate            
-            float y = -cosphi;                // Position, y coordinate
-            float z = -costheta*sinphi;       // Position, z coordinate
-            float* basePtr = VBOdataBuffer + stride*vertNumber;
-            float* vPtr = basePtr + vertPosOffset;
-            *vPtr = x;
-            *(vPtr + 1) = y;
-            *(vPtr + 2) = z;
-            if (calcNormals) {
-                float* nPtr = basePtr + vertNormalOffset;
-                *nPtr = x;
-                *(nPtr + 1) = y;
-                *(nPtr + 2) = z;
+    // Without texture coordinates, the last slice (i==numSlices) would be a duplicate of the first.
+    int lastSlice = calcTexCoords ? numSlices : numSlices - 1;
+    CalcSliceVerts(VBOdataBuffer, 0, lastSlice, vertPosOffset, vertNormalOffset, vertTexCoordsOffset, stride);
+    CalcSliceElts(EBOdataBuffer, 0, numSlices, !calcTexCoords, 0);
+}
+
+// A chunk holds the slices unitStart,...,unitEnd-1 (see GlGeomBase.h).
+//    Its vertices are the two poles and the slices unitStart,...,unitEnd,
+//    including the slice unitEnd even when there are no texture coordinates.
+void GlGeomSphere::GetChunkSize(int unitStart, int unitEnd, bool /*calcTexCoords*/, int* numVerts, int* numElts) const
+{
+    *numVerts = 2 + (unitEnd - unitStart + 1) * (numStacks - 1);
+    *numElts = (unitEnd - unitStart) * GetNumElementsInSlice();
+}
+
+void GlGeomSphere::CalcChunk(int unitStart, int unitEnd, float* VBOdataBuffer, unsigned int* EBOdataBuffer,
+    int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride)
+{
+    CalcSliceVerts(VBOdataBuffer, unitStart, unitEnd, vertPosOffset, vertNormalOffset, vertTexCoordsOffset, stride);
+    CalcSliceElts(EBOdataBuffer, unitStart, unitEnd, false, unitStart);
+}
+
+// Writes the vertices of the south and north poles, then of the slices firstSlice,...,lastSlice.
+void GlGeomSphere::CalcSliceVerts(float* VBOdataBuffer, int firstSlice, int lastSlice,
+    int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride)
+{
+    // The sines and cosines of theta and phi come from tables shared by all slices (see GlGeomTrigTable.h).
+    //   phi measures from the (postive-y)-axis
+    const GlGeomTrigTable& sliceTrig = GlGeomTrigTable::GetCircle(numSlices);
+    const GlGeomTrigTable& stackTrig = GlGeomTrigTable::GetHalfCircle(numStacks);
+
+    // The vertices are written strictly in order (see GetVertexNumber), since
+    //   VBOdataBuffer is usually mapped GPU memory, where scattered writes are slow:
+    //   first the south and north poles, then each slice from south to north.
+    // The layout is fixed at compile time (see GlGeomLayout.h), so the inner loop has no branches.
+    // Large meshes are split into ranges of slices, which are generated in parallel.
+    int vertsPerSlice = numStacks - 1;
+    int minSlicesPerTask = 1 + MinVertsPerTask / vertsPerSlice;
+    GlGeomDispatchLayout(vertPosOffset, vertNormalOffset, vertTexCoordsOffset, stride, [&](auto layout) {
+        auto putVertex = [&](float*& basePtr, float x, float y, float z, float s, float t) {
+            layout.SetPos(basePtr, x, y, z);
+            layout.SetNormal(basePtr, x, y, z);
+            layout.SetTexCoords(basePtr, s, t);
+            basePtr += layout.Stride();
+        };
+        // x and z are -0.0 at the poles, as computed by -sin(theta)*sin(phi) and -cos(theta)*sin(phi).
+        float* polesPtr = VBOdataBuffer;
+        putVertex(polesPtr, -0.0f, -1.0f, -0.0f, 0.5f, 0.0f);   // South pole (s=0.5 at the poles)
+        putVertex(polesPtr, -0.0f, 1.0f, -0.0f, 0.5f, 1.0f);    // North pole
+
+        ParallelFor(firstSlice, lastSlice + 1, minSlicesPerTask, [&](int sliceStart, int sliceEnd) {
+            float* basePtr = polesPtr + (sliceStart - firstSlice) * vertsPerSlice * layout.Stride();
+            for (int i = sliceStart; i < sliceEnd; i++) {
+                // Handle a slice of vertices.
+                // theta measures from the (negative-z)-axis, going counterclockwise viewed from above.
+                float sTexCd = ((float)i) / (float)numSlices;     // s texture coordinate
+                float costheta = sliceTrig.Cos(i);
+                float sintheta = sliceTrig.Sin(i);
+                for (int j = 1; j < numStacks; j++) {
+                    float tTexCd = ((float)j) / (float)(numStacks);
+                    float sinphi = stackTrig.Sin(j);
+                    putVertex(basePtr, -sintheta*sinphi, -stackTrig.Cos(j), -costheta*sinphi, sTexCd, tTexCd);
+                }
             }
-            if (calcTexCoords) {
-                float* tcPtr = basePtr + vertTexCoordsOffset;
-                *tcPtr = (j != 0 && j != numStacks) ? sTexCd : 0.5f;  // s=0.5 at the poles
-                *(tcPtr + 1) = tTexCd;
+        });
+    });
+}
+
+// Calculate elements (vertex indices) suitable for putting into an EBO
+//      in GL_TRIANGLES mode, for the slices sliceStart,...,sliceEnd-1.
+//      Each slice has 6*(numStacks-1) elements.
+//   The vertices are numbered as written by CalcSliceVerts with first slice firstSlice.
+//   If wrapSeam is true, the last slice's right side uses the vertices of slice 0.
+void GlGeomSphere::CalcSliceElts(unsigned int* EBOdataBuffer, int sliceStart, int sliceEnd,
+    bool wrapSeam, int firstSlice)
+{
+    int minSlicesPerTask = 1 + MinVertsPerTask / (numStacks - 1);
+    ParallelFor(sliceStart, sliceEnd, minSlicesPerTask, [&](int rangeStart, int rangeEnd) {
+        unsigned int* toEbo = EBOdataBuffer + GetNumElementsInSlice() * (rangeStart - sliceStart);
+        for (int i = rangeStart - firstSlice; i < rangeEnd - firstSlice; i++) {
+            // Handle a slice of vertices.
+            unsigned int leftIdxOld, rightIdxOld;
+            GetVertexNumber(i, 0, !wrapSeam, &leftIdxOld);
+            GetVertexNumber(i + 1, 1, !wrapSeam, &rightIdxOld);
+            for (int j = 0; j < numStacks-1; j++) {
+                unsigned int leftIdxNew, rightIdxNew;
+                GetVertexNumber(i, j + 1, !wrapSeam, &leftIdxNew);
+                GetVertexNumber(i + 1, j + 2, !wrapSeam, &rightIdxNew);
+                *(toEbo++) = leftIdxOld;
+                *(toEbo++) = rightIdxOld;
+                *(toEbo++) = leftIdxNew;
+
+                *(toEbo++) = leftIdxNew;
+                *(toEbo++) = rightIdxOld;
+                *(toEbo++) = rightIdxNew;
+
+                leftIdxOld = leftIdxNew;
+                rightIdxOld = rightIdxNew;
             }
         }
-     }
-     
-     // Calculate elements (vertex indices) suitable for putting into an EBO
-     //      in GL_TRIANGLES mode.
-     unsigned int* toEbo = EBOdataBuffer;
-     for (int i = 0; i < numSlices; i++) {
-         // Handle a slice of vertices.
-         unsigned int leftIdxOld, rightIdxOld;
-         GetVertexNumber(i, 0, calcTexCoords, &leftIdxOld);
-         GetVertexNumber(i + 1, 1, calcTexCoords, &rightIdxOld);
-         for (int j = 0; j < numStacks-1; j++) {
-             unsigned int leftIdxNew, rightIdxNew;
-             GetVertexNumber(i, j + 1, calcTexCoords, &leftIdxNew);
-             GetVertexNumber(i + 1, j + 2, calcTexCoords, &rightIdxNew);
-             *(toEbo++) = leftIdxOld;
-             *(toEbo++) = rightIdxOld;
-             *(toEbo++) = leftIdxNew;
-
-             *(toEbo++) = leftIdxNew;
-             *(toEbo++) = rightIdxOld;
-             *(toEbo++) = rightIdxNew;
-
-             leftIdxOld = leftIdxNew;
-             rightIdxOld = rightIdxNew;
-         }
-     }
-     assert(toEbo - EBOdataBuffer == GetNumElements());
+    });
 }
 
 // Calculate the vertex number for the vertex on slice i and stack j.
@@ -156,9 +196,14 @@ void GlGeomSphere::PreRender() {
 // **********************************************
 // This routine does the rendering.
 // If the sphere's VBO and EBO data need to be calculated, it does this first.
+//   Procedural rendering (see GlGeomProcedural.h) needs no VBO or EBO.
 // **********************************************
 void GlGeomSphere::Render()
 {
+    if (GlGeomProcedural::IsEnabled()) {
+        GlGeomProcedural::RenderTriangles(GlGeomProcedural::Sphere, numSlices, numStacks, 0, 0.0f, GetNumElements());
+        return;
+    }
     PreRender();
     GlGeomBase::Render();
 }
@@ -55,6 +55,7 @@ public:
     // Can be called either before or after InitializeAttribLocations(), but it is
     //    more efficient if Remesh() is called first, or if the constructor sets the mesh resolution.
     void Remesh(int slices, int stacks);
+    bool NeedsReload() const { return !VboEboLoaded; }
 
     // Allocate the VAO, VBO, and EBO.
     // Set up info about the Vertex Attribute Locations
@@ -99,6 +100,12 @@ public:
         int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset,
         unsigned int stride);
 
+    // Large spheres are loaded in chunks of slices.  See GlGeomBase.h.
+    int GetNumChunkUnits() const { return numSlices; }
+    void GetChunkSize(int unitStart, int unitEnd, bool calcTexCoords, int* numVerts, int* numElts) const;
+    void CalcChunk(int unitStart, int unitEnd, float* VBOdataBuffer, unsigned int* EBOdataBuffer,
+        int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride);
+
 private:
 
 	// Disable all copy and assignment operators.
@@ -118,6 +125,9 @@ private:
 
 private:
     bool GetVertexNumber(int i, int j, bool calcTexCoords, unsigned int* retVertNum);
+    void CalcSliceVerts(float* VBOdataBuffer, int firstSlice, int lastSlice,
+        int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride);
+    void CalcSliceElts(unsigned int* EBOdataBuffer, int sliceStart, int sliceEnd, bool wrapSeam, int firstSlice);
     void PreRender();
 };
 
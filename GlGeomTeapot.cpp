@@ -23,8 +23,6 @@
 
 #include "GlGeomTeapot.h"
 
-double* GlGeomTeapot::teapotControlPts = 0;  // Stores the entire set of Bezier patch control points
-
 // The data arrays below are from fg_teaput_data.h (Freeglut-3.2.1)
 
 /*
@@ -34,7 +32,7 @@ double* GlGeomTeapot::teapotControlPts = 0;  // Stores the entire set of Bezier
  * to have consistent outward face directions.
  */
 #define GLUT_TEAPOT_N_INPUT_PATCHES 10
-static int patchdata_teapot[GLUT_TEAPOT_N_INPUT_PATCHES][16] =
+static constexpr int patchdata_teapot[GLUT_TEAPOT_N_INPUT_PATCHES][16] =
 {
     {  0,   1,   2,   3,   4,   5,   6,   7,   8,   9,  10,  11,  12,  13,  14,  15, }, /* rim    */
     { 12,  13,  14,  15,  16,  17,  18,  19,  20,  21,  22,  23,  24,  25,  26,  27, }, /* body   */
@@ -53,7 +51,7 @@ static int patchdata_teapot[GLUT_TEAPOT_N_INPUT_PATCHES][16] =
 //     Second: Out the side (would be expected to be "x")
 //     Third: Central axis (would be expected to be "y")
 // The code permutes the teapot axes so that "y" is up, and "z" is the spout direction.
-static float cpdata_teapot[][3] =
+static constexpr float cpdata_teapot[][3] =
 {
     { 1.40000f,  0.00000f,  2.40000f}, { 1.40000f, -0.78400f,  2.40000f},
     { 0.78400f, -1.40000f,  2.40000f}, { 0.00000f, -1.40000f,  2.40000f},
@@ -123,27 +121,16 @@ static float cpdata_teapot[][3] =
 };
 
 
-void GlGeomTeapot::InitializeAttribLocations(
-    unsigned int pos_loc, unsigned int normal_loc, unsigned int texcoords_loc)
-{
-    // Load vertices into the GlGeomBezier if not already done.
-    if (teapotControlPts == 0) {
-        LoadTeapotControlPoints();
-    }
-    GlGeomBezier::InitializeAttribLocations(pos_loc, normal_loc, texcoords_loc);
-}
-
-void GlGeomTeapot::LoadTeapotControlPoints() {
-    CalcTeapotControlPoints();
-    GlGeomBezier::LoadControlPts(4, 4, 3, 32, teapotControlPts);
-}
+// The control points for all 32 patches, with the axes permuted as above.
+//   They are computed at compile time by CalcTeapotControlPoints(),
+//   so there is no allocation and no computation at startup.
+struct TeapotControlPoints {
+    double pts[4 * 4 * 3 * 32];     // Control points for 32 patches
+};
 
-void GlGeomTeapot::CalcTeapotControlPoints() {
-    if (teapotControlPts != 0) {
-        return;
-    }
-    teapotControlPts = new double[4 * 4 * 3 * 32 * 4];    // Control points for 32 patches
-    double* toPtr = teapotControlPts;
+static constexpr TeapotControlPoints CalcTeapotControlPoints() {
+    TeapotControlPoints ret = {};
+    double* toPtr = ret.pts;
 
     // Calculate 24 patches from the the six patches with 4-fold rotational symmetry
     for (int i = 0; i < 6; i++) {
@@ -189,4 +176,21 @@ void GlGeomTeapot::CalcTeapotControlPoints() {
             *(toPtr++) = cpdata_teapot[index][0]; 
         }
     }
+    return ret;
+}
+
+static constexpr TeapotControlPoints teapotControlPts = CalcTeapotControlPoints();
+
+void GlGeomTeapot::InitializeAttribLocations(
+    unsigned int pos_loc, unsigned int normal_loc, unsigned int texcoords_loc)
+{
+    // Load vertices into the GlGeomBezier if not already done.
+    if (GetNumPatches() == 0) {
+        LoadTeapotControlPoints();
+    }
+    GlGeomBezier::InitializeAttribLocations(pos_loc, normal_loc, texcoords_loc);
+}
+
+void GlGeomTeapot::LoadTeapotControlPoints() {
+    GlGeomBezier::LoadControlPts(4, 4, 3, 32, teapotControlPts.pts);
 }
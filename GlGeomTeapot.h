@@ -90,9 +90,6 @@ public:
 
 private:
     void LoadTeapotControlPoints();
-    void CalcTeapotControlPoints();
-
-    static double* teapotControlPts;
 
 };
 
@@ -102,7 +99,7 @@ inline GlGeomTeapot::GlGeomTeapot(int uMeshResolution, int vMeshResolution)
 }
 
 
-inline GlGeomTeapot::~GlGeomTeapot() { delete teapotControlPts; }
+inline GlGeomTeapot::~GlGeomTeapot() {}
 
 #endif // GLGEOM_TEAPOT_H
 
@@ -28,6 +28,10 @@
 #include <C:/GLFW/glfw3.h>
 
 #include "GlGeomTorus.h"
+#include "GlGeomLayout.h"
+#include "GlGeomProcedural.h"
+#include "GlGeomTrigTable.h"
+#include "ParallelFor.h"
 #include "MathMisc.h"
 #include "assert.h"
 
@@ -37,8 +41,8 @@ void GlGeomTorus::Remesh(int rings, int sides, float minorRadius)
     if (sides == numSides && rings == numRings && minorRadius == radius) {
         return;
     }
-    numSides = ClampRange(sides, 3, 255);
-    numRings = ClampRange(rings, 3, 255);
+    numSides = ClampRange(sides, 3, MaxChunkedRes);   // Large tori are loaded in chunks
+    numRings = ClampRange(rings, 3, MaxChunkedRes);
     radius = minorRadius;           // Should be between 0.0 and 1.0
 
     VboEboLoaded = false;
@@ -49,65 +53,99 @@ void GlGeomTorus::CalcVboAndEbo(float* VBOdataBuffer, unsigned int* EBOdataBuffe
     int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride)
 {
     assert(vertPosOffset >= 0 && stride > 0);
-    bool calcNormals = (vertNormalOffset >= 0);       // Should normals be calculated?
     bool calcTexCoords = (vertTexCoordsOffset >= 0);  // Should texture coordinates be calculated?
 
+    // Without texture coordinates, the last ring (i==numRings) would be a duplicate of the first.
+    int stopRings = calcTexCoords ? numRings : numRings - 1;
+    CalcRingVerts(VBOdataBuffer, 0, stopRings, vertPosOffset, vertNormalOffset, vertTexCoordsOffset, stride);
+    CalcRingElts(EBOdataBuffer, 0, numRings, calcTexCoords, !calcTexCoords, 0);
+}
+
+// A chunk holds the rings unitStart,...,unitEnd-1 (see GlGeomBase.h).
+//    Its vertices are those of the rings unitStart,...,unitEnd, including
+//    the ring unitEnd even when there are no texture coordinates.
+void GlGeomTorus::GetChunkSize(int unitStart, int unitEnd, bool calcTexCoords, int* numVerts, int* numElts) const
+{
+    int vertsPerRing = calcTexCoords ? numSides + 1 : numSides;
+    *numVerts = (unitEnd - unitStart + 1) * vertsPerRing;
+    *numElts = (unitEnd - unitStart) * GetNumElementsPerRing();
+}
+
+void GlGeomTorus::CalcChunk(int unitStart, int unitEnd, float* VBOdataBuffer, unsigned int* EBOdataBuffer,
+    int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride)
+{
+    bool calcTexCoords = (vertTexCoordsOffset >= 0);
+    CalcRingVerts(VBOdataBuffer, unitStart, unitEnd, vertPosOffset, vertNormalOffset, vertTexCoordsOffset, stride);
+    CalcRingElts(EBOdataBuffer, unitStart, unitEnd, calcTexCoords, false, unitStart);
+}
+
+// Writes the vertices of the rings firstRing,...,lastRing.
+void GlGeomTorus::CalcRingVerts(float* VBOdataBuffer, int firstRing, int lastRing,
+    int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride)
+{
+    bool calcTexCoords = (vertTexCoordsOffset >= 0);
+
+    // The sines and cosines of theta and phi come from tables shared by all rings (see GlGeomTrigTable.h).
+    //   phi measures from the inner seam, going under, around and over, back to the inner seam.
+    int stopSides = calcTexCoords ? numSides : numSides - 1;
+    const GlGeomTrigTable& ringTrig = GlGeomTrigTable::GetCircle(numRings);
+    const GlGeomTrigTable& sideTrig = GlGeomTrigTable::GetCircle(numSides);
+
     // VBO Data is laid out: Around each ring. Starting with ring at x==0 and z<0.
     //          Each ring starts at the innermost seam of the torus (nearest to the y-axis).
-    float* toPtr = VBOdataBuffer;
-
-    // Outermost loop over the rings
-    int stopRings = calcTexCoords ? numRings : numRings-1;
-    for (int i = 0; i <= stopRings; i++) {
-        // Handle a ring of vertices.
-        // theta measures from the negative z-axis, counterclockwise viewed from above.
-        float sCoord = ((float)(i)) / (float)(numRings);
-        float theta = (float)PI2 * ((float)(i % numRings)) / (float)(numRings);
-        float c = -cosf(theta);      // Negated values (start at negative z-axis)
-        float s = -sinf(theta);
-        int stopSides = calcTexCoords ? numSides : numSides - 1;
-        for (int j = 0; j <= stopSides; j++, toPtr += stride) {
-            // phi measures from the inner seam, going under, around and over, back to the inner seam.
-            float tCoord = ((float)(j)) / (float)(numSides);
-            float phi = (float)PI2 * ((float)(j % numSides)) / (float)(numSides);
-            float cphi = -cosf(phi);      // Negated value (start at inner seam)
-            float sphi = -sinf(phi);       // Negated, start downward (-y)
-            float* posPtr = toPtr;
-            *(posPtr++) = s * (1.0f + radius * cphi);    // x coordinate
-            *(posPtr++) = radius * sphi;                  // y coordinate
-            *posPtr = c * (1.0f + radius * cphi);        // z coordinate
-            if (calcNormals) {
-                float* nPtr = toPtr + vertNormalOffset;
-                *(nPtr++) = s * cphi;           // Normal in x direction
-                *(nPtr++) = sphi;                  // Normal in y direction
-                *nPtr = c * cphi;               // Normal in z direction
-            }
-            if (calcTexCoords) {
-                float* tcPtr = toPtr + vertTexCoordsOffset;
-                *(tcPtr++) = sCoord;
-                *tcPtr = tCoord;
+    // The layout is fixed at compile time (see GlGeomLayout.h), so the inner loop has no branches.
+    // Large meshes are split into ranges of rings, which are generated in parallel.
+    int vertsPerRing = stopSides + 1;
+    int minRingsPerTask = 1 + MinVertsPerTask / vertsPerRing;
+    GlGeomDispatchLayout(vertPosOffset, vertNormalOffset, vertTexCoordsOffset, stride, [&](auto layout) {
+        // Outermost loop over the rings
+        ParallelFor(firstRing, lastRing + 1, minRingsPerTask, [&](int ringStart, int ringEnd) {
+            float* toPtr = VBOdataBuffer + (ringStart - firstRing) * vertsPerRing * layout.Stride();
+            for (int i = ringStart; i < ringEnd; i++) {
+                // Handle a ring of vertices.
+                // theta measures from the negative z-axis, counterclockwise viewed from above.
+                float sCoord = ((float)(i)) / (float)(numRings);
+                float c = -ringTrig.Cos(i);      // Negated values (start at negative z-axis)
+                float s = -ringTrig.Sin(i);
+                for (int j = 0; j <= stopSides; j++, toPtr += layout.Stride()) {
+                    float cphi = -sideTrig.Cos(j);      // Negated value (start at inner seam)
+                    float sphi = -sideTrig.Sin(j);      // Negated, start downward (-y)
+                    layout.SetPos(toPtr, s * (1.0f + radius * cphi), radius * sphi, c * (1.0f + radius * cphi));
+                    layout.SetNormal(toPtr, s * cphi, sphi, c * cphi);
+                    layout.SetTexCoords(toPtr, sCoord, ((float)(j)) / (float)(numSides));
+                }
             }
-        }
-    }
+        });
+    });
+}
 
-    // EBO data is also laid out in the same order, for GL_TRIANGLES
-    unsigned int* eboPtr = EBOdataBuffer;
+// EBO data is also laid out in the same order, for GL_TRIANGLES.  Each ring has 6*numSides elements.
+//   Writes the elements of the rings ringStart,...,ringEnd-1, numbering the vertices
+//   as written by CalcRingVerts with first ring firstRing.
+//   If wrapSeam is true, the last ring is joined to the vertices of ring 0.
+void GlGeomTorus::CalcRingElts(unsigned int* EBOdataBuffer, int ringStart, int ringEnd,
+    bool calcTexCoords, bool wrapSeam, int firstRing)
+{
     int ringDelta = calcTexCoords ? numSides + 1 : numSides;
-    for (int ii = 0; ii < numRings; ii++) {
-        int iii = calcTexCoords ? (ii + 1) : ((ii + 1) % numRings);
-        int leftR = ii * ringDelta;
-        int rightR = iii *ringDelta;
-        for (int j = 0; j < numSides; j++) {
-            int jj = calcTexCoords ? (j + 1) : ((j + 1) % numSides);
-            *(eboPtr++) = rightR + j;
-            *(eboPtr++) = leftR + jj;
-            *(eboPtr++) = leftR+j;
-
-            *(eboPtr++) = rightR + j;
-            *(eboPtr++) = rightR + jj;
-            *(eboPtr++) = leftR + jj;
+    int minRingsPerTask = 1 + MinVertsPerTask / ringDelta;
+    ParallelFor(ringStart, ringEnd, minRingsPerTask, [&](int rangeStart, int rangeEnd) {
+        unsigned int* eboPtr = EBOdataBuffer + 6 * numSides * (rangeStart - ringStart);
+        for (int ii = rangeStart - firstRing; ii < rangeEnd - firstRing; ii++) {
+            int iii = wrapSeam ? ((ii + 1) % numRings) : (ii + 1);
+            int leftR = ii * ringDelta;
+            int rightR = iii *ringDelta;
+            for (int j = 0; j < numSides; j++) {
+                int jj = calcTexCoords ? (j + 1) : ((j + 1) % numSides);
+                *(eboPtr++) = rightR + j;
+                *(eboPtr++) = leftR + jj;
+                *(eboPtr++) = leftR+j;
+
+                *(eboPtr++) = rightR + j;
+                *(eboPtr++) = rightR + jj;
+                *(eboPtr++) = leftR + jj;
+            }
         }
-    }
+    });
 }
 
 
@@ -139,6 +177,10 @@ void GlGeomTorus::PreRender()
 // Render entire torus as triangles
 void GlGeomTorus::Render()
 {
+    if (GlGeomProcedural::IsEnabled()) {       // No VBO or EBO needed (see GlGeomProcedural.h)
+        GlGeomProcedural::RenderTriangles(GlGeomProcedural::Torus, numRings, numSides, 0, radius, GetNumElements());
+        return;
+    }
     PreRender();
     GlGeomBase::Render();
 }
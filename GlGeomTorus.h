@@ -62,6 +62,7 @@ public:
     //    more efficient if Remesh() is called first, or if the constructor sets the mesh resolution.
     void Remesh(int rings, int sides) { Remesh(rings, sides, radius); }
     void Remesh(int rings, int sides, float minorRadius);
+    bool NeedsReload() const { return !VboEboLoaded; }
 
 	// Allocate the VAO, VBO, and EBO.
 	// Set up info about the Vertex Attribute Locations
@@ -102,6 +103,12 @@ public:
     void CalcVboAndEbo(float* VBOdataBuffer, unsigned int* EBOdataBuffer,
         int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset,
         unsigned int stride);
+
+    // Large tori are loaded in chunks of rings.  See GlGeomBase.h.
+    int GetNumChunkUnits() const { return numRings; }
+    void GetChunkSize(int unitStart, int unitEnd, bool calcTexCoords, int* numVerts, int* numElts) const;
+    void CalcChunk(int unitStart, int unitEnd, float* VBOdataBuffer, unsigned int* EBOdataBuffer,
+        int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride);
  
 private:
 
@@ -122,6 +129,10 @@ private:
 private: 
     bool VboEboLoaded = false;
 
+    void CalcRingVerts(float* VBOdataBuffer, int firstRing, int lastRing,
+        int vertPosOffset, int vertNormalOffset, int vertTexCoordsOffset, unsigned int stride);
+    void CalcRingElts(unsigned int* EBOdataBuffer, int ringStart, int ringEnd,
+        bool calcTexCoords, bool wrapSeam, int firstRing);
     void PreRender();
 };
 
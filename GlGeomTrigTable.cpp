@@ -0,0 +1,64 @@
+/*
+* GlGeomTrigTable.cpp - Version 1.0
+*
+* Tables of the sines and cosines of equally spaced angles.
+*   See GlGeomTrigTable.h for information on how to use it.
+*
+* Software is "as-is" and carries no warranty.  It may be used without
+*   restriction, but if you modify it, please change the filenames to
+*   prevent confusion between different versions.
+*/
+
+#include <math.h>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "MathMisc.h"
+#include "GlGeomTrigTable.h"
+
+namespace {
+    std::mutex tablesMutex;
+    std::map<int, std::unique_ptr<GlGeomTrigTable>> circleTables;       // Indexed by n
+    std::map<int, std::unique_ptr<GlGeomTrigTable>> halfCircleTables;
+}
+
+const GlGeomTrigTable& GlGeomTrigTable::GetCircle(int n)
+{
+    assert(n > 0);
+    std::lock_guard<std::mutex> lock(tablesMutex);
+    std::unique_ptr<GlGeomTrigTable>& table = circleTables[n];
+    if (!table) {
+        table.reset(new GlGeomTrigTable(n, false));
+    }
+    return *table;
+}
+
+const GlGeomTrigTable& GlGeomTrigTable::GetHalfCircle(int n)
+{
+    assert(n > 0);
+    std::lock_guard<std::mutex> lock(tablesMutex);
+    std::unique_ptr<GlGeomTrigTable>& table = halfCircleTables[n];
+    if (!table) {
+        table.reset(new GlGeomTrigTable(n, true));
+    }
+    return *table;
+}
+
+// The angles are computed in float arithmetic, in the same way the
+//    shapes computed them before the tables, so the meshes do not change.
+GlGeomTrigTable::GlGeomTrigTable(int n, bool halfCircle)
+    : cosines(n + 1), sines(n + 1)
+{
+    for (int k = 0; k <= n; k++) {
+        float angle;
+        if (halfCircle) {
+            angle = (((float)k) / (float)n) * (float)PI;
+        }
+        else {
+            angle = ((float)(k % n)) * (float)PI2 / (float)n;
+        }
+        cosines[k] = cosf(angle);
+        sines[k] = sinf(angle);
+    }
+}
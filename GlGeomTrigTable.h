@@ -0,0 +1,50 @@
+/*
+* GlGeomTrigTable.h - Version 1.0
+*
+* Tables of the sines and cosines of equally spaced angles, for the
+*   CalcVboAndEbo routines of the GlGeomShape classes.  A shape with n slices
+*   (or rings, or sides) uses the angles 2*pi*k/n, so the same table serves
+*   every slice, and every shape, with the same resolution.
+*
+*   The tables are computed the first time they are needed, and kept.
+*   GetCircle() and GetHalfCircle() may be called from any thread.
+*
+* Software is "as-is" and carries no warranty.  It may be used without
+*   restriction, but if you modify it, please change the filenames to
+*   prevent confusion between different versions.
+*/
+
+#pragma once
+#ifndef GLGEOM_TRIG_TABLE_H
+#define GLGEOM_TRIG_TABLE_H
+
+#include <assert.h>
+#include <vector>
+
+class GlGeomTrigTable
+{
+public:
+    // The angles 2*pi*k/n, for k = 0,1,...,n.  Entry n is exactly entry 0,
+    //    so the closing slice of a shape with texture coordinates can use it.
+    static const GlGeomTrigTable& GetCircle(int n);
+    // The angles pi*k/n, for k = 0,1,...,n.  (From the north pole to the south pole of a sphere.)
+    static const GlGeomTrigTable& GetHalfCircle(int n);
+
+    // Disable all copy and assignment operators.
+    GlGeomTrigTable(const GlGeomTrigTable&) = delete;
+    GlGeomTrigTable& operator=(const GlGeomTrigTable&) = delete;
+    GlGeomTrigTable(GlGeomTrigTable&&) = delete;
+    GlGeomTrigTable& operator=(GlGeomTrigTable&&) = delete;
+
+    int GetN() const { return (int)cosines.size() - 1; }
+    float Cos(int k) const { assert(k >= 0 && k <= GetN()); return cosines[k]; }
+    float Sin(int k) const { assert(k >= 0 && k <= GetN()); return sines[k]; }
+
+private:
+    GlGeomTrigTable(int n, bool halfCircle);
+
+    std::vector<float> cosines;
+    std::vector<float> sines;
+};
+
+#endif  // GLGEOM_TRIG_TABLE_H
@@ -45,6 +45,9 @@
 //     vertexshader
 //     fragmentshader
 //     geometryshader
+//     tesscontrolshader
+//     tessevaluationshader    (the tessellation shaders need OpenGL 4.0)
+//     computeshader           (needs OpenGL 4.3)
 //     codeblock    (a part of a shader)
 //  (Other types to be supported in the future.)
 //  <codeblockname> must a unique name for the shader (or block of code).
@@ -52,10 +55,12 @@
 
 // Names are not case sensitive
 std::vector<std::string> GlShaderMgr::shaderTypeName = {
-    "vertexshader", "fragmentshader", "geometryshader", "codeblock" };
+    "vertexshader", "fragmentshader", "geometryshader",
+    "tesscontrolshader", "tessevaluationshader", "computeshader", "codeblock" };
 
 std::vector<unsigned int> GlShaderMgr::openGLtypes = {
-    GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER };
+    GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER,
+    GL_TESS_CONTROL_SHADER, GL_TESS_EVALUATION_SHADER, GL_COMPUTE_SHADER };
 
 // Information about all the code blocks,
 //   plus information about the individual compiled shader programs.
@@ -110,7 +110,8 @@ public:
     static unsigned int check_ok_to_link(int numShaders, const unsigned int shaderList[]);
 
 protected:
-    enum ShaderType { vertex_shader, fragment_shader, geometry_shader, code_block };
+    enum ShaderType { vertex_shader, fragment_shader, geometry_shader,
+        tess_control_shader, tess_evaluation_shader, compute_shader, code_block };
     static std::vector<std::string> shaderTypeName;
     static std::vector<unsigned int> openGLtypes;
 
@@ -0,0 +1,122 @@
+/*
+* GlStreamBuffer.cpp - Version 1.0
+*
+* A triple-buffered, fence-synchronized buffer object for data which
+*   is rewritten every frame.  See GlStreamBuffer.h.
+*
+* Software is "as-is" and carries no warranty.  It may be used without
+*   restriction, but if you modify it, please change the filenames to
+*   prevent confusion between different versions.
+*/
+
+#include "GlStreamBuffer.h"
+#include <assert.h>
+
+// Use the static library (so glew32.dll is not needed):
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+bool GlStreamBuffer::PersistentMappingSupported()
+{
+    return GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+}
+
+void GlStreamBuffer::Allocate(unsigned int target, size_t regionBytes, size_t regionAlign, bool allowPersistent)
+{
+    assert((regionAlign & (regionAlign - 1)) == 0);
+    Free();
+    theTarget = target;
+    regionSize = regionBytes;
+    regionStride = (regionBytes + regionAlign - 1) & ~(regionAlign - 1);
+    GLsizeiptr totalBytes = (GLsizeiptr)(NumRegions * regionStride);
+
+    glGenBuffers(1, &theBuffer);
+    glBindBuffer(theTarget, theBuffer);
+    if (allowPersistent && PersistentMappingSupported()) {
+        // Immutable storage, mapped once for the lifetime of the buffer.
+        //    Coherent: the writes are seen by the GPU with no explicit flush.
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(theTarget, totalBytes, 0, flags);
+        persistentData = (char*)glMapBufferRange(theTarget, 0, totalBytes, flags);
+        assert(persistentData != 0);
+    }
+    else {
+        glBufferData(theTarget, totalBytes, 0, GL_STREAM_DRAW);
+    }
+    curRegion = NumRegions - 1;
+    numWaits = 0;
+}
+
+void GlStreamBuffer::Free()
+{
+    for (int i = 0; i < NumRegions; i++) {
+        if (fences[i] != 0) {
+            glDeleteSync((GLsync)fences[i]);
+            fences[i] = 0;
+        }
+    }
+    if (theBuffer != 0) {
+        if (persistentData != 0) {
+            glBindBuffer(theTarget, theBuffer);
+            glUnmapBuffer(theTarget);
+            persistentData = 0;
+        }
+        glDeleteBuffers(1, &theBuffer);
+        theBuffer = 0;
+    }
+}
+
+void* GlStreamBuffer::BeginWrite()
+{
+    assert(theBuffer != 0 && mappedRegion == 0);
+
+    // Everything issued so far may read the current region: fence it.
+    if (fences[curRegion] != 0) {
+        glDeleteSync((GLsync)fences[curRegion]);
+    }
+    fences[curRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    // Move to the next region, and wait until the GPU has finished with it.
+    //    It was fenced two frames ago, so this seldom waits.
+    curRegion = (curRegion + 1) % NumRegions;
+    GLsync fence = (GLsync)fences[curRegion];
+    if (fence != 0) {
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            numWaits++;
+            do {
+                status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);     // 1 millisecond
+            } while (status == GL_TIMEOUT_EXPIRED);
+        }
+        glDeleteSync(fence);
+        fences[curRegion] = 0;
+    }
+
+    if (persistentData != 0) {
+        mappedRegion = persistentData + GetRegionOffset();
+    }
+    else {
+        // The fence already guarantees the GPU is done: no need for the driver to synchronize.
+        glBindBuffer(theTarget, theBuffer);
+        mappedRegion = (char*)glMapBufferRange(theTarget, (GLintptr)GetRegionOffset(), (GLsizeiptr)regionSize,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        assert(mappedRegion != 0);
+    }
+    return mappedRegion;
+}
+
+void GlStreamBuffer::EndWrite()
+{
+    assert(mappedRegion != 0);
+    glBindBuffer(theTarget, theBuffer);
+    if (persistentData == 0) {
+        glUnmapBuffer(theTarget);
+    }
+    mappedRegion = 0;
+}
+
+GlStreamBuffer::~GlStreamBuffer()
+{
+    Free();
+}
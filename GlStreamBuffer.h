@@ -0,0 +1,84 @@
+/*
+* GlStreamBuffer.h - Version 1.0
+*
+* A buffer object for data which is rewritten every frame.
+*   The buffer holds three regions.  Each frame writes the next region,
+*   while the GPU may still be reading the regions of the previous two
+*   frames.  A fence (glFenceSync) is set each time a region is finished,
+*   and a region is rewritten only after its fence has signaled, so the
+*   CPU never writes data the GPU is still using, and (usually) never waits.
+*
+*   With OpenGL 4.4 (or ARB_buffer_storage), the buffer is mapped once,
+*   persistently and coherently, and written directly.  Otherwise, each
+*   region is mapped with glMapBufferRange, unsynchronized (the fences
+*   provide the synchronization) and invalidated, then unmapped.
+*
+* Software is "as-is" and carries no warranty.  It may be used without
+*   restriction, but if you modify it, please change the filenames to
+*   prevent confusion between different versions.
+*/
+
+#pragma once
+#ifndef GLSTREAM_BUFFER_H
+#define GLSTREAM_BUFFER_H
+
+#include <stddef.h>
+
+// GlStreamBuffer
+// How to use:
+//     * Call Allocate() once, and again if the size of the data grows.
+//     * Each frame, call BeginWrite(), write the data to the returned pointer,
+//       and call EndWrite().  Then issue the draw commands using the data,
+//       which starts at byte GetRegionOffset() of the buffer GetBuffer().
+//     * The next BeginWrite() fences all commands issued before it, so
+//       they may use the region until then.
+
+class GlStreamBuffer
+{
+public:
+    static const int NumRegions = 3;
+
+    GlStreamBuffer() {}
+    ~GlStreamBuffer();
+
+    // Disable all copy and assignment operators.
+    GlStreamBuffer(const GlStreamBuffer&) = delete;
+    GlStreamBuffer& operator=(const GlStreamBuffer&) = delete;
+    GlStreamBuffer(GlStreamBuffer&&) = delete;
+    GlStreamBuffer& operator=(GlStreamBuffer&&) = delete;
+
+    // Create (or re-create) the buffer, with regions of regionBytes each.
+    //   The regions start on multiples of regionAlign bytes (a power of two).
+    //   The buffer is left bound to target.
+    //   Set allowPersistent to false to use the glMapBufferRange version
+    //   even when persistent mapping is available.
+    void Allocate(unsigned int target, size_t regionBytes, size_t regionAlign = 256, bool allowPersistent = true);
+    void Free();
+
+    // Returns a pointer to the next region, waiting if the GPU still uses it.
+    //   At most GetRegionBytes() bytes may be written.
+    void* BeginWrite();
+    // Finishes the writes.  The buffer is left bound to its target.
+    void EndWrite();
+
+    unsigned int GetBuffer() const { return theBuffer; }
+    size_t GetRegionOffset() const { return (size_t)curRegion * regionStride; }   // Region of the last BeginWrite()
+    size_t GetRegionBytes() const { return regionSize; }
+    bool IsPersistent() const { return persistentData != 0; }
+    int GetNumWaits() const { return numWaits; }    // Times BeginWrite() had to wait for the GPU
+
+    static bool PersistentMappingSupported();
+
+private:
+    unsigned int theBuffer = 0;
+    unsigned int theTarget = 0;
+    size_t regionSize = 0;
+    size_t regionStride = 0;            // regionSize rounded up to the alignment
+    char* persistentData = 0;           // The persistently mapped buffer, or null
+    char* mappedRegion = 0;             // The region being written (between BeginWrite and EndWrite)
+    void* fences[NumRegions] = { 0, 0, 0 };     // GLsync objects, or null
+    int curRegion = NumRegions - 1;
+    int numWaits = 0;
+};
+
+#endif  // GLSTREAM_BUFFER_H
@@ -0,0 +1,1195 @@
+/*
+ *
+ * LinearBench.cpp, release 1.0.
+ *
+ * Timing benchmarks for the linear algebra classes.
+ *   This is a separate console program, with its own main().
+ *   It is not compiled as part of the MySurfaces program.
+ *   Each operation is reported in ns/op and in millions of operations per second.
+ *   The core operations are also checked against reference values; the program
+ *   prints every failed check and returns a nonzero exit code if any check fails.
+ *   Thus a change to the math library can be judged on both speed and correctness.
+ *
+ *   Usage:  LinearBench [-csv] [section ...]
+ *       The sections are: core mat4f affine arrays mat3arrays expr quat anim.  (Default: all of them.)
+ *       -csv prints the timings as comma separated values, tagged with the compiler
+ *       and the build options, so runs from different builds can be collected and compared.
+ *
+ *   Build it with optimization turned on, for instance:
+ *       g++ -O2 -DNDEBUG -std=c++14 LinearBench.cpp LinearR3.cpp LinearR4.cpp LinearR3Array.cpp Mat4f.cpp Quaternion.cpp TRSf.cpp AnimCurves.cpp -o LinearBench
+ *       cl /O2 /EHsc /DNDEBUG LinearBench.cpp LinearR3.cpp LinearR4.cpp LinearR3Array.cpp Mat4f.cpp Quaternion.cpp TRSf.cpp AnimCurves.cpp
+ *   Add -mavx2 (gcc/clang) or /arch:AVX2 (Visual Studio) to time the AVX code paths.
+ *   NDEBUG removes the asserts, some of which (e.g., in InverseRigid) cost more than the operation.
+ *
+ * Software is "as-is" and carries no warranty.  It may be used without
+ *   restriction, but if you modify it, please change the filenames to
+ *   prevent confusion between different versions.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+#include "LinearR3.h"
+#include "LinearR4.h"
+#include "LinearR3Array.h"
+#include "LinearExpr.h"
+#include "Mat4f.h"
+#include "Quaternion.h"
+#include "TRSf.h"
+#include "AnimCurves.h"
+
+// Results are accumulated here so the compiler cannot remove the work being timed.
+volatile double benchSink = 0.0;
+
+bool csvOutput = false;			// Print the timings as comma separated values
+char buildTag[128];				// Compiler and build options, set by SetBuildTag()
+int checksFailed = 0;
+int checksRun = 0;
+
+// Describes the compiler and the options that affect the timings.
+void SetBuildTag()
+{
+	char compiler[64];
+#if defined(__clang__)
+	sprintf( compiler, "clang %d.%d.%d", __clang_major__, __clang_minor__, __clang_patchlevel__ );
+#elif defined(__GNUC__)
+	sprintf( compiler, "gcc %d.%d.%d", __GNUC__, __GNUC_MINOR__, __GNUC_PATCHLEVEL__ );
+#elif defined(_MSC_VER)
+	sprintf( compiler, "Visual C++ %d", _MSC_VER );
+#else
+	sprintf( compiler, "unknown compiler" );
+#endif
+	// Visual C++ does not say whether it is optimizing; _DEBUG indicates a Debug configuration.
+#if defined(__OPTIMIZE_SIZE__)
+	const char* opt = "optimized for size";
+#elif defined(__OPTIMIZE__)
+	const char* opt = "optimized";
+#elif defined(_MSC_VER) && !defined(_DEBUG)
+	const char* opt = "release";
+#else
+	const char* opt = "NOT optimized";
+#endif
+#if defined(__AVX2__)
+	const char* simd = "AVX2";
+#elif defined(__AVX__)
+	const char* simd = "AVX";
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2)
+	const char* simd = "SSE2";
+#else
+	const char* simd = "no SIMD";
+#endif
+#if defined(__FMA__)
+	const char* fma = " FMA";
+#else
+	const char* fma = "";
+#endif
+#if defined(NDEBUG)
+	const char* asserts = "asserts off";
+#else
+	const char* asserts = "asserts ON";
+#endif
+	sprintf( buildTag, "%s, %s, %s%s, %s", compiler, opt, simd, fma, asserts );
+}
+
+// Run func() repeatedly for about a fifth of a second.
+//   Each call of func() performs opsPerCall operations.
+//   Prints and returns the time per operation in nanoseconds.
+template<class F> double TimeIt( const char* name, int opsPerCall, F func )
+{
+	typedef std::chrono::high_resolution_clock Clock;
+	func();									// Warm up the caches
+	long long calls = 0;
+	double seconds = 0.0;
+	Clock::time_point start = Clock::now();
+	while ( seconds < 0.2 ) {
+		for ( int i=0; i<16; i++ ) {
+			func();
+		}
+		calls += 16;
+		seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	}
+	double ns = 1.0e9*seconds/((double)calls*opsPerCall);
+	if ( csvOutput ) {
+		printf( "\"%s\",\"%s\",%.3f,%.0f\n", buildTag, name, ns, 1.0e9/ns );
+	}
+	else {
+		printf( "  %-52s %9.2f ns/op %9.1f Mop/s\n", name, ns, 1.0e3/ns );
+	}
+	return ns;
+}
+
+// Prints the title of a group of timings (not in CSV output).
+void Title( const char* title )
+{
+	if ( !csvOutput ) {
+		printf( "%s:\n", title );
+	}
+}
+
+// Records a check of a result against a reference value.
+//    Prints a message if the error is larger than the tolerance (or is a NaN).
+void Check( const char* what, double error, double tolerance )
+{
+	checksRun++;
+	if ( !(error <= tolerance) ) {
+		checksFailed++;
+		printf( "  CHECK FAILED: %s: error %g, tolerance %g\n", what, error, tolerance );
+	}
+}
+
+// The largest difference between entries of A and B
+double MaxEntryDiff( const Matrix3x3& A, const Matrix3x3& B )
+{
+	const double* a[9] = { &A.m11, &A.m12, &A.m13, &A.m21, &A.m22, &A.m23, &A.m31, &A.m32, &A.m33 };
+	const double* b[9] = { &B.m11, &B.m12, &B.m13, &B.m21, &B.m22, &B.m23, &B.m31, &B.m32, &B.m33 };
+	double maxDiff = 0.0;
+	for ( int k=0; k<9; k++ ) {
+		maxDiff = Max( maxDiff, fabs(*a[k] - *b[k]) );
+	}
+	return maxDiff;
+}
+
+// The (i,j) entry of A, for 1 <= i,j <= 4.  (The entries are stored column by column.)
+double Entry( const Matrix4x4& A, int i, int j )
+{
+	return (&A.m11)[4*(j-1)+(i-1)];
+}
+
+double MaxEntryDiff( const Matrix4x4& A, const Matrix4x4& B )
+{
+	double maxDiff = 0.0;
+	for ( int i=1; i<=4; i++ ) {
+		for ( int j=1; j<=4; j++ ) {
+			maxDiff = Max( maxDiff, fabs(Entry(A,i,j) - Entry(B,i,j)) );
+		}
+	}
+	return maxDiff;
+}
+
+double RandomUnit()
+{
+	return 2.0*((double)rand()/(double)RAND_MAX) - 1.0;
+}
+
+// A random affine matrix: a rotation, a scaling and a translation.
+LinearMapR4 RandomAffine()
+{
+	LinearMapR4 A;
+	A.Set_glTranslate( RandomUnit(), RandomUnit(), RandomUnit() );
+	A.Mult_glRotate( 3.0*RandomUnit(), RandomUnit(), RandomUnit(), 2.0+RandomUnit() );
+	A.Mult_glScale( 1.5+RandomUnit(), 1.5+RandomUnit(), 1.5+RandomUnit() );
+	return A;
+}
+
+const int NumMats = 1024;		// Matrices used per call; small enough to stay in the cache
+
+// ******************************************************
+// Core LinearR3/LinearR4 operations, with checks       *
+//    against reference values                          *
+// ******************************************************
+
+// The product A*B, computed entry by entry from the definition
+LinearMapR4 ReferenceProduct( const Matrix4x4& A, const Matrix4x4& B )
+{
+	LinearMapR4 P;
+	double* p = &P.m11;
+	for ( int i=1; i<=4; i++ ) {
+		for ( int j=1; j<=4; j++ ) {
+			double sum = 0.0;
+			for ( int k=1; k<=4; k++ ) {
+				sum += Entry(A,i,k)*Entry(B,k,j);
+			}
+			p[4*(j-1)+(i-1)] = sum;
+		}
+	}
+	return P;
+}
+
+// The rotation matrix for the given angle and unit axis, from Rodrigues' formula:
+//     R = cos*I + sin*[axis]x + (1-cos)*axis*axis^T
+LinearMapR3 ReferenceRotation( double theta, const VectorR3& u )
+{
+	double c = cos(theta);
+	double s = sin(theta);
+	double t = 1.0-c;
+	return LinearMapR3( t*u.x*u.x + c,     t*u.x*u.y + s*u.z, t*u.x*u.z - s*u.y,		// Column 1
+						t*u.x*u.y - s*u.z, t*u.y*u.y + c,     t*u.y*u.z + s*u.x,		// Column 2
+						t*u.x*u.z + s*u.y, t*u.y*u.z - s*u.x, t*u.z*u.z + c );			// Column 3
+}
+
+// The upper left 3x3 part of A
+LinearMapR3 Upper3x3( const Matrix4x4& A )
+{
+	return LinearMapR3( A.m11, A.m21, A.m31, A.m12, A.m22, A.m32, A.m13, A.m23, A.m33 );
+}
+
+// How far the columns of A are from being orthonormal
+double OrthonormalError( const LinearMapR3& A )
+{
+	return MaxEntryDiff( A.Transpose()*A, LinearMapR3(1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0) );
+}
+
+void BenchCore()
+{
+	Title( "Core LinearR3/LinearR4 operations" );
+	std::vector<LinearMapR4> mats(NumMats), projs(NumMats), out(NumMats);
+	std::vector<VectorR4> rhs(NumMats), sols(NumMats);
+	std::vector<VectorR3> vecs(NumMats), axes(NumMats), vecsOut(NumMats);
+	std::vector<LinearMapR3> rots(NumMats), rotsOut(NumMats);
+	std::vector<double> angles(NumMats);
+	for ( int i=0; i<NumMats; i++ ) {
+		mats[i] = RandomAffine();
+		projs[i].Set_gluPerspective( 0.5+0.2*RandomUnit(), 1.5, 0.1, 20.0 );
+		projs[i] *= mats[i];
+		rhs[i].Set( RandomUnit(), RandomUnit(), RandomUnit(), RandomUnit() );
+		vecs[i].Set( RandomUnit(), RandomUnit(), RandomUnit() );
+		axes[i].Set( RandomUnit(), RandomUnit(), 2.0+RandomUnit() );
+		axes[i].MakeUnit();
+		angles[i] = 3.0*RandomUnit();
+		// Rotations, perturbed so they are only nearly orthonormal (as after many products)
+		rots[i] = ReferenceRotation( angles[i], axes[i] );
+		rots[i].m12 += 1.0e-6*RandomUnit();
+		rots[i].m33 += 1.0e-6*RandomUnit();
+	}
+
+	// Reference values which are known exactly, or nearly so
+	LinearMapR4 R;
+	R.Set_glRotate( PIhalves, 0.0, 0.0, 1.0 );
+	Check( "glRotate by pi/2 around z maps x to y", Dist(R*VectorR4(1.0, 0.0, 0.0, 1.0), VectorR4(0.0, 1.0, 0.0, 1.0)), 1.0e-15 );
+	VectorR3 v( 1.0, 0.0, 0.0 );
+	v.Rotate( PIhalves, VectorR3(0.0, 0.0, 1.0) );
+	Check( "VectorR3::Rotate by pi/2 around z maps x to y", Dist(v, VectorR3(0.0, 1.0, 0.0)), 1.0e-15 );
+	LinearMapR4 S;
+	S.Set_glScale( 2.0, 3.0, 4.0 );
+	Check( "Determinant of glScale(2,3,4) is 24", fabs(S.Determinant() - 24.0), 0.0 );
+	S.Mult_glTranslate( 1.0, 2.0, 3.0 );
+	Check( "Inverse of glScale*glTranslate", MaxEntryDiff(S.Inverse()*S, Matrix4x4::Identity), 0.0 );
+
+	// Checks on the random matrices
+	double errProduct = 0.0, errProductProj = 0.0, errInverse = 0.0, errInverseProj = 0.0;
+	double errDet = 0.0, errSolve = 0.0, errReNormalize = 0.0, errRotate = 0.0;
+	double errGlRotate = 0.0, errMultGlRotate = 0.0, errRotateCosSin = 0.0;
+	for ( int i=0; i<NumMats; i++ ) {
+		int j = (i+1)%NumMats;
+		LinearMapR4 P = mats[i];
+		P *= mats[j];
+		errProduct = Max( errProduct, MaxEntryDiff(P, ReferenceProduct(mats[i], mats[j])) );
+		P = projs[i];
+		P *= projs[j];
+		errProductProj = Max( errProductProj, MaxEntryDiff(P, ReferenceProduct(projs[i], projs[j])) );
+		errInverse = Max( errInverse, MaxEntryDiff(mats[i].Inverse()*mats[i], Matrix4x4::Identity) );
+		errInverseProj = Max( errInverseProj, MaxEntryDiff(projs[i]*projs[i].Inverse(), Matrix4x4::Identity) );
+		double detProduct = (mats[i]*projs[j]).Determinant();
+		errDet = Max( errDet, fabs(detProduct - mats[i].Determinant()*projs[j].Determinant())/fabs(detProduct) );
+		errSolve = Max( errSolve, Dist(projs[i]*projs[i].Solve(rhs[i]), rhs[i]) );
+		LinearMapR3 rot = rots[i];
+		rot.ReNormalize();
+		errReNormalize = Max( errReNormalize, OrthonormalError(rot) );
+		VectorR3 u = vecs[i];
+		u.Rotate( angles[i], axes[i] );
+		errRotate = Max( errRotate, Dist(u, ReferenceRotation(angles[i], axes[i])*vecs[i]) );
+		R.Set_glRotate( angles[i], 3.0*axes[i] );		// The axis need not be a unit vector
+		errGlRotate = Max( errGlRotate, MaxEntryDiff(Upper3x3(R), ReferenceRotation(angles[i], axes[i])) );
+		P = mats[i];
+		P.Mult_glRotate( angles[i], axes[i] );
+		errMultGlRotate = Max( errMultGlRotate, MaxEntryDiff(P, ReferenceProduct(mats[i], R)) );
+		LinearMapR4 Rcs;
+		Rcs.Set_glRotate( cos(angles[i]), sin(angles[i]), 3.0*axes[i] );
+		errRotateCosSin = Max( errRotateCosSin, MaxEntryDiff(Rcs, R) );
+	}
+	Check( "Matrix4x4 *=, affine matrices", errProduct, 1.0e-14 );
+	Check( "Matrix4x4 *=, general matrices", errProductProj, 1.0e-13 );
+	Check( "LinearMapR4::Inverse, affine matrices", errInverse, 1.0e-13 );
+	Check( "LinearMapR4::Inverse, general matrices", errInverseProj, 1.0e-12 );
+	Check( "LinearMapR4::Determinant of a product (relative)", errDet, 1.0e-13 );
+	Check( "LinearMapR4::Solve residual", errSolve, 1.0e-12 );
+	Check( "Matrix3x3::ReNormalize", errReNormalize, 1.0e-11 );
+	Check( "VectorR3::Rotate", errRotate, 1.0e-14 );
+	Check( "LinearMapR4::Set_glRotate", errGlRotate, 1.0e-14 );
+	Check( "LinearMapR4::Mult_glRotate", errMultGlRotate, 1.0e-14 );
+	Check( "Set_glRotate(cos, sin, ...)", errRotateCosSin, 0.0 );
+
+	// Timings
+	TimeIt( "Matrix4x4 *=, affine matrices", NumMats, [&]() {
+		for ( int i=0; i<NumMats; i++ ) {
+			out[i] = mats[i];
+			out[i] *= mats[(i+1)&(NumMats-1)];
+		}
+		benchSink += out[7].m11;
+	} );
+	TimeIt( "Matrix4x4 *=, general matrices", NumMats, [&]() {
+		for ( int i=0; i<NumMats; i++ ) {
+			out[i] = projs[i];
+			out[i] *= projs[(i+1)&(NumMats-1)];
+		}
+		benchSink += out[7].m11;
+	} );
+	TimeIt( "LinearMapR4::Inverse, affine matrices", NumMats, [&]() {
+		for ( int i=0; i<NumMats; i++ ) {
+			out[i] = mats[i].Inverse();
+		}
+		benchSink += out[7].m11;
+	} );
+	TimeIt( "LinearMapR4::Inverse, general matrices", NumMats, [&]() {
+		for ( int i=0; i<NumMats; i++ ) {
+			out[i] = projs[i].Inverse();
+		}
+		benchSink += out[7].m11;
+	} );
+	TimeIt( "LinearMapR4::Determinant", NumMats, [&]() {
+		double sum = 0.0;
+		for ( int i=0; i<NumMats; i++ ) {
+			sum += projs[i].Determinant();
+		}
+		benchSink += sum;
+	} );
+	TimeIt( "LinearMapR4::Solve", NumMats, [&]() {
+		for ( int i=0; i<NumMats; i++ ) {
+			sols[i] = projs[i].Solve( rhs[i] );
+		}
+		benchSink += sols[7].x;
+	} );
+	TimeIt( "Matrix3x3::ReNormalize", NumMats, [&]() {
+		for ( int i=0; i<NumMats; i++ ) {
+			rotsOut[i] = rots[i];
+			rotsOut[i].ReNormalize();
+		}
+		benchSink += rotsOut[7].m11;
+	} );
+	TimeIt( "VectorR3::Rotate", NumMats, [&]() {
+		for ( int i=0; i<NumMats; i++ ) {
+			vecsOut[i] = vecs[i];
+			vecsOut[i].Rotate( angles[i], axes[i] );
+		}
+		benchSink += vecsOut[7].x;
+	} );
+	TimeIt( "LinearMapR4::Set_glRotate (radians)", NumMats, [&]() {
+		for ( int i=0; i<NumMats; i++ ) {
+			out[i].Set_glRotate( angles[i], axes[i] );
+		}
+		benchSink += out[7].m11;
+	} );
+	TimeIt( "LinearMapR4::Set_glRotate (cos, sin)", NumMats, [&]() {
+		for ( int i=0; i<NumMats; i++ ) {
+			out[i].Set_glRotate( 0.6, 0.8, axes[i] );
+		}
+		benchSink += out[7].m11;
+	} );
+	TimeIt( "LinearMapR4::Mult_glRotate (radians)", NumMats, [&]() {
+		for ( int i=0; i<NumMats; i++ ) {
+			out[i] = mats[i];
+			out[i].Mult_glRotate( angles[i], axes[i] );
+		}
+		benchSink += out[7].m11;
+	} );
+}
+
+// ******************************************************
+// Mat4f compared with LinearMapR4                      *
+// ******************************************************
+
+void BenchMat4f()
+{
+	Title( "Mat4f (float, SIMD) compared with LinearMapR4 (double)" );
+	std::vector<LinearMapR4> mats(NumMats);
+	std::vector<Mat4f> matsF(NumMats);
+	for ( int i=0; i<NumMats; i++ ) {
+		mats[i] = RandomAffine();
+		matsF[i].Set( mats[i] );
+	}
+
+	TimeIt( "LinearMapR4 product", NumMats, [&]() {
+		LinearMapR4 P = mats[0];
+		for ( int i=1; i<NumMats; i++ ) {
+			P = mats[i-1]*mats[i];
+			benchSink += P.m11;
+		}
+	} );
+	TimeIt( "Mat4f product", NumMats, [&]() {
+		for ( int i=1; i<NumMats; i++ ) {
+			Mat4f P = matsF[i-1]*matsF[i];
+			benchSink += P.m[0];
+		}
+	} );
+	TimeIt( "Mat4f affine product", NumMats, [&]() {
+		for ( int i=1; i<NumMats; i++ ) {
+			Mat4f P = matsF[i-1];
+			P.MultAffine( matsF[i] );
+			benchSink += P.m[0];
+		}
+	} );
+
+	// The typical modelview computation in MyRenderInitial()
+	float matEntries[16];
+	TimeIt( "LinearMapR4 translate/rotate/scale + DumpByColumns", NumMats, [&]() {
+		for ( int i=0; i<NumMats; i++ ) {
+			LinearMapR4 M = mats[i];
+			M.Mult_glTranslate( 0.0, 0.9, -0.3 );
+			M.Mult_glRotate( 0.01*i, 1.0, 1.0, 1.0 );
+			M.Mult_glScale( 0.4, 0.4, 0.4 );
+			M.DumpByColumns( matEntries );
+			benchSink += matEntries[5];
+		}
+	} );
+	TimeIt( "Mat4f translate/rotate/scale", NumMats, [&]() {
+		for ( int i=0; i<NumMats; i++ ) {
+			Mat4f M = matsF[i];
+			M.Mult_glTranslate( 0.0f, 0.9f, -0.3f );
+			M.Mult_glRotate( 0.01f*i, 1.0f, 1.0f, 1.0f );
+			M.Mult_glScale( 0.4f, 0.4f, 0.4f );
+			benchSink += M.Data()[5];
+		}
+	} );
+
+	TimeIt( "LinearMapR4::Inverse", NumMats, [&]() {
+		for ( int i=0; i<NumMats; i++ ) {
+			benchSink += mats[i].Inverse().m11;
+		}
+	} );
+	TimeIt( "Mat4f::Inverse", NumMats, [&]() {
+		for ( int i=0; i<NumMats; i++ ) {
+			benchSink += matsF[i].Inverse().m[0];
+		}
+	} );
+	TimeIt( "Mat4f::InverseAffine", NumMats, [&]() {
+		for ( int i=0; i<NumMats; i++ ) {
+			benchSink += matsF[i].InverseAffine().m[0];
+		}
+	} );
+
+	const int NumPts = 4096;
+	std::vector<float> pts(3*NumPts);
+	for ( int i=0; i<3*NumPts; i++ ) {
+		pts[i] = (float)RandomUnit();
+	}
+	std::vector<float> ptsOut(3*NumPts);
+	TimeIt( "LinearMapR4*VectorR4 (positions)", NumPts, [&]() {
+		for ( int i=0; i<NumPts; i++ ) {
+			VectorR4 v( pts[3*i], pts[3*i+1], pts[3*i+2], 1.0 );
+			VectorR4 w = mats[0]*v;
+			ptsOut[3*i] = (float)w.x;
+			ptsOut[3*i+1] = (float)w.y;
+			ptsOut[3*i+2] = (float)w.z;
+		}
+		benchSink += ptsOut[7];
+	} );
+	TimeIt( "Mat4f::TransformPositions", NumPts, [&]() {
+		matsF[0].TransformPositions( pts.data(), ptsOut.data(), NumPts );
+		benchSink += ptsOut[7];
+	} );
+}
+
+// ******************************************************
+// LinearMapR4 affine and rigid fast paths              *
+// ******************************************************
+
+void BenchAffine()
+{
+	Title( "LinearMapR4 general, affine and rigid matrices" );
+	std::vector<LinearMapR4> mats(NumMats), rigids(NumMats), projs(NumMats);
+	for ( int i=0; i<NumMats; i++ ) {
+		mats[i] = RandomAffine();
+		rigids[i].Set_glTranslate( RandomUnit(), RandomUnit(), RandomUnit() );
+		rigids[i].Mult_glRotate( 3.0*RandomUnit(), RandomUnit(), RandomUnit(), 2.0+RandomUnit() );
+		// A non-affine matrix: a perspective matrix times an affine matrix
+		projs[i].Set_gluPerspective( 0.5+0.2*RandomUnit(), 1.5, 0.1, 20.0 );
+		projs[i] *= mats[i];
+	}
+
+	TimeIt( "Matrix4x4 product, general (non-affine) matrices", NumMats, [&]() {
+		for ( int i=1; i<NumMats; i++ ) {
+			LinearMapR4 P = projs[i-1]*projs[i];
+			benchSink += P.m11;
+		}
+	} );
+	TimeIt( "Matrix4x4 product, affine matrices (3x4 product)", NumMats, [&]() {
+		for ( int i=1; i<NumMats; i++ ) {
+			LinearMapR4 P = mats[i-1]*mats[i];
+			benchSink += P.m11;
+		}
+	} );
+	TimeIt( "Mult_glRotate (3x3 product)", NumMats, [&]() {
+		for ( int i=0; i<NumMats; i++ ) {
+			LinearMapR4 P = mats[i];
+			P.Mult_glRotate( 0.01*i, 1.0, 1.0, 1.0 );
+			benchSink += P.m11;
+		}
+	} );
+	TimeIt( "LinearMapR4::Inverse, general (non-affine) matrices", NumMats, [&]() {
+		for ( int i=0; i<NumMats; i++ ) {
+			benchSink += projs[i].Inverse().m11;
+		}
+	} );
+	TimeIt( "LinearMapR4::Inverse, affine matrices", NumMats, [&]() {
+		for ( int i=0; i<NumMats; i++ ) {
+			benchSink += mats[i].Inverse().m11;
+		}
+	} );
+	TimeIt( "LinearMapR4::InverseRigid", NumMats, [&]() {
+		for ( int i=0; i<NumMats; i++ ) {
+			benchSink += rigids[i].InverseRigid().m11;
+		}
+	} );
+}
+
+// ******************************************************
+// VectorR3Array batched operations compared with       *
+//    one VectorR3 at a time                            *
+// ******************************************************
+
+void BenchVectorArrays()
+{
+#if LINEAR_ARRAY_USE_AVX2
+	Title( "VectorR3Array (AVX2) compared with VectorR3" );
+#else
+	Title( "VectorR3Array (scalar) compared with VectorR3" );
+#endif
+	const int NumVecs = 16384;
+	LinearMapR4 A = RandomAffine();
+	std::vector<VectorR3> vecs(NumVecs), vecsOut(NumVecs), vecs2(NumVecs);
+	VectorR3Array arr(NumVecs), arr2(NumVecs), arrOut;
+	for ( int i=0; i<NumVecs; i++ ) {
+		vecs[i].Set( RandomUnit(), RandomUnit(), RandomUnit() );
+		vecs2[i].Set( RandomUnit(), RandomUnit(), RandomUnit() );
+		arr.Set( i, vecs[i] );
+		arr2.Set( i, vecs2[i] );
+	}
+	std::vector<double> dots(arr.PaddedSize());
+
+	TimeIt( "LinearMapR4::AffineTransformPosition", NumVecs, [&]() {
+		for ( int i=0; i<NumVecs; i++ ) {
+			vecsOut[i] = vecs[i];
+			A.AffineTransformPosition( vecsOut[i] );
+		}
+		benchSink += vecsOut[7].x;
+	} );
+	TimeIt( "AffineTransformPositions (array)", NumVecs, [&]() {
+		AffineTransformPositions( A, arr, arrOut );
+		benchSink += arrOut.X()[7];
+	} );
+	TimeIt( "VectorR3 dot product", NumVecs, [&]() {
+		for ( int i=0; i<NumVecs; i++ ) {
+			dots[i] = vecs[i]^vecs2[i];
+		}
+		benchSink += dots[7];
+	} );
+	TimeIt( "Dot (array)", NumVecs, [&]() {
+		Dot( arr, arr2, dots.data() );
+		benchSink += dots[7];
+	} );
+	TimeIt( "VectorR3 cross product", NumVecs, [&]() {
+		for ( int i=0; i<NumVecs; i++ ) {
+			vecsOut[i] = vecs[i]*vecs2[i];
+		}
+		benchSink += vecsOut[7].x;
+	} );
+	TimeIt( "Cross (array)", NumVecs, [&]() {
+		Cross( arr, arr2, arrOut );
+		benchSink += arrOut.X()[7];
+	} );
+	TimeIt( "VectorR3::MakeUnit", NumVecs, [&]() {
+		for ( int i=0; i<NumVecs; i++ ) {
+			vecsOut[i] = vecs[i];
+			vecsOut[i].MakeUnit();
+		}
+		benchSink += vecsOut[7].x;
+	} );
+	TimeIt( "Lerp + Normalize (array)", NumVecs, [&]() {
+		Lerp( arr, arr2, 0.3, arrOut );		// Normalize works in place; start from fresh data
+		Normalize( arrOut );
+		benchSink += arrOut.X()[7];
+	} );
+	TimeIt( "Lerp of VectorR3's", NumVecs, [&]() {
+		for ( int i=0; i<NumVecs; i++ ) {
+			Lerp( vecs[i], vecs2[i], 0.3, vecsOut[i] );
+		}
+		benchSink += vecsOut[7].x;
+	} );
+	TimeIt( "Lerp (array)", NumVecs, [&]() {
+		Lerp( arr, arr2, 0.3, arrOut );
+		benchSink += arrOut.X()[7];
+	} );
+	TimeIt( "Bounding box of VectorR3's", NumVecs, [&]() {
+		VectorR3 boxMin = vecs[0];
+		VectorR3 boxMax = vecs[0];
+		for ( int i=1; i<NumVecs; i++ ) {
+			UpdateMinMax( vecs[i].x, boxMin.x, boxMax.x );
+			UpdateMinMax( vecs[i].y, boxMin.y, boxMax.y );
+			UpdateMinMax( vecs[i].z, boxMin.z, boxMax.z );
+		}
+		benchSink += boxMin.x + boxMax.z;
+	} );
+	TimeIt( "BoundingBox (array)", NumVecs, [&]() {
+		VectorR3 boxMin, boxMax;
+		BoundingBox( arr, &boxMin, &boxMax );
+		benchSink += boxMin.x + boxMax.z;
+	} );
+}
+
+// ******************************************************
+// Matrix3x3Array compared with LinearMapR3             *
+// ******************************************************
+
+void BenchMatrix3x3Arrays()
+{
+#if LINEAR_ARRAY_USE_AVX2
+	Title( "Matrix3x3Array (AVX2) compared with LinearMapR3" );
+#else
+	Title( "Matrix3x3Array (scalar) compared with LinearMapR3" );
+#endif
+	const int NumMats3 = 4096;
+	std::vector<LinearMapR3> mats(NumMats3), posDef(NumMats3), matsOut(NumMats3);
+	std::vector<VectorR3> rhs(NumMats3), sols(NumMats3);
+	Matrix3x3Array arr(NumMats3), arrPosDef(NumMats3), arrOut;
+	VectorR3Array arrRhs(NumMats3), arrSols;
+	for ( int i=0; i<NumMats3; i++ ) {
+		// A general matrix, kept away from singular by a multiple of the identity
+		mats[i].Set( 3.0+RandomUnit(), RandomUnit(), RandomUnit(),
+					 RandomUnit(), 3.0+RandomUnit(), RandomUnit(),
+					 RandomUnit(), RandomUnit(), 3.0+RandomUnit() );
+		// A symmetric positive definite matrix, as formed by least squares normal equations
+		posDef[i] = mats[i].Transpose()*mats[i];
+		rhs[i].Set( RandomUnit(), RandomUnit(), RandomUnit() );
+		arr.Set( i, mats[i] );
+		arrPosDef.Set( i, posDef[i] );
+		arrRhs.Set( i, rhs[i] );
+	}
+	std::vector<double> dets(arr.PaddedSize());
+
+	// Accuracy: the batched results should equal the single matrix results.
+	//    The residual |A*x-b| measures the accuracy of the solver itself.
+	double diffInv = 0.0, diffSym = 0.0, diffPosDef = 0.0, diffSafe = 0.0, diffDet = 0.0, diffSolve = 0.0, residual = 0.0;
+	Determinant( arr, dets.data() );
+	Invert( arr, arrOut );
+	for ( int i=0; i<NumMats3; i++ ) {
+		diffInv = Max( diffInv, MaxEntryDiff(mats[i].Inverse(), arrOut.Get(i)) );
+		diffDet = Max( diffDet, fabs(mats[i].Determinant() - dets[i]) );
+	}
+	InvertSym( arrPosDef, arrOut );
+	for ( int i=0; i<NumMats3; i++ ) {
+		diffSym = Max( diffSym, MaxEntryDiff(posDef[i].InverseSym(), arrOut.Get(i)) );
+	}
+	InvertPosDef( arrPosDef, arrOut );
+	for ( int i=0; i<NumMats3; i++ ) {
+		diffPosDef = Max( diffPosDef, MaxEntryDiff(posDef[i].InversePosDef(), arrOut.Get(i)) );
+	}
+	InvertPosDefSafe( arrPosDef, arrOut );
+	for ( int i=0; i<NumMats3; i++ ) {
+		LinearMapR3 inv = posDef[i];
+		diffSafe = Max( diffSafe, MaxEntryDiff(inv.InvertPosDefSafe(), arrOut.Get(i)) );
+	}
+	Solve( arr, arrRhs, arrSols );
+	for ( int i=0; i<NumMats3; i++ ) {
+		VectorR3 x = arrSols.Get(i);
+		diffSolve = Max( diffSolve, Dist(mats[i].Solve(rhs[i]), x) );
+		residual = Max( residual, Dist(mats[i]*x, rhs[i]) );
+	}
+	if ( !csvOutput ) {
+		printf( "  Largest differences from LinearMapR3: Inverse %g, InverseSym %g, InversePosDef %g,\n", diffInv, diffSym, diffPosDef );
+		printf( "     InvertPosDefSafe %g, Determinant %g, Solve %g.  Largest residual |A*x-b|: %g\n", diffSafe, diffDet, diffSolve, residual );
+	}
+	// The same formulas give identical results, unless the compiler fuses
+	//   some multiply-adds in one version and not the other.
+#if defined(__FMA__)
+	const double sameTolerance = 1.0e-13;
+#else
+	const double sameTolerance = 0.0;
+#endif
+	Check( "Invert (array)", diffInv, sameTolerance );
+	Check( "InvertSym (array)", diffSym, sameTolerance );
+	Check( "InvertPosDef (array)", diffPosDef, sameTolerance );
+	Check( "InvertPosDefSafe (array)", diffSafe, sameTolerance );
+	Check( "Determinant (array)", diffDet, sameTolerance );
+	Check( "Solve (array)", diffSolve, sameTolerance );
+	Check( "Solve (array) residual", residual, 1.0e-14 );
+
+	TimeIt( "LinearMapR3::Inverse", NumMats3, [&]() {
+		for ( int i=0; i<NumMats3; i++ ) {
+			matsOut[i] = mats[i].Inverse();
+		}
+		benchSink += matsOut[7].m11;
+	} );
+	TimeIt( "Invert (array)", NumMats3, [&]() {
+		Invert( arr, arrOut );
+		benchSink += arrOut.Entries(1,1)[7];
+	} );
+	TimeIt( "LinearMapR3::InverseSym", NumMats3, [&]() {
+		for ( int i=0; i<NumMats3; i++ ) {
+			posDef[i].InverseSym( &matsOut[i] );
+		}
+		benchSink += matsOut[7].m11;
+	} );
+	TimeIt( "InvertSym (array)", NumMats3, [&]() {
+		InvertSym( arrPosDef, arrOut );
+		benchSink += arrOut.Entries(1,1)[7];
+	} );
+	TimeIt( "LinearMapR3::InversePosDef", NumMats3, [&]() {
+		for ( int i=0; i<NumMats3; i++ ) {
+			posDef[i].InversePosDef( &matsOut[i] );
+		}
+		benchSink += matsOut[7].m11;
+	} );
+	TimeIt( "InvertPosDef (array)", NumMats3, [&]() {
+		InvertPosDef( arrPosDef, arrOut );
+		benchSink += arrOut.Entries(1,1)[7];
+	} );
+	TimeIt( "Matrix3x3::Solve", NumMats3, [&]() {
+		for ( int i=0; i<NumMats3; i++ ) {
+			sols[i] = mats[i].Solve( rhs[i] );
+		}
+		benchSink += sols[7].x;
+	} );
+	TimeIt( "Solve (array)", NumMats3, [&]() {
+		Solve( arr, arrRhs, arrSols );
+		benchSink += arrSols.X()[7];
+	} );
+}
+
+// ******************************************************
+// Expression templates compared with the operators     *
+//    that return temporary vectors                     *
+// ******************************************************
+
+void BenchExpr()
+{
+	Title( "LinearExpr expression templates compared with VectorR3 operators" );
+	const int NumVecs = 4096;
+	std::vector<VectorR3> us(NumVecs), vs(NumVecs), ws(NumVecs), out(NumVecs), outExpr(NumVecs);
+	for ( int i=0; i<NumVecs; i++ ) {
+		us[i].Set( RandomUnit(), RandomUnit(), RandomUnit() );
+		vs[i].Set( RandomUnit(), RandomUnit(), RandomUnit() );
+		vs[i].MakeUnit();
+		ws[i].Set( RandomUnit(), RandomUnit(), RandomUnit() );
+	}
+
+	// Gram-Schmidt step plus a cross product term.
+	TimeIt( "u - ((u^v)*v) + 0.5*(u*w), operators", NumVecs, [&]() {
+		for ( int i=0; i<NumVecs; i++ ) {
+			const VectorR3& u = us[i];
+			const VectorR3& v = vs[i];
+			out[i] = u - ((u^v)*v) + 0.5*(u*ws[i]);
+		}
+		benchSink += out[7].x;
+	} );
+	TimeIt( "u - ((u^v)*v) + 0.5*(u*w), expression templates", NumVecs, [&]() {
+		using namespace LinearExpr;
+		for ( int i=0; i<NumVecs; i++ ) {
+			const VectorR3& u = us[i];
+			const VectorR3& v = vs[i];
+			Assign( outExpr[i], Expr(u) - Dot(u,v)*Expr(v) + 0.5*Cross(Expr(u), Expr(ws[i])) );
+		}
+		benchSink += outExpr[7].x;
+	} );
+
+	// Interpolate between two points, then project
+	TimeIt( "ProjectPerpUnit(Interpolate(u,w,0.3), v)", NumVecs, [&]() {
+		for ( int i=0; i<NumVecs; i++ ) {
+			out[i] = ProjectPerpUnit( Interpolate(us[i], ws[i], 0.3), vs[i] );
+		}
+		benchSink += out[7].x;
+	} );
+	TimeIt( "The same, with expression templates", NumVecs, [&]() {
+		using namespace LinearExpr;
+		for ( int i=0; i<NumVecs; i++ ) {
+			VectorR3 p;
+			Assign( p, Interpolate(Expr(us[i]), Expr(ws[i]), 0.3) );
+			Assign( outExpr[i], Expr(p) - Dot(p, vs[i])*Expr(vs[i]) );
+		}
+		benchSink += outExpr[7].x;
+	} );
+
+	double maxDiff = 0.0;
+	for ( int i=0; i<NumVecs; i++ ) {
+		maxDiff = Max( maxDiff, Dist(out[i], outExpr[i]) );
+	}
+	if ( !csvOutput ) {
+		printf( "  Largest difference between the two results: %g\n", maxDiff );
+	}
+	Check( "Expression templates equal the VectorR3 operators", maxDiff, 1.0e-15 );
+}
+
+// ******************************************************
+// Quaternions, TRSf transforms and batched SLERP       *
+// ******************************************************
+
+Quaternion RandomRotation()
+{
+	Quaternion q;
+	return q.SetRotate( 3.0*RandomUnit(), RandomUnit(), RandomUnit(), 2.0+RandomUnit() );
+}
+
+double MaxEntryDiff( const Mat4f& A, const Mat4f& B )
+{
+	double maxDiff = 0.0;
+	for ( int k=0; k<16; k++ ) {
+		maxDiff = Max( maxDiff, (double)fabsf(A.m[k] - B.m[k]) );
+	}
+	return maxDiff;
+}
+
+// The largest difference between components of q1 and q2, as rotations (q and -q are the same)
+double RotationDiff( const Quaternion& q1, const Quaternion& q2 )
+{
+	double diffPlus = Max( Max( fabs(q1.x-q2.x), fabs(q1.y-q2.y) ), Max( fabs(q1.z-q2.z), fabs(q1.w-q2.w) ) );
+	double diffMinus = Max( Max( fabs(q1.x+q2.x), fabs(q1.y+q2.y) ), Max( fabs(q1.z+q2.z), fabs(q1.w+q2.w) ) );
+	return Min( diffPlus, diffMinus );
+}
+
+double QuatfDiff( const Quatf& q1, const Quatf& q2 )
+{
+	return Max( Max( fabsf(q1.x-q2.x), fabsf(q1.y-q2.y) ), Max( fabsf(q1.z-q2.z), fabsf(q1.w-q2.w) ) );
+}
+
+void BenchQuaternions()
+{
+	Title( "Quaternion, TRSf and batched SLERP/NLERP" );
+	std::vector<Quaternion> quats(NumMats);
+	std::vector<TRSf> trs(NumMats);
+	std::vector<LinearMapR4> mats(NumMats);
+	std::vector<double> angles(NumMats);
+	std::vector<VectorR3> axes(NumMats);
+	QuatfArray qa, qb, qdest;
+	double rotErr = 0.0, matErr = 0.0, vecErr = 0.0, slerpErr = 0.0, nlerpErr = 0.0, composeErr = 0.0;
+	for ( int i=0; i<NumMats; i++ ) {
+		angles[i] = 3.0*RandomUnit();
+		axes[i].Set( RandomUnit(), RandomUnit(), 2.0+RandomUnit() );
+		quats[i].SetRotate( angles[i], axes[i] );
+		VectorR3 u = axes[i];
+		u.Normalize();
+		LinearMapR3 R = ReferenceRotation( angles[i], u );
+		rotErr = Max( rotErr, MaxEntryDiff( quats[i].RotationMapR3(), R ) );
+		Quaternion fromMatrix;
+		matErr = Max( matErr, RotationDiff( fromMatrix.Set(R), quats[i] ) );
+		VectorR3 v( RandomUnit(), RandomUnit(), RandomUnit() );
+		VectorR3 w = v;
+		vecErr = Max( vecErr, (w.Rotate(quats[i]) - R*v).MaxAbs() );
+
+		Quaternion p = RandomRotation();
+		double alpha = 0.5 + 0.5*RandomUnit();
+		Quatf qf( quats[i] ), pf( p );
+		Quaternion qfd( qf.x, qf.y, qf.z, qf.w ), pfd( pf.x, pf.y, pf.z, pf.w );	// The same, in double precision
+		Quatf s = Slerp( qf, pf, (float)alpha );
+		slerpErr = Max( slerpErr, RotationDiff( Quaternion(s.x, s.y, s.z, s.w), Slerp( qfd, pfd, (float)alpha ) ) );
+		Quatf n = Nlerp( qf, pf, (float)alpha );
+		nlerpErr = Max( nlerpErr, RotationDiff( Quaternion(n.x, n.y, n.z, n.w), Nlerp( qfd, pfd, (float)alpha ) ) );
+		qa.PushBack( qf );
+		qb.PushBack( pf );
+
+		float scale = (float)(1.5+RandomUnit());
+		trs[i] = TRSf( (float)RandomUnit(), (float)RandomUnit(), (float)RandomUnit(), qf, scale, scale, scale );
+		mats[i].Set_glTranslate( trs[i].t[0], trs[i].t[1], trs[i].t[2] );
+		mats[i] *= quats[i].RotationMapR4();
+		mats[i].Mult_glScale( scale );
+		if ( i>0 ) {
+			TRSf B = trs[i-1];
+			B.SetScale( (float)(1.5+RandomUnit()), (float)(1.5+RandomUnit()), (float)(1.5+RandomUnit()) );
+			composeErr = Max( composeErr, MaxEntryDiff( (trs[i]*B).ToMat4f(), trs[i].ToMat4f()*B.ToMat4f() ) );
+		}
+	}
+	Check( "Quaternion::RotationMapR3 equals Rodrigues' formula", rotErr, 1.0e-14 );
+	Check( "Quaternion::Set(Matrix3x3) inverts RotationMapR3", matErr, 1.0e-14 );
+	Check( "VectorR3::Rotate(Quaternion) equals the rotation matrix", vecErr, 1.0e-14 );
+	Check( "Slerp(Quatf) approximation equals Slerp(Quaternion)", slerpErr, 2.0e-6 );	// Approximation plus float rounding
+	Check( "Nlerp(Quatf) equals Nlerp(Quaternion)", nlerpErr, 1.0e-6 );
+	Check( "TRSf composition equals the Mat4f product", composeErr, 1.0e-5 );
+
+	double arrayErr = 0.0;
+	Slerp( qa, qb, 0.37f, qdest );
+	for ( int i=0; i<NumMats; i++ ) {
+		arrayErr = Max( arrayErr, QuatfDiff( qdest.Get(i), Slerp( qa.Get(i), qb.Get(i), 0.37f ) ) );
+	}
+	Nlerp( qa, qb, 0.37f, qdest );
+	for ( int i=0; i<NumMats; i++ ) {
+		arrayErr = Max( arrayErr, QuatfDiff( qdest.Get(i), Nlerp( qa.Get(i), qb.Get(i), 0.37f ) ) );
+	}
+	// Identical results, unless the compiler fuses multiply-adds in the Quatf versions.
+#if defined(__FMA__)
+	const double sameTolerance = 1.0e-6;
+#else
+	const double sameTolerance = 0.0;
+#endif
+	Check( "QuatfArray Slerp/Nlerp equal the Quatf versions", arrayErr, sameTolerance );
+
+	TimeIt( "LinearMapR4 from translate, quaternion rotate, scale", NumMats, [&]() {
+		for ( int i=0; i<NumMats; i++ ) {
+			LinearMapR4 M;
+			M.Set_glTranslate( trs[i].t[0], trs[i].t[1], trs[i].t[2] );
+			M *= quats[i].RotationMapR4();
+			M.Mult_glScale( trs[i].s[0] );
+			benchSink += M.m11;
+		}
+	} );
+	TimeIt( "TRSf::ToMat4f", NumMats, [&]() {
+		for ( int i=0; i<NumMats; i++ ) {
+			Mat4f M;
+			benchSink += trs[i].ToMat4f(M).m[0];
+		}
+	} );
+	TimeIt( "LinearMapR4 affine product", NumMats, [&]() {
+		for ( int i=1; i<NumMats; i++ ) {
+			LinearMapR4 P = mats[i-1]*mats[i];
+			benchSink += P.m11;
+		}
+	} );
+	TimeIt( "TRSf composition", NumMats, [&]() {
+		for ( int i=1; i<NumMats; i++ ) {
+			TRSf C = trs[i-1]*trs[i];
+			benchSink += C.t[0];
+		}
+	} );
+	TimeIt( "Slerp(Quaternion), with trig functions", NumMats, [&]() {
+		for ( int i=1; i<NumMats; i++ ) {
+			benchSink += Slerp( quats[i-1], quats[i], 0.37 ).w;
+		}
+	} );
+	TimeIt( "Slerp(Quatf), polynomial", NumMats, [&]() {
+		for ( int i=0; i<NumMats; i++ ) {
+			benchSink += Slerp( qa.Get(i), qb.Get(i), 0.37f ).w;
+		}
+	} );
+	TimeIt( "Slerp(QuatfArray)", NumMats, [&]() {
+		Slerp( qa, qb, 0.37f, qdest );
+		benchSink += qdest.W()[0];
+	} );
+	TimeIt( "Nlerp(Quatf)", NumMats, [&]() {
+		for ( int i=0; i<NumMats; i++ ) {
+			benchSink += Nlerp( qa.Get(i), qb.Get(i), 0.37f ).w;
+		}
+	} );
+	TimeIt( "Nlerp(QuatfArray)", NumMats, [&]() {
+		Nlerp( qa, qb, 0.37f, qdest );
+		benchSink += qdest.W()[0];
+	} );
+}
+
+// ******************************************************
+// Keyframe animation curves                            *
+// ******************************************************
+
+// A cubic, which Hermite and Bezier segments reproduce exactly
+float Cubic( float t ) { return ((t - 2.0f)*t + 0.5f)*t + 1.0f; }
+float CubicDeriv( float t ) { return (3.0f*t - 4.0f)*t + 0.5f; }
+
+// Adds one track of each kind, with numKeys keys at random times in [0,1].
+//   The Hermite and Bezier keys are taken from Cubic().
+void AddAnimTracks( AnimCurveSet& anim, int numKeys )
+{
+	std::vector<float> times(numKeys), data;
+	times[0] = 0.0f;
+	for ( int i=1; i<numKeys; i++ ) {
+		times[i] = (float)i + 0.5f*(float)RandomUnit();
+	}
+	for ( int i=0; i<numKeys; i++ ) {
+		times[i] /= times[numKeys-1];
+	}
+	Quatf q;
+	q.SetRotate( (float)(3.0*RandomUnit()), (float)RandomUnit(), (float)RandomUnit(), 2.0f );
+	Quatf step;
+	step.SetRotate( 0.5f, (float)RandomUnit(), 1.0f, (float)RandomUnit() );
+	for ( int type=AnimCurveSet::ScalarTrack; type<=AnimCurveSet::QuatTrack; type++ ) {
+		int dim = (type==AnimCurveSet::ScalarTrack) ? 1 : ( type==AnimCurveSet::VectorTrack ? 3 : 4 );
+		for ( int interp=AnimCurveSet::Linear; interp<=AnimCurveSet::Bezier; interp++ ) {
+			data.clear();
+			Quatf qk = q;
+			for ( int i=0; i<numKeys; i++ ) {
+				float t = times[i];
+				float dtIn = ( i>0 ? t - times[i-1] : 0.0f )/3.0f;
+				float dtOut = ( i<numKeys-1 ? times[i+1] - t : 0.0f )/3.0f;
+				float value[4] = { Cubic(t), 2.0f*Cubic(t), 1.0f - Cubic(t), 0.0f };
+				float deriv[4] = { CubicDeriv(t), 2.0f*CubicDeriv(t), -CubicDeriv(t), 0.0f };
+				if ( type==AnimCurveSet::QuatTrack ) {
+					value[0] = qk.x; value[1] = qk.y; value[2] = qk.z; value[3] = qk.w;
+					deriv[0] = deriv[1] = deriv[2] = deriv[3] = 0.0f;
+					qk = step*qk;
+				}
+				for ( int part=0; part<=interp; part++ ) {
+					for ( int k=0; k<dim; k++ ) {
+						float v = value[k];
+						if ( interp==AnimCurveSet::Hermite && part==1 ) {
+							v = deriv[k];
+						}
+						else if ( interp==AnimCurveSet::Bezier && part!=1 ) {
+							v = value[k] + ( part==0 ? -dtIn : dtOut )*deriv[k];
+						}
+						data.push_back( v );
+					}
+				}
+			}
+			anim.AddTrack( (AnimCurveSet::TrackType)type, (AnimCurveSet::Interpolation)interp,
+						   numKeys, times.data(), data.data() );
+		}
+	}
+}
+
+// The tracks added by AddAnimTracks(), numGroups times
+void BuildAnimTracks( AnimCurveSet& anim, int numGroups, int numKeys )
+{
+	anim.Clear();
+	for ( int g=0; g<numGroups; g++ ) {
+		AddAnimTracks( anim, numKeys );
+	}
+}
+
+// The largest difference between the values of the tracks of two sets built by BuildAnimTracks()
+double MaxTrackDiff( const AnimCurveSet& a, const AnimCurveSet& b )
+{
+	double maxDiff = 0.0;
+	for ( int j=0; j<a.GetNumTracks(); j++ ) {
+		switch ( (j%9)/3 ) {
+		case AnimCurveSet::ScalarTrack:
+			maxDiff = Max( maxDiff, (double)fabsf( a.GetScalar(j) - b.GetScalar(j) ) );
+			break;
+		case AnimCurveSet::VectorTrack:
+			for ( int k=0; k<3; k++ ) {
+				maxDiff = Max( maxDiff, (double)fabsf( a.GetVector(j)[k] - b.GetVector(j)[k] ) );
+			}
+			break;
+		default:
+			maxDiff = Max( maxDiff, QuatfDiff( a.GetQuat(j), b.GetQuat(j) ) );
+			break;
+		}
+	}
+	return maxDiff;
+}
+
+void BenchAnimCurves()
+{
+	Title( "Keyframe animation curves (AnimCurveSet)" );
+	const int numKeys = 32;
+	const int numGroups = 128;			// Each group has one track of each of the nine kinds
+	const int numTracks = 9*numGroups;
+	const int numTimes = 1000;
+	AnimCurveSet anim, animJumping;
+	int seed = rand();
+	srand( seed );
+	BuildAnimTracks( anim, numGroups, numKeys );
+	srand( seed );
+	BuildAnimTracks( animJumping, numGroups, numKeys );
+
+	// A spin track: four quarter turns at a constant rate
+	AnimCurveSet spin;
+	float spinTimes[5];
+	Quatf spinKeys[5];
+	for ( int i=0; i<5; i++ ) {
+		spinTimes[i] = 0.25f*i;
+		spinKeys[i].SetRotate( (float)(0.25*i*PI2), 1.0f, 1.0f, 1.0f );
+	}
+	spin.AddTrack( AnimCurveSet::QuatTrack, AnimCurveSet::Linear, 5, spinTimes, &spinKeys[0].x );
+
+	// Hermite and Bezier tracks reproduce the cubic.  The spin track equals the
+	//   rotation at the angle.  Sequential playback (using the cached segments)
+	//   agrees with evaluation after a jump to a random time (a binary search).
+	double cubicErr = 0.0, spinErr = 0.0, jumpErr = 0.0;
+	for ( int n=0; n<=numTimes; n++ ) {
+		float t = (float)n/(float)numTimes;
+		anim.Evaluate( t );
+		float c = Cubic(t);
+		for ( int g=0; g<numGroups; g++ ) {
+			cubicErr = Max( cubicErr, (double)fabsf( anim.GetScalar(9*g+1) - c ) );
+			cubicErr = Max( cubicErr, (double)fabsf( anim.GetScalar(9*g+2) - c ) );
+			cubicErr = Max( cubicErr, (double)fabsf( anim.GetVector(9*g+4)[1] - 2.0f*c ) );
+			cubicErr = Max( cubicErr, (double)fabsf( anim.GetVector(9*g+5)[2] - (1.0f - c) ) );
+		}
+		animJumping.Evaluate( (float)(0.5 + 0.5*RandomUnit()) );
+		animJumping.Evaluate( t );
+		jumpErr = Max( jumpErr, MaxTrackDiff( anim, animJumping ) );
+		Quatf expected;
+		expected.SetRotate( (float)(t*PI2), 1.0f, 1.0f, 1.0f );
+		spin.Evaluate( t );
+		spinErr = Max( spinErr, QuatfDiff( spin.GetQuat(0), expected ) );
+	}
+	Check( "Hermite and Bezier tracks reproduce a cubic", cubicErr, 1.0e-5 );
+	Check( "Slerp spin track equals the rotation", spinErr, 2.0e-6 );
+	Check( "Sequential playback equals evaluation after a jump", jumpErr, 0.0 );
+
+	int frame = 0;
+	TimeIt( "AnimCurveSet::Evaluate, sequential times (per track)", numTracks, [&]() {
+		frame = (frame < numTimes) ? frame+1 : 0;
+		anim.Evaluate( (float)frame/(float)numTimes );
+		benchSink += anim.GetScalar(0);
+	} );
+	std::vector<float> randomTimes(numTimes);
+	for ( int n=0; n<numTimes; n++ ) {
+		randomTimes[n] = (float)(0.5 + 0.5*RandomUnit());
+	}
+	TimeIt( "AnimCurveSet::Evaluate, random times (per track)", numTracks, [&]() {
+		frame = (frame < numTimes-1) ? frame+1 : 0;
+		anim.Evaluate( randomTimes[frame] );
+		benchSink += anim.GetScalar(0);
+	} );
+}
+
+struct BenchSection {
+	const char* name;
+	void (*func)();
+};
+
+int main( int argc, char** argv )
+{
+	static const BenchSection sections[] = {
+		{ "core", BenchCore },
+		{ "mat4f", BenchMat4f },
+		{ "affine", BenchAffine },
+		{ "arrays", BenchVectorArrays },
+		{ "mat3arrays", BenchMatrix3x3Arrays },
+		{ "expr", BenchExpr },
+		{ "quat", BenchQuaternions },
+		{ "anim", BenchAnimCurves },
+	};
+	const int numSections = sizeof(sections)/sizeof(sections[0]);
+
+	// Parse the command line
+	bool runSection[numSections];
+	bool runAll = true;
+	for ( int k=0; k<numSections; k++ ) {
+		runSection[k] = false;
+	}
+	for ( int a=1; a<argc; a++ ) {
+		if ( strcmp(argv[a], "-csv")==0 ) {
+			csvOutput = true;
+			continue;
+		}
+		int k = 0;
+		while ( k<numSections && strcmp(argv[a], sections[k].name)!=0 ) {
+			k++;
+		}
+		if ( k==numSections ) {
+			printf( "Unknown section \"%s\".  Usage: LinearBench [-csv] [section ...]\n   Sections:", argv[a] );
+			for ( k=0; k<numSections; k++ ) {
+				printf( " %s", sections[k].name );
+			}
+			printf( "\n" );
+			return 2;
+		}
+		runSection[k] = true;
+		runAll = false;
+	}
+
+	SetBuildTag();
+	if ( csvOutput ) {
+		printf( "build,operation,ns/op,ops/sec\n" );
+	}
+	else {
+		printf( "LinearBench: %s\n", buildTag );
+	}
+	for ( int k=0; k<numSections; k++ ) {
+		if ( runAll || runSection[k] ) {
+			srand(155);				// The same data, whichever sections are run
+			sections[k].func();
+		}
+	}
+
+	if ( checksFailed>0 ) {
+		printf( "%d of %d checks FAILED.\n", checksFailed, checksRun );
+		return 1;
+	}
+	if ( !csvOutput ) {
+		printf( "All %d checks passed.\n", checksRun );
+	}
+	return 0;
+}
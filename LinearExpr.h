@@ -0,0 +1,231 @@
+/*
+ *
+ * LinearExpr.h, release 1.0.
+ *
+ * Expression templates for VectorR3 and VectorR4 arithmetic.
+ *   The operators in LinearR3.h and LinearR4.h return a new vector for each
+ *   operation, so a chain like  u - ((u^v)*v) + 0.5*(u*w)  builds several
+ *   temporary vectors.  With this header the same chain can be written as
+ *       Assign( dest, Expr(u) - Dot(u,v)*Expr(v) + 0.5*Cross(Expr(u),Expr(w)) );
+ *   which is evaluated component by component, directly into dest, with
+ *   no temporary vectors.
+ *
+ *   Expressions are only formed when an operand is wrapped with Expr(),
+ *   so the existing operators on VectorR3 and VectorR4 are not affected.
+ *
+ *   An expression holds references to the vectors it was built from.
+ *   Do not store an expression (e.g., in an "auto" variable);
+ *   pass it immediately to Assign(), AddTo() or Eval().
+ *   The destination may be one of the operands: each component of the
+ *   result is computed before any component of dest is changed.
+ *
+ * Software is "as-is" and carries no warranty.  It may be used without
+ *   restriction, but if you modify it, please change the filenames to
+ *   prevent confusion between different versions.
+ *
+ */
+
+#ifndef LINEAR_EXPR_H
+#define LINEAR_EXPR_H
+
+#include "LinearR3.h"
+#include "LinearR4.h"
+
+namespace LinearExpr {
+
+// The vector type with N components
+template<int N> struct VectorOfDim;
+template<> struct VectorOfDim<3> { typedef VectorR3 Type; };
+template<> struct VectorOfDim<4> { typedef VectorR4 Type; };
+
+inline double Coord( const VectorR3& u, int i ) { return i==0 ? u.x : (i==1 ? u.y : u.z); }
+inline double Coord( const VectorR4& u, int i ) { return i==0 ? u.x : (i==1 ? u.y : (i==2 ? u.z : u.w)); }
+
+// Base class of all expressions with N components.
+//   E is the derived class, which defines Coord(i).
+template<class E, int N> class VecExpr {
+public:
+	const E& Self() const { return static_cast<const E&>(*this); }
+	double operator[]( int i ) const { return Self().Coord(i); }
+};
+
+// A VectorR3 or VectorR4 used in an expression
+template<class V, int N> class VecRef : public VecExpr<VecRef<V,N>, N> {
+public:
+	explicit VecRef( const V& u ) : u(u) {}
+	double Coord( int i ) const { return LinearExpr::Coord(u, i); }
+private:
+	const V& u;
+};
+
+template<class A, class B, int N> class VecSum : public VecExpr<VecSum<A,B,N>, N> {
+public:
+	VecSum( const A& a, const B& b ) : a(a), b(b) {}
+	double Coord( int i ) const { return a.Coord(i) + b.Coord(i); }
+private:
+	A a;
+	B b;
+};
+
+template<class A, class B, int N> class VecDiff : public VecExpr<VecDiff<A,B,N>, N> {
+public:
+	VecDiff( const A& a, const B& b ) : a(a), b(b) {}
+	double Coord( int i ) const { return a.Coord(i) - b.Coord(i); }
+private:
+	A a;
+	B b;
+};
+
+template<class A, int N> class VecNeg : public VecExpr<VecNeg<A,N>, N> {
+public:
+	explicit VecNeg( const A& a ) : a(a) {}
+	double Coord( int i ) const { return -a.Coord(i); }
+private:
+	A a;
+};
+
+template<class A, int N> class VecScale : public VecExpr<VecScale<A,N>, N> {
+public:
+	VecScale( const A& a, double m ) : a(a), m(m) {}
+	double Coord( int i ) const { return a.Coord(i)*m; }
+private:
+	A a;
+	double m;
+};
+
+// The cross product evaluates its operands once, when it is formed,
+//   since each of their components is needed twice.
+class VecCross : public VecExpr<VecCross, 3> {
+public:
+	template<class A, class B> VecCross( const VecExpr<A,3>& a, const VecExpr<B,3>& b )
+	{
+		double ax = a[0], ay = a[1], az = a[2];
+		double bx = b[0], by = b[1], bz = b[2];
+		c[0] = ay*bz - az*by;
+		c[1] = az*bx - ax*bz;
+		c[2] = ax*by - ay*bx;
+	}
+	double Coord( int i ) const { return c[i]; }
+private:
+	double c[3];
+};
+
+// Linear interpolation, with the same formulas as Lerp() in MathMisc.h
+template<class A, class B, int N> class VecLerp : public VecExpr<VecLerp<A,B,N>, N> {
+public:
+	VecLerp( const A& a, const B& b, double alpha ) : a(a), b(b)
+	{
+		double beta = 1.0-alpha;
+		fromA = beta>alpha;
+		ratio = fromA ? alpha/beta : beta/alpha;
+		factor = fromA ? beta : alpha;
+	}
+	double Coord( int i ) const
+	{
+		return fromA ? (b.Coord(i)*ratio + a.Coord(i))*factor : (a.Coord(i)*ratio + b.Coord(i))*factor;
+	}
+private:
+	A a;
+	B b;
+	bool fromA;
+	double ratio, factor;
+};
+
+// **************************************
+// Forming expressions                  *
+// * * * * * * * * * * * * * * * * * * **
+
+inline VecRef<VectorR3,3> Expr( const VectorR3& u ) { return VecRef<VectorR3,3>(u); }
+inline VecRef<VectorR4,4> Expr( const VectorR4& u ) { return VecRef<VectorR4,4>(u); }
+
+template<class A, class B, int N>
+inline VecSum<A,B,N> operator+( const VecExpr<A,N>& a, const VecExpr<B,N>& b )
+	{ return VecSum<A,B,N>( a.Self(), b.Self() ); }
+template<class A, class B, int N>
+inline VecDiff<A,B,N> operator-( const VecExpr<A,N>& a, const VecExpr<B,N>& b )
+	{ return VecDiff<A,B,N>( a.Self(), b.Self() ); }
+template<class A, int N>
+inline VecNeg<A,N> operator-( const VecExpr<A,N>& a )
+	{ return VecNeg<A,N>( a.Self() ); }
+template<class A, int N>
+inline VecScale<A,N> operator*( const VecExpr<A,N>& a, double m )
+	{ return VecScale<A,N>( a.Self(), m ); }
+template<class A, int N>
+inline VecScale<A,N> operator*( double m, const VecExpr<A,N>& a )
+	{ return VecScale<A,N>( a.Self(), m ); }
+template<class A, int N>
+inline VecScale<A,N> operator/( const VecExpr<A,N>& a, double m )
+	{ return VecScale<A,N>( a.Self(), 1.0/m ); }
+
+// Cross product.  (Not operator*, to avoid confusion with the scalar product.)
+template<class A, class B>
+inline VecCross Cross( const VecExpr<A,3>& a, const VecExpr<B,3>& b )
+	{ return VecCross( a, b ); }
+
+// Linear interpolation, as Interpolate() in LinearR3.h.
+//   (Not named Lerp, since the Lerp template in MathMisc.h would be chosen instead.)
+template<class A, class B, int N>
+inline VecLerp<A,B,N> Interpolate( const VecExpr<A,N>& a, const VecExpr<B,N>& b, double alpha )
+	{ return VecLerp<A,B,N>( a.Self(), b.Self(), alpha ); }
+
+// Dot products are scalars, and are evaluated immediately.
+template<class A, class B, int N>
+inline double Dot( const VecExpr<A,N>& a, const VecExpr<B,N>& b )
+{
+	double sum = a[0]*b[0];
+	for ( int i=1; i<N; i++ ) {
+		sum += a[i]*b[i];
+	}
+	return sum;
+}
+inline double Dot( const VectorR3& u, const VectorR3& v ) { return u^v; }
+inline double Dot( const VectorR4& u, const VectorR4& v ) { return u^v; }
+
+template<class A, int N>
+inline double NormSq( const VecExpr<A,N>& a ) { return Dot( a, a ); }
+
+// **************************************
+// Evaluating expressions               *
+// * * * * * * * * * * * * * * * * * * **
+
+// dest = a
+template<class A>
+inline VectorR3& Assign( VectorR3& dest, const VecExpr<A,3>& a )
+{
+	double x = a[0], y = a[1], z = a[2];
+	dest.x = x;
+	dest.y = y;
+	dest.z = z;
+	return dest;
+}
+
+template<class A>
+inline VectorR4& Assign( VectorR4& dest, const VecExpr<A,4>& a )
+{
+	double x = a[0], y = a[1], z = a[2], w = a[3];
+	dest.x = x;
+	dest.y = y;
+	dest.z = z;
+	dest.w = w;
+	return dest;
+}
+
+// dest += a
+template<class A, int N>
+inline typename VectorOfDim<N>::Type& AddTo( typename VectorOfDim<N>::Type& dest, const VecExpr<A,N>& a )
+{
+	return Assign( dest, Expr(dest) + a );
+}
+
+// Returns the value of a as a VectorR3 or VectorR4
+template<class A, int N>
+inline typename VectorOfDim<N>::Type Eval( const VecExpr<A,N>& a )
+{
+	typename VectorOfDim<N>::Type ret;
+	Assign( ret, a );
+	return ret;
+}
+
+} // namespace LinearExpr
+
+#endif // LINEAR_EXPR_H
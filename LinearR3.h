@@ -67,8 +67,8 @@ public:
 	//static const VectorR3 NegUnitZ;
 
 public:
-	VectorR3( ) : x(0.0), y(0.0), z(0.0) {}
-	VectorR3( double xVal, double yVal, double zVal )
+	constexpr VectorR3( ) : x(0.0), y(0.0), z(0.0) {}
+	constexpr VectorR3( double xVal, double yVal, double zVal )
 		: x(xVal), y(yVal), z(zVal) {}
 
 	VectorR3& Set( const Quaternion& );	// Convert quat to rotation vector
@@ -143,16 +143,16 @@ public:
 
 };
 
-inline VectorR3 operator+( const VectorR3& u, const VectorR3& v );
-inline VectorR3 operator-( const VectorR3& u, const VectorR3& v ); 
-inline VectorR3 operator*( const VectorR3& u, double m); 
-inline VectorR3 operator*( double m, const VectorR3& u); 
-inline VectorR3 operator/( const VectorR3& u, double m); 
+inline constexpr VectorR3 operator+( const VectorR3& u, const VectorR3& v );
+inline constexpr VectorR3 operator-( const VectorR3& u, const VectorR3& v ); 
+inline constexpr VectorR3 operator*( const VectorR3& u, double m); 
+inline constexpr VectorR3 operator*( double m, const VectorR3& u); 
+inline constexpr VectorR3 operator/( const VectorR3& u, double m); 
 
-inline double operator^ (const VectorR3& u, const VectorR3& v ); // Dot Product
-inline double InnerProduct(const VectorR3& u, const VectorR3& v ) { return (u^v); }
-inline VectorR3 operator* (const VectorR3& u, const VectorR3& v);	 // Cross Product
-inline VectorR3 ArrayProd ( const VectorR3& u, const VectorR3& v );
+inline constexpr double operator^ (const VectorR3& u, const VectorR3& v ); // Dot Product
+inline constexpr double InnerProduct(const VectorR3& u, const VectorR3& v ) { return (u^v); }
+inline constexpr VectorR3 operator* (const VectorR3& u, const VectorR3& v);	 // Cross Product
+inline constexpr VectorR3 ArrayProd ( const VectorR3& u, const VectorR3& v );
 
 inline double Mag(const VectorR3& u) { return u.Norm(); }
 inline double Dist(const VectorR3& u, const VectorR3& v) { return u.Dist(v); }
@@ -190,8 +190,8 @@ public:
 
 public:
 	inline Matrix3x3();
-	inline Matrix3x3(const VectorR3&, const VectorR3&, const VectorR3&); // Sets by columns!
-	inline Matrix3x3(double, double, double, double, double, double,
+	inline constexpr Matrix3x3(const VectorR3&, const VectorR3&, const VectorR3&); // Sets by columns!
+	inline constexpr Matrix3x3(double, double, double, double, double, double,
 					 double, double, double );	// Sets by columns
 
 	inline void SetIdentity ();		// Set to the identity map
@@ -257,7 +257,7 @@ protected:
 
 };
 
-inline VectorR3 operator* ( const Matrix3x3&, const VectorR3& );
+inline constexpr VectorR3 operator* ( const Matrix3x3&, const VectorR3& );
 
 ostream& operator<< ( ostream& os, const Matrix3x3& A );
 
@@ -270,11 +270,11 @@ class LinearMapR3 : public Matrix3x3 {
 
 public:
 
-	LinearMapR3();
-	LinearMapR3( const VectorR3&, const VectorR3&, const VectorR3& );
-	LinearMapR3( double, double, double, double, double, double,
+	constexpr LinearMapR3();
+	constexpr LinearMapR3( const VectorR3&, const VectorR3&, const VectorR3& );
+	constexpr LinearMapR3( double, double, double, double, double, double,
 					 double, double, double );		// Sets by columns
-	LinearMapR3 ( const Matrix3x3& );
+	constexpr LinearMapR3 ( const Matrix3x3& );
 
 	void SetZero ();			// Set to the zero map
 	inline void Negate();
@@ -289,7 +289,7 @@ public:
 	void LeftMultiplyBy( const Matrix3x3& M ) { Matrix3x3::LeftMultiplyBy(M); }
 	void LeftMultiplyByTranspose( const Matrix3x3& M ) { Matrix3x3::LeftMultiplyByTranspose(M); }
 
-	inline LinearMapR3 Transpose() const;	// Returns the transpose
+	inline constexpr LinearMapR3 Transpose() const;	// Returns the transpose
 	double Determinant () const;			// Returns the determinant
 	LinearMapR3 Inverse() const;			// Returns inverse
 	LinearMapR3& Invert();					// Converts into inverse.
@@ -416,41 +416,41 @@ inline VectorR3& VectorR3::MakeUnit ()			// Convert to unit vector (or leave zer
 	return *this;
 }
 
-inline VectorR3 operator+( const VectorR3& u, const VectorR3& v ) 
+inline constexpr VectorR3 operator+( const VectorR3& u, const VectorR3& v ) 
 { 
 	return VectorR3(u.x+v.x, u.y+v.y, u.z+v.z); 
 }
-inline VectorR3 operator-( const VectorR3& u, const VectorR3& v ) 
+inline constexpr VectorR3 operator-( const VectorR3& u, const VectorR3& v ) 
 { 
 	return VectorR3(u.x-v.x, u.y-v.y, u.z-v.z); 
 }
-inline VectorR3 operator*( const VectorR3& u, register double m) 
+inline constexpr VectorR3 operator*( const VectorR3& u, double m) 
 { 
 	return VectorR3( u.x*m, u.y*m, u.z*m); 
 }
-inline VectorR3 operator*( register double m, const VectorR3& u) 
+inline constexpr VectorR3 operator*( double m, const VectorR3& u) 
 { 
 	return VectorR3( u.x*m, u.y*m, u.z*m); 
 }
-inline VectorR3 operator/( const VectorR3& u, double m) 
+inline constexpr VectorR3 operator/( const VectorR3& u, double m) 
 { 
-	register double mInv = 1.0/m;
+	double mInv = 1.0/m;
 	return VectorR3( u.x*mInv, u.y*mInv, u.z*mInv); 
 }
 
-inline double operator^ ( const VectorR3& u, const VectorR3& v ) // Dot Product
+inline constexpr double operator^ ( const VectorR3& u, const VectorR3& v ) // Dot Product
 { 
 	return ( u.x*v.x + u.y*v.y + u.z*v.z ); 
 }
 
-inline VectorR3 operator* (const VectorR3& u, const VectorR3& v)	// Cross Product
+inline constexpr VectorR3 operator* (const VectorR3& u, const VectorR3& v)	// Cross Product
 {
 	return (VectorR3(	u.y*v.z - u.z*v.y,
 					u.z*v.x - u.x*v.z,
 					u.x*v.y - u.y*v.x  ) );
 }
 
-inline VectorR3 ArrayProd ( const VectorR3& u, const VectorR3& v )
+inline constexpr VectorR3 ArrayProd ( const VectorR3& u, const VectorR3& v )
 {
 	return ( VectorR3( u.x*v.x, u.y*v.y, u.z*v.z ) );
 }
@@ -556,35 +556,22 @@ inline VectorR3 Interpolate( const VectorR3& start, const VectorR3& end, double
 
 inline Matrix3x3::Matrix3x3() {}
 
-inline Matrix3x3::Matrix3x3( const VectorR3& u, const VectorR3& v, 
+// The constructors are constexpr, so constant matrices can be computed at compile time.
+inline constexpr Matrix3x3::Matrix3x3( const VectorR3& u, const VectorR3& v, 
 							 const VectorR3& s )
-{
-	m11 = u.x;		// Column 1
-	m21 = u.y;
-	m31 = u.z;
-	m12 = v.x;		// Column 2
-	m22 = v.y;
-	m32 = v.z;
-	m13 = s.x;		// Column 3
-	m23 = s.y;
-	m33 = s.z;
-}
+	: m11(u.x), m21(u.y), m31(u.z),		// Column 1
+	  m12(v.x), m22(v.y), m32(v.z),		// Column 2
+	  m13(s.x), m23(s.y), m33(s.z)		// Column 3
+{ }
 
-inline Matrix3x3::Matrix3x3( double a11, double a21, double a31,
+inline constexpr Matrix3x3::Matrix3x3( double a11, double a21, double a31,
 							 double a12, double a22, double a32,
 							 double a13, double a23, double a33)
 					// Values specified in column order!!!
-{
-	m11 = a11;		// Row 1
-	m12 = a12;
-	m13 = a13;
-	m21 = a21;		// Row 2
-	m22 = a22;
-	m23 = a23;
-	m31 = a31;		// Row 3
-	m32 = a32;
-	m33 = a33;
-}
+	: m11(a11), m21(a21), m31(a31),
+	  m12(a12), m22(a22), m32(a32),
+	  m13(a13), m23(a23), m33(a33)
+{ }
 	
 inline void Matrix3x3::SetIdentity ( )
 {
@@ -836,7 +823,7 @@ inline void Matrix3x3::MakeTranspose()	// Transposes it.
 	m32 = temp;
 }
 
-inline VectorR3 operator* ( const Matrix3x3& A, const VectorR3& u)
+inline constexpr VectorR3 operator* ( const Matrix3x3& A, const VectorR3& u)
 {
 	return( VectorR3( A.m11*u.x + A.m12*u.y + A.m13*u.z,
 					  A.m21*u.x + A.m22*u.y + A.m23*u.z,
@@ -881,18 +868,16 @@ inline void Matrix3x3::TransformTranspose( const VectorR3& src, VectorR3* dest )
 // * LinearMapR3 class - inlined functions				*
 // * * * * * * * * * * * * * * * * * * * * * * * * * * **
 
-inline LinearMapR3::LinearMapR3()
-{
-	SetZero();
-	return;
-}	
+inline constexpr LinearMapR3::LinearMapR3()
+:Matrix3x3 ( 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 )		// The zero map
+{ }	
 
-inline LinearMapR3::LinearMapR3( const VectorR3& u, const VectorR3& v, 
+inline constexpr LinearMapR3::LinearMapR3( const VectorR3& u, const VectorR3& v, 
 							 const VectorR3& s )
 :Matrix3x3 ( u, v, s )
 { }
 
-inline LinearMapR3::LinearMapR3( 
+inline constexpr LinearMapR3::LinearMapR3( 
 							 double a11, double a21, double a31,
 							 double a12, double a22, double a32,
 							 double a13, double a23, double a33)
@@ -900,7 +885,7 @@ inline LinearMapR3::LinearMapR3(
 :Matrix3x3 ( a11, a21, a31, a12, a22, a32, a13, a23, a33)
 { }
 
-inline LinearMapR3::LinearMapR3 ( const Matrix3x3& A )
+inline constexpr LinearMapR3::LinearMapR3 ( const Matrix3x3& A )
 : Matrix3x3 (A) 
 {}
 
@@ -1067,7 +1052,7 @@ inline VectorR3 LinearMapR3::Solve(const VectorR3& u) const	// Returns solution
 	return ( Matrix3x3::Solve( u ) );
 }
 	
-inline LinearMapR3 LinearMapR3::Transpose() const	// Returns the transpose
+inline constexpr LinearMapR3 LinearMapR3::Transpose() const	// Returns the transpose
 {
 	return ( LinearMapR3 ( m11, m12, m13, m21, m22, m23, m31, m32, m33) );
 }
@@ -1079,13 +1064,15 @@ inline LinearMapR3 LinearMapR3::Transpose() const	// Returns the transpose
 // Returns the projection of u onto unit v
 inline VectorR3 ProjectToUnit ( const VectorR3& u, const VectorR3& v)
 {
-	return (u^v)*v;
+	double d = u^v;			// Computed componentwise, with no temporary vectors
+	return VectorR3( d*v.x, d*v.y, d*v.z );
 }
 
 // Returns the projection of u onto the plane perpindicular to the unit vector v
 inline VectorR3 ProjectPerpUnit ( const VectorR3& u, const VectorR3& v)
 {
-	return ( u - ((u^v)*v) );
+	double d = u^v;
+	return VectorR3( u.x-d*v.x, u.y-d*v.y, u.z-d*v.z );
 }
 
 // Returns the projection of u onto the plane perpindicular to the unit vector v
@@ -1094,7 +1081,10 @@ inline VectorR3 ProjectPerpUnitDiff ( const VectorR3& u, const VectorR3& v)
 {
 	VectorR3 ans = u;
 	ans -= v;
-	ans -= ((ans^v)*v);
+	double d = ans^v;
+	ans.x -= d*v.x;
+	ans.y -= d*v.y;
+	ans.z -= d*v.z;
 	return ans;				// ans = (u-v) - ((u-v)^v)*v
 }
 
@@ -0,0 +1,790 @@
+/*
+ *
+ * LinearR3Array.cpp, release 1.0.
+ *
+ * Arrays of VectorR3's and VectorR4's stored as separate x, y, z (and w)
+ *   streams, and arrays of 3x3 matrices, with batched operations.
+ *   See LinearR3Array.h.
+ *
+ * Software is "as-is" and carries no warranty.  It may be used without
+ *   restriction, but if you modify it, please change the filenames to
+ *   prevent confusion between different versions.
+ *
+ */
+
+#include "LinearR3Array.h"
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#if LINEAR_ARRAY_USE_AVX2
+#include <immintrin.h>
+#endif
+
+// The streams are carved from a single block of doubles, aligned on 32 bytes.
+//   Returns the aligned start of the block.
+static double* AlignedStart( double* block )
+{
+	uintptr_t p = (uintptr_t)block;
+	return (double*)((p + 31) & ~(uintptr_t)31);
+}
+
+// **************************************
+// VectorR3Array class                  *
+// * * * * * * * * * * * * * * * * * * **
+
+void VectorR3Array::Reallocate( int newCapacity )
+{
+	assert( (newCapacity&3)==0 && newCapacity>=PaddedSize() );
+	double* newBlock = new double[3*newCapacity + 4];	// 4 extra doubles for alignment
+	double* start = AlignedStart(newBlock);
+	memset( start, 0, 3*newCapacity*sizeof(double) );
+	if ( size>0 ) {
+		memcpy( start, x, size*sizeof(double) );
+		memcpy( start+newCapacity, y, size*sizeof(double) );
+		memcpy( start+2*newCapacity, z, size*sizeof(double) );
+	}
+	delete[] block;
+	block = newBlock;
+	x = start;
+	y = start+newCapacity;
+	z = start+2*newCapacity;
+	capacity = newCapacity;
+}
+
+void VectorR3Array::Reserve( int n )
+{
+	int newCapacity = (n+3)&~3;
+	if ( newCapacity>capacity ) {
+		Reallocate( newCapacity );
+	}
+}
+
+void VectorR3Array::Resize( int n )
+{
+	assert( n>=0 );
+	if ( n>capacity ) {
+		int newCapacity = capacity<4 ? 4 : 2*capacity;
+		Reallocate( newCapacity>=n ? newCapacity : ((n+3)&~3) );
+	}
+	// Zero the new entries, or the old entries that become padding
+	int first = n>size ? size : n;
+	int last = n>size ? n : PaddedSize();
+	memset( x+first, 0, (last-first)*sizeof(double) );
+	memset( y+first, 0, (last-first)*sizeof(double) );
+	memset( z+first, 0, (last-first)*sizeof(double) );
+	size = n;
+}
+
+void VectorR3Array::PushBack( const VectorR3& u )
+{
+	Resize( size+1 );
+	Set( size-1, u );
+}
+
+void VectorR3Array::Load( const float* src, int n, int stride )
+{
+	Resize( n );
+	for ( int i=0; i<n; i++, src+=stride ) {
+		x[i] = src[0];
+		y[i] = src[1];
+		z[i] = src[2];
+	}
+}
+
+void VectorR3Array::Store( float* dest, int stride ) const
+{
+	for ( int i=0; i<size; i++, dest+=stride ) {
+		dest[0] = (float)x[i];
+		dest[1] = (float)y[i];
+		dest[2] = (float)z[i];
+	}
+}
+
+// **************************************
+// VectorR4Array class                  *
+// * * * * * * * * * * * * * * * * * * **
+
+void VectorR4Array::Reallocate( int newCapacity )
+{
+	assert( (newCapacity&3)==0 && newCapacity>=PaddedSize() );
+	double* newBlock = new double[4*newCapacity + 4];
+	double* start = AlignedStart(newBlock);
+	memset( start, 0, 4*newCapacity*sizeof(double) );
+	if ( size>0 ) {
+		memcpy( start, x, size*sizeof(double) );
+		memcpy( start+newCapacity, y, size*sizeof(double) );
+		memcpy( start+2*newCapacity, z, size*sizeof(double) );
+		memcpy( start+3*newCapacity, w, size*sizeof(double) );
+	}
+	delete[] block;
+	block = newBlock;
+	x = start;
+	y = start+newCapacity;
+	z = start+2*newCapacity;
+	w = start+3*newCapacity;
+	capacity = newCapacity;
+}
+
+void VectorR4Array::Reserve( int n )
+{
+	int newCapacity = (n+3)&~3;
+	if ( newCapacity>capacity ) {
+		Reallocate( newCapacity );
+	}
+}
+
+void VectorR4Array::Resize( int n )
+{
+	assert( n>=0 );
+	if ( n>capacity ) {
+		int newCapacity = capacity<4 ? 4 : 2*capacity;
+		Reallocate( newCapacity>=n ? newCapacity : ((n+3)&~3) );
+	}
+	int first = n>size ? size : n;
+	int last = n>size ? n : PaddedSize();
+	memset( x+first, 0, (last-first)*sizeof(double) );
+	memset( y+first, 0, (last-first)*sizeof(double) );
+	memset( z+first, 0, (last-first)*sizeof(double) );
+	memset( w+first, 0, (last-first)*sizeof(double) );
+	size = n;
+}
+
+void VectorR4Array::PushBack( const VectorR4& u )
+{
+	Resize( size+1 );
+	Set( size-1, u );
+}
+
+// **************************************
+// Matrix3x3Array class                 *
+// * * * * * * * * * * * * * * * * * * **
+
+void Matrix3x3Array::SetStreams( double* start, int streamLength )
+{
+	for ( int k=0; k<9; k++ ) {
+		m[k] = start ? start + k*streamLength : 0;
+	}
+}
+
+// The streams are separated by an extra 64 bytes.  Otherwise, when the capacity
+//   is a power of two, the nine streams (plus those of the destination) all
+//   map to the same cache sets, and the batched operations run several times slower.
+void Matrix3x3Array::Reallocate( int newCapacity )
+{
+	assert( (newCapacity&3)==0 && newCapacity>=PaddedSize() );
+	int streamLength = newCapacity + 8;
+	double* newBlock = new double[9*streamLength + 4];
+	double* start = AlignedStart(newBlock);
+	memset( start, 0, 9*streamLength*sizeof(double) );
+	for ( int k=0; k<9 && size>0; k++ ) {
+		memcpy( start+k*streamLength, m[k], size*sizeof(double) );
+	}
+	delete[] block;
+	block = newBlock;
+	SetStreams( start, streamLength );
+	capacity = newCapacity;
+}
+
+void Matrix3x3Array::Reserve( int n )
+{
+	int newCapacity = (n+3)&~3;
+	if ( newCapacity>capacity ) {
+		Reallocate( newCapacity );
+	}
+}
+
+void Matrix3x3Array::Resize( int n )
+{
+	assert( n>=0 );
+	if ( n>capacity ) {
+		int newCapacity = capacity<4 ? 4 : 2*capacity;
+		Reallocate( newCapacity>=n ? newCapacity : ((n+3)&~3) );
+	}
+	int first = n>size ? size : n;
+	int last = n>size ? n : PaddedSize();
+	for ( int k=0; k<9; k++ ) {
+		memset( m[k]+first, 0, (last-first)*sizeof(double) );
+	}
+	size = n;
+}
+
+void Matrix3x3Array::PushBack( const Matrix3x3& A )
+{
+	Resize( size+1 );
+	Set( size-1, A );
+}
+
+// **************************************
+// Batched operations                   *
+// * * * * * * * * * * * * * * * * * * **
+
+// The AVX2 versions compute exactly the same products and sums, in the
+//   same order, as the scalar versions.  (No fused multiply-adds are used.)
+//   Thus the results do not depend on which version is compiled.
+
+void AffineTransformPositions( const LinearMapR4& A, const VectorR3Array& src, VectorR3Array& dest )
+{
+	assert( A.IsAffine() );
+	dest.Resize( src.Size() );
+	int n = src.PaddedSize();
+	const double* sx = src.X();
+	const double* sy = src.Y();
+	const double* sz = src.Z();
+	double* dx = dest.X();
+	double* dy = dest.Y();
+	double* dz = dest.Z();
+	double wInv = 1.0/A.m44;
+	int i = 0;
+#if LINEAR_ARRAY_USE_AVX2
+	__m256d a11 = _mm256_set1_pd(A.m11), a12 = _mm256_set1_pd(A.m12), a13 = _mm256_set1_pd(A.m13), a14 = _mm256_set1_pd(A.m14);
+	__m256d a21 = _mm256_set1_pd(A.m21), a22 = _mm256_set1_pd(A.m22), a23 = _mm256_set1_pd(A.m23), a24 = _mm256_set1_pd(A.m24);
+	__m256d a31 = _mm256_set1_pd(A.m31), a32 = _mm256_set1_pd(A.m32), a33 = _mm256_set1_pd(A.m33), a34 = _mm256_set1_pd(A.m34);
+	__m256d vwInv = _mm256_set1_pd(wInv);
+	for ( ; i<n; i+=4 ) {
+		__m256d vx = _mm256_load_pd(sx+i);
+		__m256d vy = _mm256_load_pd(sy+i);
+		__m256d vz = _mm256_load_pd(sz+i);
+		__m256d nx = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(vx,a11), _mm256_mul_pd(vy,a12)), _mm256_mul_pd(vz,a13)), a14);
+		__m256d ny = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(vx,a21), _mm256_mul_pd(vy,a22)), _mm256_mul_pd(vz,a23)), a24);
+		__m256d nz = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(vx,a31), _mm256_mul_pd(vy,a32)), _mm256_mul_pd(vz,a33)), a34);
+		_mm256_store_pd(dx+i, _mm256_mul_pd(nx, vwInv));
+		_mm256_store_pd(dy+i, _mm256_mul_pd(ny, vwInv));
+		_mm256_store_pd(dz+i, _mm256_mul_pd(nz, vwInv));
+	}
+#endif
+	for ( ; i<n; i++ ) {
+		double x = sx[i], y = sy[i], z = sz[i];
+		dx[i] = (x*A.m11 + y*A.m12 + z*A.m13 + A.m14) * wInv;
+		dy[i] = (x*A.m21 + y*A.m22 + z*A.m23 + A.m24) * wInv;
+		dz[i] = (x*A.m31 + y*A.m32 + z*A.m33 + A.m34) * wInv;
+	}
+}
+
+void AffineTransformDirections( const LinearMapR4& A, const VectorR3Array& src, VectorR3Array& dest )
+{
+	assert( A.IsAffine() );
+	dest.Resize( src.Size() );
+	int n = src.PaddedSize();
+	const double* sx = src.X();
+	const double* sy = src.Y();
+	const double* sz = src.Z();
+	double* dx = dest.X();
+	double* dy = dest.Y();
+	double* dz = dest.Z();
+	int i = 0;
+#if LINEAR_ARRAY_USE_AVX2
+	__m256d a11 = _mm256_set1_pd(A.m11), a12 = _mm256_set1_pd(A.m12), a13 = _mm256_set1_pd(A.m13);
+	__m256d a21 = _mm256_set1_pd(A.m21), a22 = _mm256_set1_pd(A.m22), a23 = _mm256_set1_pd(A.m23);
+	__m256d a31 = _mm256_set1_pd(A.m31), a32 = _mm256_set1_pd(A.m32), a33 = _mm256_set1_pd(A.m33);
+	for ( ; i<n; i+=4 ) {
+		__m256d vx = _mm256_load_pd(sx+i);
+		__m256d vy = _mm256_load_pd(sy+i);
+		__m256d vz = _mm256_load_pd(sz+i);
+		_mm256_store_pd(dx+i, _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(vx,a11), _mm256_mul_pd(vy,a12)), _mm256_mul_pd(vz,a13)));
+		_mm256_store_pd(dy+i, _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(vx,a21), _mm256_mul_pd(vy,a22)), _mm256_mul_pd(vz,a23)));
+		_mm256_store_pd(dz+i, _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(vx,a31), _mm256_mul_pd(vy,a32)), _mm256_mul_pd(vz,a33)));
+	}
+#endif
+	for ( ; i<n; i++ ) {
+		double x = sx[i], y = sy[i], z = sz[i];
+		dx[i] = x*A.m11 + y*A.m12 + z*A.m13;
+		dy[i] = x*A.m21 + y*A.m22 + z*A.m23;
+		dz[i] = x*A.m31 + y*A.m32 + z*A.m33;
+	}
+}
+
+void Transform( const LinearMapR4& A, const VectorR4Array& src, VectorR4Array& dest )
+{
+	dest.Resize( src.Size() );
+	int n = src.PaddedSize();
+	const double* sx = src.X();
+	const double* sy = src.Y();
+	const double* sz = src.Z();
+	const double* sw = src.W();
+	double* dx = dest.X();
+	double* dy = dest.Y();
+	double* dz = dest.Z();
+	double* dw = dest.W();
+	int i = 0;
+#if LINEAR_ARRAY_USE_AVX2
+	__m256d a[16];
+	const double* entries[16] = { &A.m11, &A.m12, &A.m13, &A.m14, &A.m21, &A.m22, &A.m23, &A.m24,
+								  &A.m31, &A.m32, &A.m33, &A.m34, &A.m41, &A.m42, &A.m43, &A.m44 };
+	for ( int k=0; k<16; k++ ) {
+		a[k] = _mm256_set1_pd( *entries[k] );
+	}
+	for ( ; i<n; i+=4 ) {
+		__m256d vx = _mm256_load_pd(sx+i);
+		__m256d vy = _mm256_load_pd(sy+i);
+		__m256d vz = _mm256_load_pd(sz+i);
+		__m256d vw = _mm256_load_pd(sw+i);
+		double* d[4] = { dx, dy, dz, dw };
+		for ( int r=0; r<4; r++ ) {
+			const __m256d* row = a+4*r;
+			_mm256_store_pd( d[r]+i, _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(vx,row[0]),
+				_mm256_mul_pd(vy,row[1])), _mm256_mul_pd(vz,row[2])), _mm256_mul_pd(vw,row[3])) );
+		}
+	}
+#endif
+	for ( ; i<n; i++ ) {
+		double x = sx[i], y = sy[i], z = sz[i], w = sw[i];
+		dx[i] = x*A.m11 + y*A.m12 + z*A.m13 + w*A.m14;
+		dy[i] = x*A.m21 + y*A.m22 + z*A.m23 + w*A.m24;
+		dz[i] = x*A.m31 + y*A.m32 + z*A.m33 + w*A.m34;
+		dw[i] = x*A.m41 + y*A.m42 + z*A.m43 + w*A.m44;
+	}
+}
+
+void Dot( const VectorR3Array& u, const VectorR3Array& v, double* dest )
+{
+	assert( u.Size()==v.Size() );
+	int n = u.PaddedSize();
+	const double* ux = u.X();
+	const double* uy = u.Y();
+	const double* uz = u.Z();
+	const double* vx = v.X();
+	const double* vy = v.Y();
+	const double* vz = v.Z();
+	int i = 0;
+#if LINEAR_ARRAY_USE_AVX2
+	for ( ; i<n; i+=4 ) {
+		__m256d d = _mm256_add_pd(_mm256_add_pd(
+			_mm256_mul_pd(_mm256_load_pd(ux+i), _mm256_load_pd(vx+i)),
+			_mm256_mul_pd(_mm256_load_pd(uy+i), _mm256_load_pd(vy+i))),
+			_mm256_mul_pd(_mm256_load_pd(uz+i), _mm256_load_pd(vz+i)));
+		_mm256_storeu_pd(dest+i, d);		// dest need not be aligned
+	}
+#endif
+	for ( ; i<n; i++ ) {
+		dest[i] = ux[i]*vx[i] + uy[i]*vy[i] + uz[i]*vz[i];
+	}
+}
+
+void Cross( const VectorR3Array& u, const VectorR3Array& v, VectorR3Array& dest )
+{
+	assert( u.Size()==v.Size() );
+	dest.Resize( u.Size() );
+	int n = u.PaddedSize();
+	const double* ux = u.X();
+	const double* uy = u.Y();
+	const double* uz = u.Z();
+	const double* vx = v.X();
+	const double* vy = v.Y();
+	const double* vz = v.Z();
+	double* dx = dest.X();
+	double* dy = dest.Y();
+	double* dz = dest.Z();
+	int i = 0;
+#if LINEAR_ARRAY_USE_AVX2
+	for ( ; i<n; i+=4 ) {
+		__m256d ax = _mm256_load_pd(ux+i), ay = _mm256_load_pd(uy+i), az = _mm256_load_pd(uz+i);
+		__m256d bx = _mm256_load_pd(vx+i), by = _mm256_load_pd(vy+i), bz = _mm256_load_pd(vz+i);
+		_mm256_store_pd(dx+i, _mm256_sub_pd(_mm256_mul_pd(ay,bz), _mm256_mul_pd(az,by)));
+		_mm256_store_pd(dy+i, _mm256_sub_pd(_mm256_mul_pd(az,bx), _mm256_mul_pd(ax,bz)));
+		_mm256_store_pd(dz+i, _mm256_sub_pd(_mm256_mul_pd(ax,by), _mm256_mul_pd(ay,bx)));
+	}
+#endif
+	for ( ; i<n; i++ ) {
+		double ax = ux[i], ay = uy[i], az = uz[i];
+		double bx = vx[i], by = vy[i], bz = vz[i];
+		dx[i] = ay*bz - az*by;
+		dy[i] = az*bx - ax*bz;
+		dz[i] = ax*by - ay*bx;
+	}
+}
+
+void Normalize( VectorR3Array& u )
+{
+	int n = u.PaddedSize();
+	double* ux = u.X();
+	double* uy = u.Y();
+	double* uz = u.Z();
+	int i = 0;
+#if LINEAR_ARRAY_USE_AVX2
+	__m256d zero = _mm256_setzero_pd();
+	__m256d one = _mm256_set1_pd(1.0);
+	for ( ; i<n; i+=4 ) {
+		__m256d x = _mm256_load_pd(ux+i), y = _mm256_load_pd(uy+i), z = _mm256_load_pd(uz+i);
+		__m256d nSq = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(x,x), _mm256_mul_pd(y,y)), _mm256_mul_pd(z,z));
+		// Zero vectors get the scale factor 0 instead of 1/0.
+		__m256d isZero = _mm256_cmp_pd(nSq, zero, _CMP_EQ_OQ);
+		__m256d scale = _mm256_div_pd(one, _mm256_sqrt_pd(nSq));
+		scale = _mm256_andnot_pd(isZero, scale);
+		_mm256_store_pd(ux+i, _mm256_mul_pd(x, scale));
+		_mm256_store_pd(uy+i, _mm256_mul_pd(y, scale));
+		_mm256_store_pd(uz+i, _mm256_mul_pd(z, scale));
+	}
+#endif
+	for ( ; i<n; i++ ) {
+		double x = ux[i], y = uy[i], z = uz[i];
+		double nSq = x*x + y*y + z*z;
+		double scale = (nSq != 0.0) ? 1.0/sqrt(nSq) : 0.0;
+		ux[i] = x*scale;
+		uy[i] = y*scale;
+		uz[i] = z*scale;
+	}
+}
+
+// Uses the same formulas as the Lerp template in MathMisc.h.
+void Lerp( const VectorR3Array& u, const VectorR3Array& v, double alpha, VectorR3Array& dest )
+{
+	assert( u.Size()==v.Size() );
+	dest.Resize( u.Size() );
+	int n = u.PaddedSize();
+	// The result is (b*ratio + a)*factor, with a, b swapped when alpha > 1/2.
+	double beta = 1.0-alpha;
+	bool fromU = beta>alpha;
+	const VectorR3Array& a = fromU ? u : v;
+	const VectorR3Array& b = fromU ? v : u;
+	double ratio = fromU ? alpha/beta : beta/alpha;
+	double factor = fromU ? beta : alpha;
+	const double* ax = a.X();
+	const double* ay = a.Y();
+	const double* az = a.Z();
+	const double* bx = b.X();
+	const double* by = b.Y();
+	const double* bz = b.Z();
+	double* dx = dest.X();
+	double* dy = dest.Y();
+	double* dz = dest.Z();
+	int i = 0;
+#if LINEAR_ARRAY_USE_AVX2
+	__m256d vRatio = _mm256_set1_pd(ratio);
+	__m256d vFactor = _mm256_set1_pd(factor);
+	for ( ; i<n; i+=4 ) {
+		_mm256_store_pd(dx+i, _mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_load_pd(bx+i), vRatio), _mm256_load_pd(ax+i)), vFactor));
+		_mm256_store_pd(dy+i, _mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_load_pd(by+i), vRatio), _mm256_load_pd(ay+i)), vFactor));
+		_mm256_store_pd(dz+i, _mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_load_pd(bz+i), vRatio), _mm256_load_pd(az+i)), vFactor));
+	}
+#endif
+	for ( ; i<n; i++ ) {
+		dx[i] = (bx[i]*ratio + ax[i])*factor;
+		dy[i] = (by[i]*ratio + ay[i])*factor;
+		dz[i] = (bz[i]*ratio + az[i])*factor;
+	}
+}
+
+void BoundingBox( const VectorR3Array& u, VectorR3* boxMin, VectorR3* boxMax )
+{
+	int size = u.Size();
+	assert( size>0 );
+	const double* ux = u.X();
+	const double* uy = u.Y();
+	const double* uz = u.Z();
+	int i = 0;
+	double minX = ux[0], minY = uy[0], minZ = uz[0];
+	double maxX = minX, maxY = minY, maxZ = minZ;
+#if LINEAR_ARRAY_USE_AVX2
+	// Only whole groups of four real vectors; the padding must not be included.
+	int n4 = size&~3;
+	if ( n4>0 ) {
+		__m256d lox = _mm256_load_pd(ux), loy = _mm256_load_pd(uy), loz = _mm256_load_pd(uz);
+		__m256d hix = lox, hiy = loy, hiz = loz;
+		for ( i=4; i<n4; i+=4 ) {
+			__m256d x = _mm256_load_pd(ux+i), y = _mm256_load_pd(uy+i), z = _mm256_load_pd(uz+i);
+			lox = _mm256_min_pd(lox, x); hix = _mm256_max_pd(hix, x);
+			loy = _mm256_min_pd(loy, y); hiy = _mm256_max_pd(hiy, y);
+			loz = _mm256_min_pd(loz, z); hiz = _mm256_max_pd(hiz, z);
+		}
+		double lo[3][4], hi[3][4];
+		_mm256_storeu_pd(lo[0], lox); _mm256_storeu_pd(lo[1], loy); _mm256_storeu_pd(lo[2], loz);
+		_mm256_storeu_pd(hi[0], hix); _mm256_storeu_pd(hi[1], hiy); _mm256_storeu_pd(hi[2], hiz);
+		for ( int k=0; k<4; k++ ) {
+			minX = Min(minX, lo[0][k]); maxX = Max(maxX, hi[0][k]);
+			minY = Min(minY, lo[1][k]); maxY = Max(maxY, hi[1][k]);
+			minZ = Min(minZ, lo[2][k]); maxZ = Max(maxZ, hi[2][k]);
+		}
+	}
+#endif
+	for ( ; i<size; i++ ) {
+		minX = Min(minX, ux[i]); maxX = Max(maxX, ux[i]);
+		minY = Min(minY, uy[i]); maxY = Max(maxY, uy[i]);
+		minZ = Min(minZ, uz[i]); maxZ = Max(maxZ, uz[i]);
+	}
+	boxMin->Set( minX, minY, minZ );
+	boxMax->Set( maxX, maxY, maxZ );
+}
+
+// **************************************
+// Batched 3x3 inverses and solvers     *
+// * * * * * * * * * * * * * * * * * * **
+
+// The matrix kernels are templates, instantiated with T = double for one
+//   matrix at a time and, with AVX2, with T = Lanes for four matrices at a time.
+//   Thus both versions use exactly the same formulas as LinearR3.cpp.
+
+inline void LoadLanes( const double* p, double& v ) { v = *p; }
+inline void StoreLanes( double* p, double v ) { *p = v; }
+
+#if LINEAR_ARRAY_USE_AVX2
+// Four doubles, with the arithmetic operators needed by the kernels.
+struct Lanes {
+	__m256d v;
+	Lanes() {}
+	Lanes( double a ) : v(_mm256_set1_pd(a)) {}
+	Lanes( __m256d a ) : v(a) {}
+};
+inline Lanes operator+( Lanes a, Lanes b ) { return _mm256_add_pd(a.v, b.v); }
+inline Lanes operator-( Lanes a, Lanes b ) { return _mm256_sub_pd(a.v, b.v); }
+inline Lanes operator-( Lanes a ) { return _mm256_xor_pd(a.v, _mm256_set1_pd(-0.0)); }	// Flip the sign bit
+inline Lanes operator*( Lanes a, Lanes b ) { return _mm256_mul_pd(a.v, b.v); }
+inline Lanes operator/( Lanes a, Lanes b ) { return _mm256_div_pd(a.v, b.v); }
+inline Lanes Max( Lanes a, Lanes b ) { return _mm256_max_pd(a.v, b.v); }	// Same as Max in MathMisc.h
+// The matrix streams are aligned, but the determinant array need not be.
+inline void LoadLanes( const double* p, Lanes& v ) { v.v = _mm256_loadu_pd(p); }
+inline void StoreLanes( double* p, Lanes v ) { _mm256_storeu_pd(p, v.v); }
+#endif
+
+// Pointers to the nine streams of a Matrix3x3Array, in the order m11, m12, ..., m33
+struct MatrixStreams {
+	const double* a[9];
+	explicit MatrixStreams( const Matrix3x3Array& A )
+	{
+		for ( int k=0; k<9; k++ ) {
+			a[k] = A.Entries( k/3+1, k%3+1 );
+		}
+	}
+};
+struct MatrixDestStreams {
+	double* d[9];
+	explicit MatrixDestStreams( Matrix3x3Array& A )
+	{
+		for ( int k=0; k<9; k++ ) {
+			d[k] = A.Entries( k/3+1, k%3+1 );
+		}
+	}
+};
+
+// Loads the i-th matrix (or matrices), with entries in the order m11, m12, ..., m33.
+//   Written out, not as loops, so that the entries stay in registers.
+template<class T> inline void LoadMatrix( const MatrixStreams& A, int i, T m[9] )
+{
+	LoadLanes( A.a[0]+i, m[0] ); LoadLanes( A.a[1]+i, m[1] ); LoadLanes( A.a[2]+i, m[2] );
+	LoadLanes( A.a[3]+i, m[3] ); LoadLanes( A.a[4]+i, m[4] ); LoadLanes( A.a[5]+i, m[5] );
+	LoadLanes( A.a[6]+i, m[6] ); LoadLanes( A.a[7]+i, m[7] ); LoadLanes( A.a[8]+i, m[8] );
+}
+template<class T> inline void StoreMatrix( const MatrixDestStreams& D, int i, const T m[9] )
+{
+	StoreLanes( D.d[0]+i, m[0] ); StoreLanes( D.d[1]+i, m[1] ); StoreLanes( D.d[2]+i, m[2] );
+	StoreLanes( D.d[3]+i, m[3] ); StoreLanes( D.d[4]+i, m[4] ); StoreLanes( D.d[5]+i, m[5] );
+	StoreLanes( D.d[6]+i, m[6] ); StoreLanes( D.d[7]+i, m[7] ); StoreLanes( D.d[8]+i, m[8] );
+}
+
+// The nine subdeterminants, as in LinearMapR3::Inverse.
+//    Returns 1/determinant.
+template<class T> inline T Subdeterminants( const T a[9], T sd[9] )
+{
+	const T& m11 = a[0]; const T& m12 = a[1]; const T& m13 = a[2];
+	const T& m21 = a[3]; const T& m22 = a[4]; const T& m23 = a[5];
+	const T& m31 = a[6]; const T& m32 = a[7]; const T& m33 = a[8];
+	sd[0] = m22*m33-m23*m32;		// sd11
+	sd[3] = m32*m13-m12*m33;		// sd21
+	sd[6] = m12*m23-m22*m13;		// sd31
+	sd[1] = m31*m23-m21*m33;		// sd12
+	sd[4] = m11*m33-m31*m13;		// sd22
+	sd[7] = m21*m13-m11*m23;		// sd32
+	sd[2] = m21*m32-m31*m22;		// sd13
+	sd[5] = m31*m12-m11*m32;		// sd23
+	sd[8] = m11*m22-m21*m12;		// sd33
+	return T(1.0)/(m11*sd[0] + m12*sd[1] + m13*sd[2]);
+}
+
+template<class T> inline void DeterminantKernel( const MatrixStreams& A, double* dest, int i )
+{
+	T a[9];
+	LoadMatrix( A, i, a );
+	const T& m11 = a[0]; const T& m12 = a[1]; const T& m13 = a[2];
+	const T& m21 = a[3]; const T& m22 = a[4]; const T& m23 = a[5];
+	const T& m31 = a[6]; const T& m32 = a[7]; const T& m33 = a[8];
+	StoreLanes( dest+i, m11*(m22*m33-m23*m32) - m12*(m21*m33-m31*m23) + m13*(m21*m23-m31*m22) );
+}
+
+template<class T> inline void InvertKernel( const MatrixStreams& A, const MatrixDestStreams& D, int i )
+{
+	T a[9], sd[9];
+	LoadMatrix( A, i, a );
+	T detInv = Subdeterminants( a, sd );
+	// The inverse is the transpose of sd, divided by the determinant
+	T inv[9] = { sd[0]*detInv, sd[3]*detInv, sd[6]*detInv,
+				 sd[1]*detInv, sd[4]*detInv, sd[7]*detInv,
+				 sd[2]*detInv, sd[5]*detInv, sd[8]*detInv };
+	StoreMatrix( D, i, inv );
+}
+
+template<class T> inline void InvertSymKernel( const MatrixStreams& A, const MatrixDestStreams& D, int i )
+{
+	T a[9];
+	LoadMatrix( A, i, a );
+	const T& m11 = a[0]; const T& m21 = a[3]; const T& m22 = a[4];
+	const T& m31 = a[6]; const T& m32 = a[7]; const T& m33 = a[8];
+	// The six distinct subdeterminants
+	T sd11 = m22*m33-m32*m32;
+	T sd12 = m31*m32-m21*m33;
+	T sd22 = m11*m33-m31*m31;
+	T sd13 = m21*m32-m31*m22;
+	T sd23 = m31*m21-m11*m32;
+	T sd33 = m11*m22-m21*m21;
+	T detInv = T(1.0)/(m11*sd11 + m21*sd12 + m31*sd13);
+	T inv[9];
+	inv[0] = sd11*detInv;
+	inv[1] = inv[3] = sd12*detInv;
+	inv[2] = inv[6] = sd13*detInv;
+	inv[4] = sd22*detInv;
+	inv[5] = inv[7] = sd23*detInv;
+	inv[8] = sd33*detInv;
+	StoreMatrix( D, i, inv );
+}
+
+// The inverse from an L*D*L^T factorization, as in LinearMapR3::InversePosDef.
+//    If safe is true, the pivots are kept at least epsilon, as in LinearMapR3::InvertPosDefSafe.
+template<class T> inline void InvertPosDefKernel( const MatrixStreams& A, const MatrixDestStreams& D, int i, bool safe )
+{
+	T a[9];
+	LoadMatrix( A, i, a );
+	T m11 = a[0]; const T& m12 = a[1]; const T& m13 = a[2];
+	const T& m22 = a[4]; const T& m23 = a[5]; const T& m33 = a[8];
+	T epsilon = T(1.0e-5)*(m11+m22+m33);		// Threshold for being positive (if safe)
+	if ( safe ) {
+		m11 = Max( epsilon, m11 );
+	}
+	T d1 = T(1.0)/m11;
+	T aa = m12*d1;
+	T b = m13*d1;
+	T u22star = m22 - m12*aa;
+	// InvertPosDefSafe computes u23star from m12*b; InversePosDef from m13*a.
+	T u23star = safe ? m23 - m12*b : m23 - m13*aa;
+	T u33star = m33 - m13*b;
+	if ( safe ) {
+		u22star = Max( epsilon, u22star );
+	}
+	T d2 = T(1.0)/u22star;
+	T c = u23star*d2;
+	T u33starstar = u33star - u23star*c;
+	if ( safe ) {
+		u33starstar = Max( epsilon, u33starstar );
+	}
+	T d3 = T(1.0)/u33starstar;
+
+	// Compute the inverse
+	T inv[9];
+	inv[8] = d3;
+	inv[5] = inv[7] = -c*d3;
+	inv[4] = d2 - c*inv[5];
+	T acminusb = aa*c - b;
+	inv[2] = inv[6] = acminusb*d3;
+	T ad2 = aa*d2;
+	inv[1] = inv[3] = -c*inv[2] - ad2;
+	inv[0] = d1 + aa*ad2 + acminusb*inv[2];
+	StoreMatrix( D, i, inv );
+}
+
+template<class T> inline void SolveKernel( const MatrixStreams& A, const double* const b[3], double* const x[3], int i )
+{
+	T a[9], sd[9];
+	LoadMatrix( A, i, a );
+	T detInv = Subdeterminants( a, sd );
+	T ux, uy, uz;
+	LoadLanes( b[0]+i, ux );
+	LoadLanes( b[1]+i, uy );
+	LoadLanes( b[2]+i, uz );
+	StoreLanes( x[0]+i, (ux*sd[0] + uy*sd[3] + uz*sd[6])*detInv );
+	StoreLanes( x[1]+i, (ux*sd[1] + uy*sd[4] + uz*sd[7])*detInv );
+	StoreLanes( x[2]+i, (ux*sd[2] + uy*sd[5] + uz*sd[8])*detInv );
+}
+
+void Determinant( const Matrix3x3Array& A, double* dest )
+{
+	MatrixStreams a( A );
+	int n = A.PaddedSize();
+	int i = 0;
+#if LINEAR_ARRAY_USE_AVX2
+	for ( ; i<n; i+=4 ) {
+		DeterminantKernel<Lanes>( a, dest, i );
+	}
+#endif
+	for ( ; i<n; i++ ) {
+		DeterminantKernel<double>( a, dest, i );
+	}
+}
+
+void Invert( const Matrix3x3Array& A, Matrix3x3Array& dest )
+{
+	dest.Resize( A.Size() );
+	MatrixStreams a( A );
+	MatrixDestStreams d( dest );
+	int n = A.PaddedSize();
+	int i = 0;
+#if LINEAR_ARRAY_USE_AVX2
+	for ( ; i<n; i+=4 ) {
+		InvertKernel<Lanes>( a, d, i );
+	}
+#endif
+	for ( ; i<n; i++ ) {
+		InvertKernel<double>( a, d, i );
+	}
+}
+
+void InvertSym( const Matrix3x3Array& A, Matrix3x3Array& dest )
+{
+	dest.Resize( A.Size() );
+	MatrixStreams a( A );
+	MatrixDestStreams d( dest );
+	int n = A.PaddedSize();
+	int i = 0;
+#if LINEAR_ARRAY_USE_AVX2
+	for ( ; i<n; i+=4 ) {
+		InvertSymKernel<Lanes>( a, d, i );
+	}
+#endif
+	for ( ; i<n; i++ ) {
+		InvertSymKernel<double>( a, d, i );
+	}
+}
+
+// Shared by InvertPosDef and InvertPosDefSafe
+static void InvertPosDefArray( const Matrix3x3Array& A, Matrix3x3Array& dest, bool safe )
+{
+	dest.Resize( A.Size() );
+	MatrixStreams a( A );
+	MatrixDestStreams d( dest );
+	int n = A.PaddedSize();
+	int i = 0;
+#if LINEAR_ARRAY_USE_AVX2
+	for ( ; i<n; i+=4 ) {
+		InvertPosDefKernel<Lanes>( a, d, i, safe );
+	}
+#endif
+	for ( ; i<n; i++ ) {
+		InvertPosDefKernel<double>( a, d, i, safe );
+	}
+}
+
+void InvertPosDef( const Matrix3x3Array& A, Matrix3x3Array& dest )
+{
+	InvertPosDefArray( A, dest, false );
+}
+
+void InvertPosDefSafe( const Matrix3x3Array& A, Matrix3x3Array& dest )
+{
+	InvertPosDefArray( A, dest, true );
+}
+
+void Solve( const Matrix3x3Array& A, const VectorR3Array& b, VectorR3Array& x )
+{
+	assert( A.Size()==b.Size() );
+	x.Resize( A.Size() );
+	MatrixStreams a( A );
+	const double* bb[3] = { b.X(), b.Y(), b.Z() };
+	double* xx[3] = { x.X(), x.Y(), x.Z() };
+	int n = A.PaddedSize();
+	int i = 0;
+#if LINEAR_ARRAY_USE_AVX2
+	for ( ; i<n; i+=4 ) {
+		SolveKernel<Lanes>( a, bb, xx, i );
+	}
+#endif
+	for ( ; i<n; i++ ) {
+		SolveKernel<double>( a, bb, xx, i );
+	}
+}
@@ -0,0 +1,232 @@
+/*
+ *
+ * LinearR3Array.h, release 1.0.
+ *
+ * Arrays of VectorR3's and VectorR4's stored as separate streams
+ *   of x, y, z (and w) values, and arrays of 3x3 matrices stored as
+ *   separate streams of entries, with batched operations.
+ *   Each stream is aligned on a 32 byte boundary and its length is
+ *   padded to a multiple of four, so the kernels process four vectors
+ *   at a time with AVX2, with no special code for the last few vectors.
+ *   Without AVX2 the kernels are plain C++ loops, which the compiler
+ *   is free to vectorize.
+ *
+ *   The values of the padding entries are unspecified: the kernels
+ *   may write anything to them, and they are never used as results.
+ *
+ * Software is "as-is" and carries no warranty.  It may be used without
+ *   restriction, but if you modify it, please change the filenames to
+ *   prevent confusion between different versions.
+ *
+ */
+
+#ifndef LINEAR_R3_ARRAY_H
+#define LINEAR_R3_ARRAY_H
+
+#include <assert.h>
+#include "LinearR3.h"
+#include "LinearR4.h"
+
+#if defined(__AVX2__)
+#define LINEAR_ARRAY_USE_AVX2 1
+#endif
+
+class VectorR3Array;
+class VectorR4Array;
+class Matrix3x3Array;
+
+// **************************************
+// VectorR3Array class                  *
+// * * * * * * * * * * * * * * * * * * **
+
+class VectorR3Array {
+
+public:
+	VectorR3Array() : block(0), x(0), y(0), z(0), size(0), capacity(0) {}
+	explicit VectorR3Array( int n ) : block(0), x(0), y(0), z(0), size(0), capacity(0) { Resize(n); }
+	~VectorR3Array() { delete[] block; }
+
+	VectorR3Array( const VectorR3Array& ) = delete;
+	VectorR3Array& operator= ( const VectorR3Array& ) = delete;
+
+	int Size() const { return size; }
+	int PaddedSize() const { return (size+3)&~3; }
+	void Resize( int n );				// New entries are set to zero
+	void Reserve( int n );
+	void Clear() { Resize(0); }
+	void PushBack( const VectorR3& u );
+
+	VectorR3 Get( int i ) const { assert(0<=i && i<size); return VectorR3( x[i], y[i], z[i] ); }
+	void Set( int i, const VectorR3& u ) { assert(0<=i && i<size); x[i] = u.x; y[i] = u.y; z[i] = u.z; }
+	void Set( int i, double xx, double yy, double zz ) { assert(0<=i && i<size); x[i] = xx; y[i] = yy; z[i] = zz; }
+
+	// The streams (each of length PaddedSize(), aligned on 32 bytes)
+	double* X() { return x; }
+	double* Y() { return y; }
+	double* Z() { return z; }
+	const double* X() const { return x; }
+	const double* Y() const { return y; }
+	const double* Z() const { return z; }
+
+	// Load from, or store to, interleaved floats (e.g., a VBO).
+	//    The i-th vector is at src[i*stride], src[i*stride+1], src[i*stride+2].
+	//    Load() resizes the array to n.  Store() stores Size() vectors.
+	void Load( const float* src, int n, int stride = 3 );
+	void Store( float* dest, int stride = 3 ) const;
+
+private:
+	double* block;				// Allocated memory; x, y, z point into this
+	double* x;
+	double* y;
+	double* z;
+	int size;					// Number of vectors
+	int capacity;				// Length of each stream, a multiple of four
+
+	void Reallocate( int newCapacity );
+};
+
+// **************************************
+// VectorR4Array class                  *
+// * * * * * * * * * * * * * * * * * * **
+
+class VectorR4Array {
+
+public:
+	VectorR4Array() : block(0), x(0), y(0), z(0), w(0), size(0), capacity(0) {}
+	explicit VectorR4Array( int n ) : block(0), x(0), y(0), z(0), w(0), size(0), capacity(0) { Resize(n); }
+	~VectorR4Array() { delete[] block; }
+
+	VectorR4Array( const VectorR4Array& ) = delete;
+	VectorR4Array& operator= ( const VectorR4Array& ) = delete;
+
+	int Size() const { return size; }
+	int PaddedSize() const { return (size+3)&~3; }
+	void Resize( int n );				// New entries are set to zero
+	void Reserve( int n );
+	void Clear() { Resize(0); }
+	void PushBack( const VectorR4& u );
+
+	VectorR4 Get( int i ) const { assert(0<=i && i<size); return VectorR4( x[i], y[i], z[i], w[i] ); }
+	void Set( int i, const VectorR4& u ) { assert(0<=i && i<size); x[i] = u.x; y[i] = u.y; z[i] = u.z; w[i] = u.w; }
+
+	double* X() { return x; }
+	double* Y() { return y; }
+	double* Z() { return z; }
+	double* W() { return w; }
+	const double* X() const { return x; }
+	const double* Y() const { return y; }
+	const double* Z() const { return z; }
+	const double* W() const { return w; }
+
+private:
+	double* block;
+	double* x;
+	double* y;
+	double* z;
+	double* w;
+	int size;
+	int capacity;
+
+	void Reallocate( int newCapacity );
+};
+
+// **************************************
+// Matrix3x3Array class                 *
+// * * * * * * * * * * * * * * * * * * **
+
+// An array of 3x3 matrices, stored as nine streams, one for each entry.
+class Matrix3x3Array {
+
+public:
+	Matrix3x3Array() : block(0), size(0), capacity(0) { SetStreams(0, 0); }
+	explicit Matrix3x3Array( int n ) : block(0), size(0), capacity(0) { SetStreams(0, 0); Resize(n); }
+	~Matrix3x3Array() { delete[] block; }
+
+	Matrix3x3Array( const Matrix3x3Array& ) = delete;
+	Matrix3x3Array& operator= ( const Matrix3x3Array& ) = delete;
+
+	int Size() const { return size; }
+	int PaddedSize() const { return (size+3)&~3; }
+	void Resize( int n );				// New entries are set to zero
+	void Reserve( int n );
+	void Clear() { Resize(0); }
+	void PushBack( const Matrix3x3& A );
+
+	LinearMapR3 Get( int i ) const;
+	void Set( int i, const Matrix3x3& A );
+
+	// The stream of (row,col) entries, for 1 <= row, col <= 3.
+	//    E.g., Entries(2,3) holds the m23 entries of the matrices.
+	double* Entries( int row, int col ) { assert(1<=row && row<=3 && 1<=col && col<=3); return m[3*row+col-4]; }
+	const double* Entries( int row, int col ) const { assert(1<=row && row<=3 && 1<=col && col<=3); return m[3*row+col-4]; }
+
+private:
+	double* block;
+	double* m[9];				// The streams, in the order m11, m12, m13, m21, ..., m33
+	int size;
+	int capacity;
+
+	void SetStreams( double* start, int streamLength );
+	void Reallocate( int newCapacity );
+};
+
+inline LinearMapR3 Matrix3x3Array::Get( int i ) const
+{
+	assert(0<=i && i<size);
+	return LinearMapR3( m[0][i], m[3][i], m[6][i],			// Column by column
+						m[1][i], m[4][i], m[7][i],
+						m[2][i], m[5][i], m[8][i] );
+}
+
+inline void Matrix3x3Array::Set( int i, const Matrix3x3& A )
+{
+	assert(0<=i && i<size);
+	m[0][i] = A.m11; m[1][i] = A.m12; m[2][i] = A.m13;
+	m[3][i] = A.m21; m[4][i] = A.m22; m[5][i] = A.m23;
+	m[6][i] = A.m31; m[7][i] = A.m32; m[8][i] = A.m33;
+}
+
+// **************************************
+// Batched operations                   *
+// * * * * * * * * * * * * * * * * * * **
+
+// In all of these, the destination array is resized to match the source,
+//   and may be the same array as a source (the operations are done in place).
+//   Sources given as a pair must have the same size.
+
+// Batched versions of LinearMapR4::AffineTransformPosition and AffineTransformDirection.
+//   A must be affine.
+void AffineTransformPositions( const LinearMapR4& A, const VectorR3Array& src, VectorR3Array& dest );
+void AffineTransformDirections( const LinearMapR4& A, const VectorR3Array& src, VectorR3Array& dest );
+// dest[i] = A*src[i], for any 4x4 matrix A
+void Transform( const LinearMapR4& A, const VectorR4Array& src, VectorR4Array& dest );
+
+// dest[i] = u[i]^v[i]  (dot product).  dest must have room for u.PaddedSize() values.
+void Dot( const VectorR3Array& u, const VectorR3Array& v, double* dest );
+// dest[i] = u[i]*v[i]  (cross product)
+void Cross( const VectorR3Array& u, const VectorR3Array& v, VectorR3Array& dest );
+// Normalize each vector in place.  Zero vectors are left equal to zero (as in VectorR3::MakeUnit).
+void Normalize( VectorR3Array& u );
+// dest[i] = (1-alpha)*u[i] + alpha*v[i]   (as in Lerp for VectorR3's)
+void Lerp( const VectorR3Array& u, const VectorR3Array& v, double alpha, VectorR3Array& dest );
+
+// The axis aligned bounding box of the vectors.  The array must not be empty.
+void BoundingBox( const VectorR3Array& u, VectorR3* boxMin, VectorR3* boxMax );
+
+// Batched versions of the LinearMapR3 inverses and Matrix3x3::Solve.
+//   Each uses the same formulas as the single matrix version, and gives the same results.
+//   Nothing is checked: singular (or non-positive definite) matrices give infinite or NaN results.
+// dest[i] = determinant of A[i].  dest must have room for A.PaddedSize() values.
+void Determinant( const Matrix3x3Array& A, double* dest );
+// dest[i] = inverse of A[i]  (as LinearMapR3::Inverse)
+void Invert( const Matrix3x3Array& A, Matrix3x3Array& dest );
+// Inverses of symmetric matrices, using only the lower part of A[i]  (as LinearMapR3::InverseSym)
+void InvertSym( const Matrix3x3Array& A, Matrix3x3Array& dest );
+// Inverses of symmetric positive definite matrices  (as LinearMapR3::InversePosDef)
+void InvertPosDef( const Matrix3x3Array& A, Matrix3x3Array& dest );
+// Inverses of nearly positive definite matrices  (as LinearMapR3::InvertPosDefSafe)
+void InvertPosDefSafe( const Matrix3x3Array& A, Matrix3x3Array& dest );
+// x[i] = solution of A[i]*x[i] = b[i]  (as Matrix3x3::Solve).  x may be the same array as b.
+void Solve( const Matrix3x3Array& A, const VectorR3Array& b, VectorR3Array& x );
+
+#endif // LINEAR_R3_ARRAY_H
@@ -33,6 +33,7 @@ const VectorR4 VectorR4::Zero;
 //const VectorR4 VectorR4::NegUnitZ( 0.0, 0.0,-1.0, 0.0);
 //const VectorR4 VectorR4::NegUnitW( 0.0, 0.0, 0.0,-1.0);
 
+// The constructor is constexpr, so Identity is initialized at compile time.
 const Matrix4x4 Matrix4x4::Identity(1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0,
 									0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0);
 
@@ -59,42 +60,6 @@ double VectorR4::MaxAbs() const
 // * * * * * * * * * * * * * * * * * * * * * * * * * * **
 
 
-void Matrix4x4::operator*= (const Matrix4x4& B)	// Matrix product
-{
-	double t1, t2, t3;		// temporary values
-	t1 =  m11*B.m11 + m12*B.m21 + m13*B.m31 + m14*B.m41;
-	t2 =  m11*B.m12 + m12*B.m22 + m13*B.m32 + m14*B.m42;
-	t3 =  m11*B.m13 + m12*B.m23 + m13*B.m33 + m14*B.m43;
-	m14 = m11*B.m14 + m12*B.m24 + m13*B.m34 + m14*B.m44;
-	m11 = t1;
-	m12 = t2;
-	m13 = t3;
-
-	t1 =  m21*B.m11 + m22*B.m21 + m23*B.m31 + m24*B.m41;
-	t2 =  m21*B.m12 + m22*B.m22 + m23*B.m32 + m24*B.m42;
-	t3 =  m21*B.m13 + m22*B.m23 + m23*B.m33 + m24*B.m43;
-	m24 = m21*B.m14 + m22*B.m24 + m23*B.m34 + m24*B.m44;
-	m21 = t1;
-	m22 = t2;
-	m23 = t3;
-
-	t1 =  m31*B.m11 + m32*B.m21 + m33*B.m31 + m34*B.m41;
-	t2 =  m31*B.m12 + m32*B.m22 + m33*B.m32 + m34*B.m42;
-	t3 =  m31*B.m13 + m32*B.m23 + m33*B.m33 + m34*B.m43;
-	m34 = m31*B.m14 + m32*B.m24 + m33*B.m34 + m34*B.m44;
-	m31 = t1;
-	m32 = t2;
-	m33 = t3;
-
-	t1 =  m41*B.m11 + m42*B.m21 + m43*B.m31 + m44*B.m41;
-	t2 =  m41*B.m12 + m42*B.m22 + m43*B.m32 + m44*B.m42;
-	t3 =  m41*B.m13 + m42*B.m23 + m43*B.m33 + m44*B.m43;
-	m44 = m41*B.m14 + m42*B.m24 + m43*B.m34 + m44*B.m44;
-	m41 = t1;
-	m42 = t2;
-	m43 = t3;
-}
-
 inline void ReNormalizeHelper ( double &a, double &b, double &c, double &d )
 {
 	register double scaleF = a*a+b*b+c*c+d*d;		// Inner product of Vector-R4
@@ -172,6 +137,9 @@ double LinearMapR4::Determinant () const		// Returns the determinant
 
 LinearMapR4 LinearMapR4::Inverse() const			// Returns inverse
 {
+	if ( IsAffine3x4() ) {
+		return InverseAffine();
+	}
 
 	double Tbt34C12 = m31*m42-m32*m41;		// 2x2 subdeterminants
 	double Tbt34C13 = m31*m43-m33*m41;
@@ -220,6 +188,9 @@ LinearMapR4 LinearMapR4::Inverse() const			// Returns inverse
 
 LinearMapR4& LinearMapR4::Invert() 			// Converts into inverse.
 {
+	if ( IsAffine3x4() ) {
+		return InvertAffine();
+	}
 	double Tbt34C12 = m31*m42-m32*m41;		// 2x2 subdeterminants
 	double Tbt34C13 = m31*m43-m33*m41;
 	double Tbt34C14 = m31*m44-m34*m41;
@@ -278,6 +249,79 @@ LinearMapR4& LinearMapR4::Invert() 			// Converts into inverse.
 	return ( *this );
 }
 
+// Inverse of an affine matrix [A t; 0 0 0 1] is [A^{-1}  -A^{-1}t; 0 0 0 1].
+//   A^{-1} is computed from the 3x3 cofactors, as in LinearMapR3::Inverse.
+LinearMapR4 LinearMapR4::InverseAffine() const
+{
+	assert( IsAffine3x4() );
+	double sd11 = m22*m33-m23*m32;		// 2x2 subdeterminants
+	double sd21 = m32*m13-m12*m33;
+	double sd31 = m12*m23-m22*m13;
+	double sd12 = m31*m23-m21*m33;
+	double sd22 = m11*m33-m31*m13;
+	double sd32 = m21*m13-m11*m23;
+	double sd13 = m21*m32-m31*m22;
+	double sd23 = m31*m12-m11*m32;
+	double sd33 = m11*m22-m21*m12;
+
+	register double detInv = 1.0/(m11*sd11 + m12*sd12 + m13*sd13);
+
+	double i11 = sd11*detInv;
+	double i12 = sd21*detInv;
+	double i13 = sd31*detInv;
+	double i21 = sd12*detInv;
+	double i22 = sd22*detInv;
+	double i23 = sd32*detInv;
+	double i31 = sd13*detInv;
+	double i32 = sd23*detInv;
+	double i33 = sd33*detInv;
+
+	return( LinearMapR4( i11, i21, i31, 0.0,
+						 i12, i22, i32, 0.0,
+						 i13, i23, i33, 0.0,
+						 -(i11*m14 + i12*m24 + i13*m34),
+						 -(i21*m14 + i22*m24 + i23*m34),
+						 -(i31*m14 + i32*m24 + i33*m34), 1.0 ) );
+}
+
+LinearMapR4& LinearMapR4::InvertAffine()
+{
+	*this = InverseAffine();
+	return ( *this );
+}
+
+// Inverse of a rigid motion [R t; 0 0 0 1], R a rotation, is [R^T  -R^T t; 0 0 0 1].
+LinearMapR4 LinearMapR4::InverseRigid() const
+{
+	assert( IsRigid() );
+	return( LinearMapR4( m11, m12, m13, 0.0,
+						 m21, m22, m23, 0.0,
+						 m31, m32, m33, 0.0,
+						 -(m11*m14 + m21*m24 + m31*m34),
+						 -(m12*m14 + m22*m24 + m32*m34),
+						 -(m13*m14 + m23*m24 + m33*m34), 1.0 ) );
+}
+
+LinearMapR4& LinearMapR4::InvertRigid()
+{
+	*this = InverseRigid();
+	return ( *this );
+}
+
+bool LinearMapR4::IsRigid(double tolerance) const
+{
+	if ( !IsAffine3x4() ) {
+		return false;
+	}
+	// The columns of the 3x3 part must be orthonormal, and form a right-handed frame.
+	VectorR3 c1(m11, m21, m31);
+	VectorR3 c2(m12, m22, m32);
+	VectorR3 c3(m13, m23, m33);
+	return ( c1.IsUnit(tolerance) && c2.IsUnit(tolerance) && c3.IsUnit(tolerance)
+		&& fabs(c1^c2)<=tolerance && fabs(c1^c3)<=tolerance && fabs(c2^c3)<=tolerance
+		&& ((c1*c2)^c3)>0.0 );
+}
+
 VectorR4 LinearMapR4::Solve(const VectorR4& u) const	// Returns solution
 {												
 	// Just uses Inverse() for now.
@@ -341,31 +385,6 @@ LinearMapR4& LinearMapR4::Set_glOrtho(double left, double right,
 //   Most of them are inlined in the header file
 
 
-LinearMapR4& LinearMapR4::Set_glRotate(double costheta, double sintheta, double x, double y, double z)
-{
-	double normSq = x * x + y * y + z * z;
-	assert(normSq > 0.0);
-	double normInv = 1.0 / sqrt(normSq);
-	x *= normInv;
-	y *= normInv;
-	z *= normInv;
-	double omC = 1 - costheta;
-	double omCx = omC * x;
-	double omCy = omC * y;
-	double omCz = omC * z;
-	m11 = omCx * x + costheta;
-	m21 = omCx * y + sintheta * z;
-	m31 = omCx * z - sintheta * y;
-	m12 = omCy * x - sintheta * z;
-	m22 = omCy * y + costheta;
-	m32 = omCy * z + sintheta * x;
-	m13 = omCz * x + sintheta * y;
-	m23 = omCz * y - sintheta * x;
-	m33 = omCz * z + costheta;
-	m41 = m42 = m43 = m14 = m24 = m34 = 0.0;
-	m44 = 1.0;
-	return *this;
-}
 
 
 LinearMapR4& LinearMapR4::Set_glFrustum(double left, double right, double bottom, double top, double near, double far)
@@ -69,8 +69,8 @@ public:
 	//static const VectorR4 NegUnitW;
 
 public:
-	VectorR4( ) : x(0.0), y(0.0), z(0.0), w(0.0) {}
-	VectorR4( double xVal, double yVal, double zVal, double wVal )
+	constexpr VectorR4( ) : x(0.0), y(0.0), z(0.0), w(0.0) {}
+	constexpr VectorR4( double xVal, double yVal, double zVal, double wVal )
 		: x(xVal), y(yVal), z(zVal), w(wVal) {}
 	// VectorR4( const Quaternion& q);			// Definition with Quaternion routines
 	
@@ -129,16 +129,16 @@ public:
 
 };
 
-inline VectorR4 operator+( const VectorR4& u, const VectorR4& v );
-inline VectorR4 operator-( const VectorR4& u, const VectorR4& v ); 
-inline VectorR4 operator*( const VectorR4& u, double m); 
-inline VectorR4 operator*( double m, const VectorR4& u); 
-inline VectorR4 operator/( const VectorR4& u, double m); 
+inline constexpr VectorR4 operator+( const VectorR4& u, const VectorR4& v );
+inline constexpr VectorR4 operator-( const VectorR4& u, const VectorR4& v ); 
+inline constexpr VectorR4 operator*( const VectorR4& u, double m); 
+inline constexpr VectorR4 operator*( double m, const VectorR4& u); 
+inline constexpr VectorR4 operator/( const VectorR4& u, double m); 
 inline bool operator==( const VectorR4& u, const VectorR4& v ); 
 
-inline double operator^ (const VectorR4& u, const VectorR4& v ); // Dot Product
-inline double InnerProduct(const VectorR4& u, const VectorR4& v ) { return (u^v); }
-inline VectorR4 ArrayProd(const VectorR4& u, const VectorR4& v );
+inline constexpr double operator^ (const VectorR4& u, const VectorR4& v ); // Dot Product
+inline constexpr double InnerProduct(const VectorR4& u, const VectorR4& v ) { return (u^v); }
+inline constexpr VectorR4 ArrayProd(const VectorR4& u, const VectorR4& v );
 
 inline double Mag(const VectorR4& u) { return u.Norm(); }
 inline double Dist(const VectorR4& u, const VectorR4& v) { return u.Dist(v); }
@@ -162,9 +162,9 @@ public:
 public:
 
 	Matrix4x4();
-	Matrix4x4( const VectorR4&, const VectorR4&, 
+	constexpr Matrix4x4( const VectorR4&, const VectorR4&, 
 					const VectorR4&, const VectorR4& );	// Sets by columns!
-	Matrix4x4( double, double, double, double, 
+	constexpr Matrix4x4( double, double, double, double, 
 					 double, double, double, double,
 					 double, double, double, double,
 					 double, double, double, double );	// Sets by columns
@@ -203,7 +203,16 @@ public:
 	inline double Diagonal( int );
 
 	inline void MakeTranspose();					// Transposes it.
-	void operator*= (const Matrix4x4& B); // Matrix product	
+	constexpr void operator*= (const Matrix4x4& B); // Matrix product	
+	// Fast paths for the matrix product:
+	//   MultAffine(B) requires both matrices to have bottom row 0,0,0,1 (see IsAffine3x4),
+	//      and only forms the 3x4 product.  operator*= calls it automatically.
+	//   MultLinear3x3(B) requires B to have the form [3x3 0; 0 0 0 1] (e.g., a rotation),
+	//      and only updates the first three columns.
+	constexpr void MultAffine(const Matrix4x4& B);
+	constexpr void MultLinear3x3(const Matrix4x4& B);
+	// True if the bottom row is exactly 0,0,0,1, so the matrix is determined by its top 3x4 part.
+	inline constexpr bool IsAffine3x4() const;
 
 	Matrix4x4& ReNormalize();
 
@@ -211,7 +220,7 @@ public:
 
 };
 
-inline VectorR4 operator* ( const Matrix4x4&, const VectorR4& );
+inline constexpr VectorR4 operator* ( const Matrix4x4&, const VectorR4& );
 
 ostream& operator<< ( ostream& os, const Matrix4x4& A );
 
@@ -224,68 +233,80 @@ class LinearMapR4 : public Matrix4x4 {
 
 public:
 
-	LinearMapR4();
-	LinearMapR4( const VectorR4&, const VectorR4&, 
+	constexpr LinearMapR4();
+	constexpr LinearMapR4( const VectorR4&, const VectorR4&, 
 					const VectorR4&, const VectorR4& );	// Sets by columns!
-	LinearMapR4( double, double, double, double, 
+	constexpr LinearMapR4( double, double, double, double, 
 					 double, double, double, double,
 					 double, double, double, double,
 					 double, double, double, double );	// Sets by columns
-	LinearMapR4 ( const Matrix4x4& );
+	constexpr LinearMapR4 ( const Matrix4x4& );
 
 	inline LinearMapR4& operator+= (const LinearMapR4& );
 	inline LinearMapR4& operator-= (const LinearMapR4& );
 	inline LinearMapR4& operator*= (double);
 	inline LinearMapR4& operator/= (double);
-	inline LinearMapR4& operator*= (const Matrix4x4& );	// Matrix product
+	inline constexpr LinearMapR4& operator*= (const Matrix4x4& );	// Matrix product
 
-	inline LinearMapR4 Transpose() const;
+	inline constexpr LinearMapR4 Transpose() const;
 	double Determinant () const;			// Returns the determinant
 	LinearMapR4 Inverse() const;			// Returns inverse
 	LinearMapR4& Invert();					// Converts into inverse.
 	VectorR4 Solve(const VectorR4&) const;	// Returns solution
+	// Inverses of special matrices.  Inverse() and Invert() use InverseAffine()
+	//   automatically when the bottom row is 0,0,0,1.
+	//   InverseRigid() is for rotations followed by translations (see IsRigid()).
+	//      It must be requested explicitly, since checking for it is as slow as the inverse.
+	LinearMapR4 InverseAffine() const;		// Requires IsAffine3x4()
+	LinearMapR4& InvertAffine();
+	LinearMapR4 InverseRigid() const;		// Requires IsRigid()
+	LinearMapR4& InvertRigid();
 	LinearMapR4 PseudoInverse() const;		// Returns pseudo-inverse TO DO
 	VectorR4 PseudoSolve(const VectorR4&);	// Finds least squares solution TO DO
 
     bool IsAffine() const;           // Check if represents affine transformation
+    bool IsRigid(double tolerance = 1.0e-6) const;  // Affine, with orthonormal 3x3 part of determinant 1
     void AffineTransformPosition(VectorR3& dest) const;
     void AffineTransformDirection(VectorR3& dest) const;
 
 	// Reproduce OpenGL Projection and Modelview Matrix operations.
 	//  EXCEPT: these routines use radians, not degrees.  (!)
-	LinearMapR4& Set_glScale(double xyzScale);
-	LinearMapR4& Mult_glScale(double xyzScale);
-	LinearMapR4& Set_glScale(double xScale, double yScale, double zScale);
-	LinearMapR4& Mult_glScale(double xScale, double yScale, double zScale);
-	LinearMapR4& Set_glTranslate(double xTranslation, double yTranslation, double zTranslation);
-	LinearMapR4& Mult_glTranslate(double xTranslation, double yTranslation, double zTranslation);
-	LinearMapR4& Set_glTranslate(const VectorR3& translation);
-	LinearMapR4& Mult_glTranslate(const VectorR3& translation);
+	// The scale and translate routines, and the rotate routines taking
+	//   costheta and sintheta, are constexpr.  So fixed transforms can be
+	//   computed at compile time, using ConstCos and ConstSin from MathMisc.h.
+	constexpr LinearMapR4& Set_glScale(double xyzScale);
+	constexpr LinearMapR4& Mult_glScale(double xyzScale);
+	constexpr LinearMapR4& Set_glScale(double xScale, double yScale, double zScale);
+	constexpr LinearMapR4& Mult_glScale(double xScale, double yScale, double zScale);
+	constexpr LinearMapR4& Set_glTranslate(double xTranslation, double yTranslation, double zTranslation);
+	constexpr LinearMapR4& Mult_glTranslate(double xTranslation, double yTranslation, double zTranslation);
+	constexpr LinearMapR4& Set_glTranslate(const VectorR3& translation);
+	constexpr LinearMapR4& Mult_glTranslate(const VectorR3& translation);
 	LinearMapR4& Set_glRotate(double radians, double x, double y, double z);
 	LinearMapR4& Mult_glRotate(double radians, double x, double y, double z);
 	LinearMapR4& Set_glRotate(double radians, const VectorR3& axis);
 	LinearMapR4& Mult_glRotate(double radians, const VectorR3& axis);
-	LinearMapR4& Set_glRotate(double costheta, double sintheta, double x, double y, double z);
-	LinearMapR4& Mult_glRotate(double costheta, double sintheta, double x, double y, double z);
-	LinearMapR4& Set_glRotate(double costheta, double sintheta, const VectorR3& axis);
-	LinearMapR4& Mult_glRotate(double costheta, double sintheta, const VectorR3& axis);
+	constexpr LinearMapR4& Set_glRotate(double costheta, double sintheta, double x, double y, double z);
+	constexpr LinearMapR4& Mult_glRotate(double costheta, double sintheta, double x, double y, double z);
+	constexpr LinearMapR4& Set_glRotate(double costheta, double sintheta, const VectorR3& axis);
+	constexpr LinearMapR4& Mult_glRotate(double costheta, double sintheta, const VectorR3& axis);
 	LinearMapR4& Set_glFrustum(double left, double right, double bottom, double top, double near, double far);
     LinearMapR4& Set_glOrtho(double left, double right, double bottom, double top, double near, double far);
     LinearMapR4& Set_gluPerspective(double fieldofview_y_Radians, double aspectRatio, double zNear, double zFar);
     LinearMapR4& Set_gluLookAt(const VectorR3& eyePos, const VectorR3& lookAtPos, const VectorR3& upDir);
 };
 
-inline LinearMapR4 operator+ (const LinearMapR4&, const LinearMapR4&);
-inline LinearMapR4 operator- (const LinearMapR4&);
-inline LinearMapR4 operator- (const LinearMapR4&, const LinearMapR4&);
-inline LinearMapR4 operator* ( const LinearMapR4&, double);
-inline LinearMapR4 operator* ( double, const LinearMapR4& );
-inline LinearMapR4 operator/ ( const LinearMapR4&, double );
+inline constexpr LinearMapR4 operator+ (const LinearMapR4&, const LinearMapR4&);
+inline constexpr LinearMapR4 operator- (const LinearMapR4&);
+inline constexpr LinearMapR4 operator- (const LinearMapR4&, const LinearMapR4&);
+inline constexpr LinearMapR4 operator* ( const LinearMapR4&, double);
+inline constexpr LinearMapR4 operator* ( double, const LinearMapR4& );
+inline constexpr LinearMapR4 operator/ ( const LinearMapR4&, double );
 
 // Matrix product (composition)
-inline LinearMapR4 operator* ( const Matrix4x4&, const LinearMapR4& ); 
-inline LinearMapR4 operator* (const LinearMapR4&, const Matrix4x4&);
-inline LinearMapR4 operator* (const LinearMapR4&, const LinearMapR4&);
+inline constexpr LinearMapR4 operator* ( const Matrix4x4&, const LinearMapR4& ); 
+inline constexpr LinearMapR4 operator* (const LinearMapR4&, const Matrix4x4&);
+inline constexpr LinearMapR4 operator* (const LinearMapR4&, const LinearMapR4&);
 
 // ***************************************************************
 // * 4-space vector and matrix utilities (prototypes)			 *
@@ -317,13 +338,15 @@ inline VectorR4 ProjectPerpUnitDiff ( const VectorR4& u, const VectorR4& v);
 // Returns the projection of u onto unit v
 inline VectorR4 ProjectToUnit ( const VectorR4& u, const VectorR4& v)
 {
-	return (u^v)*v;
+	double d = u^v;			// Computed componentwise, with no temporary vectors
+	return VectorR4( d*v.x, d*v.y, d*v.z, d*v.w );
 }
 
 // Returns the projection of u onto the plane perpindicular to the unit vector v
 inline VectorR4 ProjectPerpUnit ( const VectorR4& u, const VectorR4& v)
 {
-	return ( u - ((u^v)*v) );
+	double d = u^v;
+	return VectorR4( u.x-d*v.x, u.y-d*v.y, u.z-d*v.z, u.w-d*v.w );
 }
 
 // Returns the projection of u onto the plane perpindicular to the unit vector v
@@ -332,7 +355,11 @@ inline VectorR4 ProjectPerpUnitDiff ( const VectorR4& u, const VectorR4& v)
 {
 	VectorR4 ans = u;
 	ans -= v;
-	ans -= ((ans^v)*v);
+	double d = ans^v;
+	ans.x -= d*v.x;
+	ans.y -= d*v.y;
+	ans.z -= d*v.z;
+	ans.w -= d*v.w;
 	return ans;				// ans = (u-v) - ((u-v)^v)*v
 }
 
@@ -430,25 +457,25 @@ inline VectorR4& VectorR4::MakeUnit ()			// Convert to unit vector (or leave zer
 	return *this;
 }
 
-inline VectorR4 operator+( const VectorR4& u, const VectorR4& v ) 
+inline constexpr VectorR4 operator+( const VectorR4& u, const VectorR4& v ) 
 { 
 	return VectorR4(u.x+v.x, u.y+v.y, u.z+v.z, u.w+v.w ); 
 }
-inline VectorR4 operator-( const VectorR4& u, const VectorR4& v ) 
+inline constexpr VectorR4 operator-( const VectorR4& u, const VectorR4& v ) 
 { 
 	return VectorR4(u.x-v.x, u.y-v.y, u.z-v.z, u.w-v.w); 
 }
-inline VectorR4 operator*( const VectorR4& u, register double m) 
+inline constexpr VectorR4 operator*( const VectorR4& u, double m) 
 { 
 	return VectorR4( u.x*m, u.y*m, u.z*m, u.w*m ); 
 }
-inline VectorR4 operator*( register double m, const VectorR4& u) 
+inline constexpr VectorR4 operator*( double m, const VectorR4& u) 
 { 
 	return VectorR4( u.x*m, u.y*m, u.z*m, u.w*m ); 
 }
-inline VectorR4 operator/( const VectorR4& u, double m) 
+inline constexpr VectorR4 operator/( const VectorR4& u, double m) 
 { 
-	register double mInv = 1.0/m;
+	double mInv = 1.0/m;
 	return VectorR4( u.x*mInv, u.y*mInv, u.z*mInv, u.w*mInv ); 
 }
 
@@ -457,12 +484,12 @@ inline bool operator==( const VectorR4& u, const VectorR4& v )
 	return ( u.x==v.x && u.y==v.y && u.z==v.z && u.w==v.w );
 }
 
-inline double operator^ ( const VectorR4& u, const VectorR4& v ) // Dot Product
+inline constexpr double operator^ ( const VectorR4& u, const VectorR4& v ) // Dot Product
 { 
 	return ( u.x*v.x + u.y*v.y + u.z*v.z + u.w*v.w ); 
 }
 
-inline VectorR4 ArrayProd ( const VectorR4& u, const VectorR4& v )
+inline constexpr VectorR4 ArrayProd ( const VectorR4& u, const VectorR4& v )
 {
 	return ( VectorR4( u.x*v.x, u.y*v.y, u.z*v.z, u.w*v.w ) );
 }
@@ -536,50 +563,25 @@ inline double VectorR4::DistSq( const VectorR4& u ) const	// Distance from u
 
 inline Matrix4x4::Matrix4x4() {}
 
-inline Matrix4x4::Matrix4x4( const VectorR4& u, const VectorR4& v, 
+// The constructors are constexpr, so constant matrices can be computed at compile time.
+inline constexpr Matrix4x4::Matrix4x4( const VectorR4& u, const VectorR4& v, 
 							 const VectorR4& s, const VectorR4& t)
-{
-	m11 = u.x;		// Column 1
-	m21 = u.y;
-	m31 = u.z;
-	m41 = u.w;
-	m12 = v.x;		// Column 2
-	m22 = v.y;
-	m32 = v.z;
-	m42 = v.w;
-	m13 = s.x;		// Column 3
-	m23 = s.y;
-	m33 = s.z;
-	m43 = s.w;
-	m14 = t.x;		// Column 4
-	m24 = t.y;
-	m34 = t.z;
-	m44 = t.w;
-}
+	: m11(u.x), m21(u.y), m31(u.z), m41(u.w),		// Column 1
+	  m12(v.x), m22(v.y), m32(v.z), m42(v.w),		// Column 2
+	  m13(s.x), m23(s.y), m33(s.z), m43(s.w),		// Column 3
+	  m14(t.x), m24(t.y), m34(t.z), m44(t.w)		// Column 4
+{ }
 
-inline Matrix4x4::Matrix4x4( double a11, double a21, double a31, double a41,
+inline constexpr Matrix4x4::Matrix4x4( double a11, double a21, double a31, double a41,
 							 double a12, double a22, double a32, double a42,
 							 double a13, double a23, double a33, double a43,
 							 double a14, double a24, double a34, double a44)
 					// Values specified in column order!!!
-{
-	m11 = a11;		// Row 1
-	m12 = a12;
-	m13 = a13;
-	m14 = a14;
-	m21 = a21;		// Row 2
-	m22 = a22;
-	m23 = a23;
-	m24 = a24;
-	m31 = a31;		// Row 3
-	m32 = a32;
-	m33 = a33;
-	m34 = a34;
-	m41 = a41;		// Row 4
-	m42 = a42;
-	m43 = a43;
-	m44 = a44;
-}
+	: m11(a11), m21(a21), m31(a31), m41(a41),
+	  m12(a12), m22(a22), m32(a32), m42(a42),
+	  m13(a13), m23(a23), m33(a33), m43(a43),
+	  m14(a14), m24(a24), m34(a34), m44(a44)
+{ }
 
 /*
 inline Matrix4x4::Matrix4x4 ( const Matrix4x4& A)
@@ -846,7 +848,118 @@ inline void Matrix4x4::MakeTranspose()	// Transposes it.
 	m43 = temp;
 }
 
-inline VectorR4 operator* ( const Matrix4x4& A, const VectorR4& u)
+inline constexpr bool Matrix4x4::IsAffine3x4() const
+{
+	return ( m41==0.0 && m42==0.0 && m43==0.0 && m44==1.0 );
+}
+
+inline constexpr void Matrix4x4::operator*= (const Matrix4x4& B)	// Matrix product
+{
+	// Modelview matrices are almost always affine: use the 3x4 product.
+	//   This gives the same result as the general product (except possibly the sign of a zero).
+	if ( IsAffine3x4() && B.IsAffine3x4() ) {
+		MultAffine(B);
+		return;
+	}
+
+	double t1 = 0.0, t2 = 0.0, t3 = 0.0;		// temporary values
+	t1 =  m11*B.m11 + m12*B.m21 + m13*B.m31 + m14*B.m41;
+	t2 =  m11*B.m12 + m12*B.m22 + m13*B.m32 + m14*B.m42;
+	t3 =  m11*B.m13 + m12*B.m23 + m13*B.m33 + m14*B.m43;
+	m14 = m11*B.m14 + m12*B.m24 + m13*B.m34 + m14*B.m44;
+	m11 = t1;
+	m12 = t2;
+	m13 = t3;
+
+	t1 =  m21*B.m11 + m22*B.m21 + m23*B.m31 + m24*B.m41;
+	t2 =  m21*B.m12 + m22*B.m22 + m23*B.m32 + m24*B.m42;
+	t3 =  m21*B.m13 + m22*B.m23 + m23*B.m33 + m24*B.m43;
+	m24 = m21*B.m14 + m22*B.m24 + m23*B.m34 + m24*B.m44;
+	m21 = t1;
+	m22 = t2;
+	m23 = t3;
+
+	t1 =  m31*B.m11 + m32*B.m21 + m33*B.m31 + m34*B.m41;
+	t2 =  m31*B.m12 + m32*B.m22 + m33*B.m32 + m34*B.m42;
+	t3 =  m31*B.m13 + m32*B.m23 + m33*B.m33 + m34*B.m43;
+	m34 = m31*B.m14 + m32*B.m24 + m33*B.m34 + m34*B.m44;
+	m31 = t1;
+	m32 = t2;
+	m33 = t3;
+
+	t1 =  m41*B.m11 + m42*B.m21 + m43*B.m31 + m44*B.m41;
+	t2 =  m41*B.m12 + m42*B.m22 + m43*B.m32 + m44*B.m42;
+	t3 =  m41*B.m13 + m42*B.m23 + m43*B.m33 + m44*B.m43;
+	m44 = m41*B.m14 + m42*B.m24 + m43*B.m34 + m44*B.m44;
+	m41 = t1;
+	m42 = t2;
+	m43 = t3;
+}
+
+// Product of two matrices with bottom rows equal to 0,0,0,1.
+//   The terms multiplied by the zeros in B's bottom row are skipped,
+//   and the bottom row of *this is unchanged.
+inline constexpr void Matrix4x4::MultAffine (const Matrix4x4& B)
+{
+	assert( IsAffine3x4() && B.IsAffine3x4() );
+	double t1 = 0.0, t2 = 0.0, t3 = 0.0;		// temporary values
+	t1 =  m11*B.m11 + m12*B.m21 + m13*B.m31;
+	t2 =  m11*B.m12 + m12*B.m22 + m13*B.m32;
+	t3 =  m11*B.m13 + m12*B.m23 + m13*B.m33;
+	m14 = m11*B.m14 + m12*B.m24 + m13*B.m34 + m14;
+	m11 = t1;
+	m12 = t2;
+	m13 = t3;
+
+	t1 =  m21*B.m11 + m22*B.m21 + m23*B.m31;
+	t2 =  m21*B.m12 + m22*B.m22 + m23*B.m32;
+	t3 =  m21*B.m13 + m22*B.m23 + m23*B.m33;
+	m24 = m21*B.m14 + m22*B.m24 + m23*B.m34 + m24;
+	m21 = t1;
+	m22 = t2;
+	m23 = t3;
+
+	t1 =  m31*B.m11 + m32*B.m21 + m33*B.m31;
+	t2 =  m31*B.m12 + m32*B.m22 + m33*B.m32;
+	t3 =  m31*B.m13 + m32*B.m23 + m33*B.m33;
+	m34 = m31*B.m14 + m32*B.m24 + m33*B.m34 + m34;
+	m31 = t1;
+	m32 = t2;
+	m33 = t3;
+}
+
+// Product with a matrix B of the form [3x3 0; 0 0 0 1].
+//   Only the first three columns of *this change.  *this may be any 4x4 matrix.
+inline constexpr void Matrix4x4::MultLinear3x3 (const Matrix4x4& B)
+{
+	assert( B.m41==0.0 && B.m42==0.0 && B.m43==0.0 && B.m14==0.0 && B.m24==0.0 && B.m34==0.0 && B.m44==1.0 );
+	double t1 = 0.0, t2 = 0.0;		// temporary values
+	t1 =  m11*B.m11 + m12*B.m21 + m13*B.m31;
+	t2 =  m11*B.m12 + m12*B.m22 + m13*B.m32;
+	m13 = m11*B.m13 + m12*B.m23 + m13*B.m33;
+	m11 = t1;
+	m12 = t2;
+
+	t1 =  m21*B.m11 + m22*B.m21 + m23*B.m31;
+	t2 =  m21*B.m12 + m22*B.m22 + m23*B.m32;
+	m23 = m21*B.m13 + m22*B.m23 + m23*B.m33;
+	m21 = t1;
+	m22 = t2;
+
+	t1 =  m31*B.m11 + m32*B.m21 + m33*B.m31;
+	t2 =  m31*B.m12 + m32*B.m22 + m33*B.m32;
+	m33 = m31*B.m13 + m32*B.m23 + m33*B.m33;
+	m31 = t1;
+	m32 = t2;
+
+	t1 =  m41*B.m11 + m42*B.m21 + m43*B.m31;
+	t2 =  m41*B.m12 + m42*B.m22 + m43*B.m32;
+	m43 = m41*B.m13 + m42*B.m23 + m43*B.m33;
+	m41 = t1;
+	m42 = t2;
+}
+
+inline constexpr VectorR4 operator* ( const Matrix4x4& A, const VectorR4& u)
 {
 	VectorR4 ret;
 	ret.x = A.m11*u.x + A.m12*u.y + A.m13*u.z + A.m14*u.w;
@@ -861,18 +974,17 @@ inline VectorR4 operator* ( const Matrix4x4& A, const VectorR4& u)
 // * LinearMapR4 class - inlined functions				*
 // * * * * * * * * * * * * * * * * * * * * * * * * * * **
 
-inline LinearMapR4::LinearMapR4()
-{
-	SetZero();
-	return;
-}	
+inline constexpr LinearMapR4::LinearMapR4()
+:Matrix4x4 ( 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
+			 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 )		// The zero map
+{ }	
 
-inline LinearMapR4::LinearMapR4( const VectorR4& u, const VectorR4& v, 
+inline constexpr LinearMapR4::LinearMapR4( const VectorR4& u, const VectorR4& v, 
 							 const VectorR4& s, const VectorR4& t)
 :Matrix4x4 ( u, v, s ,t )
 { }
 
-inline LinearMapR4::LinearMapR4( 
+inline constexpr LinearMapR4::LinearMapR4( 
 							 double a11, double a21, double a31, double a41,
 							 double a12, double a22, double a32, double a42,
 							 double a13, double a23, double a33, double a43,
@@ -882,7 +994,7 @@ inline LinearMapR4::LinearMapR4(
 			 a13, a23, a33, a43, a14, a24, a34, a44 )
 { }
 
-inline LinearMapR4::LinearMapR4 ( const Matrix4x4& A )
+inline constexpr LinearMapR4::LinearMapR4 ( const Matrix4x4& A )
 : Matrix4x4 (A) 
 {}
 
@@ -929,7 +1041,7 @@ inline LinearMapR4& LinearMapR4::operator-= (const LinearMapR4& B)
 	return( *this );
 }
 
-inline LinearMapR4 operator+ (const LinearMapR4& A, const LinearMapR4& B)
+inline constexpr LinearMapR4 operator+ (const LinearMapR4& A, const LinearMapR4& B)
 {
 	return( LinearMapR4( A.m11+B.m11, A.m21+B.m21, A.m31+B.m31, A.m41+B.m41,
 						 A.m12+B.m12, A.m22+B.m22, A.m32+B.m32, A.m42+B.m42,
@@ -937,7 +1049,7 @@ inline LinearMapR4 operator+ (const LinearMapR4& A, const LinearMapR4& B)
 						 A.m14+B.m14, A.m24+B.m24, A.m34+B.m34, A.m44+B.m44) );
 }
 
-inline LinearMapR4 operator- (const LinearMapR4& A)
+inline constexpr LinearMapR4 operator- (const LinearMapR4& A)
 {
 	return( LinearMapR4( -A.m11, -A.m21, -A.m31, -A.m41,
 						 -A.m12, -A.m22, -A.m32, -A.m42,
@@ -945,7 +1057,7 @@ inline LinearMapR4 operator- (const LinearMapR4& A)
 						 -A.m14, -A.m24, -A.m34, -A.m44 ) );
 }
 
-inline LinearMapR4 operator- (const LinearMapR4& A, const LinearMapR4& B)
+inline constexpr LinearMapR4 operator- (const LinearMapR4& A, const LinearMapR4& B)
 {
 	return( LinearMapR4( A.m11-B.m11, A.m21-B.m21, A.m31-B.m31, A.m41-B.m41,
 						 A.m12-B.m12, A.m22-B.m22, A.m32-B.m32, A.m42-B.m42,
@@ -974,7 +1086,7 @@ inline LinearMapR4& LinearMapR4::operator*= (register double b)
 	return ( *this);
 }
 
-inline LinearMapR4 operator* ( const LinearMapR4& A, register double b)
+inline constexpr LinearMapR4 operator* ( const LinearMapR4& A, double b)
 {
 	return( LinearMapR4( A.m11*b, A.m21*b, A.m31*b, A.m41*b,
 						 A.m12*b, A.m22*b, A.m32*b, A.m42*b,
@@ -982,7 +1094,7 @@ inline LinearMapR4 operator* ( const LinearMapR4& A, register double b)
 						 A.m14*b, A.m24*b, A.m34*b, A.m44*b) );
 }
 
-inline LinearMapR4 operator* ( register double b, const LinearMapR4& A)
+inline constexpr LinearMapR4 operator* ( double b, const LinearMapR4& A)
 {
 	return( LinearMapR4( A.m11*b, A.m21*b, A.m31*b, A.m41*b,
 						 A.m12*b, A.m22*b, A.m32*b, A.m42*b,
@@ -990,9 +1102,9 @@ inline LinearMapR4 operator* ( register double b, const LinearMapR4& A)
 						 A.m14*b, A.m24*b, A.m34*b, A.m44*b ) );
 }
 
-inline LinearMapR4 operator/ ( const LinearMapR4& A, double b)
+inline constexpr LinearMapR4 operator/ ( const LinearMapR4& A, double b)
 {
-	register double bInv = 1.0/b;
+	double bInv = 1.0/b;
 	return ( A*bInv );
 }
 
@@ -1002,7 +1114,7 @@ inline LinearMapR4& LinearMapR4::operator/= (register double b)
 	return ( *this *= bInv );
 }
 
-inline VectorR4 operator* ( const LinearMapR4& A, const VectorR4& u)
+inline constexpr VectorR4 operator* ( const LinearMapR4& A, const VectorR4& u)
 {
 	return(VectorR4 ( A.m11*u.x + A.m12*u.y + A.m13*u.z + A.m14*u.w,
 					  A.m21*u.x + A.m22*u.y + A.m23*u.z + A.m24*u.w,
@@ -1010,7 +1122,7 @@ inline VectorR4 operator* ( const LinearMapR4& A, const VectorR4& u)
 					  A.m41*u.x + A.m42*u.y + A.m43*u.z + A.m44*u.w ) ); 
 }
 	
-inline LinearMapR4 LinearMapR4::Transpose() const	// Returns the transpose
+inline constexpr LinearMapR4 LinearMapR4::Transpose() const	// Returns the transpose
 {
 	return (LinearMapR4( m11, m12, m13, m14, 
 						 m21, m22, m23, m24,
@@ -1018,28 +1130,28 @@ inline LinearMapR4 LinearMapR4::Transpose() const	// Returns the transpose
 						 m41, m42, m43, m44 ) );
 }
 
-inline LinearMapR4& LinearMapR4::operator*= (const Matrix4x4& B)	// Matrix product
+inline constexpr LinearMapR4& LinearMapR4::operator*= (const Matrix4x4& B)	// Matrix product
 {
 	(*this).Matrix4x4::operator*=(B);
 
 	return( *this );
 }
 
-inline LinearMapR4 operator* ( const LinearMapR4& A, const Matrix4x4& B)
+inline constexpr LinearMapR4 operator* ( const LinearMapR4& A, const Matrix4x4& B)
 {
 	LinearMapR4 AA(A);
 	AA.Matrix4x4::operator*=(B);
 	return AA;
 }
 
-inline LinearMapR4 operator* (const Matrix4x4& A, const LinearMapR4& B)
+inline constexpr LinearMapR4 operator* (const Matrix4x4& A, const LinearMapR4& B)
 {
     LinearMapR4 AA(A);
     AA.Matrix4x4::operator*=(B);
     return AA;
 }
 
-inline LinearMapR4 operator* (const LinearMapR4& A, const LinearMapR4& B)
+inline constexpr LinearMapR4 operator* (const LinearMapR4& A, const LinearMapR4& B)
 {
     LinearMapR4 AA(A);
     AA.Matrix4x4::operator*=(B);
@@ -1057,17 +1169,17 @@ inline bool LinearMapR4::IsAffine() const
 //   The "Set" routines replace the matrix contents.
 //   All routines return the *this matrix.
 
-inline LinearMapR4& LinearMapR4::Set_glScale(double xyzScale)
+inline constexpr LinearMapR4& LinearMapR4::Set_glScale(double xyzScale)
 {
 	return Set_glScale(xyzScale, xyzScale, xyzScale);
 }
 
-inline LinearMapR4& LinearMapR4::Mult_glScale(double xyzScale)
+inline constexpr LinearMapR4& LinearMapR4::Mult_glScale(double xyzScale)
 {
 	return Mult_glScale(xyzScale, xyzScale, xyzScale);
 }
 
-inline LinearMapR4& LinearMapR4::Set_glScale(double xScale, double yScale, double zScale)
+inline constexpr LinearMapR4& LinearMapR4::Set_glScale(double xScale, double yScale, double zScale)
 {
 	m11 = xScale;
 	m22 = yScale;
@@ -1077,7 +1189,7 @@ inline LinearMapR4& LinearMapR4::Set_glScale(double xScale, double yScale, doubl
 	return *this;
 }
 
-inline LinearMapR4& LinearMapR4::Mult_glScale(double xScale, double yScale, double zScale)
+inline constexpr LinearMapR4& LinearMapR4::Mult_glScale(double xScale, double yScale, double zScale)
 {
 	m11 *= xScale;
 	m21 *= xScale;
@@ -1094,7 +1206,7 @@ inline LinearMapR4& LinearMapR4::Mult_glScale(double xScale, double yScale, doub
 	return *this;
 }
 
-inline LinearMapR4& LinearMapR4::Set_glTranslate(double xTranslation, double yTranslation, double zTranslation)
+inline constexpr LinearMapR4& LinearMapR4::Set_glTranslate(double xTranslation, double yTranslation, double zTranslation)
 {
 	m14 = xTranslation;
 	m24 = yTranslation;
@@ -1104,7 +1216,7 @@ inline LinearMapR4& LinearMapR4::Set_glTranslate(double xTranslation, double yTr
 	return *this;
 }
 
-inline LinearMapR4& LinearMapR4::Mult_glTranslate(double xTranslation, double yTranslation, double zTranslation)
+inline constexpr LinearMapR4& LinearMapR4::Mult_glTranslate(double xTranslation, double yTranslation, double zTranslation)
 {
 	m14 += xTranslation * m11 + yTranslation * m12 + zTranslation * m13;
 	m24 += xTranslation * m21 + yTranslation * m22 + zTranslation * m23;
@@ -1113,12 +1225,12 @@ inline LinearMapR4& LinearMapR4::Mult_glTranslate(double xTranslation, double yT
 	return *this;
 }
 
-inline LinearMapR4& LinearMapR4::Set_glTranslate(const VectorR3& translation)
+inline constexpr LinearMapR4& LinearMapR4::Set_glTranslate(const VectorR3& translation)
 {
 	return Set_glTranslate(translation.x, translation.y, translation.z);
 }
 
-inline LinearMapR4& LinearMapR4::Mult_glTranslate(const VectorR3& translation)
+inline constexpr LinearMapR4& LinearMapR4::Mult_glTranslate(const VectorR3& translation)
 {
 	return Mult_glTranslate(translation.x, translation.y, translation.z);
 }
@@ -1143,20 +1255,48 @@ inline LinearMapR4& LinearMapR4::Mult_glRotate(double radians, const VectorR3& a
 	return Mult_glRotate(cos(radians), sin(radians), axis);
 }
 
-inline LinearMapR4& LinearMapR4::Mult_glRotate(double costheta, double sintheta, double x, double y, double z)
+inline constexpr LinearMapR4& LinearMapR4::Set_glRotate(double costheta, double sintheta, double x, double y, double z)
+{
+	double normSq = x * x + y * y + z * z;
+	assert(normSq > 0.0);
+	if (normSq != 1.0) {			// Skipped for unit axes; this keeps it usable at compile time
+		double normInv = 1.0 / sqrt(normSq);
+		x *= normInv;
+		y *= normInv;
+		z *= normInv;
+	}
+	double omC = 1 - costheta;
+	double omCx = omC * x;
+	double omCy = omC * y;
+	double omCz = omC * z;
+	m11 = omCx * x + costheta;
+	m21 = omCx * y + sintheta * z;
+	m31 = omCx * z - sintheta * y;
+	m12 = omCy * x - sintheta * z;
+	m22 = omCy * y + costheta;
+	m32 = omCy * z + sintheta * x;
+	m13 = omCz * x + sintheta * y;
+	m23 = omCz * y - sintheta * x;
+	m33 = omCz * z + costheta;
+	m41 = m42 = m43 = m14 = m24 = m34 = 0.0;
+	m44 = 1.0;
+	return *this;
+}
+
+inline constexpr LinearMapR4& LinearMapR4::Mult_glRotate(double costheta, double sintheta, double x, double y, double z)
 {
 	LinearMapR4 rotMatrix;
 	rotMatrix.Set_glRotate(costheta, sintheta, x, y, z);
-	(*this) *= rotMatrix;
+	MultLinear3x3(rotMatrix);		// The fourth row and column of rotMatrix are trivial
 	return *this;
 }
 
-inline LinearMapR4& LinearMapR4::Set_glRotate(double costheta, double sintheta, const VectorR3& axis)
+inline constexpr LinearMapR4& LinearMapR4::Set_glRotate(double costheta, double sintheta, const VectorR3& axis)
 {
 	return Set_glRotate(costheta, sintheta, axis.x, axis.y, axis.z);
 }
 
-inline LinearMapR4& LinearMapR4::Mult_glRotate(double costheta, double sintheta, const VectorR3& axis)
+inline constexpr LinearMapR4& LinearMapR4::Mult_glRotate(double costheta, double sintheta, const VectorR3& axis)
 {
 	return Mult_glRotate(costheta, sintheta, axis.x, axis.y, axis.z);
 }
@@ -0,0 +1,434 @@
+/*
+ *
+ * Mat4f.cpp, release 1.0.
+ *
+ * A single precision 4x4 matrix for the render path.
+ *   See Mat4f.h for information on how to use it.
+ *
+ * Software is "as-is" and carries no warranty.  It may be used without
+ *   restriction, but if you modify it, please change the filenames to
+ *   prevent confusion between different versions.
+ *
+ */
+
+#include <math.h>
+#include <assert.h>
+#include "LinearR4.h"
+#include "Mat4f.h"
+
+// ******************************************************
+// SSE helper functions                                 *
+// ******************************************************
+
+#if MAT4F_USE_SSE
+
+#define MAT4F_SHUFFLE(v, x, y, z, w)  _mm_shuffle_ps((v), (v), _MM_SHUFFLE(w, z, y, x))
+
+// Cross product of the x,y,z parts.  The w component of the result is 0 if a.w*b.w is finite.
+inline static __m128 CrossSSE( __m128 a, __m128 b )
+{
+	__m128 t = _mm_sub_ps( _mm_mul_ps(a, MAT4F_SHUFFLE(b, 1, 2, 0, 3)),
+						   _mm_mul_ps(MAT4F_SHUFFLE(a, 1, 2, 0, 3), b) );
+	return MAT4F_SHUFFLE(t, 1, 2, 0, 3);
+}
+
+// Dot product of the x,y,z parts, in all four components.
+inline static __m128 Dot3SSE( __m128 a, __m128 b )
+{
+	__m128 p = _mm_mul_ps(a, b);
+	__m128 s = _mm_add_ss( p, MAT4F_SHUFFLE(p, 1, 1, 1, 1) );
+	s = _mm_add_ss( s, MAT4F_SHUFFLE(p, 2, 2, 2, 2) );
+	return MAT4F_SHUFFLE(s, 0, 0, 0, 0);
+}
+
+// Linear combination a0*x + a1*y + a2*z + a3*w of the four columns of a matrix.
+inline static __m128 CombineSSE( const float* a, float x, float y, float z, float w )
+{
+	__m128 r = _mm_mul_ps( _mm_loadu_ps(a), _mm_set1_ps(x) );
+	r = _mm_add_ps( r, _mm_mul_ps(_mm_loadu_ps(a+4), _mm_set1_ps(y)) );
+	r = _mm_add_ps( r, _mm_mul_ps(_mm_loadu_ps(a+8), _mm_set1_ps(z)) );
+	return _mm_add_ps( r, _mm_mul_ps(_mm_loadu_ps(a+12), _mm_set1_ps(w)) );
+}
+
+// 2x2 matrix products used by Inverse().  A 2x2 matrix is held as (m00, m01, m10, m11).
+inline static __m128 Mat2Mul( __m128 a, __m128 b )
+{
+	return _mm_add_ps( _mm_mul_ps(a, MAT4F_SHUFFLE(b, 0, 3, 0, 3)),
+					   _mm_mul_ps(MAT4F_SHUFFLE(a, 1, 0, 3, 2), MAT4F_SHUFFLE(b, 2, 1, 2, 1)) );
+}
+// adj(a)*b
+inline static __m128 Mat2AdjMul( __m128 a, __m128 b )
+{
+	return _mm_sub_ps( _mm_mul_ps(MAT4F_SHUFFLE(a, 3, 3, 0, 0), b),
+					   _mm_mul_ps(MAT4F_SHUFFLE(a, 1, 1, 2, 2), MAT4F_SHUFFLE(b, 2, 3, 0, 1)) );
+}
+// a*adj(b)
+inline static __m128 Mat2MulAdj( __m128 a, __m128 b )
+{
+	return _mm_sub_ps( _mm_mul_ps(a, MAT4F_SHUFFLE(b, 3, 0, 3, 0)),
+					   _mm_mul_ps(MAT4F_SHUFFLE(a, 1, 0, 3, 2), MAT4F_SHUFFLE(b, 2, 1, 2, 1)) );
+}
+
+#endif  // MAT4F_USE_SSE
+
+// ******************************************************
+// Mat4f member functions                               *
+// ******************************************************
+
+Mat4f& Mat4f::Set( const Matrix4x4& A )
+{
+	m[0] = (float)A.m11;  m[1] = (float)A.m21;  m[2] = (float)A.m31;  m[3] = (float)A.m41;
+	m[4] = (float)A.m12;  m[5] = (float)A.m22;  m[6] = (float)A.m32;  m[7] = (float)A.m42;
+	m[8] = (float)A.m13;  m[9] = (float)A.m23;  m[10] = (float)A.m33; m[11] = (float)A.m43;
+	m[12] = (float)A.m14; m[13] = (float)A.m24; m[14] = (float)A.m34; m[15] = (float)A.m44;
+	return *this;
+}
+
+Mat4f& Mat4f::SetIdentity()
+{
+	SetZero();
+	m[0] = m[5] = m[10] = m[15] = 1.0f;
+	return *this;
+}
+
+Mat4f& Mat4f::SetZero()
+{
+	for ( int i=0; i<16; i++ ) {
+		m[i] = 0.0f;
+	}
+	return *this;
+}
+
+Mat4f& Mat4f::operator*= ( const Mat4f& B )
+{
+#if MAT4F_USE_AVX
+	// Two columns of the product at a time.  Each 128 bit lane holds one column.
+	__m256 a0 = _mm256_broadcast_ps( (const __m128*)(m) );
+	__m256 a1 = _mm256_broadcast_ps( (const __m128*)(m+4) );
+	__m256 a2 = _mm256_broadcast_ps( (const __m128*)(m+8) );
+	__m256 a3 = _mm256_broadcast_ps( (const __m128*)(m+12) );
+	__m256 b01 = _mm256_loadu_ps(B.m);
+	__m256 b23 = _mm256_loadu_ps(B.m+8);
+	__m256 r01 = _mm256_mul_ps( a0, _mm256_permute_ps(b01, 0x00) );
+	r01 = _mm256_add_ps( r01, _mm256_mul_ps(a1, _mm256_permute_ps(b01, 0x55)) );
+	r01 = _mm256_add_ps( r01, _mm256_mul_ps(a2, _mm256_permute_ps(b01, 0xAA)) );
+	r01 = _mm256_add_ps( r01, _mm256_mul_ps(a3, _mm256_permute_ps(b01, 0xFF)) );
+	__m256 r23 = _mm256_mul_ps( a0, _mm256_permute_ps(b23, 0x00) );
+	r23 = _mm256_add_ps( r23, _mm256_mul_ps(a1, _mm256_permute_ps(b23, 0x55)) );
+	r23 = _mm256_add_ps( r23, _mm256_mul_ps(a2, _mm256_permute_ps(b23, 0xAA)) );
+	r23 = _mm256_add_ps( r23, _mm256_mul_ps(a3, _mm256_permute_ps(b23, 0xFF)) );
+	_mm256_storeu_ps( m, r01 );
+	_mm256_storeu_ps( m+8, r23 );
+#elif MAT4F_USE_SSE
+	__m128 r0 = CombineSSE( m, B.m[0], B.m[1], B.m[2], B.m[3] );
+	__m128 r1 = CombineSSE( m, B.m[4], B.m[5], B.m[6], B.m[7] );
+	__m128 r2 = CombineSSE( m, B.m[8], B.m[9], B.m[10], B.m[11] );
+	__m128 r3 = CombineSSE( m, B.m[12], B.m[13], B.m[14], B.m[15] );
+	_mm_storeu_ps( m, r0 );
+	_mm_storeu_ps( m+4, r1 );
+	_mm_storeu_ps( m+8, r2 );
+	_mm_storeu_ps( m+12, r3 );
+#else
+	float r[16];
+	for ( int j=0; j<4; j++ ) {
+		for ( int i=0; i<4; i++ ) {
+			r[4*j+i] = m[i]*B.m[4*j] + m[4+i]*B.m[4*j+1] + m[8+i]*B.m[4*j+2] + m[12+i]*B.m[4*j+3];
+		}
+	}
+	for ( int i=0; i<16; i++ ) {
+		m[i] = r[i];
+	}
+#endif
+	return *this;
+}
+
+Mat4f& Mat4f::MultAffine( const Mat4f& B )
+{
+	assert ( B.m[3]==0.0f && B.m[7]==0.0f && B.m[11]==0.0f && B.m[15]==1.0f );
+#if MAT4F_USE_SSE
+	__m128 a0 = _mm_loadu_ps(m);
+	__m128 a1 = _mm_loadu_ps(m+4);
+	__m128 a2 = _mm_loadu_ps(m+8);
+	__m128 r[4];
+	for ( int j=0; j<4; j++ ) {
+		r[j] = _mm_mul_ps( a0, _mm_set1_ps(B.m[4*j]) );
+		r[j] = _mm_add_ps( r[j], _mm_mul_ps(a1, _mm_set1_ps(B.m[4*j+1])) );
+		r[j] = _mm_add_ps( r[j], _mm_mul_ps(a2, _mm_set1_ps(B.m[4*j+2])) );
+	}
+	r[3] = _mm_add_ps( r[3], _mm_loadu_ps(m+12) );
+	for ( int j=0; j<4; j++ ) {
+		_mm_storeu_ps( m+4*j, r[j] );
+	}
+#else
+	float r[12];
+	for ( int j=0; j<4; j++ ) {
+		for ( int i=0; i<3; i++ ) {
+			r[3*j+i] = m[i]*B.m[4*j] + m[4+i]*B.m[4*j+1] + m[8+i]*B.m[4*j+2];
+		}
+	}
+	for ( int j=0; j<4; j++ ) {
+		for ( int i=0; i<3; i++ ) {
+			m[4*j+i] = (j<3) ? r[3*j+i] : r[3*j+i] + m[12+i];
+		}
+	}
+#endif
+	return *this;
+}
+
+// General inverse by 2x2 blocks (the block form of the cofactor inverse).
+//    The same code inverts a matrix stored by rows or by columns.
+Mat4f Mat4f::Inverse() const
+{
+	Mat4f ret;
+#if MAT4F_USE_SSE
+	__m128 c0 = _mm_loadu_ps(m);
+	__m128 c1 = _mm_loadu_ps(m+4);
+	__m128 c2 = _mm_loadu_ps(m+8);
+	__m128 c3 = _mm_loadu_ps(m+12);
+
+	// The four 2x2 blocks
+	__m128 A = _mm_movelh_ps(c0, c1);
+	__m128 B = _mm_movehl_ps(c1, c0);
+	__m128 C = _mm_movelh_ps(c2, c3);
+	__m128 D = _mm_movehl_ps(c3, c2);
+
+	// Determinants of the blocks, (|A|, |B|, |C|, |D|)
+	__m128 detSub = _mm_sub_ps(
+		_mm_mul_ps( _mm_shuffle_ps(c0, c2, _MM_SHUFFLE(2,0,2,0)), _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(3,1,3,1)) ),
+		_mm_mul_ps( _mm_shuffle_ps(c0, c2, _MM_SHUFFLE(3,1,3,1)), _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(2,0,2,0)) ) );
+	__m128 detA = MAT4F_SHUFFLE(detSub, 0, 0, 0, 0);
+	__m128 detB = MAT4F_SHUFFLE(detSub, 1, 1, 1, 1);
+	__m128 detC = MAT4F_SHUFFLE(detSub, 2, 2, 2, 2);
+	__m128 detD = MAT4F_SHUFFLE(detSub, 3, 3, 3, 3);
+
+	__m128 D_C = Mat2AdjMul(D, C);
+	__m128 A_B = Mat2AdjMul(A, B);
+	__m128 X_ = _mm_sub_ps( _mm_mul_ps(detD, A), Mat2Mul(B, D_C) );
+	__m128 W_ = _mm_sub_ps( _mm_mul_ps(detA, D), Mat2Mul(C, A_B) );
+	__m128 Y_ = _mm_sub_ps( _mm_mul_ps(detB, C), Mat2MulAdj(D, A_B) );
+	__m128 Z_ = _mm_sub_ps( _mm_mul_ps(detC, B), Mat2MulAdj(A, D_C) );
+
+	// |M| = |A||D| + |B||C| - trace(adj(A)*B*adj(D)*C)
+	__m128 tr = _mm_mul_ps( A_B, MAT4F_SHUFFLE(D_C, 0, 2, 1, 3) );
+	tr = _mm_add_ps( tr, _mm_movehl_ps(tr, tr) );
+	tr = _mm_add_ss( tr, MAT4F_SHUFFLE(tr, 1, 1, 1, 1) );
+	tr = MAT4F_SHUFFLE(tr, 0, 0, 0, 0);
+	__m128 detM = _mm_sub_ps( _mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr );
+	assert ( _mm_cvtss_f32(detM) != 0.0f );
+
+	__m128 rDetM = _mm_div_ps( _mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM );
+	X_ = _mm_mul_ps(X_, rDetM);
+	Y_ = _mm_mul_ps(Y_, rDetM);
+	Z_ = _mm_mul_ps(Z_, rDetM);
+	W_ = _mm_mul_ps(W_, rDetM);
+
+	// Take the adjugates of the blocks and put them in place
+	_mm_storeu_ps( ret.m, _mm_shuffle_ps(X_, Y_, _MM_SHUFFLE(1,3,1,3)) );
+	_mm_storeu_ps( ret.m+4, _mm_shuffle_ps(X_, Y_, _MM_SHUFFLE(0,2,0,2)) );
+	_mm_storeu_ps( ret.m+8, _mm_shuffle_ps(Z_, W_, _MM_SHUFFLE(1,3,1,3)) );
+	_mm_storeu_ps( ret.m+12, _mm_shuffle_ps(Z_, W_, _MM_SHUFFLE(0,2,0,2)) );
+#else
+	LinearMapR4 A;
+	A.Set( m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7],
+		   m[8], m[9], m[10], m[11], m[12], m[13], m[14], m[15] );
+	ret.Set( A.Inverse() );
+#endif
+	return ret;
+}
+
+// Inverse of an affine matrix [M t]:  [M^{-1}  -M^{-1}t].
+//    The rows of M^{-1} are cross products of the columns of M, divided by det(M).
+Mat4f Mat4f::InverseAffine() const
+{
+	assert ( m[3]==0.0f && m[7]==0.0f && m[11]==0.0f && m[15]==1.0f );
+	Mat4f ret;
+#if MAT4F_USE_SSE
+	__m128 c0 = _mm_loadu_ps(m);
+	__m128 c1 = _mm_loadu_ps(m+4);
+	__m128 c2 = _mm_loadu_ps(m+8);
+	__m128 r0 = CrossSSE(c1, c2);
+	__m128 r1 = CrossSSE(c2, c0);
+	__m128 r2 = CrossSSE(c0, c1);
+	__m128 det = Dot3SSE(c0, r0);
+	assert ( _mm_cvtss_f32(det) != 0.0f );
+	__m128 rDet = _mm_div_ps( _mm_set1_ps(1.0f), det );
+	r0 = _mm_mul_ps(r0, rDet);
+	r1 = _mm_mul_ps(r1, rDet);
+	r2 = _mm_mul_ps(r2, rDet);
+	__m128 r3 = _mm_setzero_ps();
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);			// Now r0,r1,r2 are the columns of M^{-1}
+	__m128 t = _mm_mul_ps( r0, _mm_set1_ps(-m[12]) );
+	t = _mm_sub_ps( t, _mm_mul_ps(r1, _mm_set1_ps(m[13])) );
+	t = _mm_sub_ps( t, _mm_mul_ps(r2, _mm_set1_ps(m[14])) );
+	t = _mm_add_ps( t, _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f) );
+	_mm_storeu_ps( ret.m, r0 );
+	_mm_storeu_ps( ret.m+4, r1 );
+	_mm_storeu_ps( ret.m+8, r2 );
+	_mm_storeu_ps( ret.m+12, t );
+#else
+	const float* c0 = m;
+	const float* c1 = m+4;
+	const float* c2 = m+8;
+	float r0[3] = { c1[1]*c2[2]-c1[2]*c2[1], c1[2]*c2[0]-c1[0]*c2[2], c1[0]*c2[1]-c1[1]*c2[0] };
+	float r1[3] = { c2[1]*c0[2]-c2[2]*c0[1], c2[2]*c0[0]-c2[0]*c0[2], c2[0]*c0[1]-c2[1]*c0[0] };
+	float r2[3] = { c0[1]*c1[2]-c0[2]*c1[1], c0[2]*c1[0]-c0[0]*c1[2], c0[0]*c1[1]-c0[1]*c1[0] };
+	float det = c0[0]*r0[0] + c0[1]*r0[1] + c0[2]*r0[2];
+	assert ( det != 0.0f );
+	float rDet = 1.0f/det;
+	for ( int j=0; j<3; j++ ) {
+		ret.m[4*j] = r0[j]*rDet;
+		ret.m[4*j+1] = r1[j]*rDet;
+		ret.m[4*j+2] = r2[j]*rDet;
+		ret.m[4*j+3] = 0.0f;
+	}
+	for ( int i=0; i<3; i++ ) {
+		ret.m[12+i] = -(ret.m[i]*m[12] + ret.m[4+i]*m[13] + ret.m[8+i]*m[14]);
+	}
+	ret.m[15] = 1.0f;
+#endif
+	return ret;
+}
+
+void Mat4f::Transform( const float in[4], float out[4] ) const
+{
+#if MAT4F_USE_SSE
+	_mm_storeu_ps( out, CombineSSE(m, in[0], in[1], in[2], in[3]) );
+#else
+	float x = in[0], y = in[1], z = in[2], w = in[3];
+	for ( int i=0; i<4; i++ ) {
+		out[i] = m[i]*x + m[4+i]*y + m[8+i]*z + m[12+i]*w;
+	}
+#endif
+}
+
+void Mat4f::TransformPosition( const float in[3], float out[3] ) const
+{
+	float v[4] = { in[0], in[1], in[2], 1.0f };
+	float r[4];
+	Transform( v, r );
+	out[0] = r[0];
+	out[1] = r[1];
+	out[2] = r[2];
+}
+
+void Mat4f::TransformDirection( const float in[3], float out[3] ) const
+{
+	float v[4] = { in[0], in[1], in[2], 0.0f };
+	float r[4];
+	Transform( v, r );
+	out[0] = r[0];
+	out[1] = r[1];
+	out[2] = r[2];
+}
+
+void Mat4f::TransformPositions( const float* in, float* out, int n ) const
+{
+#if MAT4F_USE_SSE
+	__m128 c0 = _mm_loadu_ps(m);
+	__m128 c1 = _mm_loadu_ps(m+4);
+	__m128 c2 = _mm_loadu_ps(m+8);
+	__m128 c3 = _mm_loadu_ps(m+12);
+	alignas(16) float r[4];
+	for ( int k=0; k<n; k++, in+=3, out+=3 ) {
+		__m128 v = _mm_add_ps( _mm_mul_ps(c0, _mm_set1_ps(in[0])), _mm_mul_ps(c1, _mm_set1_ps(in[1])) );
+		v = _mm_add_ps( v, _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(in[2])), c3) );
+		_mm_store_ps( r, v );
+		out[0] = r[0];
+		out[1] = r[1];
+		out[2] = r[2];
+	}
+#else
+	for ( int k=0; k<n; k++, in+=3, out+=3 ) {
+		TransformPosition( in, out );
+	}
+#endif
+}
+
+// ******************************************************
+// Builders, similar to the LinearMapR4 builders        *
+// ******************************************************
+
+Mat4f& Mat4f::Set_glTranslate( float x, float y, float z )
+{
+	SetIdentity();
+	m[12] = x;
+	m[13] = y;
+	m[14] = z;
+	return *this;
+}
+
+Mat4f& Mat4f::Mult_glTranslate( float x, float y, float z )
+{
+#if MAT4F_USE_SSE
+	_mm_storeu_ps( m+12, CombineSSE(m, x, y, z, 1.0f) );
+#else
+	for ( int i=0; i<4; i++ ) {
+		m[12+i] += m[i]*x + m[4+i]*y + m[8+i]*z;
+	}
+#endif
+	return *this;
+}
+
+Mat4f& Mat4f::Set_glScale( float x, float y, float z )
+{
+	SetZero();
+	m[0] = x;
+	m[5] = y;
+	m[10] = z;
+	m[15] = 1.0f;
+	return *this;
+}
+
+Mat4f& Mat4f::Mult_glScale( float x, float y, float z )
+{
+	for ( int i=0; i<4; i++ ) {
+		m[i] *= x;
+		m[4+i] *= y;
+		m[8+i] *= z;
+	}
+	return *this;
+}
+
+// Rotation by "radians" around the axis (x,y,z).  The axis need not be a unit vector.
+Mat4f& Mat4f::Set_glRotate( float radians, float x, float y, float z )
+{
+	SetIdentity();
+	return Mult_glRotate( radians, x, y, z );
+}
+
+// Multiplying on the right by a rotation only changes the first three columns:
+//    the new column j is a combination of the old columns 0, 1, 2.
+Mat4f& Mat4f::Mult_glRotate( float radians, float x, float y, float z )
+{
+	float norm = sqrtf( x*x + y*y + z*z );
+	assert ( norm != 0.0f );
+	x /= norm;
+	y /= norm;
+	z /= norm;
+	float c = cosf(radians);
+	float s = sinf(radians);
+	float t = 1.0f - c;
+	float R[9] = {							// The rotation matrix by columns
+		t*x*x + c,   t*x*y + s*z, t*x*z - s*y,
+		t*x*y - s*z, t*y*y + c,   t*y*z + s*x,
+		t*x*z + s*y, t*y*z - s*x, t*z*z + c };
+#if MAT4F_USE_SSE
+	__m128 r0 = CombineSSE( m, R[0], R[1], R[2], 0.0f );
+	__m128 r1 = CombineSSE( m, R[3], R[4], R[5], 0.0f );
+	__m128 r2 = CombineSSE( m, R[6], R[7], R[8], 0.0f );
+	_mm_storeu_ps( m, r0 );
+	_mm_storeu_ps( m+4, r1 );
+	_mm_storeu_ps( m+8, r2 );
+#else
+	float r[12];
+	for ( int j=0; j<3; j++ ) {
+		for ( int i=0; i<4; i++ ) {
+			r[4*j+i] = m[i]*R[3*j] + m[4+i]*R[3*j+1] + m[8+i]*R[3*j+2];
+		}
+	}
+	for ( int i=0; i<12; i++ ) {
+		m[i] = r[i];
+	}
+#endif
+	return *this;
+}
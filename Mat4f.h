@@ -0,0 +1,100 @@
+/*
+ *
+ * Mat4f.h, release 1.0.
+ *
+ * A single precision 4x4 matrix for the render path.
+ *   Mat4f stores 16 floats in column order (the order expected by
+ *   glUniformMatrix4fv with transpose == false), aligned on a 16 byte
+ *   boundary, so Data() can be passed to OpenGL with no copy.
+ *   The products, transforms and inverses use SSE (and AVX, if enabled
+ *   by the compiler) with a plain C++ fallback.
+ *
+ *   Conversion from a LinearMapR4 (or Matrix4x4) rounds each entry
+ *   to float exactly as Matrix4x4::DumpByColumns does, so matrices
+ *   built with Mat4f give the shader the same values as before.
+ *
+ * Software is "as-is" and carries no warranty.  It may be used without
+ *   restriction, but if you modify it, please change the filenames to
+ *   prevent confusion between different versions.
+ *
+ */
+
+#ifndef MAT4F_H
+#define MAT4F_H
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define MAT4F_USE_SSE 1
+#include <xmmintrin.h>
+#endif
+#if defined(__AVX__)
+#define MAT4F_USE_AVX 1
+#include <immintrin.h>
+#endif
+
+class Matrix4x4;
+
+// Mat4f
+//    m[4*j+i] is the entry in row i and column j (rows and columns numbered from 0).
+//    The SIMD kernels use unaligned loads and stores, so a Mat4f may be
+//    placed anywhere (e.g., in memory from new[] on 32 bit systems);
+//    but aligned storage is faster on older processors.
+
+class alignas(16) Mat4f {
+
+public:
+	float m[16];
+
+public:
+	Mat4f() {}								// Entries are not initialized
+	explicit Mat4f( const Matrix4x4& A ) { Set(A); }
+
+	Mat4f& Set( const Matrix4x4& A );		// Round each entry to float
+	Mat4f& SetIdentity();
+	Mat4f& SetZero();
+
+	// Column-major data, ready for glUniformMatrix4fv(loc, 1, false, M.Data())
+	const float* Data() const { return m; }
+	float* Data() { return m; }
+
+	float& operator() ( int row, int col ) { return m[4*col+row]; }
+	float operator() ( int row, int col ) const { return m[4*col+row]; }
+
+	// Matrix products.  "*this *= B" sets *this to (*this)*B.
+	Mat4f& operator*= ( const Mat4f& B );
+	// Product of two affine matrices (bottom rows equal to 0,0,0,1).
+	//    Cheaper than the general product; the bottom row is set to 0,0,0,1.
+	Mat4f& MultAffine( const Mat4f& B );
+
+	// Inverses.  Inverse() is the general inverse.
+	//   InverseAffine() is for affine matrices (bottom row 0,0,0,1).
+	//   The matrix must be invertible.
+	Mat4f Inverse() const;
+	Mat4f InverseAffine() const;
+
+	// Transform a 4-vector, or a position (w=1) or a direction (w=0) in 3-space.
+	void Transform( const float in[4], float out[4] ) const;
+	void TransformPosition( const float in[3], float out[3] ) const;
+	void TransformDirection( const float in[3], float out[3] ) const;
+	// Transform n positions, packed as x,y,z,x,y,z,...   "in" and "out" may be equal.
+	void TransformPositions( const float* in, float* out, int n ) const;
+
+	// Float versions of the LinearMapR4 builders.
+	//   The Mult_ versions multiply on the right, as in the legacy OpenGL.
+	//   These assume the matrix is affine.
+	Mat4f& Set_glTranslate( float x, float y, float z );
+	Mat4f& Mult_glTranslate( float x, float y, float z );
+	Mat4f& Set_glScale( float x, float y, float z );
+	Mat4f& Mult_glScale( float x, float y, float z );
+	Mat4f& Mult_glScale( float s ) { return Mult_glScale(s, s, s); }
+	Mat4f& Set_glRotate( float radians, float x, float y, float z );
+	Mat4f& Mult_glRotate( float radians, float x, float y, float z );
+};
+
+inline Mat4f operator* ( const Mat4f& A, const Mat4f& B )
+{
+	Mat4f ret = A;
+	ret *= B;
+	return ret;
+}
+
+#endif // MAT4F_H
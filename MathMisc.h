@@ -28,36 +28,38 @@
 
 //
 // Commonly used constants
+//   The constants not needing sqrt(), log() or exp() are constexpr,
+//   so they can be used in compile time computations.
 //
 
 const double DBL_NAN = sqrt(-1.0);	// Kludgy - ought to be an IEEE standard for this constant
 
-const double PI = 3.1415926535897932384626433832795028841972;
-const double PI2 = 2.0*PI;
-const double PI4 = 4.0*PI;
-const double PISq = PI*PI;
-const double PIhalves = 0.5*PI;
-const double PIthirds = PI/3.0;
-const double PItwothirds = PI2/3.0;
-const double PIfourths = 0.25*PI;
-const double PIsixths = PI/6.0;
-const double PIsixthsSq = PIsixths*PIsixths;
-const double PItwelfths = PI/12.0;
-const double PItwelfthsSq = PItwelfths*PItwelfths;
-const double PIinv = 1.0/PI;
-const double PI2inv = 0.5/PI;
-const double PIhalfinv = 2.0/PI;
+constexpr double PI = 3.1415926535897932384626433832795028841972;
+constexpr double PI2 = 2.0*PI;
+constexpr double PI4 = 4.0*PI;
+constexpr double PISq = PI*PI;
+constexpr double PIhalves = 0.5*PI;
+constexpr double PIthirds = PI/3.0;
+constexpr double PItwothirds = PI2/3.0;
+constexpr double PIfourths = 0.25*PI;
+constexpr double PIsixths = PI/6.0;
+constexpr double PIsixthsSq = PIsixths*PIsixths;
+constexpr double PItwelfths = PI/12.0;
+constexpr double PItwelfthsSq = PItwelfths*PItwelfths;
+constexpr double PIinv = 1.0/PI;
+constexpr double PI2inv = 0.5/PI;
+constexpr double PIhalfinv = 2.0/PI;
 const double TwoPiSqrtInv = 1.0/sqrt(2.0*PI);
 const double LogPI = log(PI);
 
-const double RadiansToDegrees = 180.0/PI;
-const double DegreesToRadians = PI/180;
+constexpr double RadiansToDegrees = 180.0/PI;
+constexpr double DegreesToRadians = PI/180;
 
-const double OneThird = 1.0/3.0;
-const double TwoThirds = 2.0/3.0;
-const double OneSixth = 1.0/6.0;
-const double OneEighth = 1.0/8.0;
-const double OneTwelfth = 1.0/12.0;
+constexpr double OneThird = 1.0/3.0;
+constexpr double TwoThirds = 2.0/3.0;
+constexpr double OneSixth = 1.0/6.0;
+constexpr double OneEighth = 1.0/8.0;
+constexpr double OneTwelfth = 1.0/12.0;
 
 const double Root2 = sqrt(2.0);
 const double Root3 = sqrt(3.0);
@@ -72,11 +74,109 @@ const double GoldenRatio = (sqrt(5.0)+1.0)*0.5;
 const double GoldenRatioInv = (sqrt(5.0)-1.0)*0.5;  // 1.0/GoldenRatio
 
 // Special purpose constants
-const double OnePlusEpsilon15 = 1.0+1.0e-15;
-const double OneMinusEpsilon15 = 1.0-1.0e-15;
+constexpr double OnePlusEpsilon15 = 1.0+1.0e-15;
+constexpr double OneMinusEpsilon15 = 1.0-1.0e-15;
 
 const long HALF_LONG_MIN = (LONG_MIN>>1);	// Signed half of long min.
 
+//
+// Compile time (constexpr) versions of sqrt, sin and cos.
+//   For computing constant matrices and tables when compiling.
+//   At run time, use sqrt(), sin() and cos(), which are much faster.
+//
+
+// Newton's method, starting above the square root.  x must be non-negative.
+constexpr double ConstSqrt( double x )
+{
+	assert( x>=0.0 );
+	if ( x==0.0 ) {
+		return 0.0;
+	}
+	double y = (x>1.0) ? x : 1.0;
+	while ( true ) {
+		double next = 0.5*(y + x/y);
+		if ( next>=y ) {
+			return y;
+		}
+		y = next;
+	}
+}
+
+// Taylor series for sin and cos, for |r| <= pi/4.
+constexpr double ConstSinReduced( double r )
+{
+	double rSq = r*r;
+	double term = r;
+	double sum = r;
+	for ( int i=3; i<=25; i+=2 ) {
+		term *= -rSq/(double)((i-1)*i);
+		sum += term;
+	}
+	return sum;
+}
+
+constexpr double ConstCosReduced( double r )
+{
+	double rSq = r*r;
+	double term = 1.0;
+	double sum = 1.0;
+	for ( int i=2; i<=24; i+=2 ) {
+		term *= -rSq/(double)((i-1)*i);
+		sum += term;
+	}
+	return sum;
+}
+
+// Reduces x to r = x - k*(pi/2), with |r| <= pi/4.  Returns k mod 4.
+//   pi/2 is split in two parts, so that r is accurate for moderate x.
+constexpr int ConstReduceAngle( double x, double* r )
+{
+	const double PIhalvesHi = 1.5707963267948966;		// pi/2 rounded to double
+	const double PIhalvesLo = 6.123233995736766e-17;	// pi/2 - PIhalvesHi
+	double q = x/PIhalvesHi;
+	long long k = (long long)(q>=0.0 ? q+0.5 : q-0.5);
+	*r = (x - (double)k*PIhalvesHi) - (double)k*PIhalvesLo;
+	return (int)(k & 3);
+}
+
+constexpr double ConstSin( double x )
+{
+	double r = 0.0;
+	switch ( ConstReduceAngle(x, &r) ) {
+	case 0:
+		return ConstSinReduced(r);
+	case 1:
+		return ConstCosReduced(r);
+	case 2:
+		return -ConstSinReduced(r);
+	default:
+		return -ConstCosReduced(r);
+	}
+}
+
+constexpr double ConstCos( double x )
+{
+	double r = 0.0;
+	switch ( ConstReduceAngle(x, &r) ) {
+	case 0:
+		return ConstCosReduced(r);
+	case 1:
+		return -ConstSinReduced(r);
+	case 2:
+		return -ConstCosReduced(r);
+	default:
+		return ConstSinReduced(r);
+	}
+}
+
+// Compile time checks against known values (to within one or two ulps).
+static_assert( ConstSqrt(4.0)==2.0 && ConstSqrt(0.0)==0.0, "ConstSqrt" );
+static_assert( ConstSqrt(2.0)-1.4142135623730951<4.0e-16 && 1.4142135623730951-ConstSqrt(2.0)<4.0e-16, "ConstSqrt" );
+static_assert( ConstSin(PIsixths)-0.5<2.0e-16 && 0.5-ConstSin(PIsixths)<2.0e-16, "ConstSin" );
+static_assert( ConstCos(PIthirds)-0.5<4.0e-16 && 0.5-ConstCos(PIthirds)<4.0e-16, "ConstCos" );
+static_assert( ConstSin(PIfourths)-0.7071067811865476<4.0e-16 && 0.7071067811865476-ConstSin(PIfourths)<4.0e-16, "ConstSin" );
+static_assert( ConstSin(PIhalves)==1.0 && ConstCos(PI)==-1.0 && ConstCos(0.0)==1.0, "ConstSin and ConstCos" );
+
 inline double ZeroValue(const double& )
 {
 	return 0.0;
@@ -22,6 +22,8 @@
 #include "GlGeomSphere.h"
 #include "GlGeomCylinder.h"
 #include "GlGeomTorus.h"
+#include "SceneGraph.h"
+#include "AnimCurves.h"
 
 // Enable standard input and output via printf(), etc.
 // Put this include *after* the includes for glew and GLFW!
@@ -39,7 +41,6 @@
 // YOU MAY WISH TO RE-DO THIS FOR YOUR CUSTOM ANIMATION.  
 double animateIncrement = 0.01;   // Make bigger to speed up animation, smaller to slow it down.
 double currentTime = 0.0;         // Current "time" for the animation.
-double currentTime_rev = 0.0;
 double maxTime = 1.0;             // Time cycles back to 0 after reaching maxTime.
 
 // These two variables control whether running or paused.
@@ -56,6 +57,25 @@ GlGeomCylinder unitCylinder;
 GlGeomTorus torus1(6, 6, 0.05f);   // Set default mesh resolutions and inner radius
 // Initialize multiple tori if they have different inder radii.
 
+// The scene graph for the initial.
+//    The nodes which are animated are remembered so that MyRenderInitial() can update them.
+SceneGraph initialScene;
+SceneNode* initialRoot;         // Holds the view matrix
+SceneNode* crossbarNode;        // The crossbar of the "H" (animated)
+SceneNode* nucleusNode;         // The nucleus (animated)
+SceneNode* electronNode;        // The electron (animated)
+SceneNode* orbitNode1;          // The two large orbit tori (animated)
+SceneNode* orbitNode2;
+
+// The keyframed animation of the initial, evaluated at currentTime.
+//    One track for each animated quantity.
+AnimCurveSet initialAnimation;
+int crossbarTrack;              // Length of the crossbar (scalar)
+int nucleusSpinTrack;           // Rotations (quaternions)
+int electronSpinTrack;
+int orbitSpinTrack1;
+int orbitSpinTrack2;
+
 // **********************
 // This sets up a sphere and a cylinder and a torus needed for the "Initial" (the 3-D alphabet letter)
 //  This routine is called only once, for the first initialization.
@@ -68,18 +88,118 @@ void MySetupInitialGeometries() {
     unitCylinder.InitializeAttribLocations(vPos_loc, vNormal_loc, vTexcoords_loc);
     torus1.InitializeAttribLocations(vPos_loc, vNormal_loc, vTexcoords_loc);
 
+    MySetupInitialScene();
+
     check_for_opengl_errors();
 }
 
+// **********************
+// The local matrices of the static parts of the initial.
+//    These are constant expressions, so they are computed by the compiler.
+// **********************
+static constexpr LinearMapR4 TranslateScale(double tx, double ty, double tz,
+                                            double sx, double sy, double sz) {
+    LinearMapR4 mat;
+    mat.Set_glTranslate(tx, ty, tz);
+    mat.Mult_glScale(sx, sy, sz);
+    return mat;
+}
+static constexpr LinearMapR4 letterMatrix = TranslateScale(-2.5, 2.0, -2.5, 1.0, 1.0, 1.0);  // Center of the letter
+// The two upright cylinders: translated slightly towards the viewer,
+//    then scaled to thinner, flatter and taller
+static constexpr LinearMapR4 leftBarMatrix = TranslateScale(-1.0, 0.0, -0.3, 0.4, 2.0, 0.2);
+static constexpr LinearMapR4 rightBarMatrix = TranslateScale(1.0, 0.0, -0.3, 0.4, 2.0, 0.2);
+static constexpr LinearMapR4 smallTorusMatrix = TranslateScale(0.0, 0.0, -0.3, 0.8, 0.8, 0.8);
+// The crossbar is rotated onto its side: PIhalves radians around the z-axis.
+static constexpr Quatf crossbarOnSide(0.0f, 0.0f, (float)ConstSin(0.5*PIhalves), (float)ConstCos(0.5*PIhalves));
+
+// **********************
+// Build the scene graph for the initial.  Called once.
+//   The static parts are given their final local matrices here.
+//   The animated parts are given their local matrices by MyRenderInitial().
+// **********************
+void MySetupInitialScene() {
+    initialRoot = initialScene.GetRoot().AddChild();
+    SceneNode* letterNode = initialRoot->AddChild();
+    letterNode->SetLocalMatrix(letterMatrix);
+
+    // First cylinder of the H (left)
+    SceneNode* node = letterNode->AddChild(&unitCylinder);
+    node->SetColor(0.4f, 0.9f, 0.4f);
+    node->SetLocalMatrix(leftBarMatrix);
+
+    // Second cylinder of the H (right)
+    node = letterNode->AddChild(&unitCylinder);
+    node->SetColor(0.4f, 0.9f, 0.4f);
+    node->SetLocalMatrix(rightBarMatrix);
+
+    // Third cylinder, across the H
+    crossbarNode = letterNode->AddChild(&unitCylinder);
+    crossbarNode->SetColor(0.4f, 0.9f, 0.4f);
+
+    // The nucleus of the atom, and the electron orbiting it
+    nucleusNode = letterNode->AddChild(&unitSphere);
+    nucleusNode->SetColor(1.0f, 1.0f, 1.0f);
+    electronNode = letterNode->AddChild(&unitSphere);
+    electronNode->SetColor(1.0f, 1.0f, 1.0f);
+
+    // The small torus, and the two tumbling orbits
+    node = letterNode->AddChild(&torus1);
+    node->SetColor(0.2f, 0.1f, 1.0f);
+    node->SetLocalMatrix(smallTorusMatrix);
+    orbitNode1 = letterNode->AddChild(&torus1);
+    orbitNode1->SetColor(0.2f, 0.1f, 0.4f);
+    orbitNode2 = letterNode->AddChild(&torus1);
+    orbitNode2->SetColor(0.2f, 0.1f, 0.4f);
+
+    MySetupInitialAnimation();
+}
+
+// A track for one full turn around the axis as time goes from 0 to maxTime.
+//    Four quarter turns: Slerp between the keys rotates at a constant rate.
+static int AddSpinTrack(float axisX, float axisY, float axisZ) {
+    float times[5];
+    Quatf keys[5];
+    for (int i = 0; i < 5; i++) {
+        times[i] = (float)(0.25 * i * maxTime);
+        keys[i].SetRotate((float)(0.25 * i * PI2), axisX, axisY, axisZ);
+    }
+    return initialAnimation.AddTrack(AnimCurveSet::QuatTrack, AnimCurveSet::Linear, 5, times, &keys[0].x);
+}
+
+// **********************
+// Build the animation tracks for the initial.  Called once.
+// **********************
+void MySetupInitialAnimation() {
+    initialAnimation.Clear();
+
+    // The crossbar grows and shrinks: its length goes linearly from -1.3 to 1.3.
+    //    (The negative lengths turn the cylinder inside out, which looks the same.)
+    const float crossbarTimes[2] = { 0.0f, (float)maxTime };
+    const float crossbarLengths[2] = { -1.3f, 1.3f };
+    crossbarTrack = initialAnimation.AddTrack(AnimCurveSet::ScalarTrack, AnimCurveSet::Linear,
+                                              2, crossbarTimes, crossbarLengths);
+
+    nucleusSpinTrack = AddSpinTrack(1.0f, 0.0f, 0.0f);
+    electronSpinTrack = AddSpinTrack(1.0f, 1.0f, 1.0f);
+    orbitSpinTrack1 = AddSpinTrack(1.0f, 1.0f, 1.0f);
+    orbitSpinTrack2 = AddSpinTrack(-1.0f, -1.0f, -1.0f);
+}
+
 // *********************
 // This is called when geometric shapes are initialized.
 // And is called again whenever the mesh resolution changes.
 // IF YOU ADD EXTRA TORII, THEY NEED TO BE HANDLED HERE
+// With largeMeshes, the sphere and torus have LargeMeshFactor times the resolution
+//    (up to several million triangles each), and are loaded in chunks (see GlGeomBase.h).
 // ********************
+const int LargeMeshFactor = 32;
+
 void MyRemeshGeometries() {
-    unitSphere.Remesh(meshRes, meshRes);              // Number of slices and stacks both set to meshRes
+    int largeRes = largeMeshes ? LargeMeshFactor * meshRes : meshRes;
+    unitSphere.Remesh(largeRes, largeRes);            // Number of slices and stacks both set to largeRes
     unitCylinder.Remesh(meshRes, meshRes, meshRes);   // Number of slices, stacks and rings all set to meshRes
-    torus1.Remesh(meshRes, meshRes);                  // Number of rings and number of sides per ring.
+    torus1.Remesh(largeRes, largeRes);                // Number of rings and number of sides per ring.
 }
 
 // *************************************
@@ -95,110 +215,40 @@ void MyRenderInitial() {
     //  
     if (spinMode) {
         currentTime += animateIncrement;
-        currentTime_rev += animateIncrement;
         if (currentTime >= maxTime) {
             currentTime = currentTime - floor(currentTime / maxTime);  // Floor function = round down to nearest integer
         }
-
-        if (currentTime_rev > maxTime) {
-            currentTime_rev = floor(currentTime_rev / maxTime) - currentTime_rev; //givs 
-        }
         if (singleStep) {
             spinMode = false;       // If in single step mode, turn off future animation
         }
     }
 
-    // Render the letter "X" (Sam's initial) with two cylinders,
-    //    Plus a revolving ellipsoid.
+    // Render the letter "H" (for Hydrogen) with three cylinders,
+    //    plus a nucleus and an orbiting electron, and three tori.
+    // The parts are nodes in the scene graph built by MySetupInitialScene().
+    // Only the animated nodes are updated here; the static parts keep their
+    //    cached modelview matrices until the view changes.
+    initialRoot->SetLocalMatrix(viewMatrix);        // Base off of viewMatrix
 
-    // Setup the main Model view matrix
-    LinearMapR4 mat1 = viewMatrix;              // Base off of viewMatrix
-    mat1.Mult_glTranslate(-2.5, 2.0, -2.5);     // Center of the letter
+    // The animated parts are TRSf transforms: translate, rotate (a quaternion), then scale.
+    //    All the animation tracks are evaluated at once.
+    initialAnimation.Evaluate((float)currentTime);
+    float crossbarLength = initialAnimation.GetScalar(crossbarTrack);
+    crossbarNode->SetLocalTransform(TRSf(0.0f, 0.0f, -0.3f, crossbarOnSide, 0.3f, crossbarLength, 0.3f));
 
-    // Make the X partgreen-ish (YOU ARE ENCOURAGED TO ALTER COLORS) // 
-    // We will be creating an H representing Hytdrogen, with an ELECTRON ORBITTING IT! 
-    glVertexAttrib3f(vColor_loc, 0.4f, 0.9f, 0.4f);
-
-    // Draw first cylinder of the H ( left) 
-    LinearMapR4 mat2 = mat1;                   // Modelview matrix for cylinders & sphere
-    mat2.Mult_glTranslate(-1.0, 0.0, -0.3);         // Translate slightly towards the viewer  
-    //mat2.Mult_glRotate(-PIsixths, 0.0, 0.0, 1.0); // Rotate -30 degrees
-    mat2.Mult_glScale(0.4, 2.0, 0.2);          // Scale the cylinder, to thiner, flater and taller 
-    mat2.DumpByColumns(matEntries);
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    unitCylinder.Render();
-
-    // Draw the second cylinder of the H (right) 
-    mat2 = mat1;                               // Back to the main Modelview matrix
-    mat2.Mult_glTranslate(1.0, 0.0, -0.3);        // Translate slightly away from the viewer
-    //mat2.Mult_glRotate(PIsixths, 0.0, 0.0, 1.0);  // Rotate 30 degrees
-    mat2.Mult_glScale(0.4, 2.0, 0.2);          // Scale the cylinder, to thiner, flater and taller 
-    mat2.DumpByColumns(matEntries);
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    unitCylinder.Render();
+    TRSf spin;
+    spin.SetRotate(initialAnimation.GetQuat(nucleusSpinTrack));
+    nucleusNode->SetLocalTransform(spin * TRSf(0.0f, 0.9f, -0.3f, Quatf(), 0.4f, 0.4f, 0.4f));
 
-    // Draw the third cylinder across of the H 
+    spin.SetRotate(initialAnimation.GetQuat(electronSpinTrack));
+    electronNode->SetLocalTransform(spin * TRSf(0.0f, 3.0f, -0.3f, Quatf(), 0.2f, 0.2f, 0.2f));
 
-    mat2 = mat1;
-    mat2.Mult_glTranslate(0.0, 0.0, -0.3);
-    mat2.Mult_glRotate(PIhalves, 0.0, 0.0, 1.0);  // Rotate onto its side m,.nm,.jhklhjkl;;hjkl
-    mat2.Mult_glScale(0.3, 1.3 * (currentTime - (1 - currentTime_rev)), 0.3);          // Scale the cylinder, to thiner, flater and taller 
-    mat2.DumpByColumns(matEntries);
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    unitCylinder.Render();
-
-
-
-    // Draw the nucleus of the Atom! // just for fun, we can have it rotate around the center 
-    glVertexAttrib3f(vColor_loc, 1.0f, 1.0f, 1.0f);
-    mat2 = mat1;
-    mat2.Mult_glRotate(currentTime * PI2, 1.0, 0.0, 0.0);   // PI2 is 2*pi (defined in MathMisc.h)
-    mat2.Mult_glTranslate(0.0, 0.9, -0.3);
-    // mat2.Mult_glRotate(PIhalves, 0.0, 0.0, 1.0);  // Rotate 30 degrees
-    mat2.Mult_glScale(0.4, 0.4, 0.4);          // Scale the cylinder, to thiner, flater and taller 
-    mat2.DumpByColumns(matEntries);
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    unitSphere.Render();
-
-    // ELECTRONNNN 
-    glVertexAttrib3f(vColor_loc, 1.0f, 1.0f, 1.0f);
-    mat2 = mat1;
-    mat2.Mult_glRotate(currentTime * PI2, 1.0, 1.0, 1.0);   // PI2 is 2*pi (defined in MathMisc.h)
-    mat2.Mult_glTranslate(0.0, 3.0, -0.3);
-    // mat2.Mult_glRotate(PIhalves, 0.0, 0.0, 1.0);  // Rotate 30 degrees
-    mat2.Mult_glScale(0.2, 0.2, 0.2);          // Scale the cylinder, to thiner, flater and taller 
-    mat2.DumpByColumns(matEntries);
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    unitSphere.Render();
-
-    // Render the torus
-    glVertexAttrib3f(vColor_loc, 0.2f, 0.1f, 1.0f);  // Red color (slightly darkened)
-    mat2 = mat1;                              // Back to the main Modelview matrix
-    mat2.Mult_glTranslate(0.0, 0.0, -0.3);
-    mat2.Mult_glScale(0.8);                   // Uniform scaling
-    mat2.DumpByColumns(matEntries);
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    torus1.Render();
-
-    glVertexAttrib3f(vColor_loc, 0.2f, 0.1f, 0.4f);  // Red color (slightly darkened)
-    mat2 = mat1;                              // Back to the main Modelview matrix
-    mat2.Mult_glTranslate(0.0, 0.0, -0.3);
-    mat2.Mult_glRotate(currentTime * PI2, 1.0, 1.0, 1.0);   // PI2 is 2*pi (defined in MathMisc.h)
-    mat2.Mult_glScale(3.0);                   // Uniform scaling
-    mat2.DumpByColumns(matEntries);
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    torus1.Render();
-
-
-    glVertexAttrib3f(vColor_loc, 0.2f, 0.1f, 0.4f);  // Red color (slightly darkened)
-    mat2 = mat1;                              // Back to the main Modelview matrix
-    mat2.Mult_glTranslate(0.0, 0.0, -0.3);
-    mat2.Mult_glRotate(currentTime * PI2, -1.0, -1.0, -1.0);   // PI2 is 2*pi (defined in MathMisc.h)
-    mat2.Mult_glScale(3.0);                   // Uniform scaling
-    mat2.DumpByColumns(matEntries);
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    torus1.Render();
+    Quatf orbit = initialAnimation.GetQuat(orbitSpinTrack1);
+    orbitNode1->SetLocalTransform(TRSf(0.0f, 0.0f, -0.3f, orbit, 3.0f, 3.0f, 3.0f));   // Uniform scaling
+    orbit = initialAnimation.GetQuat(orbitSpinTrack2);
+    orbitNode2->SetLocalTransform(TRSf(0.0f, 0.0f, -0.3f, orbit, 3.0f, 3.0f, 3.0f));
 
+    initialScene.Render(modelviewMatLocation, vColor_loc);
 
     // Render the revolving ellipsoid
     /*
@@ -15,6 +15,7 @@
 //    but MyInitial.cpp is responsible for maintaining them.
 extern GlGeomSphere unitSphere;
 extern GlGeomCylinder unitCylinder;
+extern GlGeomTorus torus1;
 
 // These variables control the animation.
 // MyInitial.cpp has the primary responsibility of maintaining them.
@@ -30,6 +31,8 @@ extern bool singleStep;
 // Function Prototypes
 //
 void MySetupInitialGeometries();   // Called once, before rendering begins.
+void MySetupInitialScene();        // Builds the scene graph for the initial (called by MySetupInitialGeometries).
+void MySetupInitialAnimation();    // Builds the animation tracks for the initial (called by MySetupInitialScene).
 void MyRemeshGeometries();         // Called when mesh changes, must update initial's goemetries.
 
 void MyRenderInitial();
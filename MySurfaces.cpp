@@ -2,8 +2,9 @@
 //  MySurfaces.cpp
 //
 //   Sets up and renders 
-//     - the ground plane, and
-//     - the surface of rotation
+//     - the ground plane,
+//     - the surface of rotation, and
+//     - a teapot made of Bezier patches
 //   for the Math 155A project #4.
 //
 //   Comes supplied with the code for Sam Buss's "X".
@@ -19,6 +20,10 @@
 #include "LinearR4.h"		// Adjust path as needed.
 #include "MathMisc.h"       // Adjust path as needed
 
+#include <vector>
+
+#include "GlGeomProcedural.h"
+#include "GlGeomTeapot.h"
 #include "MySurfaces.h"
 #include "SurfaceProj.h"
 
@@ -35,6 +40,16 @@ unsigned int myVBO[NumObjects];  // a Vertex Buffer Object holds an array of dat
 unsigned int myVAO[NumObjects];  // a Vertex Array Object - holds info about an array of vertex data;
 unsigned int myEBO[NumObjects];  // a Element Array Buffer Object - holds an array of elements (vertex indices)
 
+// The vertex data and elements computed by MyGenerateFloor() and MyGenerateCircularSurf(),
+//    kept until MyLoadFloor() and MyLoadCircularSurf() copy them into the VBO's and EBO's.
+std::vector<float> floorVerts;
+std::vector<unsigned int> floorElements;
+std::vector<float> circularVerts;
+std::vector<unsigned int> circularElements;
+
+// The teapot has its own VAO, VBO and EBO (see GlGeomBezier.h).
+GlGeomTeapot teapot;
+
 // **********************
 // This sets up geometries needed for the "Initial" (the 3-D alphabet letter)
 //  It is called only once.
@@ -80,6 +95,7 @@ void MySetupSurfaces() {
     // This is done next by the "Remesh" routines.
 
     MyRemeshSurfaces();
+    teapot.InitializeAttribLocations(vPos_loc, vNormal_loc);
 
     check_for_opengl_errors();      // Watch the console window for error messages!
 }
@@ -100,6 +116,43 @@ void MyRemeshSurfaces()
     //RemeshCircularDemo();
     MyRemeshCircularSurf();
 
+    MyRemeshTeapot();
+
+    check_for_opengl_errors();      // Watch the console window for error messages!
+}
+
+// Remeshing in two steps (see MyRemeshScene() in SurfaceProj.cpp):
+//    The "Generate" routines compute the data and make no OpenGL calls,
+//    so they may run on worker threads, in parallel.  The "Load" routines
+//    then load the data into the VBO's and EBO's.
+void MyRemeshFloor()
+{
+    MyGenerateFloor();
+    MyLoadFloor();
+}
+
+void MyRemeshCircularSurf()
+{
+    MyGenerateCircularSurf();
+    MyLoadCircularSurf();
+}
+
+// Only sets the teapot's resolution.  The mesh is computed and loaded when it is next rendered
+//    without the tessellation shaders, and not at all when it is rendered with them.
+void MyRemeshTeapot()
+{
+    teapot.Remesh(meshRes, meshRes);
+}
+
+void MyReloadTeapot()
+{
+    teapot.InitializeAttribLocations(vPos_loc, vNormal_loc);
+}
+
+void MyLoadSurfaces()
+{
+    MyLoadFloor();
+    MyLoadCircularSurf();
     check_for_opengl_errors();      // Watch the console window for error messages!
 }
 
@@ -118,6 +171,8 @@ void MyRenderSurfaces() {
     //RenderCircularDemo();
     MyRenderCircularSurf();
 
+    MyRenderTeapot();
+
     check_for_opengl_errors();      // Watch the console window for error messages!
 }
 
@@ -230,18 +285,16 @@ void RenderCircularDemo()
 // THE CODE BELOW MUST BE WRITTEN FOR PROJECT 4.
 // *********************************************
 
-void MyRemeshFloor()
+void MyGenerateFloor()
 {
-    // Sample code for allocating arrays of floats and unsigned int's with new[] and delete[]
-    // The code fragment for allocating/deleting arrays uses C++ new and delete[].
-    // You may optionally instead use the Standard Template Library std::vector<float> if you wish.
+    // The arrays are Standard Template Library std::vector's, kept until MyLoadFloor().
 
     // Floor vertices.
     int numFloorVerts = (meshRes + 1) * (meshRes + 1);
-    float* floorVerts = new float[3 * numFloorVerts];
+    floorVerts.resize(3 * numFloorVerts);
     // Floor elements (indices to vertices in a triangle strip)
     int numFloorElts = meshRes * 2 * (meshRes + 1);
-    unsigned int* floorElements = new unsigned int[numFloorElts];
+    floorElements.resize(numFloorElts);
 
     // YOU CAN NOW ACCESS floorVerts AND floorElements WITH THE SAME
     // SYNTAX AS ARRAYS.  FOR EXAMPLE,
@@ -278,26 +331,27 @@ void MyRemeshFloor()
     }
     printf("\n");
 #endif
+}
 
+void MyLoadFloor()
+{
     // Load data into the VBO and EBO using glBindBuffer and glBufferData commands
     // YOU NEED TO WRITE THIS CODE FOR THE PROJECT 4
     // x y z * 3 
     glBindBuffer(GL_ARRAY_BUFFER, myVBO[iFloor]);
-    glBufferData(GL_ARRAY_BUFFER, 3 * sizeof(float) * numFloorVerts, floorVerts, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * floorVerts.size(), floorVerts.data(), GL_STATIC_DRAW);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iFloor]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * numFloorElts, floorElements, GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * floorElements.size(), floorElements.data(), GL_STATIC_DRAW);
 
-
-    // The array should have been copied into the GPU buffers now.
-    // If you use "new" above, you MUST delete the arrays here to avoid a memory leak.
-    delete[] floorVerts;
-    delete[] floorElements;
+    // The arrays have been copied into the GPU buffers now: release their memory.
+    std::vector<float>().swap(floorVerts);
+    std::vector<unsigned int>().swap(floorElements);
 }
 
 // ****
 // MyRemeshCircularSurf: To be written for Project 4.
 // ****
-void MyRemeshCircularSurf()
+void MyGenerateCircularSurf()
 {
     // WRITE THIS ENTIRE ROUTINE FOR THE CIRCULAR SURFACE
     // ALLOCATE MEMORY FOR ARRAYS, AND 
@@ -308,9 +362,9 @@ void MyRemeshCircularSurf()
 
     // its 9 * 6 
     int numCircularVerts = ((meshRes)*meshRes + 1) * 6; 
-    float* circularVerts = new float[numCircularVerts];
+    circularVerts.resize(numCircularVerts);
     int numCircularElements = (2* meshRes + 1)*meshRes; 
-    unsigned int* circularElements = new unsigned int[numCircularElements];
+    circularElements.resize(numCircularElements);
 
     // Circular Verts 
     // go through the rows then go through each set
@@ -325,26 +379,36 @@ void MyRemeshCircularSurf()
     circularVerts[4] = 1.0f; 
     circularVerts[5] = 0.0f; 
 
+    // The radius, and its sine and cosine, depend only on j: compute them once for all the spokes.
+    std::vector<float> radii(meshRes), sinRadii(meshRes), cosRadii(meshRes);
+    for (int j = 0; j < meshRes; j++) {
+        radii[j] = (2.7 * PI2 * (float(j))) / meshRes; // our radius changes each time we finish a j loop  
+        sinRadii[j] = sin(radii[j]);
+        cosRadii[j] = cos(radii[j]);
+    }
+
     // Define the variables necessary 
     float slope = 0, compute = 0, magnitude = 0, xVal = 0, yVal = 0, zVal = 0;
     for (int i = 0; i < meshRes; i++) { // this controls going aroud, so it should change our theta value each time it goes through 
-        //radius = (2.7 * PI2 * (i + 1)) / meshRes;
+        // The sines and cosines of the angle are the same for the whole spoke
+        float cosTheta = cos(theta * (float)i);
+        float sinTheta = sin(theta * (float)i);
+        double sinNegTheta = sin(-1.0 * theta * (float)i);
         for (int j = 0; j < meshRes; j++) { // Changes the radius
-            radius = (2.7 * PI2 * (float(j))) / meshRes; // our radius changes each time we finish a j loop  
-            // skip the center tho
-            // might do (float)j * to the front of each 
-            circularVerts[6*(1+i*meshRes+j)] = radius * cos(theta * (float)i); // do the x variable x = -rcos(theta); 
-            circularVerts[6 * (1 + i * meshRes + j) + 1] =  (radius * sin(radius)) / (1 + radius); // y variable y = r*sin(r) / 1 + r
-            circularVerts[6 * (1 + i * meshRes + j) + 2] =  radius * sin(-1.0 * theta* (float)i); // z variable z = -rsin(theta); 
-            xVal = radius * cos(theta * (float)i);
-            yVal = (radius * sin(radius)) / (1 + radius);
-            zVal = radius * sin(-1.0 * theta * (float)i); 
-            slope = (sin(radius) + (radius * radius + radius) * cos(radius)) / ((radius + 1) * (radius + 1));
+            radius = radii[j];
+            float* vert = &circularVerts[6 * (1 + i * meshRes + j)];
+            xVal = radius * cosTheta;                               // do the x variable x = -rcos(theta); 
+            yVal = (radius * sinRadii[j]) / (1 + radius);           // y variable y = r*sin(r) / 1 + r
+            zVal = radius * sinNegTheta;                            // z variable z = -rsin(theta); 
+            vert[0] = xVal;
+            vert[1] = yVal;
+            vert[2] = zVal;
+            slope = (sinRadii[j] + (radius * radius + radius) * cosRadii[j]) / ((radius + 1) * (radius + 1));
 
             magnitude = sqrt((xVal * xVal) + (yVal * yVal) + (zVal * zVal)); 
-            circularVerts[6 * (1 + i * meshRes + j) + 3] = -1.0 * ((cos(theta * (float)i)) * slope)/ magnitude; // normal x
-            circularVerts[6 * (1 + i * meshRes + j) + 4] = (1.0 / magnitude); // normal y 
-            circularVerts[6 * (1 + i * meshRes + j) + 5] = 1.0 *( sin(theta * (float)i) * slope) / magnitude; // normal z 
+            vert[3] = -1.0 * (cosTheta * slope) / magnitude;         // normal x
+            vert[4] = (1.0 / magnitude);                            // normal y 
+            vert[5] = 1.0 * (sinTheta * slope) / magnitude;         // normal z 
         }
     }
     // work in cylindrical coordinates-> (r,y) plane Calculate the tangent   
@@ -379,18 +443,20 @@ void MyRemeshCircularSurf()
     }
     printf("\n");
 #endif
+}
 
+void MyLoadCircularSurf()
+{
     // Done 
     glBindVertexArray(myVAO[iCircularSurf]);
     glBindBuffer(GL_ARRAY_BUFFER, myVBO[iCircularSurf]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float)  * numCircularVerts, circularVerts, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * circularVerts.size(), circularVerts.data(), GL_STATIC_DRAW);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iCircularSurf]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * numCircularElements, circularElements, GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * circularElements.size(), circularElements.data(), GL_STATIC_DRAW);
 
     // deallocate the memory 
-    delete[] circularVerts;
-    delete[] circularElements;
-
+    std::vector<float>().swap(circularVerts);
+    std::vector<unsigned int>().swap(circularElements);
 }
 
 // ****
@@ -409,6 +475,12 @@ void MyRenderFloor()
     viewMatrix.DumpByColumns(matEntries);
     glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
 
+    // Procedural rendering needs no VBO or EBO: the vertex shader computes the vertices.
+    if (GlGeomProcedural::IsEnabled()) {
+        GlGeomProcedural::RenderGrid(meshRes, 5.0f);
+        return;
+    }
+
     // Draw the four triangle strips
     // 2 * i * meshres + 1 is due to the fact that we needed 
 
@@ -441,4 +513,34 @@ void MyRenderCircularSurf()
         // might be 2 * meshRes + 1
         glDrawElements(GL_TRIANGLE_STRIP, (2 * meshRes + 1), GL_UNSIGNED_INT, (void*)(i * (2 * meshRes + 1) * sizeof(unsigned int)));
     }
-}
\ No newline at end of file
+}
+
+// ****
+// MyRenderTeapot: Renders the teapot, in the front left quadrant.
+//    The teapot is only shown while one of the GPU paths for Bezier patches is on:
+//    with bezierTessellation, the tessellation shaders compute its mesh from the control points;
+//    with the compute shader, CalcVboAndEbo is done on the GPU (see GlGeomBezier.h).
+// ****
+void MyRenderTeapot()
+{
+    if (!bezierTessellation && GlGeomBezier::GetComputeProgram() == 0) {
+        return;
+    }
+    LinearMapR4 matTeapot = viewMatrix;
+    matTeapot.Mult_glTranslate(-2.5, 0.0, 2.5);     // Center in the front left quadrant
+    matTeapot.Mult_glScale(0.5);
+
+    glVertexAttrib3f(vColor_loc, 0.6f, 0.8f, 1.0f);	 // Generic vertex attribute: Color (light blue) for the teapot.
+    matTeapot.DumpByColumns(matEntries);
+
+    if (bezierTessellation) {
+        unsigned int bezierParamsLoc = myUseProgramTessellated();
+        glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
+        teapot.RenderTessellated(bezierParamsLoc);
+        myUseProgramUntessellated();
+        return;
+    }
+    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
+    teapot.Render();
+}
+
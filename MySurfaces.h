@@ -4,8 +4,9 @@
 // MySurfaces.h   ---  Header file for MySurfaces.cpp.
 // 
 //   Sets up and renders 
-//     - the ground plane, and
-//     - the surface of rotation
+//     - the ground plane,
+//     - the surface of rotation, and
+//     - a teapot made of Bezier patches
 //   for the Math 155A project #4.
 //
 //
@@ -17,13 +18,21 @@ void MySetupSurfaces();             // Called once, before rendering begins.
 void MyRemeshSurfaces();            // Called when mesh changes, must update resolutions.
 void MyRemeshFloor();               // Update resolution of the ground plane
 void MyRemeshCircularSurf();        // Update resolution of the surface of rotation.
+void MyRemeshTeapot();              // Update resolution of the teapot (its mesh is computed lazily)
+void MyReloadTeapot();              // Computes and loads the teapot's mesh now (e.g., after a change of GlGeomBezier::SetComputeProgram)
+void MyGenerateFloor();             // Computes the ground plane's data (no OpenGL calls: may run on any thread)
+void MyGenerateCircularSurf();      // Computes the surface of rotation's data (no OpenGL calls)
+void MyLoadFloor();                 // Loads the data from MyGenerateFloor() into the VBO and EBO
+void MyLoadCircularSurf();          // Loads the data from MyGenerateCircularSurf() into the VBO and EBO
+void MyLoadSurfaces();              // Loads both
 
 void RemeshFloorDemo();             // Fixed size example of rendering the plane
 void RemeshCircularDemo();          // Fixed size example of circular rendering
 
-void MyRenderSurfaces();            // Called to render the two surfaces
+void MyRenderSurfaces();            // Called to render the surfaces
 void MyRenderFloor();               // Renders the meshed floor
 void MyRenderCircularSurf();        // Renders the meshed circular surface
+void MyRenderTeapot();              // Renders the teapot, if the tessellation or compute shader is on
 
 void RenderFloorDemo();             // Fixed size example of rendering the plane
 void RenderCircularDemo();          // Fixed size example of circular rendering
@@ -0,0 +1,78 @@
+/*
+* ParallelFor.cpp - Version 1.0
+*
+* Splits a loop into ranges, and runs them in parallel on the TaskScheduler.
+*   See ParallelFor.h for information on how to use it.
+*
+* Software is "as-is" and carries no warranty.  It may be used without
+*   restriction, but if you modify it, please change the filenames to
+*   prevent confusion between different versions.
+*/
+
+#include <assert.h>
+#include <atomic>
+#include <thread>
+
+#include "MathMisc.h"
+#include "ParallelFor.h"
+#include "TaskScheduler.h"
+
+// Ranges per thread: a few more ranges than threads evens out ranges which run slower.
+static const int RangesPerThread = 4;
+
+// Atomic, since ParallelFor is called from tasks on several threads at once.
+static std::atomic<int> parallelForThreads(0);      // 0 means not set yet
+
+int GetParallelForThreads()
+{
+    int numThreads = parallelForThreads.load();
+    if (numThreads == 0) {
+        // Only the first thread here sets the default (SetParallelForThreads may have set it meanwhile).
+        int defaultThreads = Max((int)std::thread::hardware_concurrency(), 1);
+        parallelForThreads.compare_exchange_strong(numThreads, defaultThreads);
+        numThreads = parallelForThreads.load();
+    }
+    return numThreads;
+}
+
+void SetParallelForThreads(int numThreads)
+{
+    assert(numThreads >= 1);
+    parallelForThreads = numThreads;
+}
+
+// The calling thread and numThreads-1 helper tasks take ranges until none are left.
+//    So at most numThreads threads work on the loop, however many workers are idle.
+void ParallelFor(int begin, int end, int minPerTask, const std::function<void(int, int)>& body)
+{
+    assert(minPerTask >= 1);
+    int count = end - begin;
+    int numThreads = Min(GetParallelForThreads(), count / minPerTask);
+    if (numThreads <= 1) {
+        if (count > 0) {
+            body(begin, end);
+        }
+        return;
+    }
+    int numRanges = Min(RangesPerThread * numThreads, count / minPerTask);
+    std::atomic<int> nextRange(0);
+    std::atomic<int> helpersDone(0);
+    auto doRanges = [&] {
+        for (int r = nextRange++; r < numRanges; r = nextRange++) {
+            int start = begin + (int)((long long)count * r / numRanges);
+            int stop = begin + (int)((long long)count * (r + 1) / numRanges);
+            body(start, stop);
+        }
+    };
+
+    TaskScheduler& scheduler = TaskScheduler::Get();
+    int numHelpers = numThreads - 1;
+    for (int i = 0; i < numHelpers; i++) {
+        scheduler.Submit([&] {
+            doRanges();
+            helpersDone++;              // Last use of the loop's state by the helper
+        });
+    }
+    doRanges();
+    scheduler.HelpUntil([&] { return helpersDone == numHelpers; });
+}
@@ -0,0 +1,35 @@
+/*
+* ParallelFor.h - Version 1.0
+*
+* Splits a loop into ranges, and runs them in parallel.  The ranges run
+*   as tasks on the TaskScheduler's worker threads, so starting a loop costs
+*   a few microseconds instead of the cost of creating threads.  ParallelFor
+*   may be called from inside a task, or from inside another ParallelFor.
+*
+*   Loops with too few iterations to be worth splitting run on the calling
+*   thread only.
+*
+* Software is "as-is" and carries no warranty.  It may be used without
+*   restriction, but if you modify it, please change the filenames to
+*   prevent confusion between different versions.
+*/
+
+#pragma once
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <functional>
+
+// Calls body(start, end) for disjoint ranges [start, end) which together cover [begin, end).
+//    The calls may run in parallel, in any order.  Each range has at least
+//    minPerTask iterations, so loops with fewer than 2*minPerTask iterations
+//    are not split.
+void ParallelFor(int begin, int end, int minPerTask, const std::function<void(int, int)>& body);
+
+// The number of threads used by ParallelFor, including the calling thread.
+//    The default is the number of hardware threads.  Set it to 1 to run
+//    every loop serially (e.g., to time the serial version).
+int GetParallelForThreads();
+void SetParallelForThreads(int numThreads);
+
+#endif  // PARALLEL_FOR_H
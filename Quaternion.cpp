@@ -0,0 +1,191 @@
+/*
+ *
+ * Quaternion.cpp, release 1.0.
+ *
+ * Quaternions for representing rotations in R3.  See Quaternion.h.
+ *
+ * Software is "as-is" and carries no warranty.  It may be used without
+ *   restriction, but if you modify it, please change the filenames to
+ *   prevent confusion between different versions.
+ *
+ */
+
+#include "Quaternion.h"
+
+// **************************************
+// Quaternion class                     *
+// * * * * * * * * * * * * * * * * * * **
+
+Quaternion& Quaternion::SetRotate( double theta, double ax, double ay, double az )
+{
+	double normSq = ax*ax + ay*ay + az*az;
+	assert( normSq > 0.0 );
+	double halfTheta = 0.5*theta;
+	double s = sin(halfTheta)/sqrt(normSq);
+	x = ax*s;
+	y = ay*s;
+	z = az*s;
+	w = cos(halfTheta);
+	return *this;
+}
+
+Quaternion& Quaternion::Set( const VectorR3& rotationVector )
+{
+	double theta = rotationVector.Norm();
+	if ( theta == 0.0 ) {
+		return SetIdentity();
+	}
+	return SetRotate( theta, rotationVector );
+}
+
+// Uses the largest of the four possible divisors, for numerical stability.
+Quaternion& Quaternion::Set( const Matrix3x3& R )
+{
+	double trace = R.m11 + R.m22 + R.m33;
+	if ( trace >= 0.0 ) {
+		double s = 2.0*sqrt( 1.0 + trace );		// s = 4w
+		w = 0.25*s;
+		x = (R.m32 - R.m23)/s;
+		y = (R.m13 - R.m31)/s;
+		z = (R.m21 - R.m12)/s;
+	}
+	else if ( R.m11 >= R.m22 && R.m11 >= R.m33 ) {
+		double s = 2.0*sqrt( 1.0 + R.m11 - R.m22 - R.m33 );	// s = 4x
+		x = 0.25*s;
+		y = (R.m12 + R.m21)/s;
+		z = (R.m13 + R.m31)/s;
+		w = (R.m32 - R.m23)/s;
+	}
+	else if ( R.m22 >= R.m33 ) {
+		double s = 2.0*sqrt( 1.0 - R.m11 + R.m22 - R.m33 );	// s = 4y
+		x = (R.m12 + R.m21)/s;
+		y = 0.25*s;
+		z = (R.m23 + R.m32)/s;
+		w = (R.m13 - R.m31)/s;
+	}
+	else {
+		double s = 2.0*sqrt( 1.0 - R.m11 - R.m22 + R.m33 );	// s = 4z
+		x = (R.m13 + R.m31)/s;
+		y = (R.m23 + R.m32)/s;
+		z = 0.25*s;
+		w = (R.m21 - R.m12)/s;
+	}
+	return *this;
+}
+
+Quaternion& Quaternion::Normalize()
+{
+	double normSq = NormSq();
+	assert( normSq > 0.0 );
+	double normInv = 1.0/sqrt(normSq);
+	x *= normInv;
+	y *= normInv;
+	z *= normInv;
+	w *= normInv;
+	return *this;
+}
+
+Quaternion Quaternion::Inverse() const
+{
+	double normSqInv = 1.0/NormSq();
+	return Quaternion( -x*normSqInv, -y*normSqInv, -z*normSqInv, w*normSqInv );
+}
+
+LinearMapR3 Quaternion::RotationMapR3() const
+{
+	double xx = x*x, yy = y*y, zz = z*z;
+	double xy = x*y, xz = x*z, yz = y*z;
+	double wx = w*x, wy = w*y, wz = w*z;
+	return LinearMapR3( 1.0 - 2.0*(yy + zz), 2.0*(xy + wz), 2.0*(xz - wy),		// Column 1
+						2.0*(xy - wz), 1.0 - 2.0*(xx + zz), 2.0*(yz + wx),		// Column 2
+						2.0*(xz + wy), 2.0*(yz - wx), 1.0 - 2.0*(xx + yy) );	// Column 3
+}
+
+LinearMapR4 Quaternion::RotationMapR4() const
+{
+	LinearMapR3 R = RotationMapR3();
+	LinearMapR4 ret;			// The zero matrix
+	ret.m11 = R.m11; ret.m12 = R.m12; ret.m13 = R.m13;
+	ret.m21 = R.m21; ret.m22 = R.m22; ret.m23 = R.m23;
+	ret.m31 = R.m31; ret.m32 = R.m32; ret.m33 = R.m33;
+	ret.m44 = 1.0;
+	return ret;
+}
+
+// **************************************
+// Interpolation                        *
+// * * * * * * * * * * * * * * * * * * **
+
+Quaternion Slerp( const Quaternion& q1, const Quaternion& q2, double alpha )
+{
+	double cosTheta = q1^q2;
+	double sign = 1.0;
+	if ( cosTheta < 0.0 ) {			// Take the shorter path
+		cosTheta = -cosTheta;
+		sign = -1.0;
+	}
+	double c1, c2;
+	if ( cosTheta > 0.9999 ) {
+		// Nearly equal: sin(theta) is too small to divide by.  Interpolate linearly.
+		c1 = 1.0 - alpha;
+		c2 = alpha;
+	}
+	else {
+		double theta = acos( cosTheta );
+		double sinThetaInv = 1.0/sin( theta );
+		c1 = sin( (1.0 - alpha)*theta )*sinThetaInv;
+		c2 = sin( alpha*theta )*sinThetaInv;
+	}
+	c2 *= sign;
+	Quaternion ret( c1*q1.x + c2*q2.x, c1*q1.y + c2*q2.y, c1*q1.z + c2*q2.z, c1*q1.w + c2*q2.w );
+	return ret.Normalize();
+}
+
+Quaternion Nlerp( const Quaternion& q1, const Quaternion& q2, double alpha )
+{
+	double c1 = 1.0 - alpha;
+	double c2 = ( (q1^q2) < 0.0 ) ? -alpha : alpha;
+	Quaternion ret( c1*q1.x + c2*q2.x, c1*q1.y + c2*q2.y, c1*q1.z + c2*q2.z, c1*q1.w + c2*q2.w );
+	return ret.Normalize();
+}
+
+// ******************************************************
+// VectorR3 and VectorR4 routines using Quaternions     *
+// * * * * * * * * * * * * * * * * * * * * * * * * * * **
+
+// The rotation vector of q: its direction is the axis of rotation,
+//   and its length is the angle of rotation (between 0 and pi).
+VectorR3& VectorR3::Set( const Quaternion& q )
+{
+	double sinHalf = sqrt( q.x*q.x + q.y*q.y + q.z*q.z );
+	if ( sinHalf == 0.0 ) {
+		return SetZero();
+	}
+	double theta = 2.0*atan2( sinHalf, fabs(q.w) );
+	double scale = ( q.w < 0.0 ? -theta : theta )/sinHalf;	// q and -q are the same rotation
+	x = q.x*scale;
+	y = q.y*scale;
+	z = q.z*scale;
+	return *this;
+}
+
+// Rotate by the unit quaternion q:  v + 2w(u*v) + 2u*(u*v), where u = (q.x, q.y, q.z)
+VectorR3& VectorR3::Rotate( const Quaternion& q )
+{
+	double tx = 2.0*(q.y*z - q.z*y);			// t = 2(u*v)
+	double ty = 2.0*(q.z*x - q.x*z);
+	double tz = 2.0*(q.x*y - q.y*x);
+	x += q.w*tx + (q.y*tz - q.z*ty);
+	y += q.w*ty + (q.z*tx - q.x*tz);
+	z += q.w*tz + (q.x*ty - q.y*tx);
+	return *this;
+}
+
+VectorR4& VectorR4::Set( const Quaternion& q )
+{
+	x = q.x;
+	y = q.y;
+	z = q.z;
+	w = q.w;
+	return *this;
+}
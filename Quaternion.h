@@ -0,0 +1,99 @@
+/*
+ *
+ * Quaternion.h, release 1.0.
+ *
+ * Quaternions for representing rotations in R3.
+ *   A unit quaternion  w + xi + yj + zk  represents the rotation by the
+ *   angle 2*acos(w) around the axis (x,y,z).  Both q and -q represent
+ *   the same rotation.
+ *
+ *   This file also defines the VectorR3 and VectorR4 routines declared
+ *   in LinearR3.h and LinearR4.h which take a Quaternion.
+ *
+ * Software is "as-is" and carries no warranty.  It may be used without
+ *   restriction, but if you modify it, please change the filenames to
+ *   prevent confusion between different versions.
+ *
+ */
+
+#ifndef QUATERNION_H
+#define QUATERNION_H
+
+#include <math.h>
+#include <assert.h>
+#include "LinearR3.h"
+#include "LinearR4.h"
+
+// **************************************
+// Quaternion class                     *
+// * * * * * * * * * * * * * * * * * * **
+
+class Quaternion {
+
+public:
+	double x, y, z, w;		// w is the scalar part
+
+public:
+	constexpr Quaternion() : x(0.0), y(0.0), z(0.0), w(1.0) {}		// The identity rotation
+	constexpr Quaternion( double xx, double yy, double zz, double ww ) : x(xx), y(yy), z(zz), w(ww) {}
+
+	Quaternion& Set( double xx, double yy, double zz, double ww )
+				{ x=xx; y=yy; z=zz; w=ww; return *this; }
+	Quaternion& SetIdentity() { x=0.0; y=0.0; z=0.0; w=1.0; return *this; }
+	// The rotation by theta radians around the axis.  The axis need not be a unit vector.
+	Quaternion& SetRotate( double theta, const VectorR3& axis );
+	Quaternion& SetRotate( double theta, double ax, double ay, double az );
+	// The rotation around the rotation vector:  its length is the angle (as in VectorR3::Set(Quaternion))
+	Quaternion& Set( const VectorR3& rotationVector );
+	// The rotation given by a rotation matrix (orthonormal, with determinant 1)
+	Quaternion& Set( const Matrix3x3& rotation );
+
+	double NormSq() const { return x*x + y*y + z*z + w*w; }
+	double Norm() const { return sqrt( NormSq() ); }
+	Quaternion& Normalize();
+	Quaternion Conjugate() const { return Quaternion( -x, -y, -z, w ); }
+	Quaternion Inverse() const;			// Equal to Conjugate() for unit quaternions
+
+	// Products.  The rotation for q1*q2 is the rotation for q2 followed by the rotation for q1.
+	Quaternion& operator*= ( const Quaternion& q );
+	Quaternion operator- () const { return Quaternion( -x, -y, -z, -w ); }
+
+	// The rotation matrix.  The quaternion must be a unit quaternion.
+	LinearMapR3 RotationMapR3() const;
+	LinearMapR4 RotationMapR4() const;		// An affine matrix
+};
+
+inline Quaternion operator* ( const Quaternion& q1, const Quaternion& q2 )
+{
+	return Quaternion( q1.w*q2.x + q1.x*q2.w + q1.y*q2.z - q1.z*q2.y,
+					   q1.w*q2.y + q1.y*q2.w + q1.z*q2.x - q1.x*q2.z,
+					   q1.w*q2.z + q1.z*q2.w + q1.x*q2.y - q1.y*q2.x,
+					   q1.w*q2.w - q1.x*q2.x - q1.y*q2.y - q1.z*q2.z );
+}
+
+inline Quaternion& Quaternion::operator*= ( const Quaternion& q )
+{
+	*this = (*this)*q;
+	return *this;
+}
+
+// Inner product (as for the vector classes)
+inline double operator^ ( const Quaternion& q1, const Quaternion& q2 )
+{
+	return q1.x*q2.x + q1.y*q2.y + q1.z*q2.z + q1.w*q2.w;
+}
+
+// Interpolation of rotations, alpha from 0 (q1) to 1 (q2).
+//   Both use the shorter path: q2 is negated if q1^q2 < 0.
+//   Slerp() rotates at a constant rate.  Nlerp() (linear interpolation,
+//   then normalization) is faster, but its rate varies slightly.
+//   q1 and q2 must be unit quaternions.
+Quaternion Slerp( const Quaternion& q1, const Quaternion& q2, double alpha );
+Quaternion Nlerp( const Quaternion& q1, const Quaternion& q2, double alpha );
+
+inline Quaternion& Quaternion::SetRotate( double theta, const VectorR3& axis )
+{
+	return SetRotate( theta, axis.x, axis.y, axis.z );
+}
+
+#endif // QUATERNION_H
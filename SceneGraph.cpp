@@ -0,0 +1,173 @@
+/*
+* SceneGraph.cpp - Version 1.0
+*
+* A small retained scene graph for the Math 155A project.
+*   See SceneGraph.h for information on how to use it.
+*
+* Software is "as-is" and carries no warranty.  It may be used without
+*   restriction, but if you modify it, please change the filenames to
+*   prevent confusion between different versions.
+*/
+
+// Use the static library (so glew32.dll is not needed):
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <string.h>
+#include "SceneGraph.h"
+#include "GlGeomBase.h"
+
+// ************************
+// SceneNode
+// ************************
+
+SceneNode::SceneNode(SceneGraph* graph, SceneNode* parentNode, GlGeomBase* geometry)
+{
+    ownerGraph = graph;
+    parent = parentNode;
+    theGeometry = geometry;
+    localMatrix.SetIdentity();
+    localMatrixF.SetIdentity();
+    worldMatrix.SetIdentity();
+    color[0] = color[1] = color[2] = 1.0f;
+}
+
+SceneNode::~SceneNode()
+{
+    for (SceneNode* child : children) {
+        delete child;
+    }
+}
+
+SceneNode* SceneNode::AddChild(GlGeomBase* geometry)
+{
+    SceneNode* child = new SceneNode(ownerGraph, this, geometry);
+    children.push_back(child);
+    child->MarkDirty();
+    ownerGraph->drawListDirty = true;
+    return child;
+}
+
+void SceneNode::SetLocalMatrix(const LinearMapR4& localMat)
+{
+    if (memcmp(&localMat, &localMatrix, sizeof(Matrix4x4)) == 0) {
+        return;                 // Unchanged: no need to recompute anything
+    }
+    localMatrix = localMat;
+    localMatrixF.Set(localMat);
+    MarkDirty();
+}
+
+void SceneNode::SetLocalTransform(const TRSf& localTRS)
+{
+    Mat4f localMat;
+    localTRS.ToMat4f(localMat);
+    if (memcmp(&localMat, &localMatrixF, sizeof(Mat4f)) == 0) {
+        return;                 // Unchanged: no need to recompute anything
+    }
+    localMatrixF = localMat;
+    const float* m = localMat.Data();
+    localMatrix.Set(m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7],
+                    m[8], m[9], m[10], m[11], m[12], m[13], m[14], m[15]);
+    MarkDirty();
+}
+
+void SceneNode::SetGeometry(GlGeomBase* geometry)
+{
+    theGeometry = geometry;
+    ownerGraph->drawListDirty = true;
+}
+
+void SceneNode::SetColor(float red, float green, float blue)
+{
+    color[0] = red;
+    color[1] = green;
+    color[2] = blue;
+}
+
+void SceneNode::SetVisible(bool visible)
+{
+    if (visible != isVisible) {
+        isVisible = visible;
+        ownerGraph->drawListDirty = true;
+    }
+}
+
+// Mark this node as changed, and let its ancestors know that
+//    their subtree needs to be visited during the next update.
+void SceneNode::MarkDirty()
+{
+    localDirty = true;
+    for (SceneNode* p = parent; p != 0 && !p->descendantDirty; p = p->parent) {
+        p->descendantDirty = true;
+    }
+}
+
+// Recompute the world matrix of this node if it or an ancestor changed.
+// Subtrees with no changes are skipped entirely.
+void SceneNode::UpdateWorld(const Mat4f& parentWorld, bool parentChanged)
+{
+    bool changed = parentChanged || localDirty;
+    if (changed) {
+        worldMatrix = parentWorld;
+        worldMatrix *= localMatrixF;
+        localDirty = false;
+    }
+    if (changed || descendantDirty) {
+        for (SceneNode* child : children) {
+            child->UpdateWorld(worldMatrix, changed);
+        }
+        descendantDirty = false;
+    }
+}
+
+void SceneNode::AppendDrawList(std::vector<const SceneNode*>& drawList) const
+{
+    if (!isVisible) {
+        return;                 // Invisible nodes hide their whole subtree
+    }
+    if (theGeometry != 0) {
+        drawList.push_back(this);
+    }
+    for (const SceneNode* child : children) {
+        child->AppendDrawList(drawList);
+    }
+}
+
+// ************************
+// SceneGraph
+// ************************
+
+SceneGraph::SceneGraph() : theRoot(this, 0, 0)
+{
+}
+
+void SceneGraph::Update()
+{
+    if (theRoot.localDirty || theRoot.descendantDirty) {
+        Mat4f identity;
+        theRoot.UpdateWorld(identity.SetIdentity(), false);
+    }
+    if (drawListDirty) {
+        drawList.clear();
+        theRoot.AppendDrawList(drawList);
+        drawListDirty = false;
+    }
+}
+
+void SceneGraph::Render(unsigned int modelviewMatLoc, unsigned int colorLoc)
+{
+    Update();
+
+    const float* lastColor = 0;
+    for (const SceneNode* node : drawList) {
+        const float* c = node->GetColor();
+        if (lastColor == 0 || memcmp(c, lastColor, 3 * sizeof(float)) != 0) {
+            glVertexAttrib3f(colorLoc, c[0], c[1], c[2]);
+            lastColor = c;
+        }
+        glUniformMatrix4fv(modelviewMatLoc, 1, false, node->GetWorldMatEntries());
+        node->GetGeometry()->Render();
+    }
+}
@@ -0,0 +1,140 @@
+/*
+* SceneGraph.h - Version 1.0
+*
+* A small retained scene graph for the Math 155A project.
+*   A SceneGraph holds a tree of SceneNode's.  Each node has a local
+*      transformation (relative to its parent), an optional geometry
+*      (a GlGeomShape object such as a GlGeomSphere) and a color.
+*   World (modelview) matrices are cached in each node as Mat4f's, ready
+*      for glUniformMatrix4fv, and are recomputed (in single precision)
+*      only when the node or one of its ancestors changes.
+*   Rendering walks a flat draw list, which is rebuilt only when
+*      the structure of the tree changes.
+*
+* Software is "as-is" and carries no warranty.  It may be used without
+*   restriction, but if you modify it, please change the filenames to
+*   prevent confusion between different versions.
+*/
+
+#pragma once
+#ifndef SCENE_GRAPH_H
+#define SCENE_GRAPH_H
+
+#include <vector>
+#include "LinearR4.h"
+#include "Mat4f.h"
+#include "TRSf.h"
+
+class GlGeomBase;
+class SceneGraph;
+
+// SceneNode
+//     One node of the scene graph.  Nodes are created by SceneGraph::GetRoot().AddChild()
+//     or by SceneNode::AddChild(), and are owned (and deleted) by their parent.
+// How to use:
+//     * Call SetLocalMatrix() or SetLocalTransform() to place the node relative to its parent.
+//       Nodes whose local matrix never changes are never recomputed,
+//       unless an ancestor changes.
+//     * Call SetGeometry() and SetColor() for nodes that are to be drawn.
+//       Nodes with no geometry just group their children.
+
+class SceneNode
+{
+    friend class SceneGraph;
+public:
+    ~SceneNode();
+
+    // Disable all copy and assignment operators for a SceneNode object.
+    SceneNode(const SceneNode&) = delete;
+    SceneNode& operator=(const SceneNode&) = delete;
+    SceneNode(SceneNode&&) = delete;
+    SceneNode& operator=(SceneNode&&) = delete;
+
+    // Add a new child node. The returned node is owned by this node.
+    SceneNode* AddChild(GlGeomBase* geometry = 0);
+
+    // Set the transformation from this node's coordinates to its parent's coordinates.
+    // Setting the same matrix again does not mark the node as changed.
+    void SetLocalMatrix(const LinearMapR4& localMat);
+    const LinearMapR4& GetLocalMatrix() const { return localMatrix; }
+    // The same, from a compact single precision transform (for animated nodes).
+    void SetLocalTransform(const TRSf& localTRS);
+
+    // The cached world (modelview) matrix. Valid after SceneGraph::Update() is called.
+    const Mat4f& GetWorldMatrix() const { return worldMatrix; }
+    const float* GetWorldMatEntries() const { return worldMatrix.Data(); }
+
+    void SetGeometry(GlGeomBase* geometry);
+    GlGeomBase* GetGeometry() const { return theGeometry; }
+    void SetColor(float red, float green, float blue);
+    const float* GetColor() const { return color; }
+    void SetVisible(bool visible);
+    bool IsVisible() const { return isVisible; }
+
+    SceneNode* GetParent() const { return parent; }
+    int GetNumChildren() const { return (int)children.size(); }
+    SceneNode* GetChild(int i) const { return children[i]; }
+
+private:
+    SceneNode(SceneGraph* graph, SceneNode* parentNode, GlGeomBase* geometry);
+
+    SceneGraph* ownerGraph;
+    SceneNode* parent;
+    std::vector<SceneNode*> children;
+
+    LinearMapR4 localMatrix;        // Maps this node's coordinates into its parent's coordinates
+    Mat4f localMatrixF;             // localMatrix rounded to floats
+    Mat4f worldMatrix;              // Product of all local matrices from the root down to this node
+
+    GlGeomBase* theGeometry;        // Geometry to render, or null for a grouping node
+    float color[3];
+    bool isVisible = true;
+
+    bool localDirty = true;         // localMatrix has changed since the last Update()
+    bool descendantDirty = false;   // Some descendant has localDirty set
+
+    void MarkDirty();
+    void UpdateWorld(const Mat4f& parentWorld, bool parentChanged);
+    void AppendDrawList(std::vector<const SceneNode*>& drawList) const;
+};
+
+// SceneGraph
+//     Owns the root node, updates the cached world matrices and
+//     renders the nodes which have geometry.
+// How to use:
+//     * Build the tree under GetRoot() once, when setting up the scene.
+//     * Each frame, change the local matrices of the animated nodes only,
+//       then call Render() (which calls Update()).
+
+class SceneGraph
+{
+public:
+    SceneGraph();
+    ~SceneGraph() {}
+
+    SceneGraph(const SceneGraph&) = delete;
+    SceneGraph& operator=(const SceneGraph&) = delete;
+    SceneGraph(SceneGraph&&) = delete;
+    SceneGraph& operator=(SceneGraph&&) = delete;
+
+    SceneNode& GetRoot() { return theRoot; }
+
+    // Recompute the world matrices of the changed nodes (and their descendants),
+    //    and rebuild the draw list if nodes were added or their geometry/visibility changed.
+    void Update();
+
+    // Render all visible nodes with geometry.
+    //   modelviewMatLoc - location of the modelview matrix uniform in the current shader program
+    //   colorLoc - location of the (generic) color vertex attribute
+    void Render(unsigned int modelviewMatLoc, unsigned int colorLoc);
+
+    int GetNumDrawItems() const { return (int)drawList.size(); }
+
+private:
+    friend class SceneNode;
+    SceneNode theRoot;
+    std::vector<const SceneNode*> drawList;
+    bool drawListDirty = true;
+};
+
+#endif  // SCENE_GRAPH_H
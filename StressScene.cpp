@@ -0,0 +1,198 @@
+//
+//  StressScene.cpp
+//
+//   A stress test for the renderer: fills the floor with stressCopies
+//   copies of the initial.  Each part of each copy is an entity in a
+//   TransformStore; all the parts using the same geometry are drawn
+//   with a single instanced draw call.
+//
+//   The average frame time, the time to update and upload the instance
+//   data, and the GPU time for the draw calls are printed every 60 frames.
+//
+
+
+// Use the static library (so glew32.dll is not needed):
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "LinearR3.h"
+#include "LinearR4.h"
+#include "MathMisc.h"
+#include "GlGeomSphere.h"
+#include "GlGeomCylinder.h"
+#include "GlGeomTorus.h"
+#include "TransformStore.h"
+#include "GlStreamBuffer.h"
+
+// Enable standard input and output via printf(), etc.
+// Put this include *after* the includes for glew and GLFW!
+#include <stdio.h>
+#include <string.h>
+
+#include "StressScene.h"
+#include "MyInitial.h"
+#include "SurfaceProj.h"
+
+int stressCopies = 0;
+
+// Geometry ID's used in the TransformStore
+const int iStressCylinder = 0;
+const int iStressSphere = 1;
+const int iStressTorus = 2;
+const int NumStressGeoms = 3;
+GlGeomBase* stressGeoms[NumStressGeoms] = { &unitCylinder, &unitSphere, &torus1 };
+
+TransformStore stressStore;
+
+// The instance data is loaded into a buffer texture, read by the vertex shader with texelFetch.
+//    The buffer is triple-buffered: each frame writes the next third of it,
+//    and the shader's instanceBase selects that third.
+GlStreamBuffer stressInstances;
+unsigned int stressTexture = 0;
+const int BytesPerInstance = TransformStore::FloatsPerInstance * sizeof(float);
+
+// Two timer queries, used alternately, so that the result is read one frame later without stalling.
+unsigned int stressQueries[2];
+int stressFrameCount = 0;
+double stressLastFrameTime = 0.0;
+double stressSumFrameTime = 0.0;
+double stressSumCpuTime = 0.0;
+double stressSumGpuTime = 0.0;
+int stressNumGpuTimes = 0;
+
+void MySetupStressScene() {
+    glGenTextures(1, &stressTexture);
+    glGenQueries(2, stressQueries);
+
+    check_for_opengl_errors();
+}
+
+// Add the parts of one copy of the initial.
+//   The parts are the same as in MyRenderInitial(), shrunk by copyScale,
+//   except the crossbar has a fixed length.
+void AddStressInitial(float x, float y, float z, float copyScale, float phase) {
+    float s = copyScale;
+    const float spin = (float)PI2;      // One revolution per animation cycle
+    // The three cylinders of the H
+    stressStore.Add(iStressCylinder, x - s, y, z - 0.3f * s, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 0.4f * s, 2.0f * s, 0.2f * s, 0.4f, 0.9f, 0.4f);
+    stressStore.Add(iStressCylinder, x + s, y, z - 0.3f * s, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 0.4f * s, 2.0f * s, 0.2f * s, 0.4f, 0.9f, 0.4f);
+    stressStore.Add(iStressCylinder, x, y, z - 0.3f * s, 0.0f, 0.0f, 1.0f, (float)PIhalves, 0.0f,
+        0.0f, 0.0f, 0.0f, 0.3f * s, 1.0f * s, 0.3f * s, 0.4f, 0.9f, 0.4f);
+    // The nucleus and the electron
+    stressStore.Add(iStressSphere, x, y, z, 1.0f, 0.0f, 0.0f, phase, spin,
+        0.0f, 0.9f * s, -0.3f * s, 0.4f * s, 0.4f * s, 0.4f * s, 1.0f, 1.0f, 1.0f);
+    stressStore.Add(iStressSphere, x, y, z, 1.0f, 1.0f, 1.0f, phase, spin,
+        0.0f, 3.0f * s, -0.3f * s, 0.2f * s, 0.2f * s, 0.2f * s, 1.0f, 1.0f, 1.0f);
+    // The small torus, and the two tumbling orbits
+    stressStore.Add(iStressTorus, x, y, z - 0.3f * s, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 0.8f * s, 0.8f * s, 0.8f * s, 0.2f, 0.1f, 1.0f);
+    stressStore.Add(iStressTorus, x, y, z - 0.3f * s, 1.0f, 1.0f, 1.0f, phase, spin,
+        0.0f, 0.0f, 0.0f, 3.0f * s, 3.0f * s, 3.0f * s, 0.2f, 0.1f, 0.4f);
+    stressStore.Add(iStressTorus, x, y, z - 0.3f * s, -1.0f, -1.0f, -1.0f, phase, spin,
+        0.0f, 0.0f, 0.0f, 3.0f * s, 3.0f * s, 3.0f * s, 0.2f, 0.1f, 0.4f);
+}
+
+// Place the copies on a square grid covering the floor (-5 to 5 in x and z).
+void MyRemeshStressScene() {
+    stressStore.Clear();
+    if (stressCopies > 0) {
+        int gridSize = (int)ceil(sqrt((double)stressCopies));
+        float cellSize = 10.0f / (float)gridSize;
+        float copyScale = cellSize / 6.5f;              // The initial is about 6.5 units wide
+        unsigned int seed = 12345;                      // Fixed seed: the same scene every time
+        stressStore.Reserve(8 * stressCopies);
+        for (int k = 0; k < stressCopies; k++) {
+            seed = seed * 1664525u + 1013904223u;
+            float phase = (float)PI2 * (float)(seed >> 8) / (float)(1 << 24);
+            float x = -5.0f + ((float)(k % gridSize) + 0.5f) * cellSize;
+            float z = -5.0f + ((float)(k / gridSize) + 0.5f) * cellSize;
+            AddStressInitial(x, 3.0f * copyScale, z, copyScale, phase);
+        }
+        printf("Stress scene: %d copies of the initial, %d objects.\n", stressCopies, stressStore.GetNumEntities());
+    }
+    stressStore.SortByGeometry();
+
+    // Regions hold a whole number of instances, so each starts at an instance boundary.
+    if (stressStore.GetNumEntities() > 0) {
+        stressInstances.Allocate(GL_TEXTURE_BUFFER, stressStore.GetNumEntities() * BytesPerInstance, BytesPerInstance);
+        glBindTexture(GL_TEXTURE_BUFFER, stressTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, stressInstances.GetBuffer());
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        printf("Stress scene: instance data %s.\n", stressInstances.IsPersistent()
+            ? "persistently mapped" : "mapped each frame (no persistent mapping)");
+    }
+    else {
+        stressInstances.Free();
+    }
+
+    stressFrameCount = 0;
+    stressSumFrameTime = stressSumCpuTime = stressSumGpuTime = 0.0;
+    stressNumGpuTimes = 0;
+    stressLastFrameTime = glfwGetTime();
+}
+
+void MyRenderStressScene() {
+    if (stressCopies == 0) {
+        return;
+    }
+
+    // Update the transforms, and write the instance data into the next region of the buffer.
+    double startTime = glfwGetTime();
+    stressStore.Update(currentTime);
+    void* instanceDest = stressInstances.BeginWrite();
+    memcpy(instanceDest, stressStore.GetInstanceData(), stressStore.GetNumEntities() * BytesPerInstance);
+    stressInstances.EndWrite();
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    int regionBase = (int)(stressInstances.GetRegionOffset() / BytesPerInstance);
+    double cpuTime = glfwGetTime() - startTime;
+
+    // The two queries alternate, so the GPU time read here (if available) is from two frames ago.
+    //    Each query is read only after it has been used once: before its first glBeginQuery, it is not a query object yet.
+    //    Then this frame is timed.
+    unsigned int query = stressQueries[stressFrameCount & 1];
+    if (stressFrameCount >= 2) {
+        GLint available = 0;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 gpuNanoseconds;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &gpuNanoseconds);
+            stressSumGpuTime += 1.0e-9 * (double)gpuNanoseconds;
+            stressNumGpuTimes++;
+        }
+    }
+    glBeginQuery(GL_TIME_ELAPSED, query);
+
+    // One instanced draw call per geometry.
+    glUseProgram(shaderProgramInstanced);
+    viewMatrix.DumpByColumns(matEntries);
+    glUniformMatrix4fv(modelviewMatLocationInstanced, 1, false, matEntries);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, stressTexture);
+    glUniform1i(instanceDataLocation, 0);
+    for (int g = 0; g < stressStore.GetNumGeometries(); g++) {
+        if (stressStore.GetBatchCount(g) > 0) {
+            glUniform1i(instanceBaseLocation, regionBase + stressStore.GetBatchStart(g));
+            stressGeoms[g]->RenderInstanced(stressStore.GetBatchCount(g));
+        }
+    }
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glEndQuery(GL_TIME_ELAPSED);
+
+    // Accumulate and report the timings.
+    double now = glfwGetTime();
+    stressSumFrameTime += now - stressLastFrameTime;
+    stressLastFrameTime = now;
+    stressSumCpuTime += cpuTime;
+    stressFrameCount++;
+    if (stressFrameCount % 60 == 0) {
+        printf("Stress scene: %d objects: frame %.2f ms, update+upload %.2f ms, GPU draw %.2f ms, %d upload waits\n",
+            stressStore.GetNumEntities(), 1000.0 * stressSumFrameTime / 60.0, 1000.0 * stressSumCpuTime / 60.0,
+            stressNumGpuTimes > 0 ? 1000.0 * stressSumGpuTime / stressNumGpuTimes : 0.0, stressInstances.GetNumWaits());
+        stressSumFrameTime = stressSumCpuTime = stressSumGpuTime = 0.0;
+        stressNumGpuTimes = 0;
+    }
+}
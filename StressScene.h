@@ -0,0 +1,18 @@
+#pragma once
+
+//
+// StressScene.h   ---  Header file for StressScene.cpp.
+//
+//   A stress test: fills the floor with many copies of the initial,
+//   stored in a TransformStore and drawn with instanced rendering.
+//   Prints the average frame time as the number of copies grows.
+//
+
+extern int stressCopies;            // Number of copies of the initial (0 = stress scene is off)
+
+//
+// Function Prototypes
+//
+void MySetupStressScene();          // Called once, after the shader programs are created.
+void MyRemeshStressScene();         // Called when stressCopies changes.
+void MyRenderStressScene();         // Renders all the copies (does nothing if stressCopies is 0)
@@ -37,6 +37,8 @@
 #include "GlGeomSphere.h"
 #include "GlGeomCylinder.h"
 #include "GlGeomTorus.h"
+#include "GlGeomBezier.h"
+#include "GlGeomProcedural.h"
 #include "GlShaderMgr.h"
 
 // Enable standard input and output via printf(), etc.
@@ -46,6 +48,10 @@
 #include "SurfaceProj.h"
 #include "MyInitial.h"
 #include "MySurfaces.h"
+#include "StressScene.h"
+#include "UploadBench.h"
+#include "GeomBench.h"
+#include "TaskGraph.h"
 
 
 
@@ -73,6 +79,13 @@ bool cullBackFaces = true; // Equals true to cull backfaces. Equals false to not
 
 // The next variable controls the resoluton of the meshes for cylinders and spheres.
 int meshRes=4;             // Resolution of the meshes (slices, stacks, and rings all equal)
+bool largeMeshes = false;  // Equals true to give the sphere and torus much higher resolution (see MyRemeshGeometries)
+bool bezierTessellation = false;    // Equals true to render the teapot with the tessellation shaders (needs OpenGL 4.0)
+
+// Damage tracking: the scene is only redrawn when something visible has changed.
+//    Set to true by anything that changes the view, the render modes, the mesh resolution,
+//    or the window size/contents.  While the animation is running (spinMode), every frame is drawn.
+bool sceneDirty = true;     // Equals true if the window needs to be redrawn
 
 // ************************
 // General data helping with setting up VAO (Vertex Array Objects)
@@ -84,6 +97,12 @@ int meshRes=4;             // Resolution of the meshes (slices, stacks, and ring
 //   The second renders normals and wirefame and as a vertex shader, a geometry shader and a fragment shader
 unsigned int shaderProgram1;
 unsigned int shaderProgramNormals;
+unsigned int shaderProgramInstanced;    // Used for the stress scene
+unsigned int shaderProgramProcedural;           // Shader program 1, also rendering procedural shapes
+unsigned int shaderProgramProceduralNormals;    // The shader program for normals, also rendering procedural shapes
+unsigned int shaderProgramTessellated;          // Shader program 1, for Bezier patches with the tessellation shaders
+unsigned int shaderProgramTessellatedNormals;   // The shader program for normals, for Bezier patches with the tessellation shaders
+unsigned int shaderProgramBezierCompute = 0;    // The compute shader program for the teapot's mesh (0 without OpenGL 4.3)
 const unsigned int vPos_loc = 0;    // Corresponds to "location = 0" in the verter shader definitions
 const unsigned int vColor_loc = 1;  // Corresponds to "location = 1" in the verter shader definitions
 const unsigned int vNormal_loc = 2; // Corresponds to "location = 2" in the verter shader definitions
@@ -101,6 +120,37 @@ const char* drawEdgesName = "drawEdges";	        // Name of the uniform variable
 unsigned int drawEdgesLocation;					    // Location of the drawEdges variable in the shader program 1
 const char* cullBackFacesName = "cullBackFaces";	// Name of the uniform variable cullBackFaces
 unsigned int cullBackFacesLocation;					// Location of the cullBackFaces variable in the shader program 1
+unsigned int projMatLocationInstanced;				// Location of the projectionMatrix in the instanced shader program
+unsigned int modelviewMatLocationInstanced;			// Location of the modelviewMatrix in the instanced shader program
+const char* instanceDataName = "instanceData";	    // Name of the buffer texture holding the instance data
+unsigned int instanceDataLocation;					// Location of instanceData in the instanced shader program
+const char* instanceBaseName = "instanceBase";	    // Name of the uniform variable instanceBase
+unsigned int instanceBaseLocation;					// Location of instanceBase in the instanced shader program
+unsigned int projMatLocationProcedural;				// Locations of the uniform variables in the two procedural shader programs
+unsigned int modelviewMatLocationProcedural;
+unsigned int projMatLocationProceduralNormals;
+unsigned int modelviewMatLocationProceduralNormals;
+unsigned int drawEdgesLocationProcedural;
+unsigned int cullBackFacesLocationProcedural;
+const char* shapeParamsName = "shapeParams";	    // Name of the uniform variable shapeParams (see GlGeomProcedural.h)
+const char* shapeRadiusName = "shapeRadius";	    // Name of the uniform variable shapeRadius
+unsigned int shapeParamsLocationProcedural;
+unsigned int shapeRadiusLocationProcedural;
+unsigned int shapeParamsLocationProceduralNormals;
+unsigned int shapeRadiusLocationProceduralNormals;
+unsigned int projMatLocationTessellated;			// Locations of the uniform variables in the two tessellation shader programs
+unsigned int modelviewMatLocationTessellated;
+unsigned int projMatLocationTessellatedNormals;
+unsigned int modelviewMatLocationTessellatedNormals;
+unsigned int drawEdgesLocationTessellated;
+unsigned int cullBackFacesLocationTessellated;
+const char* bezierParamsName = "bezierParams";	    // Name of the uniform variable bezierParams (see GlGeomBezier::RenderTessellated)
+unsigned int bezierParamsLocationTessellated;
+unsigned int bezierParamsLocationTessellatedNormals;
+
+// Which of the two shader programs myRenderScene() is currently rendering with.
+bool renderingNormals = false;
+bool renderingEdges = false;
 
 
 //  The Projection matrix: Controls the "camera view/field-of-view" transformation
@@ -143,6 +193,47 @@ void mySetupGeometries() {
     check_for_opengl_errors();   // Really a great idea to check for errors -- esp. good for debugging!
 }
 
+// *************************
+// myRemeshScene remeshes all the surfaces and geometries, after meshRes changes.
+//    The data for the five shapes is computed by tasks which run in parallel.
+//    The sphere, cylinder and torus are skipped if Remesh() left their resolution unchanged.
+//    The final task loads all the data into the VBO's and EBO's: it runs
+//    on the main thread, since it makes OpenGL calls.
+// With procedural rendering, only the circular surface has a VBO and EBO to remesh.
+// *************************
+void myRemeshScene() {
+    MyRemeshGeometries();       // Sets the new resolutions only
+    MyRemeshTeapot();
+    if (GlGeomProcedural::IsEnabled()) {
+        MyRemeshCircularSurf();
+        check_for_opengl_errors();
+        return;
+    }
+
+    TaskGraph remeshGraph;
+    std::vector<int> generateTasks;
+    generateTasks.push_back(remeshGraph.AddTask(MyGenerateFloor));
+    generateTasks.push_back(remeshGraph.AddTask(MyGenerateCircularSurf));
+    if (unitSphere.NeedsReload()) {
+        generateTasks.push_back(remeshGraph.AddTask([] { unitSphere.GenerateStaging(); }));
+    }
+    if (unitCylinder.NeedsReload()) {
+        generateTasks.push_back(remeshGraph.AddTask([] { unitCylinder.GenerateStaging(); }));
+    }
+    if (torus1.NeedsReload()) {
+        generateTasks.push_back(remeshGraph.AddTask([] { torus1.GenerateStaging(); }));
+    }
+    remeshGraph.AddMainThreadTask([] {
+        MyLoadSurfaces();
+        unitSphere.LoadBuffers();
+        unitCylinder.LoadBuffers();
+        torus1.LoadBuffers();
+    }, generateTasks);
+    remeshGraph.Run();
+
+    check_for_opengl_errors();
+}
+
 void mySetViewMatrix() {
     // Set the view matrix. Sets view distance, and view direction.
     // The final translation is done because the ground plane lies in the xz-plane,
@@ -172,32 +263,84 @@ void myRenderScene() {
     switch (renderMode)
     {
     case 1:
-        glUseProgram(shaderProgramNormals);
-        modelviewMatLocation = modelviewMatLocationNormals;
-        glUniform1i(drawEdgesLocation, 1);
+        myUseProgramNormals(true);
         // Render the edges and normals
         break;
     case 2:
-        glUseProgram(shaderProgramNormals);
-        modelviewMatLocation = modelviewMatLocationNormals;
-        glUniform1i(drawEdgesLocation, 0);
+        myUseProgramNormals(false);
         // Render just the normals
         MyRenderSurfaces();
         MyRenderInitial();
         // Fall through to case 0, to render the surface too.
     case 0:
-        glUseProgram(shaderProgram1);
-        modelviewMatLocation = modelviewMatLocation1;
+        myUseProgram1();
         // Render with the usual shader (no normals)
         break;
     }
  
     MyRenderSurfaces();
     MyRenderInitial();
+    MyRenderStressScene();
 
     check_for_opengl_errors();   // Really a great idea to check for errors -- esp. good for debugging!
 }
 
+// Make shader program 1 the current shader program, or its procedural version
+//    when procedural rendering is on.
+void myUseProgram1() {
+    renderingNormals = false;
+    if (GlGeomProcedural::IsEnabled()) {
+        glUseProgram(shaderProgramProcedural);
+        modelviewMatLocation = modelviewMatLocationProcedural;
+        GlGeomProcedural::SetUniformLocations(shapeParamsLocationProcedural, shapeRadiusLocationProcedural);
+    }
+    else {
+        glUseProgram(shaderProgram1);
+        modelviewMatLocation = modelviewMatLocation1;
+    }
+}
+
+// Make the shader program for normals the current shader program, or its procedural version.
+void myUseProgramNormals(bool drawEdges) {
+    renderingNormals = true;
+    renderingEdges = drawEdges;
+    if (GlGeomProcedural::IsEnabled()) {
+        glUseProgram(shaderProgramProceduralNormals);
+        modelviewMatLocation = modelviewMatLocationProceduralNormals;
+        glUniform1i(drawEdgesLocationProcedural, drawEdges ? 1 : 0);
+        GlGeomProcedural::SetUniformLocations(shapeParamsLocationProceduralNormals, shapeRadiusLocationProceduralNormals);
+    }
+    else {
+        glUseProgram(shaderProgramNormals);
+        modelviewMatLocation = modelviewMatLocationNormals;
+        glUniform1i(drawEdgesLocation, drawEdges ? 1 : 0);
+    }
+}
+
+// Switch to the version of the current shader program with the tessellation shaders,
+//    for rendering Bezier patches.  Returns the location of the uniform bezierParams.
+unsigned int myUseProgramTessellated() {
+    if (renderingNormals) {
+        glUseProgram(shaderProgramTessellatedNormals);
+        modelviewMatLocation = modelviewMatLocationTessellatedNormals;
+        glUniform1i(drawEdgesLocationTessellated, renderingEdges ? 1 : 0);
+        return bezierParamsLocationTessellatedNormals;
+    }
+    glUseProgram(shaderProgramTessellated);
+    modelviewMatLocation = modelviewMatLocationTessellated;
+    return bezierParamsLocationTessellated;
+}
+
+// Switch back from the version with the tessellation shaders.
+void myUseProgramUntessellated() {
+    if (renderingNormals) {
+        myUseProgramNormals(renderingEdges);
+    }
+    else {
+        myUseProgram1();
+    }
+}
+
 void my_setup_SceneData() {
     mySetupGeometries();
 
@@ -205,6 +348,37 @@ void my_setup_SceneData() {
     shaderProgram1 = GlShaderMgr::CompileAndLinkProgram("vertexShader_PosColorOnly2", "fragmentShader_simple");
     shaderProgramNormals = GlShaderMgr::CompileAndLinkProgram("vertexShader_PosColorNormalInfo", 
                                                               "geomShaderNormals", "fragmentShader_simple");
+    shaderProgramInstanced = GlShaderMgr::CompileAndLinkProgram("vertexShader_PosColorInstanced", "fragmentShader_simple");
+
+    // The procedural shader programs: their vertex shaders include the code block for procedural shapes.
+    unsigned int vertShaderProcedural = GlShaderMgr::CompileShader("vertexShader_ProceduralPosColor", "codeBlock_ProceduralShapes");
+    unsigned int vertShaderProceduralNormals = GlShaderMgr::CompileShader("vertexShader_ProceduralNormalInfo", "codeBlock_ProceduralShapes");
+    unsigned int proceduralShaders[2] = { vertShaderProcedural, GlShaderMgr::CompileShader("fragmentShader_simple") };
+    shaderProgramProcedural = GlShaderMgr::LinkShaderProgram(2, proceduralShaders);
+    unsigned int proceduralNormalsShaders[3] = { vertShaderProceduralNormals,
+        GlShaderMgr::CompileShader("geomShaderNormals"), GlShaderMgr::CompileShader("fragmentShader_simple") };
+    shaderProgramProceduralNormals = GlShaderMgr::LinkShaderProgram(3, proceduralNormalsShaders);
+
+    // The tessellation shader programs render Bezier patches from their control points (needs OpenGL 4.0).
+    if (GlGeomBezier::TessellationSupported()) {
+        GlGeomBezier::QueryTessellationLimits();
+        unsigned int vertShaderBezier = GlShaderMgr::CompileShader("vertexShader_BezierControlPts");
+        unsigned int tessControlShaderBezier = GlShaderMgr::CompileShader("tessControlShader_Bezier");
+        unsigned int tessellatedShaders[4] = { vertShaderBezier, tessControlShaderBezier,
+            GlShaderMgr::CompileShader("tessEvalShader_BezierPosColor", "codeBlock_BezierPatch"),
+            GlShaderMgr::CompileShader("fragmentShader_simple") };
+        shaderProgramTessellated = GlShaderMgr::LinkShaderProgram(4, tessellatedShaders);
+        unsigned int tessellatedNormalsShaders[5] = { vertShaderBezier, tessControlShaderBezier,
+            GlShaderMgr::CompileShader("tessEvalShader_BezierNormalInfo", "codeBlock_BezierPatch"),
+            GlShaderMgr::CompileShader("geomShaderNormals"), GlShaderMgr::CompileShader("fragmentShader_simple") };
+        shaderProgramTessellatedNormals = GlShaderMgr::LinkShaderProgram(5, tessellatedNormalsShaders);
+    }
+
+    // The compute shader program computes the teapot's VBO and EBO (needs OpenGL 4.3).
+    if (GlGeomBezier::ComputeSupported()) {
+        unsigned int computeShaderBezier = GlShaderMgr::CompileShader("computeShader_Bezier");
+        shaderProgramBezierCompute = GlShaderMgr::LinkShaderProgram(1, &computeShaderBezier);
+    }
 
 	// Get the locations of all the uniform variables in the two shader programs.
     projMatLocation1 = glGetUniformLocation(shaderProgram1, projMatName);
@@ -213,6 +387,32 @@ void my_setup_SceneData() {
     modelviewMatLocationNormals = glGetUniformLocation(shaderProgramNormals, modelviewMatName);
     drawEdgesLocation = glGetUniformLocation(shaderProgramNormals, drawEdgesName);
     cullBackFacesLocation = glGetUniformLocation(shaderProgramNormals, cullBackFacesName);
+    projMatLocationInstanced = glGetUniformLocation(shaderProgramInstanced, projMatName);
+    modelviewMatLocationInstanced = glGetUniformLocation(shaderProgramInstanced, modelviewMatName);
+    instanceDataLocation = glGetUniformLocation(shaderProgramInstanced, instanceDataName);
+    instanceBaseLocation = glGetUniformLocation(shaderProgramInstanced, instanceBaseName);
+    projMatLocationProcedural = glGetUniformLocation(shaderProgramProcedural, projMatName);
+    modelviewMatLocationProcedural = glGetUniformLocation(shaderProgramProcedural, modelviewMatName);
+    shapeParamsLocationProcedural = glGetUniformLocation(shaderProgramProcedural, shapeParamsName);
+    shapeRadiusLocationProcedural = glGetUniformLocation(shaderProgramProcedural, shapeRadiusName);
+    projMatLocationProceduralNormals = glGetUniformLocation(shaderProgramProceduralNormals, projMatName);
+    modelviewMatLocationProceduralNormals = glGetUniformLocation(shaderProgramProceduralNormals, modelviewMatName);
+    drawEdgesLocationProcedural = glGetUniformLocation(shaderProgramProceduralNormals, drawEdgesName);
+    cullBackFacesLocationProcedural = glGetUniformLocation(shaderProgramProceduralNormals, cullBackFacesName);
+    shapeParamsLocationProceduralNormals = glGetUniformLocation(shaderProgramProceduralNormals, shapeParamsName);
+    shapeRadiusLocationProceduralNormals = glGetUniformLocation(shaderProgramProceduralNormals, shapeRadiusName);
+    if (GlGeomBezier::TessellationSupported()) {
+        projMatLocationTessellated = glGetUniformLocation(shaderProgramTessellated, projMatName);
+        modelviewMatLocationTessellated = glGetUniformLocation(shaderProgramTessellated, modelviewMatName);
+        bezierParamsLocationTessellated = glGetUniformLocation(shaderProgramTessellated, bezierParamsName);
+        projMatLocationTessellatedNormals = glGetUniformLocation(shaderProgramTessellatedNormals, projMatName);
+        modelviewMatLocationTessellatedNormals = glGetUniformLocation(shaderProgramTessellatedNormals, modelviewMatName);
+        drawEdgesLocationTessellated = glGetUniformLocation(shaderProgramTessellatedNormals, drawEdgesName);
+        cullBackFacesLocationTessellated = glGetUniformLocation(shaderProgramTessellatedNormals, cullBackFacesName);
+        bezierParamsLocationTessellatedNormals = glGetUniformLocation(shaderProgramTessellatedNormals, bezierParamsName);
+    }
+
+    MySetupStressScene();
  
 	check_for_opengl_errors();   // Really a great idea to check for errors -- esp. good for debugging!
 }
@@ -232,6 +432,7 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         return;
     case 'N': 
         renderMode = (renderMode+1)%3;    // Cycle through which shader program(s) to use
+        sceneDirty = true;
         return;
     case 'R':
         if (singleStep) {			// If ending single step mode
@@ -241,10 +442,12 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         else {
             spinMode = !spinMode;	// Toggle animation on and off.
         }
+        sceneDirty = true;
         return;
     case 'S':
         singleStep = true;
         spinMode = true;
+        sceneDirty = true;
         return;
     case 'W':		// Toggle wireframe mode
         if (wireframeMode) {
@@ -255,6 +458,7 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
             wireframeMode = true;
             glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
         }
+        sceneDirty = true;
         return;
     case 'C':		// Toggle backface culling
         cullBackFaces = !cullBackFaces;     // Negate truth value of cullBackFaces
@@ -266,6 +470,13 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         }
         glUseProgram(shaderProgramNormals);
         glUniform1i(cullBackFacesLocation, cullBackFaces ? 1 : 0);      // Set the shader to have the same cull mode.
+        glUseProgram(shaderProgramProceduralNormals);
+        glUniform1i(cullBackFacesLocationProcedural, cullBackFaces ? 1 : 0);
+        if (glIsProgram(shaderProgramTessellatedNormals)) {
+            glUseProgram(shaderProgramTessellatedNormals);
+            glUniform1i(cullBackFacesLocationTessellated, cullBackFaces ? 1 : 0);
+        }
+        sceneDirty = true;
         return;
     case 'M':
         if (mods & GLFW_MOD_SHIFT) {
@@ -274,8 +485,52 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         else {
             meshRes = meshRes > 4 ? meshRes - 1 : 3;    // Lowercase 'm'
         }
-        MyRemeshSurfaces();
-        MyRemeshGeometries();
+        myRemeshScene();
+        sceneDirty = true;
+        return;
+    case 'L':       // Toggle large meshes
+        largeMeshes = !largeMeshes;
+        {
+            double startTime = glfwGetTime();
+            myRemeshScene();
+            printf("Large meshes %s: %d triangles in the sphere, remeshed in %.1f ms.\n", largeMeshes ? "on" : "off",
+                unitSphere.GetNumTriangles(), 1000.0 * (glfwGetTime() - startTime));
+        }
+        sceneDirty = true;
+        return;
+    case 'P':       // Toggle procedural rendering of the sphere, cylinder, torus and floor
+        GlGeomProcedural::SetEnabled(!GlGeomProcedural::IsEnabled());
+        {
+            double startTime = glfwGetTime();
+            myRemeshScene();
+            printf("Procedural rendering %s: remeshed in %.1f ms.\n", GlGeomProcedural::IsEnabled() ? "on" : "off",
+                1000.0 * (glfwGetTime() - startTime));
+        }
+        sceneDirty = true;
+        return;
+    case 'H':       // Toggle rendering the teapot with the (hardware) tessellation shaders
+        if (!GlGeomBezier::TessellationSupported()) {
+            printf("Tessellation shaders need OpenGL 4.0.\n");
+            return;
+        }
+        bezierTessellation = !bezierTessellation;
+        printf("Teapot tessellation shaders %s.\n", bezierTessellation ? "on" : "off");
+        sceneDirty = true;
+        return;
+    case 'K':       // Toggle computing the teapot's mesh with the compute shader
+        if (shaderProgramBezierCompute == 0) {
+            printf("The compute shader needs OpenGL 4.3.\n");
+            return;
+        }
+        GlGeomBezier::SetComputeProgram(GlGeomBezier::GetComputeProgram() == 0 ? shaderProgramBezierCompute : 0);
+        {
+            double startTime = glfwGetTime();
+            MyReloadTeapot();
+            glFinish();
+            printf("Teapot compute shader %s: mesh computed in %.1f ms.\n",
+                GlGeomBezier::GetComputeProgram() != 0 ? "on" : "off", 1000.0 * (glfwGetTime() - startTime));
+        }
+        sceneDirty = true;
         return;
     case 'F':
         if (mods & GLFW_MOD_SHIFT) {                // If upper case 'F'
@@ -285,6 +540,25 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
             animateIncrement *= sqrt(0.5);			// Halve the animation time step after two key presses
         }
         return;
+    case 'T':
+        if (mods & GLFW_MOD_SHIFT) {                // If upper case 'T'
+            stressCopies = stressCopies < 16384 ? Max(2 * stressCopies, 1) : 16384;   // Double the number of copies
+        }
+        else {                                      // Else lower case 't'
+            stressCopies = stressCopies / 2;        // Halve the number of copies (0 turns it off)
+        }
+        glfwSwapInterval(stressCopies > 0 ? 0 : 1); // Do not wait for vsync when measuring frame times
+        MyRemeshStressScene();
+        sceneDirty = true;
+        return;
+    case 'B':
+        MyRunUploadBenchmark();
+        sceneDirty = true;
+        return;
+    case 'G':
+        MyRunGeomBenchmark();
+        sceneDirty = true;
+        return;
     case GLFW_KEY_UP:
         viewAzimuth = Min(viewAzimuth + 0.01, PIhalves - 0.05);
         break;
@@ -309,8 +583,11 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
     case GLFW_KEY_END:
         extraViewDistance = Max(-8.0, extraViewDistance - 0.2);
         break;
+    default:
+        return;         // Other keys do not change the scene: no need to redraw
     }
     mySetViewMatrix();
+    sceneDirty = true;
 }
 
 
@@ -355,9 +632,43 @@ void window_size_callback(GLFWwindow* window, int width, int height) {
         theProjectionMatrix.DumpByColumns(matEntries);
         glUniformMatrix4fv(projMatLocationNormals, 1, false, matEntries);
     }
+    if (glIsProgram(shaderProgramInstanced)) {
+        glUseProgram(shaderProgramInstanced);
+        theProjectionMatrix.DumpByColumns(matEntries);
+        glUniformMatrix4fv(projMatLocationInstanced, 1, false, matEntries);
+    }
+    if (glIsProgram(shaderProgramProcedural)) {
+        glUseProgram(shaderProgramProcedural);
+        theProjectionMatrix.DumpByColumns(matEntries);
+        glUniformMatrix4fv(projMatLocationProcedural, 1, false, matEntries);
+    }
+    if (glIsProgram(shaderProgramProceduralNormals)) {
+        glUseProgram(shaderProgramProceduralNormals);
+        theProjectionMatrix.DumpByColumns(matEntries);
+        glUniformMatrix4fv(projMatLocationProceduralNormals, 1, false, matEntries);
+    }
+    if (glIsProgram(shaderProgramTessellated)) {
+        glUseProgram(shaderProgramTessellated);
+        theProjectionMatrix.DumpByColumns(matEntries);
+        glUniformMatrix4fv(projMatLocationTessellated, 1, false, matEntries);
+    }
+    if (glIsProgram(shaderProgramTessellatedNormals)) {
+        glUseProgram(shaderProgramTessellatedNormals);
+        theProjectionMatrix.DumpByColumns(matEntries);
+        glUniformMatrix4fv(projMatLocationTessellatedNormals, 1, false, matEntries);
+    }
+    sceneDirty = true;
     check_for_opengl_errors();   // Really a great idea to check for errors -- esp. good for debugging!
 }
 
+// *************************************************
+// This function is called when the contents of the window have been damaged
+//    (for instance, uncovered by another window) and need to be redrawn.
+// *************************************************
+void window_refresh_callback(GLFWwindow* window) {
+    sceneDirty = true;
+}
+
 void my_setup_OpenGL() {
 	
 	glEnable(GL_DEPTH_TEST);	// Enable depth buffering
@@ -381,6 +692,9 @@ void setup_callbacks(GLFWwindow* window) {
 	// Set callback function for resizing the window
 	glfwSetFramebufferSizeCallback(window, window_size_callback);
 
+	// Set callback for when the window contents need to be redrawn
+	glfwSetWindowRefreshCallback(window, window_refresh_callback);
+
 	// Set callback for key up/down/repeat events
 	glfwSetKeyCallback(window, key_callback);
 
@@ -429,8 +743,16 @@ int main() {
     printf("Press 'w' or 'W' (wireframe) to toggle whether wireframe or fill mode.\n");
     printf("Press 'M' (mesh) to increase the mesh resolution.\n");
     printf("Press 'm' (mesh) to decrease the mesh resolution.\n");
+    printf("Press 'l' or 'L' (large) to toggle very high resolution spheres and tori.\n");
+    printf("Press 'p' or 'P' (procedural) to toggle rendering the shapes and floor with no vertex buffers.\n");
+    printf("Press 'h' or 'H' (hardware) to toggle rendering the teapot with the tessellation shaders.\n");
+    printf("Press 'k' or 'K' to toggle computing the teapot's mesh with the compute shader.\n");
+    printf("    (The teapot is shown only while the tessellation shaders or the compute shader are on.)\n");
     printf("Press 'F'(faster) or 'f' (slower) to speed up or slow down the animation.\n");
     printf("Press 'n' or 'N' to cycle through the three modes of drawing normal vectors.\n");
+    printf("Press 'T' or 't' to double or halve the number of copies in the stress scene (timings are printed).\n");
+    printf("Press 'b' or 'B' to run the buffer upload benchmark (results are printed).\n");
+    printf("Press 'g' or 'G' to run the mesh generation benchmark (results are printed).\n");
     printf("Press ESCAPE to exit.\n");
 	
     setup_callbacks(window);
@@ -443,12 +765,20 @@ int main() {
     // Loop while program is not terminated.
 	while (!glfwWindowShouldClose(window)) {
 	
-		myRenderScene();				// Render into the current buffer
-		glfwSwapBuffers(window);		// Displays what was just rendered (using double buffering).
+		// Only redraw if animating, or if something changed since the last frame.
+		if (spinMode || sceneDirty) {
+			sceneDirty = false;
+			myRenderScene();				// Render into the current buffer
+			glfwSwapBuffers(window);		// Displays what was just rendered (using double buffering).
+		}
 
 		// Poll events (key presses, mouse events)
-		glfwWaitEventsTimeout(1.0/60.0);	    // Use this to animate at 60 frames/sec (timing is NOT reliable)
-		// glfwWaitEvents();					// Or, Use this instead if no animation.
+		if (spinMode) {
+			glfwWaitEventsTimeout(1.0/60.0);	// Use this to animate at 60 frames/sec (timing is NOT reliable)
+		}
+		else {
+			glfwWaitEvents();				// Nothing to animate: sleep until an event arrives.
+		}
 		// glfwPollEvents();					// Use this version when animating as fast as possible
 	}
 
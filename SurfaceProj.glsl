@@ -1,13 +1,32 @@
 
-// There are 5 shaders in this .glsl file
+// There are 12 shaders and 2 code blocks in this .glsl file
 //  
 //  1. vertexShader_PosColorOnly2
 //  2. vertexShader_PosColorNormalInfo
 //  3. geomShaderNormals
 //  4. fragmentShader_simple
+//  5. vertexShader_PosColorInstanced
+//  6. vertexShader_ProceduralPosColor
+//  7. vertexShader_ProceduralNormalInfo
+//  8. codeBlock_ProceduralShapes (compiled with 6 and with 7)
+//  9. vertexShader_BezierControlPts
+// 10. tessControlShader_Bezier
+// 11. tessEvalShader_BezierPosColor
+// 12. tessEvalShader_BezierNormalInfo
+// 13. codeBlock_BezierPatch (compiled with 11 and with 12)
+// 14. computeShader_Bezier
 //
 // First shader program is formed from shaders 1 and 4.
 // Second shader program is formed from shaders 2, 3, and 4.
+// Third shader program (instanced rendering) is formed from shaders 5 and 4.
+// The procedural shader programs are formed from shaders 6 and 4,
+//    and from shaders 7, 3 and 4.  They are like the first two programs,
+//    but also compute the vertices of procedural shapes (see GlGeomProcedural.h).
+// The Bezier tessellation shader programs are formed from shaders 9, 10, 11 and 4,
+//    and from shaders 9, 10, 12, 3 and 4.  They render Bezier patches from
+//    their control points (see GlGeomBezier::RenderTessellated), and need OpenGL 4.0.
+// The compute shader program is formed from shader 14 alone.  It computes the VBO and EBO
+//    of Bezier patches (see GlGeomBezier::SetComputeProgram), and needs OpenGL 4.3.
 // 
 // Author: Sam Buss, sbuss@ucsd.edu.
 // Last updated 1/26/2019.
@@ -136,3 +155,635 @@ void main()
 }
 #endglsl
 
+// ***************************
+// Vertex Shader, named "vertexShader_PosColorInstanced"
+//     Sets the position and color of a vertex of one instance of an instanced draw.
+//   Each instance has four texels in the buffer texture "instanceData":
+//      the three rows of its affine model matrix, and then its color.
+//   "instanceBase" is the index of the first instance of the draw call.
+//   The modelview matrix holds just the view matrix.
+// ***************************
+#beginglsl vertexshader vertexShader_PosColorInstanced
+#version 330 core
+layout (location = 0) in vec3 aPos;	   // Position in attribute location 0
+out vec3 theColor;                     // output a color to the fragment shader
+uniform mat4 projectionMatrix;         // The projection matrix
+uniform mat4 modelviewMatrix;          // The view matrix
+uniform samplerBuffer instanceData;    // Model matrix rows and colors of the instances
+uniform int instanceBase;              // Index of the first instance of the draw call
+void main()
+{
+   int k = 4*(instanceBase + gl_InstanceID);
+   vec4 pos = vec4(aPos.x, aPos.y, aPos.z, 1.0);
+   vec3 worldPos = vec3(dot(texelFetch(instanceData, k), pos),
+                        dot(texelFetch(instanceData, k+1), pos),
+                        dot(texelFetch(instanceData, k+2), pos));
+   gl_Position = projectionMatrix * modelviewMatrix * vec4(worldPos, 1.0);
+   theColor = texelFetch(instanceData, k+3).rgb;
+}
+#endglsl
+
+// ***************************
+// Vertex Shader, named "vertexShader_ProceduralPosColor"
+//     The same as vertexShader_PosColorOnly2, except that the vertex of
+//     a procedural shape replaces the position from the vertex attribute.
+//   Compile it with the code block "codeBlock_ProceduralShapes".
+// ***************************
+#beginglsl vertexshader vertexShader_ProceduralPosColor
+#version 330 core
+layout (location = 0) in vec3 aPos;	   // Position in attribute location 0
+layout (location = 1) in vec3 aColor;  // Color in attribute location 1
+layout (location = 2) in vec3 vNormal; // Normal Vector in attribute location 2
+out vec3 theColor;                     // output a color to the fragment shader
+uniform mat4 projectionMatrix;         // The projection matrix
+uniform mat4 modelviewMatrix;          // The model-view matrix
+void ProceduralVertex(inout vec3 pos, inout vec3 normal);     // In codeBlock_ProceduralShapes
+void main()
+{
+   vec3 pos = aPos;
+   vec3 normal = vNormal;
+   ProceduralVertex(pos, normal);
+   gl_Position = projectionMatrix * modelviewMatrix * vec4(pos, 1.0);
+   theColor = aColor;
+}
+#endglsl
+
+// ***************************
+// A vertex shader, named "vertexShader_ProceduralNormalInfo"
+//     The same as vertexShader_PosColorNormalInfo, except that the vertex
+//     of a procedural shape replaces the position and normal from the vertex attributes.
+//   Compile it with the code block "codeBlock_ProceduralShapes".
+// ***************************
+#beginglsl vertexshader vertexShader_ProceduralNormalInfo
+#version 330 core
+layout (location = 0) in vec3 aPos;	// Position in attribute location 0
+layout (location = 1) in vec3 aColor;  // Color in attribute location 1
+layout (location = 2) in vec3 aNormal; // Normal Vector in attribute location 2
+out vec3 vertColor;					// output a color to the next shaders
+out vec3 vertNormal;					// output a color to the geometry shader
+uniform mat4 modelviewMatrix;		// The model-view matrix
+void ProceduralVertex(inout vec3 pos, inout vec3 normal);     // In codeBlock_ProceduralShapes
+void main()
+{
+   vec3 pos = aPos;
+   vec3 normal = aNormal;
+   ProceduralVertex(pos, normal);
+   gl_Position = modelviewMatrix * vec4(pos, 1.0);
+   vertColor = aColor;
+   mat3 Msmall = mat3(modelviewMatrix);
+   vertNormal = normalize(transpose(inverse(Msmall)) * normal);
+}
+#endglsl
+
+// ***************************
+// Code block, named "codeBlock_ProceduralShapes"
+//    Computes the vertices of spheres, tori, cylinders and grids from gl_VertexID
+//    and gl_InstanceID, with no vertex attributes (see GlGeomProcedural.h).
+//    Vertex number e of a sphere, torus or cylinder is the vertex of element e
+//    of the EBO written by CalcVboAndEbo(), so the triangles are the same.
+//  shapeParams.x is the shape: 0 = sphere, 1 = torus, 2 = cylinder, 3 = grid,
+//    or -1 to use the vertex attributes.
+//  shapeParams.yzw are the resolutions: (slices, stacks) for a sphere, (rings, sides)
+//    for a torus, (slices, stacks, rings) for a cylinder, and (meshRes) for a grid.
+// ***************************
+#beginglsl codeblock codeBlock_ProceduralShapes
+uniform ivec4 shapeParams = ivec4(-1, 0, 0, 0);
+uniform float shapeRadius;      // The minor radius of a torus, or half the width of a grid
+
+// The six elements of a pair of triangles, as offsets from the (slice or ring, stack or side)
+//    numbers of the pair, in the orders of the EBO's.
+const int sphereDi[6] = int[6](0, 1, 0, 0, 1, 1);
+const int sphereDj[6] = int[6](0, 1, 1, 1, 1, 2);
+const int torusDi[6] = int[6](1, 0, 0, 1, 1, 0);     // Also the side of the cylinder
+const int torusDj[6] = int[6](0, 1, 0, 0, 1, 1);
+const int bottomDi[6] = int[6](0, 1, 1, 0, 1, 0);    // The rings of the cylinder's disks
+const int topDi[6] = int[6](1, 0, 0, 1, 0, 1);
+const int discDj[6] = int[6](1, 1, 2, 1, 2, 2);
+
+// Returns the cosine and sine of 2*pi*k/n, computed as in GlGeomTrigTable.
+vec2 CircleCosSin(int k, int n)
+{
+    float angle = float(k % n) * 6.28318530718 / float(n);
+    return vec2(cos(angle), sin(angle));
+}
+
+void SphereVertex(int e, out vec3 pos, out vec3 normal)
+{
+    int stacks = shapeParams.z;
+    int perSlice = 6 * (stacks - 1);
+    int c = (e % perSlice) % 6;
+    int i = e / perSlice + sphereDi[c];
+    int j = (e % perSlice) / 6 + sphereDj[c];
+    if (j == 0 || j == stacks) {
+        pos = vec3(-0.0, (j == 0) ? -1.0 : 1.0, -0.0);   // South or north pole (x and z are -0.0, as in GlGeomSphere)
+    }
+    else {
+        // theta measures from the (negative-z)-axis, phi from the (negative-y)-axis
+        vec2 theta = CircleCosSin(i, shapeParams.y);
+        float phi = (float(j) / float(stacks)) * 3.14159265359;
+        float sinphi = sin(phi);
+        pos = vec3(-theta.y*sinphi, -cos(phi), -theta.x*sinphi);
+    }
+    normal = pos;
+}
+
+void TorusVertex(int e, out vec3 pos, out vec3 normal)
+{
+    int sides = shapeParams.z;
+    int c = e % 6;
+    int i = e / (6 * sides) + torusDi[c];
+    int j = (e / 6) % sides + torusDj[c];
+    vec2 theta = -CircleCosSin(i, shapeParams.y);    // Negated values (start at negative z-axis)
+    vec2 phi = -CircleCosSin(j, sides);              // Negated values (start at the inner seam, going down)
+    float r = 1.0 + shapeRadius*phi.x;
+    pos = vec3(theta.y*r, shapeRadius*phi.y, theta.x*r);
+    normal = vec3(theta.y*phi.x, phi.y, theta.x*phi.x);
+}
+
+void CylinderVertex(int e, out vec3 pos, out vec3 normal)
+{
+    int slices = shapeParams.y;
+    int stacks = shapeParams.z;
+    int rings = shapeParams.w;
+    int discSliceElts = 3 + 6 * (rings - 1);
+    int discElts = slices * discSliceElts;
+    if (e >= 2 * discElts) {
+        // The side
+        e -= 2 * discElts;
+        int c = e % 6;
+        int i = e / (6 * stacks) + torusDi[c];
+        int j = (e / 6) % stacks + torusDj[c];
+        vec2 theta = -CircleCosSin(i, slices);
+        pos = vec3(theta.y, -1.0 + 2.0*(float(j) / float(stacks)), theta.x);
+        normal = vec3(theta.y, 0.0, theta.x);
+        return;
+    }
+    // The bottom, then the top
+    bool top = (e >= discElts);
+    e -= top ? discElts : 0;
+    int i = e / discSliceElts;
+    int r = e % discSliceElts;
+    int ring;
+    if (r < 3) {
+        ring = (r == 0) ? 0 : 1;                // The triangle at the center
+        i += (r == (top ? 2 : 1)) ? 1 : 0;
+    }
+    else {
+        int c = (r - 3) % 6;
+        ring = (r - 3) / 6 + discDj[c];
+        i += top ? topDi[c] : bottomDi[c];
+    }
+    float y = top ? 1.0 : -1.0;
+    vec2 theta = -CircleCosSin(i, slices);
+    float radius = float(ring) / float(rings);
+    pos = vec3(theta.y*radius, y, theta.x*radius);
+    normal = vec3(0.0, y, 0.0);
+}
+
+// Row gl_InstanceID of the grid is a triangle strip.  Its even vertices are on
+//    the row's back edge, and its odd vertices on its front edge.
+void GridVertex(out vec3 pos, out vec3 normal)
+{
+    float step = 2.0 * shapeRadius / float(shapeParams.y);
+    pos = vec3(-shapeRadius + float(gl_VertexID / 2)*step, 0.0,
+               -shapeRadius + float(gl_InstanceID + gl_VertexID % 2)*step);
+    normal = vec3(0.0, 1.0, 0.0);
+}
+
+// Replaces pos and normal with the vertex of the procedural shape, if there is one.
+void ProceduralVertex(inout vec3 pos, inout vec3 normal)
+{
+    switch (shapeParams.x) {
+    case 0:
+        SphereVertex(gl_VertexID, pos, normal);
+        break;
+    case 1:
+        TorusVertex(gl_VertexID, pos, normal);
+        break;
+    case 2:
+        CylinderVertex(gl_VertexID, pos, normal);
+        break;
+    case 3:
+        GridVertex(pos, normal);
+        break;
+    }
+}
+#endglsl
+
+// ***************************
+// Vertex Shader, named "vertexShader_BezierControlPts"
+//     Passes the control points of Bezier patches on to the tessellation control shader.
+//   Control points are homogeneous: w is 1.0 unless the patches are rational.
+// ***************************
+#beginglsl vertexshader vertexShader_BezierControlPts
+#version 400 core
+layout (location = 0) in vec4 aControlPt;  // Control point in attribute location 0
+layout (location = 1) in vec3 aColor;      // Color in attribute location 1
+out vec3 cpColor;
+void main()
+{
+   gl_Position = aControlPt;
+   cpColor = aColor;
+}
+#endglsl
+
+// ***************************
+// Tessellation control shader, named "tessControlShader_Bezier"
+//    Copies the control points, and sets the tessellation levels of the patch.
+//    bezierParams.xy are the mesh resolutions in u and v, and bezierParams.zw
+//    are the orders in u and v.  A patch has at most 16 control points.
+//    The mesh resolutions are clamped to GL_MAX_TESS_GEN_LEVEL on the CPU side
+//    (see GlGeomBezier::RenderTessellated), since the GPU would clamp the levels anyway.
+//    An edge of the patch which is a single point gets tessellation level 1,
+//    so there are no zero area triangles along it.
+// ***************************
+#beginglsl tesscontrolshader tessControlShader_Bezier
+#version 400 core
+layout (vertices = 16) out;
+in vec3 cpColor[];
+patch out vec3 patchColor;
+uniform ivec4 bezierParams;         // uMeshRes, vMeshRes, uOrder, vOrder
+
+// Are the count control points, from first with the given stride, all the same point?
+bool EdgeIsPoint(int first, int stride, int count)
+{
+    for (int k = 1; k < count; k++) {
+        if (gl_in[first + k*stride].gl_Position != gl_in[first].gl_Position) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void main()
+{
+    gl_out[gl_InvocationID].gl_Position = gl_in[min(gl_InvocationID, gl_PatchVerticesIn - 1)].gl_Position;
+    if (gl_InvocationID == 0) {
+        int uOrder = bezierParams.z;
+        int vOrder = bezierParams.w;
+        float uLevel = float(bezierParams.x);
+        float vLevel = float(bezierParams.y);
+        // Outer levels 0 and 2 are for the edges u=0 and u=1; 1 and 3 for the edges v=0 and v=1.
+        gl_TessLevelOuter[0] = EdgeIsPoint(0, uOrder, vOrder) ? 1.0 : vLevel;
+        gl_TessLevelOuter[1] = EdgeIsPoint(0, 1, uOrder) ? 1.0 : uLevel;
+        gl_TessLevelOuter[2] = EdgeIsPoint(uOrder - 1, uOrder, vOrder) ? 1.0 : vLevel;
+        gl_TessLevelOuter[3] = EdgeIsPoint((vOrder - 1)*uOrder, 1, uOrder) ? 1.0 : uLevel;
+        gl_TessLevelInner[0] = uLevel;
+        gl_TessLevelInner[1] = vLevel;
+        patchColor = cpColor[0];
+    }
+}
+#endglsl
+
+// ***************************
+// Tessellation evaluation shader, named "tessEvalShader_BezierPosColor"
+//     Like vertexShader_PosColorOnly2, for a vertex of a Bezier patch.
+//   Compile it with the code block "codeBlock_BezierPatch".
+// ***************************
+#beginglsl tessevaluationshader tessEvalShader_BezierPosColor
+#version 400 core
+layout (quads, equal_spacing, ccw) in;
+patch in vec3 patchColor;
+out vec3 theColor;                     // output a color to the fragment shader
+uniform mat4 projectionMatrix;         // The projection matrix
+uniform mat4 modelviewMatrix;          // The model-view matrix
+void BezierPatchVertex(vec2 uv, out vec3 pos, out vec3 normal);     // In codeBlock_BezierPatch
+void main()
+{
+   vec3 pos, normal;
+   BezierPatchVertex(gl_TessCoord.xy, pos, normal);
+   gl_Position = projectionMatrix * modelviewMatrix * vec4(pos, 1.0);
+   theColor = patchColor;
+}
+#endglsl
+
+// ***************************
+// Tessellation evaluation shader, named "tessEvalShader_BezierNormalInfo"
+//     Like vertexShader_PosColorNormalInfo, for a vertex of a Bezier patch.
+//     The output is sent to the geometry shader.
+//   Compile it with the code block "codeBlock_BezierPatch".
+// ***************************
+#beginglsl tessevaluationshader tessEvalShader_BezierNormalInfo
+#version 400 core
+layout (quads, equal_spacing, ccw) in;
+patch in vec3 patchColor;
+out vec3 vertColor;					// output a color to the next shaders
+out vec3 vertNormal;					// output a normal to the geometry shader
+uniform mat4 modelviewMatrix;		// The model-view matrix
+void BezierPatchVertex(vec2 uv, out vec3 pos, out vec3 normal);     // In codeBlock_BezierPatch
+void main()
+{
+   vec3 pos, normal;
+   BezierPatchVertex(gl_TessCoord.xy, pos, normal);
+   gl_Position = modelviewMatrix * vec4(pos, 1.0);
+   vertColor = patchColor;
+   mat3 Msmall = mat3(modelviewMatrix);
+   vertNormal = normalize(transpose(inverse(Msmall)) * normal);
+}
+#endglsl
+
+// ***************************
+// Code block, named "codeBlock_BezierPatch"
+//    Evaluates a Bezier patch, from the control points in gl_in[], for a
+//    tessellation evaluation shader.  Control point (i,j) is gl_in[j*uOrder+i].
+//    The normal is the cross product of the partial derivatives in u and v,
+//    as in GlGeomBezier::CalcVboAndEbo().  Where that is zero (at a degenerate
+//    edge or corner), the normal is taken from a point slightly nearer the
+//    center of the patch instead.
+// ***************************
+#beginglsl codeblock codeBlock_BezierPatch
+uniform ivec4 bezierParams;         // uMeshRes, vMeshRes, uOrder, vOrder
+
+const int MaxBezierOrder = 8;     // A patch has at most 16 control points, and both orders are at least 2
+
+// The Bernstein polynomials of degree order-1 at t, and their derivatives.
+void BezierBasis(int order, float t, out float b[MaxBezierOrder], out float db[MaxBezierOrder])
+{
+    // First the polynomials of degree order-2, by de Casteljau's recurrence.
+    float s = 1.0 - t;
+    b[0] = 1.0;
+    for (int n = 1; n < order - 1; n++) {
+        float prev = 0.0;
+        for (int i = 0; i < n; i++) {
+            float cur = b[i];
+            b[i] = s * cur + t * prev;
+            prev = cur;
+        }
+        b[n] = t * prev;
+    }
+    // Then one more step of the recurrence, with the derivatives.
+    float degree = float(order - 1);
+    float prev = 0.0;
+    for (int i = 0; i < order - 1; i++) {
+        float cur = b[i];
+        db[i] = degree * (prev - cur);
+        b[i] = s * cur + t * prev;
+        prev = cur;
+    }
+    db[order - 1] = degree * prev;
+    b[order - 1] = t * prev;
+}
+
+// The point of the patch at uv, and its partial derivatives (times w, for rational patches).
+void BezierPatchEval(vec2 uv, out vec3 pos, out vec3 du, out vec3 dv)
+{
+    int uOrder = bezierParams.z;
+    int vOrder = bezierParams.w;
+    float bu[MaxBezierOrder], dbu[MaxBezierOrder], bv[MaxBezierOrder], dbv[MaxBezierOrder];
+    BezierBasis(uOrder, uv.x, bu, dbu);
+    BezierBasis(vOrder, uv.y, bv, dbv);
+    vec4 p = vec4(0.0);
+    vec4 pu = vec4(0.0);
+    vec4 pv = vec4(0.0);
+    for (int j = 0; j < vOrder; j++) {
+        for (int i = 0; i < uOrder; i++) {
+            vec4 cp = gl_in[j * uOrder + i].gl_Position;
+            p += (bu[i] * bv[j]) * cp;
+            pu += (dbu[i] * bv[j]) * cp;
+            pv += (bu[i] * dbv[j]) * cp;
+        }
+    }
+    pos = p.xyz / p.w;
+    // (x/w)' = (x' - (x/w)*w')/w.  Dividing by w is skipped, since the normal is normalized anyway.
+    du = pu.xyz - pos * pu.w;
+    dv = pv.xyz - pos * pv.w;
+}
+
+void BezierPatchVertex(vec2 uv, out vec3 pos, out vec3 normal)
+{
+    vec3 du, dv;
+    BezierPatchEval(uv, pos, du, dv);
+    normal = cross(du, dv);
+    if (dot(normal, normal) <= 1.0e-8 * dot(du, du) * dot(dv, dv)) {
+        vec3 nearPos;
+        BezierPatchEval(mix(uv, vec2(0.5), 0.001), nearPos, du, dv);
+        normal = cross(du, dv);
+    }
+}
+#endglsl
+
+// ***************************
+// Compute shader, named "computeShader_Bezier"
+//    Computes the VBO and EBO of Bezier patches, as GlGeomBezier::CalcVboAndEbo() does.
+//    There are four passes, selected by bezierPass:
+//      0. One invocation per vertex: its position, normal and texture coordinates.
+//      1. One invocation per row of triangles in a patch: the number of triangles
+//         in the row which are not degenerate.
+//      2. One invocation: the first triangle of each row, and of each patch.
+//      3. One invocation per row: the row's triangles, into the EBO.
+//    The normals at the corners of the patches are computed on the CPU, by
+//    GlGeomBezier::CalcCornerNormals(), since they do not depend on the mesh resolution.
+// ***************************
+#beginglsl computeshader computeShader_Bezier
+#version 430 core
+layout (local_size_x = 64) in;
+layout (std430, binding = 0) readonly buffer BezierControlPts { vec4 controlPts[]; };
+layout (std430, binding = 1) readonly buffer BezierCorners { vec4 cornerNormals[]; };  // Four per patch. w is nearZeroSq
+layout (std430, binding = 2) buffer BezierVbo { float vbo[]; };
+layout (std430, binding = 3) buffer BezierEbo { uint ebo[]; };
+layout (std430, binding = 4) buffer BezierRows { uint rowTris[]; };    // For each row, then firstTriInPatch[]
+uniform ivec4 bezierParams;     // uMeshRes, vMeshRes, uOrder, vOrder
+uniform ivec4 vboLayout;        // Stride, normal offset, texture coordinates offset (-1 if omitted), number of patches
+uniform int bezierPass;
+
+const int MaxOrder = 8;         // As GlGeomBezier::MaxComputeOrder
+
+// Evaluates a Bezier curve at num/den, and its derivative (not multiplied by the degree),
+//    with the de Casteljau algorithm, as in GlGeomBezier::BezierMultiEval().
+//    The lerps are a+alpha*(b-a), so that equal control points give exactly the same point.
+void CurveEval(vec4 pts[MaxOrder], int order, int num, int den, out vec4 val, out vec4 deriv)
+{
+    bool reverse = (num > den / 2);     // Lerp from the nearer end
+    float alpha = float(reverse ? den - num : num) / float(den);
+    vec4 w[MaxOrder];
+    for (int k = 0; k < order; k++) {
+        w[k] = pts[reverse ? order - 1 - k : k];
+    }
+    for (int level = 1; level < order - 1; level++) {
+        for (int k = 0; k < order - level; k++) {
+            w[k] = w[k] + alpha * (w[k + 1] - w[k]);
+        }
+    }
+    deriv = reverse ? w[0] - w[1] : w[1] - w[0];
+    val = w[0] + alpha * (w[1] - w[0]);
+}
+
+// The derivative of x/w, times w (the normal is normalized anyway)
+vec3 ProjectDeriv(vec3 pos, vec4 deriv)
+{
+    return deriv.xyz - pos * deriv.w;
+}
+
+// Control point (i,j) of a patch
+vec4 ControlPt(int patchBase, int i, int j)
+{
+    return controlPts[patchBase + j * bezierParams.z + i];
+}
+
+void VertexPass(int id)
+{
+    int uRes = bezierParams.x, vRes = bezierParams.y;
+    int uOrder = bezierParams.z, vOrder = bezierParams.w;
+    int vertsInPatch = (uRes + 1) * (vRes + 1);
+    if (id >= vboLayout.w * vertsInPatch) {
+        return;
+    }
+    int patchNum = id / vertsInPatch;
+    int i = (id % vertsInPatch) % (uRes + 1);
+    int j = (id % vertsInPatch) / (uRes + 1);
+    int patchBase = patchNum * uOrder * vOrder;
+    vec4 pts[MaxOrder], slice[MaxOrder], dummy;
+
+    // The position, and the partial derivative with j fixed: first along the columns, then along the row.
+    for (int a = 0; a < uOrder; a++) {
+        for (int b = 0; b < vOrder; b++) {
+            pts[b] = ControlPt(patchBase, a, b);
+        }
+        CurveEval(pts, vOrder, j, vRes, slice[a], dummy);
+    }
+    vec4 pos4, derivJ;
+    CurveEval(slice, uOrder, i, uRes, pos4, derivJ);
+    vec3 pos = pos4.xyz / pos4.w;
+    int vboBase = id * vboLayout.x;
+    vbo[vboBase] = pos.x;
+    vbo[vboBase + 1] = pos.y;
+    vbo[vboBase + 2] = pos.z;
+
+    if (vboLayout.y >= 0) {
+        vec3 normal;
+        bool uEdge = (i == 0 || i == uRes);
+        bool vEdge = (j == 0 || j == vRes);
+        if (uEdge && vEdge) {
+            normal = cornerNormals[4 * patchNum + (j == 0 ? 0 : 2) + (i == 0 ? 0 : 1)].xyz;
+        }
+        else {
+            // The partial derivative with i fixed: first along the rows, then along the column.
+            for (int b = 0; b < vOrder; b++) {
+                for (int a = 0; a < uOrder; a++) {
+                    pts[a] = ControlPt(patchBase, a, b);
+                }
+                CurveEval(pts, uOrder, i, uRes, slice[b], dummy);
+            }
+            vec4 derivI;
+            CurveEval(slice, vOrder, j, vRes, dummy, derivI);
+            vec3 du = ProjectDeriv(pos, derivJ);
+            vec3 dv = ProjectDeriv(pos, derivI);
+            normal = cross(du, dv);
+            // At a degenerate edge, use the partial derivative along the neighboring row or column of control points.
+            float nearZeroSq = cornerNormals[4 * patchNum].w;
+            if (dot(normal, normal) < nearZeroSq) {
+                vec4 pos2, deriv2;
+                if (uEdge) {
+                    if (dot(dv, dv) < nearZeroSq) {
+                        int ii = (i == 0) ? 1 : uOrder - 2;
+                        for (int b = 0; b < vOrder; b++) {
+                            pts[b] = ControlPt(patchBase, ii, b);
+                        }
+                        CurveEval(pts, vOrder, j, vRes, pos2, deriv2);
+                        normal = cross(du, ProjectDeriv(pos2.xyz / pos2.w, deriv2));
+                    }
+                }
+                else if (vEdge) {
+                    if (dot(du, du) < nearZeroSq) {
+                        int jj = (j == 0) ? 1 : vOrder - 2;
+                        for (int a = 0; a < uOrder; a++) {
+                            pts[a] = ControlPt(patchBase, a, jj);
+                        }
+                        CurveEval(pts, uOrder, i, uRes, pos2, deriv2);
+                        normal = cross(ProjectDeriv(pos2.xyz / pos2.w, deriv2), dv);
+                    }
+                }
+            }
+            normal = normalize(normal);
+        }
+        vbo[vboBase + vboLayout.y] = normal.x;
+        vbo[vboBase + vboLayout.y + 1] = normal.y;
+        vbo[vboBase + vboLayout.y + 2] = normal.z;
+    }
+    if (vboLayout.z >= 0) {
+        vbo[vboBase + vboLayout.z] = float(i) / float(uRes);
+        vbo[vboBase + vboLayout.z + 1] = float(j) / float(vRes);
+    }
+}
+
+bool EqualVerts(int a, int b)
+{
+    int stride = vboLayout.x;
+    return vbo[a * stride] == vbo[b * stride] && vbo[a * stride + 1] == vbo[b * stride + 1]
+        && vbo[a * stride + 2] == vbo[b * stride + 2];
+}
+
+// Counts (pass 1) or writes (pass 3) the triangles of a row which are not degenerate,
+//    in the order of GlGeomBezier::CalcVboAndEbo().
+void RowPass(int rowId, bool writeTris)
+{
+    int uRes = bezierParams.x, vRes = bezierParams.y;
+    if (rowId >= vboLayout.w * vRes) {
+        return;
+    }
+    int patchBase = (rowId / vRes) * (uRes + 1) * (vRes + 1);
+    int idx = patchBase + (rowId % vRes) * (uRes + 1);
+    uint numTris = writeTris ? rowTris[rowId] : 0u;
+    for (int i = 0; i < uRes; i++) {
+        if (!(EqualVerts(idx, idx + 1) || EqualVerts(idx, idx + (uRes + 1)))) {
+            if (writeTris) {
+                ebo[3 * numTris] = uint(idx);
+                ebo[3 * numTris + 1] = uint(idx + 1);
+                ebo[3 * numTris + 2] = uint(idx + (uRes + 1));
+            }
+            numTris++;
+        }
+        if (!(EqualVerts(idx + (uRes + 1), idx + (uRes + 2)) || EqualVerts(idx + (uRes + 2), idx + 1))) {
+            if (writeTris) {
+                ebo[3 * numTris] = uint(idx + (uRes + 1));
+                ebo[3 * numTris + 1] = uint(idx + 1);
+                ebo[3 * numTris + 2] = uint(idx + (uRes + 2));
+            }
+            numTris++;
+        }
+        idx++;
+    }
+    if (!writeTris) {
+        rowTris[rowId] = numTris;
+    }
+}
+
+// Replaces the counts of triangles in the rows by the number of the first triangle of each row.
+//    firstTriInPatch[] follows.
+void PrefixSumPass()
+{
+    int vRes = bezierParams.y;
+    int numRows = vboLayout.w * vRes;
+    uint total = 0u;
+    for (int r = 0; r < numRows; r++) {
+        if (r % vRes == 0) {
+            rowTris[numRows + r / vRes] = total;
+        }
+        uint count = rowTris[r];
+        rowTris[r] = total;
+        total += count;
+    }
+    rowTris[numRows + vboLayout.w] = total;
+}
+
+void main()
+{
+    int id = int(gl_GlobalInvocationID.x);
+    switch (bezierPass) {
+    case 0:
+        VertexPass(id);
+        break;
+    case 1:
+        RowPass(id, false);
+        break;
+    case 2:
+        if (id == 0) {
+            PrefixSumPass();
+        }
+        break;
+    case 3:
+        RowPass(id, true);
+        break;
+    }
+}
+#endglsl
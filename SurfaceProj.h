@@ -27,6 +27,11 @@ extern bool cullBackFaces;   // Equals true to cull backfaces. Equals false to n
 
 // The next variable controls the resoluton of the meshes for cylinders and spheres.
 extern int meshRes;             // Resolution of the meshes (slices, stacks, and rings all equal)
+extern bool largeMeshes;        // Equals true to give the sphere and torus much higher resolution
+extern bool bezierTessellation; // Equals true to render the teapot with the tessellation shaders
+
+// Set this to true whenever something changes that requires the scene to be redrawn.
+extern bool sceneDirty;
 
 extern LinearMapR4 viewMatrix;		// The current view matrix, based on viewAzimuth and viewDirection.
 // Comment: It might be a better design to have two matrices --- a view matrix and model matrix;
@@ -42,6 +47,13 @@ extern const unsigned int vTexcoords_loc;
 extern unsigned int projMatLocation;		// Location of the projectionMatrix in the "smooth" shader program.
 extern unsigned int modelviewMatLocation;	// Location of the modelviewMatrix in the "smooth" shader program.
 
+// Shader program and uniform locations for the instanced rendering of the stress scene
+extern unsigned int shaderProgramInstanced;
+extern unsigned int shaderProgramBezierCompute;     // 0 if there are no compute shaders
+extern unsigned int modelviewMatLocationInstanced;
+extern unsigned int instanceDataLocation;
+extern unsigned int instanceBaseLocation;
+
 extern float matEntries[16];	// Holds 16 floats (since cannot load doubles into a shader that uses floats)
 
 // ***********************
@@ -51,13 +63,19 @@ extern float matEntries[16];	// Holds 16 floats (since cannot load doubles into
 bool check_for_opengl_errors();     
 
 void mySetupGeometries();
+void myRemeshScene();
 void mySetViewMatrix();  
 
 void myRenderScene();
+void myUseProgram1();
+void myUseProgramNormals(bool drawEdges);
+unsigned int myUseProgramTessellated();
+void myUseProgramUntessellated();
 
 void my_setup_SceneData();
 void my_setup_OpenGL();
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 void window_size_callback(GLFWwindow* window, int width, int height);
+void window_refresh_callback(GLFWwindow* window);
 void error_callback(int error, const char* description);
 void setup_callbacks(GLFWwindow* window);
@@ -0,0 +1,343 @@
+/*
+ *
+ * TRSf.cpp, release 1.0.
+ *
+ * Compact single precision transforms for animation.  See TRSf.h.
+ *
+ * Software is "as-is" and carries no warranty.  It may be used without
+ *   restriction, but if you modify it, please change the filenames to
+ *   prevent confusion between different versions.
+ *
+ */
+
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+#include "Quaternion.h"
+#include "TRSf.h"
+
+#if TRSF_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+// **************************************
+// Quatf class                          *
+// * * * * * * * * * * * * * * * * * * **
+
+Quatf& Quatf::Set( const Quaternion& q )
+{
+	x = (float)q.x;
+	y = (float)q.y;
+	z = (float)q.z;
+	w = (float)q.w;
+	return *this;
+}
+
+Quatf& Quatf::SetRotate( float theta, float ax, float ay, float az )
+{
+	float normSq = ax*ax + ay*ay + az*az;
+	assert( normSq > 0.0f );
+	float halfTheta = 0.5f*theta;
+	float s = sinf(halfTheta)/sqrtf(normSq);
+	x = ax*s;
+	y = ay*s;
+	z = az*s;
+	w = cosf(halfTheta);
+	return *this;
+}
+
+Quatf& Quatf::Normalize()
+{
+	float normSq = x*x + y*y + z*z + w*w;
+	assert( normSq > 0.0f );
+	float normInv = 1.0f/sqrtf(normSq);
+	x *= normInv;
+	y *= normInv;
+	z *= normInv;
+	w *= normInv;
+	return *this;
+}
+
+// v + 2w(u*v) + 2u*(u*v), where u = (x, y, z).  As in VectorR3::Rotate(Quaternion).
+void Quatf::Rotate( float v[3] ) const
+{
+	float tx = 2.0f*(y*v[2] - z*v[1]);
+	float ty = 2.0f*(z*v[0] - x*v[2]);
+	float tz = 2.0f*(x*v[1] - y*v[0]);
+	v[0] += w*tx + (y*tz - z*ty);
+	v[1] += w*ty + (z*tx - x*tz);
+	v[2] += w*tz + (x*ty - y*tx);
+}
+
+// **************************************
+// TRSf class                           *
+// * * * * * * * * * * * * * * * * * * **
+
+TRSf& TRSf::SetIdentity()
+{
+	t[0] = t[1] = t[2] = 0.0f;
+	q = Quatf();
+	s[0] = s[1] = s[2] = 1.0f;
+	return *this;
+}
+
+//  T(tA) R(qA) S(sA) T(tB) R(qB) S(sB) = T(tA + qA(sA tB)) R(qA) S(sA) R(qB) S(sB),
+//     and S(sA) R(qB) = R(qB) S(sA) when sA is uniform.
+TRSf& TRSf::operator*= ( const TRSf& B )
+{
+	// t += q rotating (s times B.t), written out as in Quatf::Rotate.
+	//   (Scalar temporaries, not an array: that keeps everything in registers.)
+	float vx = s[0]*B.t[0];
+	float vy = s[1]*B.t[1];
+	float vz = s[2]*B.t[2];
+	float tx = 2.0f*(q.y*vz - q.z*vy);
+	float ty = 2.0f*(q.z*vx - q.x*vz);
+	float tz = 2.0f*(q.x*vy - q.y*vx);
+	t[0] += vx + q.w*tx + (q.y*tz - q.z*ty);
+	t[1] += vy + q.w*ty + (q.z*tx - q.x*tz);
+	t[2] += vz + q.w*tz + (q.x*ty - q.y*tx);
+	q = q*B.q;
+	s[0] *= B.s[0];
+	s[1] *= B.s[1];
+	s[2] *= B.s[2];
+	return *this;
+}
+
+Mat4f& TRSf::ToMat4f( Mat4f& M ) const
+{
+	float xx = q.x*q.x, yy = q.y*q.y, zz = q.z*q.z;
+	float xy = q.x*q.y, xz = q.x*q.z, yz = q.y*q.z;
+	float wx = q.w*q.x, wy = q.w*q.y, wz = q.w*q.z;
+	float* m = M.m;
+	// Column j of the rotation matrix, times s[j]
+	m[0] = (1.0f - 2.0f*(yy + zz))*s[0];
+	m[1] = 2.0f*(xy + wz)*s[0];
+	m[2] = 2.0f*(xz - wy)*s[0];
+	m[3] = 0.0f;
+	m[4] = 2.0f*(xy - wz)*s[1];
+	m[5] = (1.0f - 2.0f*(xx + zz))*s[1];
+	m[6] = 2.0f*(yz + wx)*s[1];
+	m[7] = 0.0f;
+	m[8] = 2.0f*(xz + wy)*s[2];
+	m[9] = 2.0f*(yz - wx)*s[2];
+	m[10] = (1.0f - 2.0f*(xx + yy))*s[2];
+	m[11] = 0.0f;
+	m[12] = t[0];
+	m[13] = t[1];
+	m[14] = t[2];
+	m[15] = 1.0f;
+	return M;
+}
+
+void TRSf::TransformPosition( const float in[3], float out[3] ) const
+{
+	float v[3] = { s[0]*in[0], s[1]*in[1], s[2]*in[2] };
+	q.Rotate( v );
+	out[0] = v[0] + t[0];
+	out[1] = v[1] + t[1];
+	out[2] = v[2] + t[2];
+}
+
+// **************************************
+// QuatfArray class                     *
+// * * * * * * * * * * * * * * * * * * **
+
+void QuatfArray::Resize( int n )
+{
+	assert( n>=0 );
+	if ( n>capacity ) {
+		int newCapacity = capacity<4 ? 4 : 2*capacity;
+		newCapacity = newCapacity>=n ? newCapacity : ((n+3)&~3);
+		float* newBlock = new float[4*newCapacity + 4];		// 4 extra floats for alignment
+		float* start = (float*)(((uintptr_t)newBlock + 15) & ~(uintptr_t)15);
+		memset( start, 0, 4*newCapacity*sizeof(float) );
+		if ( size>0 ) {
+			memcpy( start, x, size*sizeof(float) );
+			memcpy( start+newCapacity, y, size*sizeof(float) );
+			memcpy( start+2*newCapacity, z, size*sizeof(float) );
+			memcpy( start+3*newCapacity, w, size*sizeof(float) );
+		}
+		delete[] block;
+		block = newBlock;
+		x = start;
+		y = start+newCapacity;
+		z = start+2*newCapacity;
+		w = start+3*newCapacity;
+		capacity = newCapacity;
+	}
+	// Zero the new entries, or the old entries that become padding
+	int first = n>size ? size : n;
+	int last = n>size ? n : PaddedSize();
+	memset( x+first, 0, (last-first)*sizeof(float) );
+	memset( y+first, 0, (last-first)*sizeof(float) );
+	memset( z+first, 0, (last-first)*sizeof(float) );
+	memset( w+first, 0, (last-first)*sizeof(float) );
+	size = n;
+}
+
+void QuatfArray::PushBack( const Quatf& q )
+{
+	Resize( size+1 );
+	Set( size-1, q );
+}
+
+// **************************************
+// Interpolation                        *
+// * * * * * * * * * * * * * * * * * * **
+
+// The kernels are templates, instantiated with T = float for one quaternion
+//   at a time and, with SSE, with T = Lanes for four quaternions at a time.
+//   Thus the Quatf and QuatfArray versions use exactly the same formulas.
+
+inline float SignOf( float a ) { return a<0.0f ? -1.0f : 1.0f; }
+inline float Sqrt( float a ) { return sqrtf(a); }
+
+#if TRSF_USE_SSE
+// Four floats, with the arithmetic needed by the kernels.
+struct Lanes {
+	__m128 v;
+	Lanes() {}
+	Lanes( float a ) : v(_mm_set1_ps(a)) {}
+	Lanes( __m128 a ) : v(a) {}
+};
+inline Lanes operator+( Lanes a, Lanes b ) { return _mm_add_ps(a.v, b.v); }
+inline Lanes operator-( Lanes a, Lanes b ) { return _mm_sub_ps(a.v, b.v); }
+inline Lanes operator*( Lanes a, Lanes b ) { return _mm_mul_ps(a.v, b.v); }
+inline Lanes operator/( Lanes a, Lanes b ) { return _mm_div_ps(a.v, b.v); }
+inline Lanes Sqrt( Lanes a ) { return _mm_sqrt_ps(a.v); }
+inline Lanes SignOf( Lanes a )
+{
+	__m128 negative = _mm_cmplt_ps( a.v, _mm_setzero_ps() );
+	return _mm_or_ps( _mm_and_ps(negative, _mm_set1_ps(-1.0f)), _mm_andnot_ps(negative, _mm_set1_ps(1.0f)) );
+}
+#endif
+
+// Slerp by D. Eberly's polynomial approximation ("A fast and accurate algorithm
+//   for computing SLERP", 2011).  With c = cos(theta) and d = 1-alpha,
+//      sin(alpha*theta)/sin(theta) = alpha * (1 + b_1*(1 + b_2*(1 + ... b_12))),
+//   with b_i = (u_i alpha^2 - v_i)(c-1), u_i = 1/(i(2i+1)) and v_i = i/(2i+1).
+//   The series converges slowest at c = 0 (the shorter path means c >= 0).
+//   With twelve terms, and the last term scaled by onePlusMu to reduce the
+//   truncation error, the error is below 1e-6 for all c and alpha.
+static const int slerpTerms = 12;
+static const float onePlusMu = 1.894f;
+static const float slerpU[slerpTerms] = { 1.0f/(1*3), 1.0f/(2*5), 1.0f/(3*7), 1.0f/(4*9),
+										  1.0f/(5*11), 1.0f/(6*13), 1.0f/(7*15), 1.0f/(8*17),
+										  1.0f/(9*19), 1.0f/(10*21), 1.0f/(11*23), onePlusMu/(12*25) };
+static const float slerpV[slerpTerms] = { 1.0f/3, 2.0f/5, 3.0f/7, 4.0f/9,
+										  5.0f/11, 6.0f/13, 7.0f/15, 8.0f/17,
+										  9.0f/19, 10.0f/21, 11.0f/23, onePlusMu*12/25 };
+
+template<class T> inline void SlerpKernel( const T q1[4], const T q2[4], T alpha, T out[4] )
+{
+	T cosTheta = q1[0]*q2[0] + q1[1]*q2[1] + q1[2]*q2[2] + q1[3]*q2[3];
+	T sign = SignOf( cosTheta );			// Take the shorter path
+	T xm1 = cosTheta*sign - T(1.0f);
+	T d = T(1.0f) - alpha;
+	T sqrT = alpha*alpha;
+	T sqrD = d*d;
+	T fT = T(1.0f);
+	T fD = T(1.0f);
+	for ( int i=slerpTerms-1; i>=0; i-- ) {
+		fT = T(1.0f) + (T(slerpU[i])*sqrT - T(slerpV[i]))*xm1*fT;
+		fD = T(1.0f) + (T(slerpU[i])*sqrD - T(slerpV[i]))*xm1*fD;
+	}
+	T c1 = d*fD;
+	T c2 = sign*alpha*fT;
+	for ( int k=0; k<4; k++ ) {
+		out[k] = c1*q1[k] + c2*q2[k];
+	}
+}
+
+template<class T> inline void NlerpKernel( const T q1[4], const T q2[4], T alpha, T out[4] )
+{
+	T cosTheta = q1[0]*q2[0] + q1[1]*q2[1] + q1[2]*q2[2] + q1[3]*q2[3];
+	T c1 = T(1.0f) - alpha;
+	T c2 = SignOf( cosTheta )*alpha;
+	for ( int k=0; k<4; k++ ) {
+		out[k] = c1*q1[k] + c2*q2[k];
+	}
+	T normInv = T(1.0f)/Sqrt( out[0]*out[0] + out[1]*out[1] + out[2]*out[2] + out[3]*out[3] );
+	for ( int k=0; k<4; k++ ) {
+		out[k] = out[k]*normInv;
+	}
+}
+
+Quatf Slerp( const Quatf& q1, const Quatf& q2, float alpha )
+{
+	float a[4] = { q1.x, q1.y, q1.z, q1.w };
+	float b[4] = { q2.x, q2.y, q2.z, q2.w };
+	float r[4];
+	SlerpKernel<float>( a, b, alpha, r );
+	return Quatf( r[0], r[1], r[2], r[3] );
+}
+
+Quatf Nlerp( const Quatf& q1, const Quatf& q2, float alpha )
+{
+	float a[4] = { q1.x, q1.y, q1.z, q1.w };
+	float b[4] = { q2.x, q2.y, q2.z, q2.w };
+	float r[4];
+	NlerpKernel<float>( a, b, alpha, r );
+	return Quatf( r[0], r[1], r[2], r[3] );
+}
+
+// Applies Kernel to four quaternions at a time (with SSE) and then one at a time.
+//    Each quaternion is read before its result is written, so dest may be q1 or q2.
+template<void (*KernelF)(const float*, const float*, float, float*)
+#if TRSF_USE_SSE
+	, void (*KernelL)(const Lanes*, const Lanes*, Lanes, Lanes*)
+#endif
+	>
+static void InterpolateArrays( const QuatfArray& q1, const QuatfArray& q2, float alpha, QuatfArray& dest )
+{
+	assert( q1.Size()==q2.Size() );
+	dest.Resize( q1.Size() );
+	const float* a[4] = { q1.X(), q1.Y(), q1.Z(), q1.W() };
+	const float* b[4] = { q2.X(), q2.Y(), q2.Z(), q2.W() };
+	float* d[4] = { dest.X(), dest.Y(), dest.Z(), dest.W() };
+	int n = q1.PaddedSize();
+	int i = 0;
+#if TRSF_USE_SSE
+	Lanes alphaL( alpha );
+	for ( ; i<n; i+=4 ) {
+		Lanes qa[4], qb[4], r[4];
+		for ( int k=0; k<4; k++ ) {
+			qa[k] = _mm_load_ps( a[k]+i );
+			qb[k] = _mm_load_ps( b[k]+i );
+		}
+		KernelL( qa, qb, alphaL, r );
+		for ( int k=0; k<4; k++ ) {
+			_mm_store_ps( d[k]+i, r[k].v );
+		}
+	}
+#endif
+	for ( ; i<n; i++ ) {
+		float qa[4] = { a[0][i], a[1][i], a[2][i], a[3][i] };
+		float qb[4] = { b[0][i], b[1][i], b[2][i], b[3][i] };
+		float r[4];
+		KernelF( qa, qb, alpha, r );
+		for ( int k=0; k<4; k++ ) {
+			d[k][i] = r[k];
+		}
+	}
+}
+
+// The padding entries are zero quaternions, so Nlerp divides 0 by 0 there.
+//   Those results are not used.
+void Slerp( const QuatfArray& q1, const QuatfArray& q2, float alpha, QuatfArray& dest )
+{
+#if TRSF_USE_SSE
+	InterpolateArrays<SlerpKernel<float>, SlerpKernel<Lanes> >( q1, q2, alpha, dest );
+#else
+	InterpolateArrays<SlerpKernel<float> >( q1, q2, alpha, dest );
+#endif
+}
+
+void Nlerp( const QuatfArray& q1, const QuatfArray& q2, float alpha, QuatfArray& dest )
+{
+#if TRSF_USE_SSE
+	InterpolateArrays<NlerpKernel<float>, NlerpKernel<Lanes> >( q1, q2, alpha, dest );
+#else
+	InterpolateArrays<NlerpKernel<float> >( q1, q2, alpha, dest );
+#endif
+}
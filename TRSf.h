@@ -0,0 +1,168 @@
+/*
+ *
+ * TRSf.h, release 1.0.
+ *
+ * Compact single precision transforms for animation.
+ *   Quatf is a float quaternion (a rotation).
+ *   TRSf is a translation, a rotation and a scaling: the matrix
+ *       Translate(t) * Rotate(q) * Scale(s)
+ *   in 10 floats, instead of the 16 of a Mat4f (or 16 doubles of a LinearMapR4).
+ *   TRSf's are composed directly, and converted to a Mat4f only when
+ *   needed for OpenGL.
+ *
+ *   QuatfArray stores many quaternions as separate x, y, z, w streams,
+ *   and Slerp() and Nlerp() interpolate whole arrays four at a time with SSE.
+ *   The Slerp of a Quatf (or of a QuatfArray) uses a polynomial approximation
+ *   with only multiplies and adds (no trig functions); its error is below 1e-6.
+ *
+ * Software is "as-is" and carries no warranty.  It may be used without
+ *   restriction, but if you modify it, please change the filenames to
+ *   prevent confusion between different versions.
+ *
+ */
+
+#ifndef TRSF_H
+#define TRSF_H
+
+#include <assert.h>
+#include "Mat4f.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define TRSF_USE_SSE 1
+#endif
+
+class Quaternion;
+
+// **************************************
+// Quatf class                          *
+// * * * * * * * * * * * * * * * * * * **
+
+class Quatf {
+
+public:
+	float x, y, z, w;		// w is the scalar part
+
+public:
+	constexpr Quatf() : x(0.0f), y(0.0f), z(0.0f), w(1.0f) {}		// The identity rotation
+	constexpr Quatf( float xx, float yy, float zz, float ww ) : x(xx), y(yy), z(zz), w(ww) {}
+	explicit Quatf( const Quaternion& q ) { Set(q); }
+
+	Quatf& Set( const Quaternion& q );			// Round to float
+	// The rotation by theta radians around the axis.  The axis need not be a unit vector.
+	Quatf& SetRotate( float theta, float ax, float ay, float az );
+	Quatf& Normalize();
+	Quatf Conjugate() const { return Quatf( -x, -y, -z, w ); }
+
+	// Rotate the vector v (in place).  The quaternion must be a unit quaternion.
+	void Rotate( float v[3] ) const;
+};
+
+// The rotation for q1*q2 is the rotation for q2 followed by the rotation for q1.
+inline Quatf operator* ( const Quatf& q1, const Quatf& q2 )
+{
+	return Quatf( q1.w*q2.x + q1.x*q2.w + q1.y*q2.z - q1.z*q2.y,
+				  q1.w*q2.y + q1.y*q2.w + q1.z*q2.x - q1.x*q2.z,
+				  q1.w*q2.z + q1.z*q2.w + q1.x*q2.y - q1.y*q2.x,
+				  q1.w*q2.w - q1.x*q2.x - q1.y*q2.y - q1.z*q2.z );
+}
+
+// Interpolation along the shorter path, alpha from 0 (q1) to 1 (q2).
+//   The same formulas as the batched versions below.
+Quatf Slerp( const Quatf& q1, const Quatf& q2, float alpha );
+Quatf Nlerp( const Quatf& q1, const Quatf& q2, float alpha );
+
+// **************************************
+// TRSf class                           *
+// * * * * * * * * * * * * * * * * * * **
+
+class TRSf {
+
+public:
+	float t[3];			// Translation
+	Quatf q;			// Rotation (a unit quaternion)
+	float s[3];			// Scaling (along the x, y, z axes, before the rotation)
+
+public:
+	TRSf() { SetIdentity(); }
+	TRSf( float tx, float ty, float tz, const Quatf& rotation, float sx, float sy, float sz )
+		{ t[0] = tx; t[1] = ty; t[2] = tz; q = rotation; s[0] = sx; s[1] = sy; s[2] = sz; }
+
+	TRSf& SetIdentity();
+	TRSf& SetTranslate( float tx, float ty, float tz ) { t[0] = tx; t[1] = ty; t[2] = tz; return *this; }
+	TRSf& SetRotate( const Quatf& rotation ) { q = rotation; return *this; }
+	TRSf& SetRotate( float theta, float ax, float ay, float az ) { q.SetRotate( theta, ax, ay, az ); return *this; }
+	TRSf& SetScale( float sx, float sy, float sz ) { s[0] = sx; s[1] = sy; s[2] = sz; return *this; }
+	TRSf& SetScale( float scale ) { return SetScale( scale, scale, scale ); }
+
+	// Composition: (*this)*B applies B first, then *this.
+	//   The result is exact if *this has uniform scaling (s[0]==s[1]==s[2]).
+	//   Otherwise a non-uniform scaling followed by a rotation is not a TRS
+	//   transform, and the result keeps the translation exact but only
+	//   approximates the rest.
+	TRSf& operator*= ( const TRSf& B );
+
+	// The affine matrix  Translate(t) * Rotate(q) * Scale(s)
+	Mat4f& ToMat4f( Mat4f& M ) const;
+	Mat4f ToMat4f() const { Mat4f M; return ToMat4f(M); }
+
+	void TransformPosition( const float in[3], float out[3] ) const;
+};
+
+inline TRSf operator* ( const TRSf& A, const TRSf& B )
+{
+	TRSf ret = A;
+	ret *= B;
+	return ret;
+}
+
+// **************************************
+// QuatfArray class                     *
+// * * * * * * * * * * * * * * * * * * **
+
+// An array of quaternions as four streams, each aligned on 16 bytes,
+//   with length padded to a multiple of four.  Resize() sets the padding
+//   entries to zero; the interpolations may leave other values there.
+class QuatfArray {
+
+public:
+	QuatfArray() : block(0), x(0), y(0), z(0), w(0), size(0), capacity(0) {}
+	explicit QuatfArray( int n ) : block(0), x(0), y(0), z(0), w(0), size(0), capacity(0) { Resize(n); }
+	~QuatfArray() { delete[] block; }
+
+	QuatfArray( const QuatfArray& ) = delete;
+	QuatfArray& operator= ( const QuatfArray& ) = delete;
+
+	int Size() const { return size; }
+	int PaddedSize() const { return (size+3)&~3; }
+	void Resize( int n );				// New entries are set to zero
+	void PushBack( const Quatf& q );
+
+	Quatf Get( int i ) const { assert(0<=i && i<size); return Quatf( x[i], y[i], z[i], w[i] ); }
+	void Set( int i, const Quatf& q ) { assert(0<=i && i<size); x[i] = q.x; y[i] = q.y; z[i] = q.z; w[i] = q.w; }
+
+	float* X() { return x; }
+	float* Y() { return y; }
+	float* Z() { return z; }
+	float* W() { return w; }
+	const float* X() const { return x; }
+	const float* Y() const { return y; }
+	const float* Z() const { return z; }
+	const float* W() const { return w; }
+
+private:
+	float* block;
+	float* x;
+	float* y;
+	float* z;
+	float* w;
+	int size;
+	int capacity;
+};
+
+// dest[i] = Slerp( q1[i], q2[i], alpha ), and the same for Nlerp.
+//   q1 and q2 must have the same size.  dest is resized, and may be q1 or q2.
+//   The results are the same as for the Quatf versions.
+void Slerp( const QuatfArray& q1, const QuatfArray& q2, float alpha, QuatfArray& dest );
+void Nlerp( const QuatfArray& q1, const QuatfArray& q2, float alpha, QuatfArray& dest );
+
+#endif // TRSF_H
@@ -0,0 +1,96 @@
+/*
+* TaskGraph.cpp - Version 1.0
+*
+* A set of tasks, and the order in which they must run.
+*   See TaskGraph.h for information on how to use it.
+*
+* Software is "as-is" and carries no warranty.  It may be used without
+*   restriction, but if you modify it, please change the filenames to
+*   prevent confusion between different versions.
+*/
+
+#include <assert.h>
+
+#include "TaskGraph.h"
+#include "TaskScheduler.h"
+
+int TaskGraph::AddTask(std::function<void()> work, const std::vector<int>& dependencies)
+{
+    return AddNode(std::move(work), dependencies, false);
+}
+
+int TaskGraph::AddMainThreadTask(std::function<void()> work, const std::vector<int>& dependencies)
+{
+    return AddNode(std::move(work), dependencies, true);
+}
+
+int TaskGraph::AddNode(std::function<void()> work, const std::vector<int>& dependencies, bool onMainThread)
+{
+    int taskID = (int)nodes.size();
+    for (int dep : dependencies) {
+        assert(dep >= 0 && dep < taskID);   // So the graph can have no cycles
+        nodes[dep].successors.push_back(taskID);
+    }
+    Node node;
+    node.work = std::move(work);
+    node.numDependencies = (int)dependencies.size();
+    node.onMainThread = onMainThread;
+    nodes.push_back(std::move(node));
+    return taskID;
+}
+
+void TaskGraph::Run()
+{
+    int numTasks = (int)nodes.size();
+    unfinishedDependencies.reset(new std::atomic<int>[numTasks]);
+    for (int i = 0; i < numTasks; i++) {
+        unfinishedDependencies[i] = nodes[i].numDependencies;
+    }
+    numFinished = 0;
+    for (int i = 0; i < numTasks; i++) {
+        if (nodes[i].numDependencies == 0) {
+            Dispatch(i);
+        }
+    }
+
+    // Run the main thread tasks as they become ready, and help with the other tasks meanwhile.
+    TaskScheduler& scheduler = TaskScheduler::Get();
+    scheduler.HelpUntil([&] {
+        while (true) {
+            int taskID;
+            {
+                std::lock_guard<std::mutex> lock(mainThreadMutex);
+                if (mainThreadReady.empty()) {
+                    break;
+                }
+                taskID = mainThreadReady.back();
+                mainThreadReady.pop_back();
+            }
+            Execute(taskID);
+        }
+        return numFinished == numTasks;
+    });
+}
+
+void TaskGraph::Dispatch(int taskID)
+{
+    if (nodes[taskID].onMainThread) {
+        std::lock_guard<std::mutex> lock(mainThreadMutex);
+        mainThreadReady.push_back(taskID);
+    }
+    else {
+        TaskScheduler::Get().Submit([this, taskID] { Execute(taskID); });
+    }
+}
+
+void TaskGraph::Execute(int taskID)
+{
+    Node& node = nodes[taskID];
+    node.work();
+    for (int next : node.successors) {
+        if (--unfinishedDependencies[next] == 0) {
+            Dispatch(next);
+        }
+    }
+    numFinished++;
+}
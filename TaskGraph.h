@@ -0,0 +1,71 @@
+/*
+* TaskGraph.h - Version 1.0
+*
+* A set of tasks, and the order in which they must run.
+*   Each task runs once all the tasks it depends on have finished.  The
+*   tasks run on the TaskScheduler, so independent tasks run in parallel.
+*   Tasks added with AddMainThreadTask() run on the thread which calls
+*   Run(): use these for OpenGL calls, which need the OpenGL context.
+*
+* Software is "as-is" and carries no warranty.  It may be used without
+*   restriction, but if you modify it, please change the filenames to
+*   prevent confusion between different versions.
+*/
+
+#pragma once
+#ifndef TASK_GRAPH_H
+#define TASK_GRAPH_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// TaskGraph
+// How to use:
+//     * Call AddTask() and AddMainThreadTask() for each task.  They return
+//       the task's ID.  A task may only depend on tasks added before it.
+//     * Call Run(), which returns when all the tasks have finished.
+//       Run() may be called again, to run all the tasks again.
+
+class TaskGraph
+{
+public:
+    TaskGraph() : numFinished(0) {}
+
+    // Disable all copy and assignment operators.
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+    TaskGraph(TaskGraph&&) = delete;
+    TaskGraph& operator=(TaskGraph&&) = delete;
+
+    int AddTask(std::function<void()> work, const std::vector<int>& dependencies = std::vector<int>());
+    int AddMainThreadTask(std::function<void()> work, const std::vector<int>& dependencies = std::vector<int>());
+
+    void Run();
+    void Clear() { nodes.clear(); }
+    int GetNumTasks() const { return (int)nodes.size(); }
+
+private:
+    struct Node {
+        std::function<void()> work;
+        std::vector<int> successors;        // Tasks which depend on this one
+        int numDependencies;
+        bool onMainThread;
+    };
+
+    int AddNode(std::function<void()> work, const std::vector<int>& dependencies, bool onMainThread);
+    void Dispatch(int taskID);              // Called when all of a task's dependencies have finished
+    void Execute(int taskID);
+
+    std::vector<Node> nodes;
+
+    // State while running
+    std::unique_ptr<std::atomic<int>[]> unfinishedDependencies;
+    std::atomic<int> numFinished;
+    std::mutex mainThreadMutex;
+    std::vector<int> mainThreadReady;       // Main thread tasks which are ready to run
+};
+
+#endif  // TASK_GRAPH_H
@@ -0,0 +1,111 @@
+/*
+* TaskScheduler.cpp - Version 1.0
+*
+* A work-stealing pool of worker threads which runs small tasks.
+*   See TaskScheduler.h for information on how to use it.
+*
+* Software is "as-is" and carries no warranty.  It may be used without
+*   restriction, but if you modify it, please change the filenames to
+*   prevent confusion between different versions.
+*/
+
+#include <assert.h>
+
+#include "MathMisc.h"
+#include "TaskScheduler.h"
+
+// The queue owned by the current thread: 0 for threads which are not workers.
+static thread_local int ownQueueIndex = 0;
+
+TaskScheduler& TaskScheduler::Get()
+{
+    static TaskScheduler theScheduler(Max((int)std::thread::hardware_concurrency() - 1, 0));
+    return theScheduler;
+}
+
+TaskScheduler::TaskScheduler(int numWorkers)
+    : numQueued(0)
+{
+    for (int i = 0; i <= numWorkers; i++) {
+        queues.emplace_back(new TaskQueue);
+    }
+    for (int i = 0; i < numWorkers; i++) {
+        workers.emplace_back(&TaskScheduler::WorkerLoop, this, i);
+    }
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        quitting = true;
+    }
+    sleepCV.notify_all();
+    for (std::thread& w : workers) {
+        w.join();
+    }
+}
+
+void TaskScheduler::Submit(Task task)
+{
+    TaskQueue& queue = *queues[ownQueueIndex];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        numQueued++;
+    }
+    sleepCV.notify_one();
+}
+
+// Takes the newest task of the thread's own queue, or else steals the oldest
+//    task of another queue.  The search for a victim starts after the thread's own queue.
+bool TaskScheduler::FindTask(int ownQueue, Task& task)
+{
+    int numQueues = (int)queues.size();
+    for (int k = 0; k < numQueues; k++) {
+        int i = (ownQueue + k) % numQueues;
+        TaskQueue& queue = *queues[i];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            if (k == 0) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            else {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            numQueued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TaskScheduler::RunOneTask()
+{
+    Task task;
+    if (!FindTask(ownQueueIndex, task)) {
+        return false;
+    }
+    task();
+    return true;
+}
+
+void TaskScheduler::WorkerLoop(int workerIndex)
+{
+    ownQueueIndex = workerIndex + 1;
+    while (true) {
+        if (RunOneTask()) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepCV.wait(lock, [this] { return quitting || numQueued > 0; });
+        if (quitting) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,89 @@
+/*
+* TaskScheduler.h - Version 1.0
+*
+* A work-stealing pool of worker threads which runs small tasks.
+*   Each worker has its own queue of tasks.  A task submitted by a worker
+*   goes on the worker's own queue, which the worker runs newest first
+*   (its data is likely still in the cache).  A worker with an empty queue
+*   steals the oldest task of another queue.  Tasks submitted by other
+*   threads (e.g., the main thread) go on a shared queue.
+*
+*   A thread which waits for tasks to finish should call HelpUntil(),
+*   which runs queued tasks while it waits.  So tasks may submit tasks and
+*   wait for them, and everything still runs with no worker threads at all.
+*
+* Software is "as-is" and carries no warranty.  It may be used without
+*   restriction, but if you modify it, please change the filenames to
+*   prevent confusion between different versions.
+*/
+
+#pragma once
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TaskScheduler
+{
+public:
+    typedef std::function<void()> Task;
+
+    // The scheduler, with one worker thread per hardware thread, less one for the main thread.
+    //    It is created the first time it is used.
+    static TaskScheduler& Get();
+
+    ~TaskScheduler();
+
+    // Disable all copy and assignment operators.
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+    TaskScheduler(TaskScheduler&&) = delete;
+    TaskScheduler& operator=(TaskScheduler&&) = delete;
+
+    int GetNumWorkers() const { return (int)workers.size(); }
+
+    // Queue a task, to be run by some thread.
+    void Submit(Task task);
+
+    // Runs one queued task on the calling thread.  Returns false if there was none.
+    bool RunOneTask();
+
+    // Runs queued tasks until done() returns true.
+    template<class Predicate> void HelpUntil(Predicate done);
+
+private:
+    explicit TaskScheduler(int numWorkers);
+
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool FindTask(int ownQueue, Task& task);
+    void WorkerLoop(int workerIndex);
+
+    std::vector<std::unique_ptr<TaskQueue>> queues;     // queues[0] is shared by all non-worker threads
+    std::vector<std::thread> workers;                   // Worker i owns queues[i+1]
+    std::mutex sleepMutex;
+    std::condition_variable sleepCV;                    // Idle workers wait here
+    std::atomic<int> numQueued;                         // Tasks in all queues
+    bool quitting = false;
+};
+
+template<class Predicate> inline void TaskScheduler::HelpUntil(Predicate done)
+{
+    while (!done()) {
+        if (!RunOneTask()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+#endif  // TASK_SCHEDULER_H
@@ -0,0 +1,146 @@
+/*
+* TransformStore.cpp - Version 1.0
+*
+* A data-oriented ("structure of arrays") store of many spinning objects.
+*   See TransformStore.h for information on how to use it.
+*
+* Software is "as-is" and carries no warranty.  It may be used without
+*   restriction, but if you modify it, please change the filenames to
+*   prevent confusion between different versions.
+*/
+
+#include <math.h>
+#include <assert.h>
+#include <algorithm>
+
+#include "MathMisc.h"
+#include "ParallelFor.h"
+#include "TransformStore.h"
+
+// Entities per range: smaller stores are updated by the calling thread only.
+static const int MinEntitiesPerThread = 8192;
+
+void TransformStore::Clear()
+{
+    geomID.clear();
+    posX.clear(); posY.clear(); posZ.clear();
+    axisX.clear(); axisY.clear(); axisZ.clear();
+    spinPhase.clear(); spinRate.clear();
+    pivotX.clear(); pivotY.clear(); pivotZ.clear();
+    scaleX.clear(); scaleY.clear(); scaleZ.clear();
+    colorR.clear(); colorG.clear(); colorB.clear();
+    batchStart.clear();
+    instanceData.clear();
+}
+
+void TransformStore::Reserve(int n)
+{
+    geomID.reserve(n);
+    posX.reserve(n); posY.reserve(n); posZ.reserve(n);
+    axisX.reserve(n); axisY.reserve(n); axisZ.reserve(n);
+    spinPhase.reserve(n); spinRate.reserve(n);
+    pivotX.reserve(n); pivotY.reserve(n); pivotZ.reserve(n);
+    scaleX.reserve(n); scaleY.reserve(n); scaleZ.reserve(n);
+    colorR.reserve(n); colorG.reserve(n); colorB.reserve(n);
+}
+
+int TransformStore::Add(int geometryID,
+    float x, float y, float z,
+    float ax, float ay, float az,
+    float phase, float rate,
+    float px, float py, float pz,
+    float sx, float sy, float sz,
+    float red, float green, float blue)
+{
+    assert(geometryID >= 0);
+    float axisNorm = sqrtf(ax * ax + ay * ay + az * az);
+    assert(axisNorm > 0.0f);
+    geomID.push_back(geometryID);
+    posX.push_back(x); posY.push_back(y); posZ.push_back(z);
+    axisX.push_back(ax / axisNorm); axisY.push_back(ay / axisNorm); axisZ.push_back(az / axisNorm);
+    spinPhase.push_back(phase); spinRate.push_back(rate);
+    pivotX.push_back(px); pivotY.push_back(py); pivotZ.push_back(pz);
+    scaleX.push_back(sx); scaleY.push_back(sy); scaleZ.push_back(sz);
+    colorR.push_back(red); colorG.push_back(green); colorB.push_back(blue);
+    return (int)geomID.size() - 1;
+}
+
+template<class T> void TransformStore::Permute(std::vector<T>& v, const std::vector<int>& order)
+{
+    std::vector<T> sorted(v.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        sorted[i] = v[order[i]];
+    }
+    v.swap(sorted);
+}
+
+void TransformStore::SortByGeometry()
+{
+    int n = GetNumEntities();
+    std::vector<int> order(n);
+    for (int i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(),
+        [this](int a, int b) { return geomID[a] < geomID[b]; });
+
+    Permute(geomID, order);
+    Permute(posX, order); Permute(posY, order); Permute(posZ, order);
+    Permute(axisX, order); Permute(axisY, order); Permute(axisZ, order);
+    Permute(spinPhase, order); Permute(spinRate, order);
+    Permute(pivotX, order); Permute(pivotY, order); Permute(pivotZ, order);
+    Permute(scaleX, order); Permute(scaleY, order); Permute(scaleZ, order);
+    Permute(colorR, order); Permute(colorG, order); Permute(colorB, order);
+
+    // batchStart[g] is the first entity with geometry ID g.
+    int numGeoms = (n == 0) ? 0 : geomID[n - 1] + 1;
+    batchStart.assign(numGeoms + 1, n);
+    for (int i = n - 1; i >= 0; i--) {
+        batchStart[geomID[i]] = i;
+    }
+    for (int g = numGeoms - 1; g >= 0; g--) {
+        batchStart[g] = Min(batchStart[g], batchStart[g + 1]);     // Geometry IDs with no entities
+    }
+
+    instanceData.resize((size_t)n * FloatsPerInstance);
+}
+
+void TransformStore::Update(double time)
+{
+    int n = GetNumEntities();
+    assert(instanceData.size() == (size_t)n * FloatsPerInstance);   // SortByGeometry() must be called first
+    ParallelFor(0, n, MinEntitiesPerThread, [this, time](int start, int end) {
+        UpdateRange((float)time, start, end);
+    });
+}
+
+// Compute the instance records for entities start,...,end-1.
+// The rotation is by Rodrigues' formula.  The loop has no branches and only reads
+//    from the input arrays, so it can be vectorized.
+void TransformStore::UpdateRange(float time, int start, int end)
+{
+    float* out = instanceData.data() + (size_t)start * FloatsPerInstance;
+    for (int i = start; i < end; i++, out += FloatsPerInstance) {
+        float theta = spinPhase[i] + spinRate[i] * time;
+        float c = cosf(theta);
+        float s = sinf(theta);
+        float t = 1.0f - c;
+        float x = axisX[i], y = axisY[i], z = axisZ[i];
+
+        // The rotation matrix R, by rows
+        float r11 = t * x * x + c, r12 = t * x * y - s * z, r13 = t * x * z + s * y;
+        float r21 = t * x * y + s * z, r22 = t * y * y + c, r23 = t * y * z - s * x;
+        float r31 = t * x * z - s * y, r32 = t * y * z + s * x, r33 = t * z * z + c;
+
+        // Columns are scaled by the scale factors; the translation is pos + R*pivot.
+        float sx = scaleX[i], sy = scaleY[i], sz = scaleZ[i];
+        float px = pivotX[i], py = pivotY[i], pz = pivotZ[i];
+        out[0] = r11 * sx;  out[1] = r12 * sy;  out[2] = r13 * sz;
+        out[3] = posX[i] + r11 * px + r12 * py + r13 * pz;
+        out[4] = r21 * sx;  out[5] = r22 * sy;  out[6] = r23 * sz;
+        out[7] = posY[i] + r21 * px + r22 * py + r23 * pz;
+        out[8] = r31 * sx;  out[9] = r32 * sy;  out[10] = r33 * sz;
+        out[11] = posZ[i] + r31 * px + r32 * py + r33 * pz;
+        out[12] = colorR[i]; out[13] = colorG[i]; out[14] = colorB[i]; out[15] = 1.0f;
+    }
+}
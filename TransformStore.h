@@ -0,0 +1,91 @@
+/*
+* TransformStore.h - Version 1.0
+*
+* A data-oriented ("structure of arrays") store of many spinning objects.
+*   Each entity has a position, a spin axis and angle, a pivot offset,
+*   a scale, a color and a geometry ID.  Each value is kept in its own
+*   contiguous array, so the per-frame update is a simple loop over arrays
+*   that the compiler can vectorize, and that is split among several threads.
+*
+*   The update writes one instance record per entity (an affine 3x4 matrix
+*   plus a color: 16 floats).  The entities are kept sorted by geometry ID,
+*   so each geometry is drawn with a single instanced draw call.
+*
+* Software is "as-is" and carries no warranty.  It may be used without
+*   restriction, but if you modify it, please change the filenames to
+*   prevent confusion between different versions.
+*/
+
+#pragma once
+#ifndef TRANSFORM_STORE_H
+#define TRANSFORM_STORE_H
+
+#include <vector>
+
+// TransformStore
+//     The model matrix of entity i is
+//           Translate(pos) * Rotate(angle, axis) * Translate(pivot) * Scale(scale)
+//     where angle = spinPhase + spinRate*time.
+// How to use:
+//     * Call Add() for each entity (or Reserve() first for large numbers).
+//     * Call SortByGeometry() after all entities are added.
+//     * Each frame, call Update(time) and then upload GetInstanceData().
+//       GetBatchStart(g) and GetBatchCount(g) give the range of instances
+//       using geometry g.
+
+class TransformStore
+{
+public:
+    static const int FloatsPerInstance = 16;    // Three rows of the affine matrix, then r,g,b,1
+
+    TransformStore() {}
+
+    // Disable all copy and assignment operators.
+    TransformStore(const TransformStore&) = delete;
+    TransformStore& operator=(const TransformStore&) = delete;
+    TransformStore(TransformStore&&) = delete;
+    TransformStore& operator=(TransformStore&&) = delete;
+
+    void Clear();
+    void Reserve(int numEntities);
+
+    // Add one entity.  The spin axis does not need to be a unit vector.
+    // Returns the index of the new entity (only valid until SortByGeometry() is called).
+    int Add(int geometryID,
+        float x, float y, float z,                          // Position
+        float axisX, float axisY, float axisZ,              // Spin axis
+        float spinPhase, float spinRate,                    // Angle at time zero, radians per unit time
+        float pivotX, float pivotY, float pivotZ,           // Offset applied before the rotation
+        float scaleX, float scaleY, float scaleZ,
+        float red, float green, float blue);
+
+    // Reorder the entities so that each geometry ID occupies a contiguous range.
+    void SortByGeometry();
+
+    // Compute the instance data for all entities at the given time.
+    // Large stores are split among worker threads.
+    void Update(double time);
+
+    int GetNumEntities() const { return (int)geomID.size(); }
+    int GetNumGeometries() const { return (int)batchStart.size() - 1; }
+    int GetBatchStart(int geometryID) const { return batchStart[geometryID]; }
+    int GetBatchCount(int geometryID) const { return batchStart[geometryID + 1] - batchStart[geometryID]; }
+    const float* GetInstanceData() const { return instanceData.data(); }
+
+private:
+    std::vector<int> geomID;
+    std::vector<float> posX, posY, posZ;
+    std::vector<float> axisX, axisY, axisZ;                 // Unit vectors
+    std::vector<float> spinPhase, spinRate;
+    std::vector<float> pivotX, pivotY, pivotZ;
+    std::vector<float> scaleX, scaleY, scaleZ;
+    std::vector<float> colorR, colorG, colorB;
+
+    std::vector<int> batchStart;                            // Set by SortByGeometry()
+    std::vector<float> instanceData;                        // FloatsPerInstance floats per entity
+
+    void UpdateRange(float time, int start, int end);
+    template<class T> static void Permute(std::vector<T>& v, const std::vector<int>& order);
+};
+
+#endif  // TRANSFORM_STORE_H
@@ -0,0 +1,218 @@
+//
+//  UploadBench.cpp
+//
+//   Times the ways to upload data which changes every frame.
+//   Each "frame" uploads a block of data, then the GPU reads all of it
+//   (by copying it into another buffer).  So an upload method which
+//   makes the CPU wait for the GPU, or makes the driver copy the data
+//   an extra time, is slower.
+//
+
+
+// Use the static library (so glew32.dll is not needed):
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <vector>
+#include "GlStreamBuffer.h"
+
+// Enable standard input and output via printf(), etc.
+// Put this include *after* the includes for glew and GLFW!
+#include <stdio.h>
+#include <string.h>
+
+#include "UploadBench.h"
+#include "SurfaceProj.h"
+#include "GlGeomSphere.h"
+
+const int UploadBenchFrames = 100;
+
+unsigned int uploadBenchDest = 0;       // The GPU copies the uploaded data into this buffer
+
+// Time UploadBenchFrames frames.  upload() writes the data, and returns the
+//    buffer and the offset where the GPU finds it.
+template<class F> void TimeUploads(const char* name, size_t numBytes, F upload)
+{
+    unsigned int buffer;
+    size_t offset;
+    upload(buffer, offset);             // Warm up: allocations, first mappings, etc.
+    glFinish();
+
+    double startTime = glfwGetTime();
+    for (int frame = 0; frame < UploadBenchFrames; frame++) {
+        upload(buffer, offset);
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, uploadBenchDest);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)offset, 0, (GLsizeiptr)numBytes);
+    }
+    glFinish();
+    double seconds = (glfwGetTime() - startTime) / UploadBenchFrames;
+    printf("  %-40s %8.3f ms/frame %7.2f GB/s\n", name, 1000.0 * seconds, 1.0e-9 * numBytes / seconds);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+// Write the vertices of a numRows x numCols grid (8 floats per vertex, rows
+//    consecutive in memory) to dest.  If columnOrder is true, they are written
+//    one column at a time, so consecutive writes are a row apart, as the
+//    generators used to do.
+void WriteGridVertices(float* dest, int numRows, int numCols, bool columnOrder)
+{
+    const int stride = 8;
+    int outerCount = columnOrder ? numCols : numRows;
+    int innerCount = columnOrder ? numRows : numCols;
+    for (int outer = 0; outer < outerCount; outer++) {
+        for (int inner = 0; inner < innerCount; inner++) {
+            int i = columnOrder ? inner : outer;
+            int j = columnOrder ? outer : inner;
+            float* vPtr = dest + stride * (i * numCols + j);
+            float x = (float)j;
+            float y = (float)i;
+            vPtr[0] = x;
+            vPtr[1] = y;
+            vPtr[2] = 0.0f;
+            vPtr[3] = 0.0f;
+            vPtr[4] = 0.0f;
+            vPtr[5] = 1.0f;
+            vPtr[6] = x / numCols;
+            vPtr[7] = y / numRows;
+        }
+    }
+}
+
+// Mapped buffers are usually write-combined (uncached) memory: writes which jump
+//    around, or partly rewrite a vertex, cost far more than sequential writes.
+//    Compares writing directly into the mapped buffer with generating into a
+//    staging block (in the cache) and copying it into the mapped buffer.
+void RunVertexWriteBenchmark(unsigned int buffer)
+{
+    const int numRows = 512;
+    const int numCols = 512;
+    size_t numBytes = (size_t)numRows * numCols * 8 * sizeof(float);
+    printf(" Writing a %d x %d grid of vertices (%d KB) into a mapped buffer:\n",
+        numRows, numCols, (int)(numBytes / 1024));
+    std::vector<float> staging(numBytes / sizeof(float));
+    glBindBuffer(GL_COPY_WRITE_BUFFER, uploadBenchDest);
+    glBufferData(GL_COPY_WRITE_BUFFER, numBytes, 0, GL_STATIC_COPY);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, numBytes, 0, GL_STREAM_DRAW);
+    GLbitfield mapFlags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+    for (int method = 0; method < 4; method++) {
+        static const char* names[] = { "mapped, scattered writes", "mapped, sequential writes",
+            "staging, scattered + memcpy", "staging, sequential + memcpy" };
+        bool columnOrder = (method % 2) == 0;
+        bool useStaging = (method >= 2);
+        TimeUploads(names[method], numBytes, [&](unsigned int& buf, size_t& offset) {
+            glBindBuffer(GL_ARRAY_BUFFER, buffer);
+            float* dest = (float*)glMapBufferRange(GL_ARRAY_BUFFER, 0, numBytes, mapFlags);
+            if (useStaging) {
+                WriteGridVertices(staging.data(), numRows, numCols, columnOrder);
+                memcpy(dest, staging.data(), numBytes);
+            }
+            else {
+                WriteGridVertices(dest, numRows, numCols, columnOrder);
+            }
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            buf = buffer;
+            offset = 0;
+        });
+    }
+
+    // A real generator, writing straight into the mapped buffer, and via staging.
+    GlGeomSphere sphere(512, 256);
+    int numVerts = sphere.GetNumVerticesTexCoords();
+    size_t vboBytes = (size_t)numVerts * 8 * sizeof(float);
+    std::vector<unsigned int> elements(sphere.GetNumElements());
+    staging.resize(vboBytes / sizeof(float));
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, vboBytes, 0, GL_STREAM_DRAW);
+    for (int useStaging = 0; useStaging < 2; useStaging++) {
+        TimeUploads(useStaging ? "GlGeomSphere, staging + memcpy" : "GlGeomSphere, mapped",
+            vboBytes, [&](unsigned int& buf, size_t& offset) {
+                glBindBuffer(GL_ARRAY_BUFFER, buffer);
+                float* dest = (float*)glMapBufferRange(GL_ARRAY_BUFFER, 0, vboBytes, mapFlags);
+                float* vbo = useStaging ? staging.data() : dest;
+                sphere.CalcVboAndEbo(vbo, elements.data(), 0, 3, 6, 8);
+                if (useStaging) {
+                    memcpy(dest, vbo, vboBytes);
+                }
+                glUnmapBuffer(GL_ARRAY_BUFFER);
+                buf = buffer;
+                offset = 0;
+            });
+    }
+}
+
+void MyRunUploadBenchmark() {
+    static const size_t sizes[] = { 64 * 1024, 1024 * 1024, 16 * 1024 * 1024 };
+    printf("Upload benchmark (%d frames; each frame uploads the data, then the GPU reads it):\n", UploadBenchFrames);
+    if (!GlStreamBuffer::PersistentMappingSupported()) {
+        printf("  (Persistent mapping needs OpenGL 4.4 or ARB_buffer_storage: not supported.)\n");
+    }
+
+    unsigned int buffer;
+    glGenBuffers(1, &buffer);
+    glGenBuffers(1, &uploadBenchDest);
+    for (size_t numBytes : sizes) {
+        printf(" %d KB per frame:\n", (int)(numBytes / 1024));
+        std::vector<char> data(numBytes);
+        for (size_t i = 0; i < numBytes; i++) {
+            data[i] = (char)i;
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, uploadBenchDest);
+        glBufferData(GL_COPY_WRITE_BUFFER, numBytes, 0, GL_STATIC_COPY);
+
+        // Reallocate the buffer each frame (the driver may "orphan" the old storage).
+        TimeUploads("glBufferData", numBytes, [&](unsigned int& buf, size_t& offset) {
+            glBindBuffer(GL_ARRAY_BUFFER, buffer);
+            glBufferData(GL_ARRAY_BUFFER, numBytes, data.data(), GL_STREAM_DRAW);
+            buf = buffer;
+            offset = 0;
+        });
+
+        // Overwrite the same storage each frame (the driver must wait, or copy the data).
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glBufferData(GL_ARRAY_BUFFER, numBytes, 0, GL_STREAM_DRAW);
+        TimeUploads("glBufferSubData", numBytes, [&](unsigned int& buf, size_t& offset) {
+            glBindBuffer(GL_ARRAY_BUFFER, buffer);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, numBytes, data.data());
+            buf = buffer;
+            offset = 0;
+        });
+
+        // Map with the old contents invalidated.
+        TimeUploads("glMapBufferRange, invalidate buffer", numBytes, [&](unsigned int& buf, size_t& offset) {
+            glBindBuffer(GL_ARRAY_BUFFER, buffer);
+            void* dest = glMapBufferRange(GL_ARRAY_BUFFER, 0, numBytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+            memcpy(dest, data.data(), numBytes);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            buf = buffer;
+            offset = 0;
+        });
+
+        // Triple buffered, with fences: mapped unsynchronized each frame, then persistently.
+        for (int persistent = 0; persistent < 2; persistent++) {
+            if (persistent && !GlStreamBuffer::PersistentMappingSupported()) {
+                break;
+            }
+            GlStreamBuffer stream;
+            stream.Allocate(GL_ARRAY_BUFFER, numBytes, 256, persistent != 0);
+            TimeUploads(persistent ? "GlStreamBuffer, persistent mapping" : "GlStreamBuffer, unsynchronized map",
+                numBytes, [&](unsigned int& buf, size_t& offset) {
+                    memcpy(stream.BeginWrite(), data.data(), numBytes);
+                    stream.EndWrite();
+                    buf = stream.GetBuffer();
+                    offset = stream.GetRegionOffset();
+                });
+            printf("  %-40s %d waits for the GPU\n", "", stream.GetNumWaits());
+        }
+    }
+    RunVertexWriteBenchmark(buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDeleteBuffers(1, &buffer);
+    glDeleteBuffers(1, &uploadBenchDest);
+    uploadBenchDest = 0;
+
+    check_for_opengl_errors();
+}
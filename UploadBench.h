@@ -0,0 +1,17 @@
+#pragma once
+
+//
+// UploadBench.h   ---  Header file for UploadBench.cpp.
+//
+//   A benchmark of the ways to upload data which changes every frame:
+//   glBufferData, glBufferSubData, glMapBufferRange with invalidation,
+//   and a GlStreamBuffer (with and without persistent mapping).
+//   Also times writing vertices into a mapped buffer, in scattered and in
+//   sequential order, directly and via a staging block.
+//   The results for this computer and driver are printed.
+//
+
+//
+// Function Prototypes
+//
+void MyRunUploadBenchmark();        // Runs the benchmark (takes a few seconds), and prints the results.